@@ -982,6 +982,27 @@ namespace pcl
     return (os);
   }
 
+  /** \brief A point structure representing the Signature of Histograms of OrienTations (SHOT) with 8 bits per
+    * bin, a quarter of the size of pcl::SHOT. Bin i is recovered as descriptor[i] * scale / 255.
+    * \ingroup common
+    */
+  struct SHOTQuantized
+  {
+    std::vector<uint8_t> descriptor;
+    float rf[9];
+    float scale;
+  };
+
+  inline std::ostream& operator << (std::ostream& os, const SHOTQuantized& p)
+  {
+    for (int i = 0; i < 9; ++i)
+    os << (i == 0 ? "(" : "") << p.rf[i] << (i < 8 ? ", " : ")");
+    for (size_t i = 0; i < p.descriptor.size (); ++i)
+    os << (i == 0 ? "(" : "") << static_cast<int> (p.descriptor[i]) << (i < p.descriptor.size()-1 ? ", " : ")");
+    os << " - " << p.scale;
+    return (os);
+  }
+
   /** \brief A structure representing the Local Reference Frame of a point.
     *  \ingroup common
     */
@@ -186,6 +186,11 @@ namespace pcl
     */
   struct SHOT;
 
+  /** \brief Members: std::vector<uint8_t> descriptor, rf[9], scale
+    * \ingroup common
+    */
+  struct SHOTQuantized;
+
   /** \brief Members: Axis x_axis, y_axis, z_axis
     * \ingroup common
     */
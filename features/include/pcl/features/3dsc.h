@@ -187,6 +187,22 @@ namespace pcl
       bool
       computePoint (size_t index, const pcl::PointCloud<PointNT> &normals, float rf[9], std::vector<float> &desc);
 
+      /** \brief Estimate a descriptor for a given point from its already computed neighborhood. Unlike
+        * \ref computePoint, this method does not draw from the random number generator and can therefore be
+        * called concurrently from several threads.
+        * \param[in] index the index of the point to estimate a descriptor for
+        * \param[in] nn_indices the indices of the (non empty) neighborhood of the point within search_radius_
+        * \param[in] nn_dists the squared distances from the point to its neighbors
+        * \param[in] normals a pointer to the set of normals
+        * \param[in] random_axis the random direction the X axis of the RF is derived from
+        * \param[out] rf the reference frame
+        * \param[out] desc the resultant estimated descriptor
+        */
+      void
+      computePointDescriptor (size_t index, const std::vector<int> &nn_indices, const std::vector<float> &nn_dists,
+                              const pcl::PointCloud<PointNT> &normals, const Eigen::Vector3f &random_axis,
+                              float rf[9], std::vector<float> &desc) const;
+
       /** \brief Estimate the actual feature. 
         * \param[out] output the resultant feature 
         */
@@ -74,7 +74,7 @@ namespace pcl
 
       /** \brief Constructor. */
       CRHEstimation () :
-        vpx_ (0), vpy_ (0), vpz_ (0), nbins_ (90)
+        vpx_ (0), vpy_ (0), vpz_ (0), nbins_ (90), centroid_ (Eigen::Vector4f::Zero ()), centroid_set_ (false)
       {
         k_ = 1;
         feature_name_ = "CRHEstimation";
@@ -107,10 +107,15 @@ namespace pcl
         vpz = vpz_;
       }
 
+      /** \brief Set the centroid of the object. If none is given, the centroid of the points given by
+       * <setInputCloud (), setIndices ()> is used, which is what a batch over several segments needs.
+       * \param[in] centroid the centroid of the object
+       */
       inline void
       setCentroid (Eigen::Vector4f & centroid)
       {
         centroid_ = centroid;
+        centroid_set_ = true;
       }
 
     private:
@@ -125,6 +130,9 @@ namespace pcl
       /** \brief Centroid to be used */
       Eigen::Vector4f centroid_;
 
+      /** \brief Whether the centroid was given with setCentroid () */
+      bool centroid_set_;
+
       /** \brief Estimate the CRH histogram at
        * a set of points given by <setInputCloud (), setIndices ()> using the surface in
        * setSearchSurface ()
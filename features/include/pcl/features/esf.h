@@ -44,6 +44,7 @@
 #define GRIDSIZE_H GRIDSIZE/2
 //#include <boost/multi_array.hpp>
 #include <vector>
+#include <ctime>
 
 namespace pcl
 {
@@ -71,7 +72,7 @@ namespace pcl
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
 
       /** \brief Empty constructor. */
-      ESFEstimation () : lut_ (), local_cloud_ ()
+      ESFEstimation () : lut_ (), local_cloud_ (), seed_ (static_cast<unsigned int> (time (NULL))), threads_ (1)
       {
         feature_name_ = "ESFEstimation";
         lut_.resize (GRIDSIZE);
@@ -87,19 +88,79 @@ namespace pcl
       }
 
       /** \brief Estimate the Ensebmel of Shape Function (ESF) descriptors at a set of points given by
-        * <setInputCloud (),
+        * <setInputCloud (), setIndices ()>, or of the whole search surface if one was given
         * \param output the resultant point cloud model histogram that contains the ESF feature estimates
         */
       void 
       computeFeature (PointCloudOut &output);
 
+      /** \brief Set the seed of the random point triplet sampling. The descriptor of a cloud only depends on
+        * the seed, not on the number of threads.
+        * \param[in] seed the seed
+        */
+      inline void
+      setSeed (unsigned int seed)
+      {
+        seed_ = seed;
+      }
+
+      /** \brief Get the seed of the random point triplet sampling. */
+      inline unsigned int
+      getSeed () const
+      {
+        return (seed_);
+      }
+
+      /** \brief Set the number of threads to use for sampling the point triplets.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = (nr_threads == 0) ? 1 : nr_threads;
+      }
+
+      /** \brief Get the number of threads to use for sampling the point triplets. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
     protected:
 
+      /** \brief The shape function values of a block of point triplets, sampled with their own random number
+        * generator so that the blocks can be sampled in parallel.
+        */
+      struct TripletSamples
+      {
+        /** \brief D2 distances and their IN (0), OUT (1) or MIXED (2) classes, three per triplet. */
+        std::vector<float> d2v;
+        std::vector<int> wt_d2;
+        /** \brief D3 areas and their IN ratios, one per triplet. */
+        std::vector<float> d3v;
+        std::vector<float> wt_d3;
+        /** \brief The A3 angle and D2 ratio histograms. */
+        float h_a3_in[GRIDSIZE];
+        float h_a3_out[GRIDSIZE];
+        float h_a3_mix[GRIDSIZE];
+        float h_mix_ratio[GRIDSIZE];
+      };
+
+      /** \brief Sample random point triplets of a voxelized cloud and compute their shape functions.
+        * \param[in] pc the cloud scaled into the voxel grid
+        * \param[in] seed the seed of the random number generator of this block of triplets
+        * \param[in] sample_size the number of triplets to sample
+        * \param[out] samples the shape function values of the triplets
+        */
+      void
+      sampleTriplets (const PointCloudIn &pc, unsigned int seed, int sample_size, TripletSamples &samples) const;
+
       /** \brief ... */
       int
       lci (const int x1, const int y1, const int z1, 
            const int x2, const int y2, const int z2, 
-           float &ratio, int &incnt, int &pointcount);
+           float &ratio, int &incnt, int &pointcount) const;
      
       /** \brief ... */
       void
@@ -126,6 +187,12 @@ namespace pcl
       /** \brief ... */
       PointCloudIn local_cloud_;
 
+      /** \brief The seed of the random point triplet sampling. */
+      unsigned int seed_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud
         */
@@ -156,6 +156,8 @@ namespace pcl
       }
 
       /** \brief Provide a pointer to the search object.
+        * \note Several features computed on the same cloud with the same search parameter can share a
+        * \ref pcl::search::NeighborhoodCache, so that the neighbors are only searched for once.
         * \param[in] tree a pointer to the spatial search object.
         */
       inline void
@@ -77,6 +77,8 @@ namespace pcl
       using Feature<PointInT, PointOutT>::indices_;
       using Feature<PointInT, PointOutT>::k_;
       using Feature<PointInT, PointOutT>::search_parameter_;
+      using Feature<PointInT, PointOutT>::search_radius_;
+      using Feature<PointInT, PointOutT>::tree_;
       using Feature<PointInT, PointOutT>::input_;
       using Feature<PointInT, PointOutT>::surface_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
@@ -88,7 +90,9 @@ namespace pcl
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
 
       /** \brief Empty constructor. */
-      FPFHEstimationOMP () : nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11), threads_ (1) 
+      FPFHEstimationOMP () : nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11), threads_ (1),
+        previous_points_ (), neighborhood_sqr_radii_ (), max_neighborhood_sqr_radius_ (0),
+        previous_k_ (0), previous_search_radius_ (0)
       {
         feature_name_ = "FPFHEstimationOMP";
       };
@@ -96,7 +100,9 @@ namespace pcl
       /** \brief Initialize the scheduler and set the number of threads to use.
         * \param[in] nr_threads the number of hardware threads to use (-1 sets the value back to automatic)
         */
-      FPFHEstimationOMP (unsigned int nr_threads) : nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11), threads_ (0)
+      FPFHEstimationOMP (unsigned int nr_threads) : nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11), threads_ (0),
+        previous_points_ (), neighborhood_sqr_radii_ (), max_neighborhood_sqr_radius_ (0),
+        previous_k_ (0), previous_search_radius_ (0)
       {
         setNumberOfThreads (nr_threads);
       }
@@ -112,6 +118,26 @@ namespace pcl
         threads_ = nr_threads; 
       }
 
+      /** \brief Update the FPFH descriptors of the last call to compute () or computeIncremental () after points of
+        * the input cloud were added, removed or moved. Only the SPFH signatures of the points whose neighborhood
+        * changed are recomputed, and only the FPFH signatures that aggregate one of them.
+        *
+        * The points that did not change have to keep their index: new points are appended to the cloud or fill the
+        * slots of removed points, and removed points are either set to NaN in place or dropped from the end of the
+        * cloud. Points appended to or dropped from the end of the cloud do not have to be listed. The search method
+        * is rebuilt on the input cloud, even if the cloud was modified in place.
+        *
+        * All the descriptors are computed as in compute () if the last computation used setIndices () or
+        * setSearchSurface (), used other search parameters, or if \a output does not hold its result.
+        * \param[in] added the indices of the points added to the input cloud
+        * \param[in] removed the indices (in the previous cloud) of the points removed from the input cloud
+        * \param[in] moved the indices of the points whose coordinates or normals changed
+        * \param[in,out] output the descriptors of the previous cloud, updated to the descriptors of the input cloud
+        */
+      void
+      computeIncremental (const std::vector<int> &added, const std::vector<int> &removed,
+                          const std::vector<int> &moved, PointCloudOut &output);
+
     private:
       /** \brief Estimate the Fast Point Feature Histograms (FPFH) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
@@ -121,6 +147,25 @@ namespace pcl
       void 
       computeFeature (PointCloudOut &output);
 
+      /** \brief Get the squared radius of a neighborhood, from the squared distances returned by the search method.
+        * A neighborhood with less than k points is unbounded, and gets std::numeric_limits<float>::max ().
+        * \param[in] nn_dists the squared distances to the neighbors
+        */
+      inline float
+      getNeighborhoodSqrRadius (const std::vector<float> &nn_dists) const;
+
+      /** \brief Set max_neighborhood_sqr_radius_ to the largest bounded radius in neighborhood_sqr_radii_. */
+      void
+      updateMaxNeighborhoodSqrRadius ();
+
+      /** \brief Mark the points whose neighborhood contains a given position, i.e. the points that are closer to it
+        * than the radius of their neighborhood.
+        * \param[in] positions the positions to look up
+        * \param[in,out] affected set to 1 for every point found
+        */
+      void
+      markAffectedPoints (const std::vector<Eigen::Vector3f> &positions, std::vector<char> &affected) const;
+
     public:
       /** \brief The number of subdivisions for each angular feature interval. */
       int nr_bins_f1_, nr_bins_f2_, nr_bins_f3_;
@@ -128,6 +173,23 @@ namespace pcl
       /** \brief The number of threads the scheduler should use. */
       unsigned int threads_;
 
+      /** \brief The coordinates of the points at the time of the last computation, used to find the neighborhoods
+        * that a removed or moved point was part of. Empty if the last computation cannot be updated incrementally.
+        */
+      std::vector<Eigen::Vector3f> previous_points_;
+
+      /** \brief The squared radius of the neighborhood of every point at the time of the last computation. */
+      std::vector<float> neighborhood_sqr_radii_;
+
+      /** \brief The largest value in neighborhood_sqr_radii_, not counting the unbounded neighborhoods. */
+      float max_neighborhood_sqr_radius_;
+
+      /** \brief The number of neighbors used by the last computation. */
+      int previous_k_;
+
+      /** \brief The search radius used by the last computation. */
+      double previous_search_radius_;
+
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud 
         */
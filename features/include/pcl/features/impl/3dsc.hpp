@@ -131,11 +131,6 @@ template <typename PointInT, typename PointNT, typename PointOutT> bool
 pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
     size_t index, const pcl::PointCloud<PointNT> &normals, float rf[9], std::vector<float> &desc)
 {
-  // The RF is formed as this x_axis | y_axis | normal
-  Eigen::Map<Eigen::Vector3f> x_axis (rf);
-  Eigen::Map<Eigen::Vector3f> y_axis (rf + 3);
-  Eigen::Map<Eigen::Vector3f> normal (rf + 6);
-
   // Find every point within specified search_radius_
   std::vector<int> nn_indices;
   std::vector<float> nn_dists;
@@ -149,6 +144,30 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
     return (false);
   }
 
+  // Draw the random direction of the RF X axis
+  Eigen::Vector3f random_axis;
+  random_axis[0] = static_cast<float> (rnd ());
+  random_axis[1] = static_cast<float> (rnd ());
+  random_axis[2] = static_cast<float> (rnd ());
+
+  computePointDescriptor (index, nn_indices, nn_dists, normals, random_axis, rf, desc);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePointDescriptor (
+    size_t index, const std::vector<int> &nn_indices, const std::vector<float> &nn_dists,
+    const pcl::PointCloud<PointNT> &normals, const Eigen::Vector3f &random_axis,
+    float rf[9], std::vector<float> &desc) const
+{
+  // The RF is formed as this x_axis | y_axis | normal
+  Eigen::Map<Eigen::Vector3f> x_axis (rf);
+  Eigen::Map<Eigen::Vector3f> y_axis (rf + 3);
+  Eigen::Map<Eigen::Vector3f> normal (rf + 6);
+
+  const size_t neighb_cnt = nn_indices.size ();
+
   float minDist = std::numeric_limits<float>::max ();
   int minIndex = -1;
   for (size_t i = 0; i < nn_indices.size (); i++)
@@ -167,9 +186,7 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
   normal = normals[minIndex].getNormalVector3fMap ();
 
   // Compute and store the RF direction
-  x_axis[0] = static_cast<float> (rnd ());
-  x_axis[1] = static_cast<float> (rnd ());
-  x_axis[2] = static_cast<float> (rnd ());
+  x_axis = random_axis;
   if (!pcl::utils::equal (normal[2], 0.0f))
     x_axis[2] = - (normal[0]*x_axis[0] + normal[1]*x_axis[1]) / normal[2];
   else if (!pcl::utils::equal (normal[1], 0.0f))
@@ -272,7 +289,6 @@ pcl::ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint (
 
   // 3DSC does not define a repeatable local RF, we set it to zero to signal it to the user 
   memset (rf, 0, sizeof (rf[0]) * 9);
-  return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
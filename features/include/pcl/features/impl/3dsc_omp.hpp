@@ -0,0 +1,113 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_3DSC_OMP_HPP_
+#define PCL_FEATURES_IMPL_3DSC_OMP_HPP_
+
+#include <pcl/features/3dsc_omp.h>
+#include <pcl/features/impl/3dsc.hpp>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  const int nr_points = static_cast<int> (indices_->size ());
+  // The neighborhoods of a whole block are kept in memory between the search and the description
+  const int block_size = 64 * static_cast<int> (threads_);
+
+  std::vector<std::vector<int> > nn_indices (block_size);
+  std::vector<std::vector<float> > nn_dists (block_size);
+  std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > random_axes (block_size);
+
+  bool is_dense = true;
+  for (int block_start = 0; block_start < nr_points; block_start += block_size)
+  {
+    const int block_end = std::min (block_start + block_size, nr_points);
+
+    // Find every point within specified search_radius_
+#pragma omp parallel for schedule (dynamic, 8) num_threads (threads_)
+    for (int point_index = block_start; point_index < block_end; ++point_index)
+    {
+      const int i = point_index - block_start;
+      if (!isFinite ((*input_)[(*indices_)[point_index]]))
+      {
+        nn_indices[i].clear ();
+        nn_dists[i].clear ();
+        continue;
+      }
+      if (searchForNeighbors ((*indices_)[point_index], search_radius_, nn_indices[i], nn_dists[i]) == 0)
+        nn_indices[i].clear ();
+    }
+
+    // Draw the random X axis directions sequentially, in the same order as ShapeContext3DEstimation
+    for (int i = 0; i < block_end - block_start; ++i)
+    {
+      if (nn_indices[i].empty ())
+        continue;
+      random_axes[i][0] = static_cast<float> (this->rnd ());
+      random_axes[i][1] = static_cast<float> (this->rnd ());
+      random_axes[i][2] = static_cast<float> (this->rnd ());
+    }
+
+    // Iterate over all points of the block and compute the descriptors
+#pragma omp parallel for schedule (dynamic, 8) num_threads (threads_) reduction (&& : is_dense)
+    for (int point_index = block_start; point_index < block_end; ++point_index)
+    {
+      const int i = point_index - block_start;
+      output[point_index].descriptor.resize (descriptor_length_);
+
+      // If the point is not finite or has no neighbors, set the descriptor to NaN and the RF to 0
+      if (nn_indices[i].empty ())
+      {
+        for (size_t d = 0; d < descriptor_length_; ++d)
+          output[point_index].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+
+        memset (output[point_index].rf, 0, sizeof (output[point_index].rf[0]) * 9);
+        is_dense = false;
+        continue;
+      }
+
+      this->computePointDescriptor (point_index, nn_indices[i], nn_dists[i], *normals_, random_axes[i],
+                                    output[point_index].rf, output[point_index].descriptor);
+    }
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_ShapeContext3DEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::ShapeContext3DEstimationOMP<T,NT,OutT>;
+
+#endif
@@ -67,10 +67,14 @@ pcl::CRHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
     return;
   }
 
+  Eigen::Vector4f centroid = centroid_;
+  if (!centroid_set_)
+    compute3DCentroid (*surface_, *indices_, centroid);
+
   Eigen::Vector3f plane_normal;
-  plane_normal[0] = -centroid_[0];
-  plane_normal[1] = -centroid_[1];
-  plane_normal[2] = -centroid_[2];
+  plane_normal[0] = -centroid[0];
+  plane_normal[1] = -centroid[1];
+  plane_normal[2] = -centroid[2];
   Eigen::Vector3f z_vector = Eigen::Vector3f::UnitZ ();
   plane_normal.normalize ();
   Eigen::Vector3f axis = plane_normal.cross (z_vector);
@@ -94,7 +98,7 @@ pcl::CRHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
   pcl::transformPointCloudWithNormals (grid, grid, transformPC);
 
   //fill spatial data vector
-  kiss_fft_scalar * spatial_data = new kiss_fft_scalar[nbins];
+  kiss_fft_scalar * spatial_data = new kiss_fft_scalar[nbins] ();
   float sum_w = 0, w = 0;
   int bin = 0;
   for (size_t i = 0; i < grid.points.size (); ++i)
@@ -127,6 +131,7 @@ pcl::CRHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
 
   delete[] spatial_data;
   delete[] freq_data;
+  kiss_fftr_free (mycfg);
 
 }
 
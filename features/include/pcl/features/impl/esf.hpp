@@ -42,41 +42,44 @@
 
 #include <pcl/features/esf.h>
 #include <pcl/common/common.h>
+#include <pcl/common/io.h>
 #include <pcl/common/transforms.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
 #include <vector>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
-    PointCloudIn &pc, std::vector<float> &hist)
+pcl::ESFEstimation<PointInT, PointOutT>::sampleTriplets (
+    const PointCloudIn &pc, unsigned int seed, int sample_size, TripletSamples &samples) const
 {
-  const int binsize = 64;
-  unsigned int sample_size = 20000;
-  srand (static_cast<unsigned int> (time (0)));
+  const int binsize = GRIDSIZE;
   int maxindex = static_cast<int> (pc.points.size ());
+  boost::mt19937 rng (seed);
+  boost::uniform_int<int> uniform (0, maxindex - 1);
+  boost::variate_generator<boost::mt19937&, boost::uniform_int<int> > random_index (rng, uniform);
 
   int index1, index2, index3;
-  std::vector<float> d2v, d1v, d3v, wt_d3;
-  std::vector<int> wt_d2;
-  d1v.reserve (sample_size);
+  std::vector<float> &d2v = samples.d2v, &d3v = samples.d3v, &wt_d3 = samples.wt_d3;
+  std::vector<int> &wt_d2 = samples.wt_d2;
+  d2v.clear ();
+  d3v.clear ();
+  wt_d2.clear ();
+  wt_d3.clear ();
   d2v.reserve (sample_size * 3);
   d3v.reserve (sample_size);
   wt_d2.reserve (sample_size * 3);
   wt_d3.reserve (sample_size);
 
-  float h_in[binsize] = {0};
-  float h_out[binsize] = {0};
-  float h_mix[binsize] = {0};
-  float h_mix_ratio[binsize] = {0};
-
-  float h_a3_in[binsize] = {0};
-  float h_a3_out[binsize] = {0};
-  float h_a3_mix[binsize] = {0};
-  float h_d1[binsize] = {0};
-
-  float h_d3_in[binsize] = {0};
-  float h_d3_out[binsize] = {0};
-  float h_d3_mix[binsize] = {0};
+  float *h_mix_ratio = samples.h_mix_ratio;
+  float *h_a3_in = samples.h_a3_in;
+  float *h_a3_out = samples.h_a3_out;
+  float *h_a3_mix = samples.h_a3_mix;
+  std::fill (h_mix_ratio, h_mix_ratio + binsize, 0.0f);
+  std::fill (h_a3_in, h_a3_in + binsize, 0.0f);
+  std::fill (h_a3_out, h_a3_out + binsize, 0.0f);
+  std::fill (h_a3_mix, h_a3_mix + binsize, 0.0f);
 
   float ratio=0.0;
   float pih = static_cast<float>(M_PI) / 2.0f;
@@ -84,12 +87,12 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
   int th1,th2,th3;
   int vxlcnt = 0;
   int pcnt1,pcnt2,pcnt3;
-  for (size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
+  for (int nn_idx = 0; nn_idx < sample_size; ++nn_idx)
   {
     // get a new random point
-    index1 = rand()%maxindex;
-    index2 = rand()%maxindex;
-    index3 = rand()%maxindex;
+    index1 = random_index ();
+    index2 = random_index ();
+    index3 = random_index ();
 
     if (index1==index2 || index1 == index3 || index2 == index3)
     {
@@ -212,32 +215,75 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
         wt_d3.push_back (static_cast<float> (vxlcnt_sum) / static_cast<float> (p_cnt));
       }
   }
-  // Normalizing, get max
-  float maxd1 = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
+    PointCloudIn &pc, std::vector<float> &hist)
+{
+  const int binsize = 64;
+  const int sample_size = 20000;
+
+  // The triplets are sampled in fixed blocks, each with its own random number generator, and merged in
+  // the order of the blocks, so that the descriptor does not depend on the number of threads
+  const int block_size = 1000;
+  const int nr_blocks = sample_size / block_size;
+  std::vector<TripletSamples> blocks (nr_blocks);
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads_)
+  for (int block = 0; block < nr_blocks; ++block)
+    sampleTriplets (pc, seed_ + static_cast<unsigned int> (block), block_size, blocks[block]);
+
+  std::vector<float> d2v, d3v, wt_d3;
+  std::vector<int> wt_d2;
+  d2v.reserve (sample_size * 3);
+  d3v.reserve (sample_size);
+  wt_d2.reserve (sample_size * 3);
+  wt_d3.reserve (sample_size);
+
+  float h_in[binsize] = {0};
+  float h_out[binsize] = {0};
+  float h_mix[binsize] = {0};
+  float h_mix_ratio[binsize] = {0};
+
+  float h_a3_in[binsize] = {0};
+  float h_a3_out[binsize] = {0};
+  float h_a3_mix[binsize] = {0};
+
+  float h_d3_in[binsize] = {0};
+  float h_d3_out[binsize] = {0};
+  float h_d3_mix[binsize] = {0};
+
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    d2v.insert (d2v.end (), blocks[block].d2v.begin (), blocks[block].d2v.end ());
+    d3v.insert (d3v.end (), blocks[block].d3v.begin (), blocks[block].d3v.end ());
+    wt_d2.insert (wt_d2.end (), blocks[block].wt_d2.begin (), blocks[block].wt_d2.end ());
+    wt_d3.insert (wt_d3.end (), blocks[block].wt_d3.begin (), blocks[block].wt_d3.end ());
+    for (int i = 0; i < binsize; ++i)
+    {
+      h_mix_ratio[i] += blocks[block].h_mix_ratio[i];
+      h_a3_in[i] += blocks[block].h_a3_in[i];
+      h_a3_out[i] += blocks[block].h_a3_out[i];
+      h_a3_mix[i] += blocks[block].h_a3_mix[i];
+    }
+  }
+
+  // Normalizing, get max. The triplets with a degenerate triangle have no D2 and D3 values.
   float maxd2 = 0;
   float maxd3 = 0;
 
-  for (size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
-  {
-    // get max of Dx
-    if (d1v[nn_idx] > maxd1)
-      maxd1 = d1v[nn_idx];
+  for (size_t nn_idx = 0; nn_idx < d2v.size (); ++nn_idx)
     if (d2v[nn_idx] > maxd2)
       maxd2 = d2v[nn_idx];
-    if (d2v[sample_size + nn_idx] > maxd2)
-      maxd2 = d2v[sample_size + nn_idx];
-    if (d2v[sample_size*2 +nn_idx] > maxd2)
-      maxd2 = d2v[sample_size*2 +nn_idx];
+  for (size_t nn_idx = 0; nn_idx < d3v.size (); ++nn_idx)
     if (d3v[nn_idx] > maxd3)
       maxd3 = d3v[nn_idx];
-  }
 
   // Normalize and create histogram
   int index;
-  for (size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
+  for (size_t nn_idx = 0; nn_idx < d3v.size (); ++nn_idx)
   {
-    h_d1[static_cast<int>(pcl_round (d1v[nn_idx] / maxd1 * (binsize-1)))]++ ;
-
     if (wt_d3[nn_idx] >= 0.999) // IN
     {
       index = static_cast<int>(pcl_round (d3v[nn_idx] / maxd3 * (binsize-1)));
@@ -311,7 +357,7 @@ template <typename PointInT, typename PointOutT> int
 pcl::ESFEstimation<PointInT, PointOutT>::lci (
     const int x1, const int y1, const int z1, 
     const int x2, const int y2, const int z2, 
-    float &ratio, int &incnt, int &pointcount)
+    float &ratio, int &incnt, int &pointcount) const
 {
   int voxelcount = 0;
   int voxel_in = 0;
@@ -512,9 +558,22 @@ pcl::ESFEstimation<PointInT, PointOutT>::scale_points_unit_sphere (
 template <typename PointInT, typename PointOutT> void
 pcl::ESFEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
+  // Describe the points given by the indices, unless a search surface was given
+  PointCloudIn segment;
+  if (this->fake_surface_ && !this->fake_indices_)
+    pcl::copyPointCloud (*input_, *indices_, segment);
+  const PointCloudIn &cloud = (this->fake_surface_ && !this->fake_indices_) ? segment : *surface_;
+  if (cloud.points.size () < 3)
+  {
+    PCL_ERROR ("[pcl::%s::computeFeature] At least 3 points are needed, %lu given!\n", getClassName ().c_str (), cloud.points.size ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
   Eigen::Vector4f xyz_centroid;
   std::vector<float> hist;
-  scale_points_unit_sphere (*surface_, static_cast<float>(GRIDSIZE_H), xyz_centroid);
+  scale_points_unit_sphere (cloud, static_cast<float>(GRIDSIZE_H), xyz_centroid);
   this->voxelize9 (local_cloud_);
   this->computeESF (local_cloud_, hist);
   this->cleanup9 (local_cloud_);
@@ -77,6 +77,11 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
       spfh_indices_vec[idx] = idx;
   }
 
+  // The state used by computeIncremental () is only kept when the rows of the SPFH signatures and the output points
+  // both match the indices of the input points
+  const bool keep_state = (surface_ == input_ && this->fake_indices_);
+  neighborhood_sqr_radii_.assign (keep_state ? surface_->points.size () : 0, 0.0f);
+
   // Initialize the arrays that will store the SPFH signatures
   size_t data_size = spfh_indices_vec.size ();
   hist_f1_.setZero (data_size, nr_bins_f1_);
@@ -102,7 +107,22 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
 
     // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
     spfh_hist_lookup[p_idx] = i;
+
+    if (keep_state)
+      neighborhood_sqr_radii_[p_idx] = getNeighborhoodSqrRadius (nn_dists);
+  }
+
+  if (keep_state)
+  {
+    previous_points_.resize (surface_->points.size ());
+    for (size_t i = 0; i < surface_->points.size (); ++i)
+      previous_points_[i] = surface_->points[i].getVector3fMap ();
+    updateMaxNeighborhoodSqrRadius ();
+    previous_k_ = k_;
+    previous_search_radius_ = search_radius_;
   }
+  else
+    previous_points_.clear ();
 
   // Intialize the array that will store the FPFH signature
   int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
@@ -141,6 +161,234 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeIncremental (
+    const std::vector<int> &added, const std::vector<int> &removed, const std::vector<int> &moved,
+    PointCloudOut &output)
+{
+  // The search method has to index the changed cloud, also when it was modified in place
+  if (input_ && tree_ && (!surface_ || surface_ == input_))
+    tree_->setInputCloud (input_);
+
+  if (!this->initCompute ())
+  {
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
+  const int nr_points = static_cast<int> (input_->points.size ());
+  const int nr_previous_points = static_cast<int> (previous_points_.size ());
+
+  // The previous computation has to be over the same index space, with the same parameters
+  bool incremental = (surface_ == input_ && this->fake_indices_ && !previous_points_.empty () &&
+                      static_cast<int> (output.points.size ()) == nr_previous_points &&
+                      previous_k_ == k_ && previous_search_radius_ == search_radius_ &&
+                      hist_f1_.rows () == nr_previous_points && hist_f1_.cols () == nr_bins_f1_ &&
+                      hist_f2_.cols () == nr_bins_f2_ && hist_f3_.cols () == nr_bins_f3_);
+  if (incremental)
+  {
+    for (size_t i = 0; i < added.size (); ++i)
+      incremental = incremental && added[i] >= 0 && added[i] < nr_points;
+    for (size_t i = 0; i < moved.size (); ++i)
+      incremental = incremental && moved[i] >= 0 && moved[i] < nr_points && moved[i] < nr_previous_points;
+    for (size_t i = 0; i < removed.size (); ++i)
+      incremental = incremental && removed[i] >= 0 && removed[i] < nr_previous_points;
+    if (!incremental)
+      PCL_WARN ("[pcl::%s::computeIncremental] Invalid point indices given, computing all the descriptors.\n", getClassName ().c_str ());
+  }
+
+  if (!incremental)
+  {
+    this->deinitCompute ();
+    this->compute (output);
+    return;
+  }
+
+  // Collect the changed points, with their current and their previous coordinates
+  std::vector<char> spfh_dirty (nr_points, 0);
+  std::vector<Eigen::Vector3f> positions, previous_positions;
+  for (size_t i = 0; i < added.size (); ++i)
+  {
+    spfh_dirty[added[i]] = 1;
+    positions.push_back (input_->points[added[i]].getVector3fMap ());
+  }
+  for (int i = nr_previous_points; i < nr_points; ++i)
+  {
+    spfh_dirty[i] = 1;
+    positions.push_back (input_->points[i].getVector3fMap ());
+  }
+  for (size_t i = 0; i < moved.size (); ++i)
+  {
+    spfh_dirty[moved[i]] = 1;
+    positions.push_back (input_->points[moved[i]].getVector3fMap ());
+    previous_positions.push_back (previous_points_[moved[i]]);
+  }
+  for (size_t i = 0; i < removed.size (); ++i)
+  {
+    if (removed[i] < nr_points)
+      spfh_dirty[removed[i]] = 1;
+    previous_positions.push_back (previous_points_[removed[i]]);
+  }
+  for (int i = nr_points; i < nr_previous_points; ++i)
+    previous_positions.push_back (previous_points_[i]);
+
+  // The SPFH signature of a point changes if a changed point enters or leaves its neighborhood. The points that did
+  // not change are at the same position in the current cloud, so both lookups are done with the current search method.
+  neighborhood_sqr_radii_.resize (nr_points, std::numeric_limits<float>::max ());
+  markAffectedPoints (positions, spfh_dirty);
+  markAffectedPoints (previous_positions, spfh_dirty);
+
+  std::vector<int> spfh_indices_vec;
+  for (int i = 0; i < nr_points; ++i)
+    if (spfh_dirty[i])
+      spfh_indices_vec.push_back (i);
+
+  // The rows of the SPFH signatures are the point indices
+  hist_f1_.conservativeResize (nr_points, nr_bins_f1_);
+  hist_f2_.conservativeResize (nr_points, nr_bins_f2_);
+  hist_f3_.conservativeResize (nr_points, nr_bins_f3_);
+
+#pragma omp parallel for schedule (dynamic, threads_)
+  for (int i = 0; i < static_cast<int> (spfh_indices_vec.size ()); ++i)
+  {
+    int p_idx = spfh_indices_vec[i];
+    hist_f1_.row (p_idx).setZero ();
+    hist_f2_.row (p_idx).setZero ();
+    hist_f3_.row (p_idx).setZero ();
+    neighborhood_sqr_radii_[p_idx] = 0;
+
+    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
+    std::vector<float> nn_dists (k_); 
+    if (!isFinite (input_->points[p_idx]) ||
+        this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+      continue;
+
+    this->computePointSPFHSignature (*surface_, *normals_, p_idx, p_idx, nn_indices, hist_f1_, hist_f2_, hist_f3_);
+    neighborhood_sqr_radii_[p_idx] = getNeighborhoodSqrRadius (nn_dists);
+  }
+
+  previous_points_.resize (nr_points);
+  for (size_t i = 0; i < spfh_indices_vec.size (); ++i)
+    previous_points_[spfh_indices_vec[i]] = input_->points[spfh_indices_vec[i]].getVector3fMap ();
+
+  // The neighborhoods may have shrunk as well as grown, and points may have been dropped
+  updateMaxNeighborhoodSqrRadius ();
+
+  // The FPFH signature of a point changes if its own SPFH signature or the one of a neighbor changed
+  std::vector<char> fpfh_dirty (spfh_dirty);
+  positions.resize (spfh_indices_vec.size ());
+  for (size_t i = 0; i < spfh_indices_vec.size (); ++i)
+    positions[i] = input_->points[spfh_indices_vec[i]].getVector3fMap ();
+  markAffectedPoints (positions, fpfh_dirty);
+
+  std::vector<int> fpfh_indices_vec;
+  for (int i = 0; i < nr_points; ++i)
+    if (fpfh_dirty[i])
+      fpfh_indices_vec.push_back (i);
+
+  output.header = input_->header;
+  output.points.resize (nr_points);
+  output.width = input_->width;
+  output.height = input_->height;
+
+  int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
+  bool is_dense = true;
+
+#pragma omp parallel for schedule (dynamic, threads_) reduction (&& : is_dense)
+  for (int i = 0; i < static_cast<int> (fpfh_indices_vec.size ()); ++i)
+  {
+    int idx = fpfh_indices_vec[i];
+
+    // The rows of the SPFH signatures are the point indices, so the neighbor indices do not need to be remapped
+    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
+    std::vector<float> nn_dists (k_); 
+    if (!isFinite ((*input_)[idx]) ||
+        this->searchForNeighbors (idx, search_parameter_, nn_indices, nn_dists) == 0)
+    {
+      for (int d = 0; d < nr_bins; ++d)
+        output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
+
+      is_dense = false;
+      continue;
+    }
+
+    Eigen::VectorXf fpfh_histogram = Eigen::VectorXf::Zero (nr_bins);
+    weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram);
+
+    for (int d = 0; d < nr_bins; ++d)
+      output.points[idx].histogram[d] = fpfh_histogram[d];
+  }
+  if (!is_dense)
+    output.is_dense = false;
+
+  this->deinitCompute ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> float
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::getNeighborhoodSqrRadius (const std::vector<float> &nn_dists) const
+{
+  if (k_ == 0)
+    return (static_cast<float> (search_radius_ * search_radius_));
+  // Any point joins a neighborhood that has less than k points
+  if (static_cast<int> (nn_dists.size ()) < k_)
+    return (std::numeric_limits<float>::max ());
+  return (*std::max_element (nn_dists.begin (), nn_dists.end ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::updateMaxNeighborhoodSqrRadius ()
+{
+  // The unbounded neighborhoods are left out, markAffectedPoints () handles them without a search
+  max_neighborhood_sqr_radius_ = 0;
+  for (size_t i = 0; i < neighborhood_sqr_radii_.size (); ++i)
+    if (neighborhood_sqr_radii_[i] != std::numeric_limits<float>::max ())
+      max_neighborhood_sqr_radius_ = (std::max) (max_neighborhood_sqr_radius_, neighborhood_sqr_radii_[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::markAffectedPoints (
+    const std::vector<Eigen::Vector3f> &positions, std::vector<char> &affected) const
+{
+  if (positions.empty ())
+    return;
+
+  // A neighborhood with less than k points is changed by any point
+  for (size_t i = 0; i < neighborhood_sqr_radii_.size (); ++i)
+    if (neighborhood_sqr_radii_[i] == std::numeric_limits<float>::max ())
+      affected[i] = 1;
+
+  std::vector<std::vector<int> > affected_indices (positions.size ());
+
+#pragma omp parallel for schedule (dynamic, threads_)
+  for (int i = 0; i < static_cast<int> (positions.size ()); ++i)
+  {
+    if (!pcl_isfinite (positions[i][0]) || !pcl_isfinite (positions[i][1]) || !pcl_isfinite (positions[i][2]))
+      continue;
+
+    PointInT point;
+    point.x = positions[i][0];
+    point.y = positions[i][1];
+    point.z = positions[i][2];
+
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
+    // The search radius is enlarged slightly, so that the farthest neighbor of a neighborhood is not lost to rounding
+    tree_->radiusSearch (point, sqrt (max_neighborhood_sqr_radius_) * 1.0001, nn_indices, nn_dists);
+    for (size_t j = 0; j < nn_indices.size (); ++j)
+      if (nn_dists[j] <= neighborhood_sqr_radii_[nn_indices[j]])
+        affected_indices[i].push_back (nn_indices[j]);
+  }
+
+  for (size_t i = 0; i < affected_indices.size (); ++i)
+    for (size_t j = 0; j < affected_indices[i].size (); ++j)
+      affected[affected_indices[i][j]] = 1;
+}
+
 #define PCL_INSTANTIATE_FPFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::FPFHEstimationOMP<T,NT,OutT>;
 
 #endif    // PCL_FEATURES_IMPL_FPFH_OMP_H_ 
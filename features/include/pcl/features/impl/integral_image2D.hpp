@@ -39,7 +39,50 @@
 #ifndef PCL_INTEGRAL_IMAGE2D_IMPL_H_
 #define PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Merge the bands of rows of an integral image that were integrated independently of each other. Each
+      * band is offset by the last row of the band above it, the last rows being propagated sequentially first.
+      * \param[in,out] image the (width + 1) x (height + 1) integral image with a leading row and column of zeros
+      * \param[in] width the width of the input data
+      * \param[in] height the height of the input data
+      * \param[in] nr_bands the number of bands, band b holding the input rows [b * height / nr_bands, (b + 1) * height / nr_bands)
+      * \param[in] nr_threads the number of threads to use
+      */
+    template <typename T> void
+    mergeIntegralImageBands (T* image, unsigned width, unsigned height, unsigned nr_bands, unsigned int nr_threads)
+    {
+      const unsigned stride = width + 1;
+      for (unsigned band = 1; band < nr_bands; ++band)
+      {
+        const T* offset_row = image + (band * height / nr_bands) * stride;
+        T* last_row = image + ((band + 1) * height / nr_bands) * stride;
+        for (unsigned colIdx = 1; colIdx < stride; ++colIdx)
+          last_row [colIdx] += offset_row [colIdx];
+      }
+
+#pragma omp parallel for schedule (static, 1) num_threads (nr_threads)
+      for (int band = 1; band < static_cast<int> (nr_bands); ++band)
+      {
+        const unsigned band_begin = band * height / nr_bands;
+        const unsigned band_end = (band + 1) * height / nr_bands;
+        const T* offset_row = image + band_begin * stride;
+        for (unsigned rowIdx = band_begin + 1; rowIdx < band_end; ++rowIdx)
+        {
+          T* current_row = image + rowIdx * stride;
+          for (unsigned colIdx = 1; colIdx < stride; ++colIdx)
+            current_row [colIdx] += offset_row [colIdx];
+        }
+      }
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename DataType, unsigned Dimension> void
@@ -52,15 +95,15 @@ pcl::IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compu
 template <typename DataType, unsigned Dimension> void
 pcl::IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
+  width_  = width;
+  height_ = height;
+  if ((width_ + 1) * (height_ + 1) > first_order_integral_image_.size () )
   {
-    width_  = width;
-    height_ = height;
     first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
     finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   }
+  if (compute_second_order_integral_images_ && (width_ + 1) * (height_ + 1) > second_order_integral_image_.size ())
+    second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   computeIntegralImages (data, row_stride, element_stride);
 }
 
@@ -111,68 +154,77 @@ template <typename DataType, unsigned Dimension> void
 pcl::IntegralImage2D<DataType, Dimension>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
+  const unsigned stride = width_ + 1;
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (compute_second_order_integral_images_)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
 
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
-
-  if (!compute_second_order_integral_images_)
+  // Every thread integrates a band of rows as if it was the top of the image, i.e. the first row of a band is
+  // added to the zero row. The bands are merged afterwards.
+  const unsigned nr_bands = (std::max) (1u, (std::min) (threads_, height_));
+#pragma omp parallel for schedule (static, 1) num_threads (threads_)
+  for (int band = 0; band < static_cast<int> (nr_bands); ++band)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const unsigned band_begin = band * height_ / nr_bands;
+    const unsigned band_end = (band + 1) * height_ / nr_bands;
+    for (unsigned rowIdx = band_begin; rowIdx < band_end; ++rowIdx)
     {
+      const DataType* row_data = data + static_cast<size_t> (rowIdx) * row_stride;
+      ElementType* current_row = &first_order_integral_image_[(rowIdx + 1) * stride];
+      const ElementType* previous_row = (rowIdx == band_begin) ? &first_order_integral_image_[0] : current_row - stride;
+      unsigned* count_current_row = &finite_values_integral_image_[(rowIdx + 1) * stride];
+      const unsigned* count_previous_row = (rowIdx == band_begin) ? &finite_values_integral_image_[0] : count_current_row - stride;
+
+      ElementType row_sum = ElementType::Zero ();
+      unsigned row_count = 0;
       current_row [0].setZero ();
       count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+
+      if (!compute_second_order_integral_images_)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (pcl_isfinite (element->sum ()))
+        for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
+          const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
+          if (pcl_isfinite (element->sum ()))
+          {
+            row_sum += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+            ++row_count;
+          }
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + row_sum;
+          count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + row_count;
         }
       }
-    }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    SecondOrderType so_element;
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
-    {
-      current_row [0].setZero ();
-      so_current_row [0].setZero ();
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      else
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
+        SecondOrderType* so_current_row = &second_order_integral_image_[(rowIdx + 1) * stride];
+        const SecondOrderType* so_previous_row = (rowIdx == band_begin) ? &second_order_integral_image_[0] : so_current_row - stride;
+        SecondOrderType so_row_sum = SecondOrderType::Zero ();
+        so_current_row [0].setZero ();
 
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (pcl_isfinite (element->sum ()))
+        for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
         {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
-          for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
-            for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
-              so_current_row [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
+          const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
+          if (pcl_isfinite (element->sum ()))
+          {
+            row_sum += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+            ++row_count;
+            for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
+              for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
+                so_row_sum [elIdx] += (*element)[myIdx] * (*element)[mxIdx];
+          }
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + row_sum;
+          so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_row_sum;
+          count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + row_count;
         }
       }
     }
   }
+
+  detail::mergeIntegralImageBands (&first_order_integral_image_[0], width_, height_, nr_bands, threads_);
+  detail::mergeIntegralImageBands (&finite_values_integral_image_[0], width_, height_, nr_bands, threads_);
+  if (compute_second_order_integral_images_)
+    detail::mergeIntegralImageBands (&second_order_integral_image_[0], width_, height_, nr_bands, threads_);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -180,15 +232,15 @@ pcl::IntegralImage2D<DataType, Dimension>::computeIntegralImages (
 template <typename DataType> void
 pcl::IntegralImage2D<DataType, 1>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
+  width_  = width;
+  height_ = height;
+  if ((width_ + 1) * (height_ + 1) > first_order_integral_image_.size () )
   {
-    width_  = width;
-    height_ = height;
     first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
     finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   }
+  if (compute_second_order_integral_images_ && (width_ + 1) * (height_ + 1) > second_order_integral_image_.size ())
+    second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   computeIntegralImages (data, row_stride, element_stride);
 }
 
@@ -239,62 +291,71 @@ template <typename DataType> void
 pcl::IntegralImage2D<DataType, 1>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  const unsigned stride = width_ + 1;
+  memset (&first_order_integral_image_[0], 0, sizeof (ElementType) * stride);
+  memset (&finite_values_integral_image_[0], 0, sizeof (unsigned) * stride);
+  if (compute_second_order_integral_images_)
+    memset (&second_order_integral_image_[0], 0, sizeof (SecondOrderType) * stride);
 
-  if (!compute_second_order_integral_images_)
+  const unsigned nr_bands = (std::max) (1u, (std::min) (threads_, height_));
+#pragma omp parallel for schedule (static, 1) num_threads (threads_)
+  for (int band = 0; band < static_cast<int> (nr_bands); ++band)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const unsigned band_begin = band * height_ / nr_bands;
+    const unsigned band_end = (band + 1) * height_ / nr_bands;
+    for (unsigned rowIdx = band_begin; rowIdx < band_end; ++rowIdx)
     {
+      const DataType* row_data = data + static_cast<size_t> (rowIdx) * row_stride;
+      ElementType* current_row = &first_order_integral_image_[(rowIdx + 1) * stride];
+      const ElementType* previous_row = (rowIdx == band_begin) ? &first_order_integral_image_[0] : current_row - stride;
+      unsigned* count_current_row = &finite_values_integral_image_[(rowIdx + 1) * stride];
+      const unsigned* count_previous_row = (rowIdx == band_begin) ? &finite_values_integral_image_[0] : count_current_row - stride;
+
+      ElementType row_sum = 0;
+      unsigned row_count = 0;
       current_row [0] = 0.0;
       count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+
+      if (!compute_second_order_integral_images_)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (pcl_isfinite (data [valIdx]))
+        for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
         {
-          current_row [colIdx + 1] += data [valIdx];
-          ++(count_current_row [colIdx + 1]);
+          if (pcl_isfinite (row_data [valIdx]))
+          {
+            row_sum += row_data [valIdx];
+            ++row_count;
+          }
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + row_sum;
+          count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + row_count;
         }
       }
-    }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
-    {
-      current_row [0] = 0.0;
-      so_current_row [0] = 0.0;
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      else
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (pcl_isfinite (data[valIdx]))
+        SecondOrderType* so_current_row = &second_order_integral_image_[(rowIdx + 1) * stride];
+        const SecondOrderType* so_previous_row = (rowIdx == band_begin) ? &second_order_integral_image_[0] : so_current_row - stride;
+        SecondOrderType so_row_sum = 0;
+        so_current_row [0] = 0.0;
+
+        for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
         {
-          current_row [colIdx + 1] += data[valIdx];
-          so_current_row [colIdx + 1] += data[valIdx] * data[valIdx];
-          ++(count_current_row [colIdx + 1]);
+          if (pcl_isfinite (row_data [valIdx]))
+          {
+            row_sum += row_data [valIdx];
+            so_row_sum += row_data [valIdx] * row_data [valIdx];
+            ++row_count;
+          }
+          current_row [colIdx + 1] = previous_row [colIdx + 1] + row_sum;
+          so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_row_sum;
+          count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + row_count;
         }
       }
     }
   }
+
+  detail::mergeIntegralImageBands (&first_order_integral_image_[0], width_, height_, nr_bands, threads_);
+  detail::mergeIntegralImageBands (&finite_values_integral_image_[0], width_, height_, nr_bands, threads_);
+  if (compute_second_order_integral_images_)
+    detail::mergeIntegralImageBands (&second_order_integral_image_[0], width_, height_, nr_bands, threads_);
 }
 #endif    // PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
@@ -39,6 +39,7 @@
 #define PCL_FEATURES_IMPL_MULTISCALE_FEATURE_PERSISTENCE_H_
 
 #include <pcl/features/multiscale_feature_persistence.h>
+#include <pcl/search/neighborhood_cache.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointFeature>
@@ -51,6 +52,7 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::MultiscaleFeatureP
   features_at_scale_vectorized_ (),
   mean_feature_ (),
   feature_representation_ (),
+  threads_ (1),
   unique_features_indices_ (),
   unique_features_table_ ()
 {
@@ -92,6 +94,39 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::computeFeaturesAtA
 {
   features_at_scale_.resize (scale_values_.size ());
   features_at_scale_vectorized_.resize (scale_values_.size ());
+  if (scale_values_.empty ())
+  {
+    PCL_ERROR ("[pcl::MultiscaleFeaturePersistence::computeFeaturesAtAllScales] No scale values were given\n");
+    return;
+  }
+
+  // Search the neighborhoods once at the largest scale; the smaller scales use their prefixes
+  typename pcl::Feature<PointSource, PointFeature>::KdTreePtr search = feature_estimator_->getSearchMethod ();
+  typename pcl::PointCloud<PointSource>::ConstPtr input = feature_estimator_->getInputCloud ();
+  typename pcl::PointCloud<PointSource>::ConstPtr surface = feature_estimator_->getSearchSurface ();
+  if (!surface)
+    surface = input;
+  boost::shared_ptr<pcl::search::NeighborhoodCache<PointSource> > cache;
+  if (input && !input->points.empty ())
+  {
+    if (!search)
+    {
+      if (surface->isOrganized () && input->isOrganized ())
+        search.reset (new pcl::search::OrganizedNeighbor<PointSource> ());
+      else
+        search.reset (new pcl::search::KdTree<PointSource> (false));
+    }
+    if (search->getInputCloud () != surface)
+      search->setInputCloud (surface);
+
+    cache.reset (new pcl::search::NeighborhoodCache<PointSource> (search));
+    cache->setNumberOfThreads (threads_);
+    cache->computeRadiusNeighborhoods (input, *std::max_element (scale_values_.begin (), scale_values_.end ()),
+                                       feature_estimator_->getIndices ());
+    cache->sortNeighborhoods ();
+    feature_estimator_->setSearchMethod (cache);
+  }
+
   for (size_t scale_i = 0; scale_i < scale_values_.size (); ++scale_i)
   {
     FeatureCloudPtr feature_cloud (new FeatureCloud ());
@@ -99,15 +134,20 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::computeFeaturesAtA
     features_at_scale_[scale_i] = feature_cloud;
 
     // Vectorize each feature and insert it into the vectorized feature storage
-    std::vector<std::vector<float> > feature_cloud_vectorized (feature_cloud->points.size ());
-    for (size_t feature_i = 0; feature_i < feature_cloud->points.size (); ++feature_i)
+    std::vector<std::vector<float> > &feature_cloud_vectorized = features_at_scale_vectorized_[scale_i];
+    feature_cloud_vectorized.resize (feature_cloud->points.size ());
+    int nr_features = static_cast<int> (feature_cloud->points.size ());
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+    for (int feature_i = 0; feature_i < nr_features; ++feature_i)
     {
-      std::vector<float> feature_vectorized (feature_representation_->getNumberOfDimensions ());
-      feature_representation_->vectorize (feature_cloud->points[feature_i], feature_vectorized);
-      feature_cloud_vectorized[feature_i] = feature_vectorized;
+      feature_cloud_vectorized[feature_i].resize (feature_representation_->getNumberOfDimensions ());
+      feature_representation_->vectorize (feature_cloud->points[feature_i], feature_cloud_vectorized[feature_i]);
     }
-    features_at_scale_vectorized_[scale_i] = feature_cloud_vectorized;
   }
+
+  // Give the estimator its own search object back
+  if (cache)
+    feature_estimator_->setSearchMethod (cache->getSearchMethod ());
 }
 
 
@@ -162,12 +202,12 @@ pcl::MultiscaleFeaturePersistence<PointSource, PointFeature>::extractUniqueFeatu
     // Calculate standard deviation within the scale
     float standard_dev = 0.0;
     std::vector<float> diff_vector (features_at_scale_vectorized_[scale_i].size ());
-    for (size_t point_i = 0; point_i < features_at_scale_vectorized_[scale_i].size (); ++point_i)
-    {
-      float diff = distanceBetweenFeatures (features_at_scale_vectorized_[scale_i][point_i], mean_feature_);
-      standard_dev += diff * diff;
-      diff_vector[point_i] = diff;
-    }
+    int nr_features = static_cast<int> (diff_vector.size ());
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+    for (int point_i = 0; point_i < nr_features; ++point_i)
+      diff_vector[point_i] = distanceBetweenFeatures (features_at_scale_vectorized_[scale_i][point_i], mean_feature_);
+    for (size_t point_i = 0; point_i < diff_vector.size (); ++point_i)
+      standard_dev += diff_vector[point_i] * diff_vector[point_i];
     standard_dev = sqrtf (standard_dev / static_cast<float> (features_at_scale_vectorized_[scale_i].size ()));
     PCL_DEBUG ("[pcl::MultiscaleFeaturePersistence::extractUniqueFeatures] Standard deviation for scale %f is %f\n", scale_values_[scale_i], standard_dev);
 
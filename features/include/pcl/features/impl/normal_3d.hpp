@@ -41,6 +41,275 @@
 #define PCL_FEATURES_IMPL_NORMAL_3D_H_
 
 #include <pcl/features/normal_3d.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#ifdef __SSE__
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Select a where mask is set, b elsewhere. */
+    inline __m128
+    selectSSE (const __m128 &mask, const __m128 &a, const __m128 &b)
+    {
+      return (_mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b)));
+    }
+
+    /** \brief Compute atan2 (y, x) in each lane for y >= 0, with a maximum absolute error of about 1e-7.
+      * The octant is reduced to an argument in [-tan (pi/8), tan (pi/8)] as in the Cephes atanf.
+      */
+    inline __m128
+    atan2PositiveSSE (const __m128 &y, const __m128 &x)
+    {
+      const __m128 zero = _mm_setzero_ps ();
+      const __m128 one = _mm_set1_ps (1.0f);
+      const __m128 abs_x = _mm_andnot_ps (_mm_set1_ps (-0.0f), x);
+      const __m128 num = _mm_min_ps (abs_x, y);
+      const __m128 den = _mm_max_ps (abs_x, y);
+      // atan2 (0, 0) is 0
+      __m128 a = _mm_and_ps (_mm_div_ps (num, den), _mm_cmpgt_ps (den, zero));
+
+      const __m128 reduce = _mm_cmpgt_ps (a, _mm_set1_ps (0.414213562373095f));
+      a = selectSSE (reduce, _mm_div_ps (_mm_sub_ps (a, one), _mm_add_ps (a, one)), a);
+      const __m128 z = _mm_mul_ps (a, a);
+      __m128 r = _mm_set1_ps (8.05374449538e-2f);
+      r = _mm_add_ps (_mm_mul_ps (r, z), _mm_set1_ps (-1.38776856032e-1f));
+      r = _mm_add_ps (_mm_mul_ps (r, z), _mm_set1_ps (1.99777106478e-1f));
+      r = _mm_add_ps (_mm_mul_ps (r, z), _mm_set1_ps (-3.33329491539e-1f));
+      r = _mm_add_ps (_mm_mul_ps (_mm_mul_ps (r, z), a), a);
+      r = _mm_add_ps (r, _mm_and_ps (reduce, _mm_set1_ps (static_cast<float> (M_PI / 4))));
+
+      // Back to the full [0, pi] range
+      r = selectSSE (_mm_cmpgt_ps (y, abs_x), _mm_sub_ps (_mm_set1_ps (static_cast<float> (M_PI / 2)), r), r);
+      r = selectSSE (_mm_cmplt_ps (x, zero), _mm_sub_ps (_mm_set1_ps (static_cast<float> (M_PI)), r), r);
+      return (r);
+    }
+
+    /** \brief Compute the sine and cosine of an angle in [0, pi/3] in each lane, using their Taylor series
+      * (the truncation error is below 5e-8 on that range).
+      */
+    inline void
+    sinCosSSE (const __m128 &theta, __m128 &sin_theta, __m128 &cos_theta)
+    {
+      const __m128 z = _mm_mul_ps (theta, theta);
+      __m128 s = _mm_set1_ps (1.0f / 362880.0f);
+      s = _mm_add_ps (_mm_mul_ps (s, z), _mm_set1_ps (-1.0f / 5040.0f));
+      s = _mm_add_ps (_mm_mul_ps (s, z), _mm_set1_ps (1.0f / 120.0f));
+      s = _mm_add_ps (_mm_mul_ps (s, z), _mm_set1_ps (-1.0f / 6.0f));
+      sin_theta = _mm_add_ps (_mm_mul_ps (_mm_mul_ps (s, z), theta), theta);
+
+      __m128 c = _mm_set1_ps (-1.0f / 3628800.0f);
+      c = _mm_add_ps (_mm_mul_ps (c, z), _mm_set1_ps (1.0f / 40320.0f));
+      c = _mm_add_ps (_mm_mul_ps (c, z), _mm_set1_ps (-1.0f / 720.0f));
+      c = _mm_add_ps (_mm_mul_ps (c, z), _mm_set1_ps (1.0f / 24.0f));
+      c = _mm_add_ps (_mm_mul_ps (c, z), _mm_set1_ps (-1.0f / 2.0f));
+      cos_theta = _mm_add_ps (_mm_mul_ps (c, z), _mm_set1_ps (1.0f));
+    }
+
+    /** \brief Compute the normals and curvatures of up to 4 consecutive neighborhoods, one per SSE lane.
+      * \param[in] cloud the input point cloud
+      * \param[in] nn_indices the point cloud indices of all the neighborhoods
+      * \param[in] nn_offsets the offsets of the neighborhoods in nn_indices
+      * \param[in] first the first neighborhood to process
+      * \param[in] nr_lanes the number of neighborhoods to process (at most 4)
+      * \param[out] normals_curvatures nx, ny, nz, curvature of each of the nr_lanes neighborhoods
+      */
+    template <typename PointT> void
+    computePointNormals4 (const pcl::PointCloud<PointT> &cloud,
+                          const std::vector<int> &nn_indices, const std::vector<int> &nn_offsets,
+                          int first, int nr_lanes, float *normals_curvatures)
+    {
+      // The sums are accumulated relative to the first finite point of each neighborhood, which avoids the
+      // cancellation of the single pass covariance formula when the points are far from the origin
+      int begin[4] = {0, 0, 0, 0}, end[4] = {0, 0, 0, 0};
+      float ref[3][4] = {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}};
+      int max_size = 0;
+      for (int l = 0; l < nr_lanes; ++l)
+      {
+        begin[l] = nn_offsets[first + l];
+        end[l] = nn_offsets[first + l + 1];
+        if (!cloud.is_dense)
+          while (begin[l] < end[l] && !isFinite (cloud.points[nn_indices[begin[l]]]))
+            ++begin[l];
+        if (begin[l] == end[l])
+          continue;
+        const PointT &p = cloud.points[nn_indices[begin[l]]];
+        ref[0][l] = p.x; ref[1][l] = p.y; ref[2][l] = p.z;
+        max_size = std::max (max_size, end[l] - begin[l]);
+      }
+      const __m128 ref_x = _mm_loadu_ps (ref[0]), ref_y = _mm_loadu_ps (ref[1]), ref_z = _mm_loadu_ps (ref[2]);
+
+      __m128 sum_x = _mm_setzero_ps (), sum_y = _mm_setzero_ps (), sum_z = _mm_setzero_ps ();
+      __m128 sum_xx = _mm_setzero_ps (), sum_xy = _mm_setzero_ps (), sum_xz = _mm_setzero_ps ();
+      __m128 sum_yy = _mm_setzero_ps (), sum_yz = _mm_setzero_ps (), sum_zz = _mm_setzero_ps ();
+      __m128 count = _mm_setzero_ps ();
+      float px[4], py[4], pz[4], valid[4];
+      for (int j = 0; j < max_size; ++j)
+      {
+        // Gather one point per lane; lanes which are done (or hit an invalid point) repeat their reference
+        // point, which adds nothing to the sums
+        for (int l = 0; l < 4; ++l)
+        {
+          px[l] = ref[0][l]; py[l] = ref[1][l]; pz[l] = ref[2][l];
+          valid[l] = 0.0f;
+          if (begin[l] + j >= end[l])
+            continue;
+          const PointT &p = cloud.points[nn_indices[begin[l] + j]];
+          if (!cloud.is_dense && !isFinite (p))
+            continue;
+          px[l] = p.x; py[l] = p.y; pz[l] = p.z;
+          valid[l] = 1.0f;
+        }
+        const __m128 dx = _mm_sub_ps (_mm_loadu_ps (px), ref_x);
+        const __m128 dy = _mm_sub_ps (_mm_loadu_ps (py), ref_y);
+        const __m128 dz = _mm_sub_ps (_mm_loadu_ps (pz), ref_z);
+        sum_x = _mm_add_ps (sum_x, dx);
+        sum_y = _mm_add_ps (sum_y, dy);
+        sum_z = _mm_add_ps (sum_z, dz);
+        sum_xx = _mm_add_ps (sum_xx, _mm_mul_ps (dx, dx));
+        sum_xy = _mm_add_ps (sum_xy, _mm_mul_ps (dx, dy));
+        sum_xz = _mm_add_ps (sum_xz, _mm_mul_ps (dx, dz));
+        sum_yy = _mm_add_ps (sum_yy, _mm_mul_ps (dy, dy));
+        sum_yz = _mm_add_ps (sum_yz, _mm_mul_ps (dy, dz));
+        sum_zz = _mm_add_ps (sum_zz, _mm_mul_ps (dz, dz));
+        count = _mm_add_ps (count, _mm_loadu_ps (valid));
+      }
+
+      const __m128 zero = _mm_setzero_ps ();
+      const __m128 empty = _mm_cmpeq_ps (count, zero);
+      const __m128 inv_count = _mm_div_ps (_mm_set1_ps (1.0f), _mm_max_ps (count, _mm_set1_ps (1.0f)));
+      const __m128 mean_x = _mm_mul_ps (sum_x, inv_count);
+      const __m128 mean_y = _mm_mul_ps (sum_y, inv_count);
+      const __m128 mean_z = _mm_mul_ps (sum_z, inv_count);
+      const __m128 xx = _mm_sub_ps (_mm_mul_ps (sum_xx, inv_count), _mm_mul_ps (mean_x, mean_x));
+      const __m128 xy = _mm_sub_ps (_mm_mul_ps (sum_xy, inv_count), _mm_mul_ps (mean_x, mean_y));
+      const __m128 xz = _mm_sub_ps (_mm_mul_ps (sum_xz, inv_count), _mm_mul_ps (mean_x, mean_z));
+      const __m128 yy = _mm_sub_ps (_mm_mul_ps (sum_yy, inv_count), _mm_mul_ps (mean_y, mean_y));
+      const __m128 yz = _mm_sub_ps (_mm_mul_ps (sum_yz, inv_count), _mm_mul_ps (mean_y, mean_z));
+      const __m128 zz = _mm_sub_ps (_mm_mul_ps (sum_zz, inv_count), _mm_mul_ps (mean_z, mean_z));
+
+      // From here on this is eigen33 (), one covariance matrix per lane
+      const __m128 sign_mask = _mm_set1_ps (-0.0f);
+      __m128 scale = _mm_max_ps (_mm_max_ps (_mm_andnot_ps (sign_mask, xx), _mm_andnot_ps (sign_mask, xy)),
+                                 _mm_max_ps (_mm_andnot_ps (sign_mask, xz), _mm_andnot_ps (sign_mask, yy)));
+      scale = _mm_max_ps (scale, _mm_max_ps (_mm_andnot_ps (sign_mask, yz), _mm_andnot_ps (sign_mask, zz)));
+      scale = selectSSE (_mm_cmple_ps (scale, _mm_set1_ps (std::numeric_limits<float>::min ())), _mm_set1_ps (1.0f), scale);
+      const __m128 m00 = _mm_div_ps (xx, scale), m01 = _mm_div_ps (xy, scale), m02 = _mm_div_ps (xz, scale);
+      const __m128 m11 = _mm_div_ps (yy, scale), m12 = _mm_div_ps (yz, scale), m22 = _mm_div_ps (zz, scale);
+
+      // Coefficients of the characteristic equation x^3 - c2*x^2 + c1*x - c0 = 0
+      __m128 c0 = _mm_mul_ps (_mm_mul_ps (m00, m11), m22);
+      c0 = _mm_add_ps (c0, _mm_mul_ps (_mm_set1_ps (2.0f), _mm_mul_ps (_mm_mul_ps (m01, m02), m12)));
+      c0 = _mm_sub_ps (c0, _mm_mul_ps (_mm_mul_ps (m00, m12), m12));
+      c0 = _mm_sub_ps (c0, _mm_mul_ps (_mm_mul_ps (m11, m02), m02));
+      c0 = _mm_sub_ps (c0, _mm_mul_ps (_mm_mul_ps (m22, m01), m01));
+      __m128 c1 = _mm_sub_ps (_mm_mul_ps (m00, m11), _mm_mul_ps (m01, m01));
+      c1 = _mm_add_ps (c1, _mm_sub_ps (_mm_mul_ps (m00, m22), _mm_mul_ps (m02, m02)));
+      c1 = _mm_add_ps (c1, _mm_sub_ps (_mm_mul_ps (m11, m22), _mm_mul_ps (m12, m12)));
+      const __m128 c2 = _mm_add_ps (_mm_add_ps (m00, m11), m22);
+
+      const __m128 inv3 = _mm_set1_ps (1.0f / 3.0f);
+      const __m128 c2_over_3 = _mm_mul_ps (c2, inv3);
+      const __m128 a_over_3 = _mm_min_ps (_mm_mul_ps (_mm_sub_ps (c1, _mm_mul_ps (c2, c2_over_3)), inv3), zero);
+      const __m128 half_b = _mm_mul_ps (_mm_set1_ps (0.5f),
+                                        _mm_add_ps (c0, _mm_mul_ps (c2_over_3,
+                                                                    _mm_sub_ps (_mm_mul_ps (_mm_set1_ps (2.0f), _mm_mul_ps (c2_over_3, c2_over_3)), c1))));
+      const __m128 q = _mm_min_ps (_mm_add_ps (_mm_mul_ps (half_b, half_b), _mm_mul_ps (_mm_mul_ps (a_over_3, a_over_3), a_over_3)), zero);
+      const __m128 rho = _mm_sqrt_ps (_mm_sub_ps (zero, a_over_3));
+      const __m128 theta = _mm_mul_ps (atan2PositiveSSE (_mm_sqrt_ps (_mm_sub_ps (zero, q)), half_b), inv3);
+      __m128 sin_theta, cos_theta;
+      sinCosSSE (theta, sin_theta, cos_theta);
+      // With theta in [0, pi/3], the smallest root is one of these two
+      const __m128 sqrt3_sin_theta = _mm_mul_ps (_mm_set1_ps (1.7320508075688772f), sin_theta);
+      __m128 lambda = _mm_min_ps (_mm_sub_ps (c2_over_3, _mm_mul_ps (rho, _mm_add_ps (cos_theta, sqrt3_sin_theta))),
+                                  _mm_sub_ps (c2_over_3, _mm_mul_ps (rho, _mm_sub_ps (cos_theta, sqrt3_sin_theta))));
+      // As in computeRoots (), a zero determinant or a non-positive root means the smallest eigenvalue is 0
+      const __m128 singular = _mm_cmplt_ps (_mm_andnot_ps (sign_mask, c0), _mm_set1_ps (std::numeric_limits<float>::epsilon ()));
+      lambda = _mm_andnot_ps (_mm_or_ps (singular, _mm_cmple_ps (lambda, zero)), lambda);
+
+      // The eigenvector is the largest cross product of two rows of (M - lambda * I)
+      const __m128 d00 = _mm_sub_ps (m00, lambda), d11 = _mm_sub_ps (m11, lambda), d22 = _mm_sub_ps (m22, lambda);
+      const __m128 v1x = _mm_sub_ps (_mm_mul_ps (m01, m12), _mm_mul_ps (m02, d11));
+      const __m128 v1y = _mm_sub_ps (_mm_mul_ps (m02, m01), _mm_mul_ps (d00, m12));
+      const __m128 v1z = _mm_sub_ps (_mm_mul_ps (d00, d11), _mm_mul_ps (m01, m01));
+      const __m128 v2x = _mm_sub_ps (_mm_mul_ps (m01, d22), _mm_mul_ps (m02, m12));
+      const __m128 v2y = _mm_sub_ps (_mm_mul_ps (m02, m02), _mm_mul_ps (d00, d22));
+      const __m128 v2z = _mm_sub_ps (_mm_mul_ps (d00, m12), _mm_mul_ps (m01, m02));
+      const __m128 v3x = _mm_sub_ps (_mm_mul_ps (d11, d22), _mm_mul_ps (m12, m12));
+      const __m128 v3y = _mm_sub_ps (_mm_mul_ps (m12, m02), _mm_mul_ps (m01, d22));
+      const __m128 v3z = _mm_sub_ps (_mm_mul_ps (m01, m12), _mm_mul_ps (d11, m02));
+      const __m128 len1 = _mm_add_ps (_mm_add_ps (_mm_mul_ps (v1x, v1x), _mm_mul_ps (v1y, v1y)), _mm_mul_ps (v1z, v1z));
+      const __m128 len2 = _mm_add_ps (_mm_add_ps (_mm_mul_ps (v2x, v2x), _mm_mul_ps (v2y, v2y)), _mm_mul_ps (v2z, v2z));
+      const __m128 len3 = _mm_add_ps (_mm_add_ps (_mm_mul_ps (v3x, v3x), _mm_mul_ps (v3y, v3y)), _mm_mul_ps (v3z, v3z));
+      const __m128 use1 = _mm_and_ps (_mm_cmpge_ps (len1, len2), _mm_cmpge_ps (len1, len3));
+      const __m128 use2 = _mm_andnot_ps (use1, _mm_and_ps (_mm_cmpge_ps (len2, len1), _mm_cmpge_ps (len2, len3)));
+      const __m128 len = _mm_sqrt_ps (selectSSE (use1, len1, selectSSE (use2, len2, len3)));
+      __m128 nx = _mm_div_ps (selectSSE (use1, v1x, selectSSE (use2, v2x, v3x)), len);
+      __m128 ny = _mm_div_ps (selectSSE (use1, v1y, selectSSE (use2, v2y, v3y)), len);
+      __m128 nz = _mm_div_ps (selectSSE (use1, v1z, selectSSE (use2, v2z, v3z)), len);
+
+      // Curvature as in solvePlaneParameters (): lambda_0 / (lambda_0 + lambda_1 + lambda_2)
+      const __m128 trace = _mm_add_ps (_mm_add_ps (xx, yy), zz);
+      __m128 curvature = _mm_andnot_ps (sign_mask, _mm_div_ps (_mm_mul_ps (lambda, scale), trace));
+      curvature = _mm_andnot_ps (_mm_cmpeq_ps (trace, zero), curvature);
+
+      const __m128 nan = _mm_set1_ps (std::numeric_limits<float>::quiet_NaN ());
+      nx = selectSSE (empty, nan, nx);
+      ny = selectSSE (empty, nan, ny);
+      nz = selectSSE (empty, nan, nz);
+      curvature = selectSSE (empty, nan, curvature);
+
+      _MM_TRANSPOSE4_PS (nx, ny, nz, curvature);
+      const __m128 rows[4] = {nx, ny, nz, curvature};
+      for (int l = 0; l < nr_lanes; ++l)
+        _mm_storeu_ps (normals_curvatures + 4 * l, rows[l]);
+    }
+  }
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::computePointNormals (const pcl::PointCloud<PointT> &cloud,
+                          const std::vector<int> &nn_indices, const std::vector<int> &nn_offsets,
+                          std::vector<float> &normals_curvatures, unsigned int nr_threads)
+{
+  const int nr_neighborhoods = nn_offsets.empty () ? 0 : static_cast<int> (nn_offsets.size ()) - 1;
+  normals_curvatures.resize (4 * nr_neighborhoods);
+  if (nr_neighborhoods == 0)
+    return;
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+#ifdef __SSE__
+  const int nr_groups = (nr_neighborhoods + 3) / 4;
+#pragma omp parallel for schedule (dynamic, 64) num_threads (nr_threads)
+  for (int g = 0; g < nr_groups; ++g)
+    detail::computePointNormals4 (cloud, nn_indices, nn_offsets, 4 * g, std::min (4, nr_neighborhoods - 4 * g),
+                                  &normals_curvatures[16 * g]);
+#else
+#pragma omp parallel num_threads (nr_threads)
+  {
+    std::vector<int> indices;
+    EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
+    Eigen::Vector4f xyz_centroid;
+#pragma omp for schedule (dynamic, 256)
+    for (int i = 0; i < nr_neighborhoods; ++i)
+    {
+      float *normal = &normals_curvatures[4 * i];
+      indices.assign (nn_indices.begin () + nn_offsets[i], nn_indices.begin () + nn_offsets[i + 1]);
+      if (computeMeanAndCovarianceMatrix (cloud, indices, covariance_matrix, xyz_centroid) == 0)
+      {
+        normal[0] = normal[1] = normal[2] = normal[3] = std::numeric_limits<float>::quiet_NaN ();
+        continue;
+      }
+      solvePlaneParameters (covariance_matrix, normal[0], normal[1], normal[2], normal[3]);
+    }
+  }
+#endif
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
@@ -51,49 +320,48 @@ pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &outpu
   std::vector<int> nn_indices (k_);
   std::vector<float> nn_dists (k_);
 
+  // The neighborhoods of a block of points are gathered first, so that computePointNormals () can process
+  // several of them at once
+  const int block_size = 256;
+  std::vector<int> block_indices, block_offsets, block_positions;
+  std::vector<float> block_normals;
+
   output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
+  for (int block_begin = 0; block_begin < static_cast<int> (indices_->size ()); block_begin += block_size)
   {
-    // Iterating over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+    int block_end = std::min (block_begin + block_size, static_cast<int> (indices_->size ()));
+    block_indices.clear ();
+    block_offsets.assign (1, 0);
+    block_positions.clear ();
+    for (int idx = block_begin; idx < block_end; ++idx)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+      int nr_neighbors = 0;
+      if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[idx]])) ||
+          (nr_neighbors = this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists)) == 0)
       {
         output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
 
         output.is_dense = false;
         continue;
       }
-
-      computePointNormal (*surface_, nn_indices,
-                          output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature);
-
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
-
+      block_indices.insert (block_indices.end (), nn_indices.begin (), nn_indices.begin () + nr_neighbors);
+      block_offsets.push_back (static_cast<int> (block_indices.size ()));
+      block_positions.push_back (idx);
     }
-  }
-  else
-  {
-    // Iterating over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
-      {
-        output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
 
-        output.is_dense = false;
-        continue;
-      }
+    computePointNormals (*surface_, block_indices, block_offsets, block_normals);
 
-      computePointNormal (*surface_, nn_indices,
-                          output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature);
+    for (size_t i = 0; i < block_positions.size (); ++i)
+    {
+      int idx = block_positions[i];
+      output.points[idx].normal[0] = block_normals[4 * i + 0];
+      output.points[idx].normal[1] = block_normals[4 * i + 1];
+      output.points[idx].normal[2] = block_normals[4 * i + 2];
+      output.points[idx].curvature = block_normals[4 * i + 3];
 
       flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
                                   output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
-
     }
   }
 }
@@ -110,51 +378,50 @@ pcl::NormalEstimation<PointInT, Eigen::MatrixXf>::computeFeatureEigen (pcl::Poin
   std::vector<int> nn_indices (k_);
   std::vector<float> nn_dists (k_);
 
+  // The neighborhoods of a block of points are gathered first, so that computePointNormals () can process
+  // several of them at once
+  const int block_size = 256;
+  std::vector<int> block_indices, block_offsets, block_positions;
+  std::vector<float> block_normals;
+
   output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
+  for (int block_begin = 0; block_begin < static_cast<int> (indices_->size ()); block_begin += block_size)
   {
-    // Iterating over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+    int block_end = std::min (block_begin + block_size, static_cast<int> (indices_->size ()));
+    block_indices.clear ();
+    block_offsets.assign (1, 0);
+    block_positions.clear ();
+    for (int idx = block_begin; idx < block_end; ++idx)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+      int nr_neighbors = 0;
+      if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[idx]])) ||
+          (nr_neighbors = this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists)) == 0)
       {
         output.points (idx, 0) = output.points (idx, 1) = output.points (idx, 2) = output.points (idx, 3) = std::numeric_limits<float>::quiet_NaN ();
         output.is_dense = false;
         continue;
       }
+      block_indices.insert (block_indices.end (), nn_indices.begin (), nn_indices.begin () + nr_neighbors);
+      block_offsets.push_back (static_cast<int> (block_indices.size ()));
+      block_positions.push_back (idx);
+    }
 
-      computePointNormal (*surface_, nn_indices,
-                          output.points (idx, 0), output.points (idx, 1), output.points (idx, 2), output.points (idx, 3));
-
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points (idx, 0), output.points (idx, 1), output.points (idx, 2));
+    computePointNormals (*surface_, block_indices, block_offsets, block_normals);
 
-    }
-  }
-  else
-  {
-    // Iterating over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+    for (size_t i = 0; i < block_positions.size (); ++i)
     {
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
-      {
-        output.points (idx, 0) = output.points (idx, 1) = output.points (idx, 2) = output.points (idx, 3) = std::numeric_limits<float>::quiet_NaN ();
-        output.is_dense = false;
-        continue;
-      }
-
-      computePointNormal (*surface_, nn_indices,
-                          output.points (idx, 0), output.points (idx, 1), output.points (idx, 2), output.points (idx, 3));
+      int idx = block_positions[i];
+      for (int d = 0; d < 4; ++d)
+        output.points (idx, d) = block_normals[4 * i + d];
 
       flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
                                   output.points (idx, 0), output.points (idx, 1), output.points (idx, 2));
-
     }
   }
 }
 
 #define PCL_INSTANTIATE_NormalEstimation(T,NT) template class PCL_EXPORTS pcl::NormalEstimation<T,NT>;
+#define PCL_INSTANTIATE_computePointNormals(T) template PCL_EXPORTS void pcl::computePointNormals<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const std::vector<int> &, std::vector<float> &, unsigned int);
 
 #endif    // PCL_FEATURES_IMPL_NORMAL_3D_H_ 
@@ -41,6 +41,52 @@
 #define PCL_FEATURES_IMPL_NORMAL_3D_OMP_H_
 
 #include <pcl/features/normal_3d_omp.h>
+#include <pcl/features/impl/normal_3d.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> unsigned int
+pcl::NormalEstimationOMP<PointInT, PointOutT>::getThreadsToUse () const
+{
+#ifdef _OPENMP
+  if (threads_ == 0)
+    return (static_cast<unsigned int> (omp_get_num_procs ()));
+#endif
+  return (threads_ == 0 ? 1 : threads_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::NormalEstimationOMP<PointInT, PointOutT>::searchForNeighborsBatch (
+    const std::vector<int> &queries, std::vector<int> &nn_indices,
+    std::vector<float> &nn_dists, std::vector<int> &nn_offsets) const
+{
+  if (k_ == 0)
+  {
+    tree_->batchRadiusSearch (*input_, queries, search_parameter_, nn_indices, nn_dists, nn_offsets, 0, getThreadsToUse ());
+    return;
+  }
+
+  // The k-nearest neighbor search pads the results of each query with -1; compact them into the same layout
+  tree_->batchNearestKSearch (*input_, queries, k_, nn_indices, nn_dists, getThreadsToUse ());
+  nn_offsets.resize (queries.size () + 1);
+  nn_offsets[0] = 0;
+  int nr_neighbors = 0;
+  for (size_t i = 0; i < queries.size (); ++i)
+  {
+    for (int j = static_cast<int> (i) * k_; j < static_cast<int> (i + 1) * k_ && nn_indices[j] != -1; ++j)
+    {
+      nn_indices[nr_neighbors] = nn_indices[j];
+      nn_dists[nr_neighbors] = nn_dists[j];
+      ++nr_neighbors;
+    }
+    nn_offsets[i + 1] = nr_neighbors;
+  }
+  nn_indices.resize (nr_neighbors);
+  nn_dists.resize (nr_neighbors);
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
@@ -53,42 +99,51 @@ pcl::NormalEstimationOMP<PointInT, Eigen::MatrixXf>::computeFeatureEigen (pcl::P
   // Resize the output dataset
   output.points.resize (indices_->size (), 4);
 
-  // GCC 4.2.x seems to segfault with "internal compiler error" on MacOS X here
-#if defined(_WIN32) || ((__GNUC__ > 4) && (__GNUC_MINOR__ > 2)) 
-#pragma omp parallel for schedule (dynamic, threads_)
-#endif
-  // Iterating over the entire index vector
-  for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
+  // The neighborhoods are searched for in blocks of queries, which bounds the memory used by the results
+  const int block_size = 16384;
+  std::vector<int> queries, query_positions;
+  std::vector<int> block_indices, block_offsets;
+  std::vector<float> block_dists, block_normals;
+  for (int block_begin = 0; block_begin < static_cast<int> (indices_->size ()); block_begin += block_size)
   {
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
-    std::vector<int> nn_indices (k_);
-    std::vector<float> nn_dists (k_);
-
-    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+    int block_end = std::min (block_begin + block_size, static_cast<int> (indices_->size ()));
+    queries.clear ();
+    query_positions.clear ();
+    for (int idx = block_begin; idx < block_end; ++idx)
     {
-      output.points (idx, 0) = output.points (idx, 1) = output.points (idx, 2) = output.points (idx, 3) = std::numeric_limits<float>::quiet_NaN ();
-      output.is_dense = false;
-      continue;
+      if (isFinite ((*input_)[(*indices_)[idx]]))
+      {
+        queries.push_back ((*indices_)[idx]);
+        query_positions.push_back (idx);
+      }
+      else
+      {
+        output.points (idx, 0) = output.points (idx, 1) = output.points (idx, 2) = output.points (idx, 3) = std::numeric_limits<float>::quiet_NaN ();
+        output.is_dense = false;
+      }
     }
+    // An empty list of queries would stand for the whole cloud
+    if (queries.empty ())
+      continue;
+    searchForNeighborsBatch (queries, block_indices, block_dists, block_offsets);
 
-    // 16-bytes aligned placeholder for the XYZ centroid of a surface patch
-    Eigen::Vector4f xyz_centroid;
-    // Estimate the XYZ centroid
-    compute3DCentroid (*surface_, nn_indices, xyz_centroid);
-
-    // Placeholder for the 3x3 covariance matrix at each surface patch
-    EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
-    // Compute the 3x3 covariance matrix
-    computeCovarianceMatrix (*surface_, nn_indices, xyz_centroid, covariance_matrix);
-
-    // Get the plane normal and surface curvature
-    solvePlaneParameters (covariance_matrix,
-                          output.points (idx, 0), output.points (idx, 1), output.points (idx, 2), output.points (idx, 3));
+    computePointNormals (*surface_, block_indices, block_offsets, block_normals, getThreadsToUse ());
 
-    flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx, vpy, vpz,
-                                output.points (idx, 0), output.points (idx, 1), output.points (idx, 2));
+    for (int q = 0; q < static_cast<int> (queries.size ()); ++q)
+    {
+      int idx = query_positions[q];
+      if (block_offsets[q + 1] == block_offsets[q])
+      {
+        output.points (idx, 0) = output.points (idx, 1) = output.points (idx, 2) = output.points (idx, 3) = std::numeric_limits<float>::quiet_NaN ();
+        output.is_dense = false;
+        continue;
+      }
+      for (int d = 0; d < 4; ++d)
+        output.points (idx, d) = block_normals[4 * q + d];
+
+      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx, vpy, vpz,
+                                  output.points (idx, 0), output.points (idx, 1), output.points (idx, 2));
+    }
   }
 }
 
@@ -100,40 +155,54 @@ pcl::NormalEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &ou
   getViewPoint (vpx, vpy, vpz);
 
   output.is_dense = true;
-  // Iterating over the entire index vector
-#pragma omp parallel for schedule (dynamic, threads_)
-  for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
-  {
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
-    std::vector<int> nn_indices (k_);
-    std::vector<float> nn_dists (k_);
 
-    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+  // The neighborhoods are searched for in blocks of queries, which bounds the memory used by the results
+  const int block_size = 16384;
+  std::vector<int> queries, query_positions;
+  std::vector<int> block_indices, block_offsets;
+  std::vector<float> block_dists, block_normals;
+  for (int block_begin = 0; block_begin < static_cast<int> (indices_->size ()); block_begin += block_size)
+  {
+    int block_end = std::min (block_begin + block_size, static_cast<int> (indices_->size ()));
+    queries.clear ();
+    query_positions.clear ();
+    for (int idx = block_begin; idx < block_end; ++idx)
     {
-      output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
-  
-      output.is_dense = false;
-      continue;
+      if (isFinite ((*input_)[(*indices_)[idx]]))
+      {
+        queries.push_back ((*indices_)[idx]);
+        query_positions.push_back (idx);
+      }
+      else
+      {
+        output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+        output.is_dense = false;
+      }
     }
+    // An empty list of queries would stand for the whole cloud
+    if (queries.empty ())
+      continue;
+    searchForNeighborsBatch (queries, block_indices, block_dists, block_offsets);
 
-    // 16-bytes aligned placeholder for the XYZ centroid of a surface patch
-    Eigen::Vector4f xyz_centroid;
-    // Estimate the XYZ centroid
-    compute3DCentroid (*surface_, nn_indices, xyz_centroid);
-
-    // Placeholder for the 3x3 covariance matrix at each surface patch
-    EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
-    // Compute the 3x3 covariance matrix
-    computeCovarianceMatrix (*surface_, nn_indices, xyz_centroid, covariance_matrix);
-
-    // Get the plane normal and surface curvature
-    solvePlaneParameters (covariance_matrix,
-                          output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature);
+    computePointNormals (*surface_, block_indices, block_offsets, block_normals, getThreadsToUse ());
 
-    flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx, vpy, vpz,
-                                output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
+    for (int q = 0; q < static_cast<int> (queries.size ()); ++q)
+    {
+      int idx = query_positions[q];
+      if (block_offsets[q + 1] == block_offsets[q])
+      {
+        output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+        output.is_dense = false;
+        continue;
+      }
+      output.points[idx].normal[0] = block_normals[4 * q + 0];
+      output.points[idx].normal[1] = block_normals[4 * q + 1];
+      output.points[idx].normal[2] = block_normals[4 * q + 2];
+      output.points[idx].curvature = block_normals[4 * q + 3];
+
+      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx, vpy, vpz,
+                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
+    }
   }
 }
 
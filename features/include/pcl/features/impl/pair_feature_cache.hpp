@@ -0,0 +1,262 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_PAIR_FEATURE_CACHE_H_
+#define PCL_FEATURES_IMPL_PAIR_FEATURE_CACHE_H_
+
+#include <pcl/features/pair_feature_cache.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> void
+pcl::PairFeatureCache<N>::setMemoryBudget (size_t memory_budget)
+{
+  memory_budget_ = memory_budget;
+
+  // Largest power of two number of slots per shard which fits in the budget
+  size_t slots = memory_budget / (sizeof (Entry) * shards_.size ());
+  max_shard_size_ = 0;
+  if (slots > 0)
+  {
+    max_shard_size_ = 1;
+    while (max_shard_size_ * 2 <= slots)
+      max_shard_size_ *= 2;
+  }
+
+  for (size_t s = 0; s < shards_.size (); ++s)
+  {
+    boost::mutex::scoped_lock lock (mutexes_[s]);
+    std::vector<Entry> ().swap (shards_[s].entries);
+    shards_[s] = Shard ();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> size_t
+pcl::PairFeatureCache<N>::getMemoryUsage () const
+{
+  size_t bytes = 0;
+  for (size_t s = 0; s < shards_.size (); ++s)
+  {
+    boost::mutex::scoped_lock lock (mutexes_[s]);
+    bytes += shards_[s].entries.size () * sizeof (Entry);
+  }
+  return (bytes);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> bool
+pcl::PairFeatureCache<N>::find (int p, int q, float *features)
+{
+  unsigned int h = hash (p, q);
+  size_t s = h & ((1u << shard_bits_) - 1);
+  Shard &shard = shards_[s];
+
+  boost::mutex::scoped_lock lock (mutexes_[s]);
+  if (!shard.entries.empty ())
+  {
+    size_t mask = shard.entries.size () - 1;
+    size_t slot = (h >> shard_bits_) & mask;
+    for (int probe = 0; probe < max_probes_; ++probe, slot = (slot + 1) & mask)
+    {
+      const Entry &entry = shard.entries[slot];
+      // Entries are never erased, so an empty slot ends the probing sequence
+      if (entry.p < 0)
+        break;
+      if (entry.p == p && entry.q == q)
+      {
+        for (int d = 0; d < N; ++d)
+          features[d] = entry.features[d];
+        ++shard.hits;
+        return (true);
+      }
+    }
+  }
+  ++shard.misses;
+  return (false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> void
+pcl::PairFeatureCache<N>::insert (int p, int q, const float *features)
+{
+  if (max_shard_size_ == 0)
+    return;
+
+  Entry entry;
+  entry.p = p;
+  entry.q = q;
+  for (int d = 0; d < N; ++d)
+    entry.features[d] = features[d];
+
+  unsigned int h = hash (p, q);
+  size_t s = h & ((1u << shard_bits_) - 1);
+  Shard &shard = shards_[s];
+
+  boost::mutex::scoped_lock lock (mutexes_[s]);
+  // Keep the load factor under 1/2 while the budget allows it
+  if (2 * (shard.size + 1) > shard.entries.size () && shard.entries.size () < max_shard_size_)
+    grow (shard);
+  if (insertEntry (shard.entries, h >> shard_bits_, entry, shard.size))
+    ++shard.evictions;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> bool
+pcl::PairFeatureCache<N>::insertEntry (
+    std::vector<Entry> &entries, unsigned int h, const Entry &entry, size_t &size) const
+{
+  size_t mask = entries.size () - 1;
+  size_t home = h & mask;
+  size_t slot = home;
+  for (int probe = 0; probe < max_probes_; ++probe, slot = (slot + 1) & mask)
+  {
+    if (entries[slot].p < 0)
+    {
+      entries[slot] = entry;
+      ++size;
+      return (false);
+    }
+    if (entries[slot].p == entry.p && entries[slot].q == entry.q)
+    {
+      entries[slot] = entry;
+      return (false);
+    }
+  }
+  // No free slot within the probing distance, replace the entry at the home slot
+  entries[home] = entry;
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> void
+pcl::PairFeatureCache<N>::grow (Shard &shard) const
+{
+  Entry empty;
+  empty.p = -1;
+  empty.q = -1;
+  size_t new_size = shard.entries.empty () ? 64 : shard.entries.size () * 2;
+  if (new_size > max_shard_size_)
+    new_size = max_shard_size_;
+
+  std::vector<Entry> entries (new_size, empty);
+  size_t size = 0;
+  for (size_t i = 0; i < shard.entries.size (); ++i)
+    if (shard.entries[i].p >= 0)
+      insertEntry (entries, hash (shard.entries[i].p, shard.entries[i].q) >> shard_bits_, shard.entries[i], size);
+  shard.entries.swap (entries);
+  shard.size = size;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> void
+pcl::PairFeatureCache<N>::clear ()
+{
+  for (size_t s = 0; s < shards_.size (); ++s)
+  {
+    boost::mutex::scoped_lock lock (mutexes_[s]);
+    Shard &shard = shards_[s];
+    for (size_t i = 0; i < shard.entries.size (); ++i)
+      shard.entries[i].p = -1;
+    shard.size = 0;
+    shard.hits = shard.misses = shard.evictions = 0;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> void
+pcl::PairFeatureCache<N>::reset (size_t max_entries)
+{
+  size_t memory_budget = max_entries * sizeof (Entry);
+  if (memory_budget_ != memory_budget)
+    setMemoryBudget (memory_budget);
+  else
+    clear ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> unsigned long
+pcl::PairFeatureCache<N>::getHits () const
+{
+  unsigned long hits = 0;
+  for (size_t s = 0; s < shards_.size (); ++s)
+  {
+    boost::mutex::scoped_lock lock (mutexes_[s]);
+    hits += shards_[s].hits;
+  }
+  return (hits);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> unsigned long
+pcl::PairFeatureCache<N>::getMisses () const
+{
+  unsigned long misses = 0;
+  for (size_t s = 0; s < shards_.size (); ++s)
+  {
+    boost::mutex::scoped_lock lock (mutexes_[s]);
+    misses += shards_[s].misses;
+  }
+  return (misses);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> unsigned long
+pcl::PairFeatureCache<N>::getEvictions () const
+{
+  unsigned long evictions = 0;
+  for (size_t s = 0; s < shards_.size (); ++s)
+  {
+    boost::mutex::scoped_lock lock (mutexes_[s]);
+    evictions += shards_[s].evictions;
+  }
+  return (evictions);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int N> size_t
+pcl::PairFeatureCache<N>::size () const
+{
+  size_t size = 0;
+  for (size_t s = 0; s < shards_.size (); ++s)
+  {
+    boost::mutex::scoped_lock lock (mutexes_[s]);
+    size += shards_[s].size;
+  }
+  return (size);
+}
+
+#endif    // PCL_FEATURES_IMPL_PAIR_FEATURE_CACHE_H_
@@ -80,11 +80,17 @@ pcl::PFHRGBEstimation<PointInT, PointNT, PointOutT>::computePointPFHRGBSignature
       if (i_idx == j_idx)
         continue;
 
-      // Compute the pair NNi to NNj
-      if (!computeRGBPairFeatures (cloud, normals, indices[i_idx], indices[j_idx],
-                                   pfhrgb_tuple_[0], pfhrgb_tuple_[1], pfhrgb_tuple_[2], pfhrgb_tuple_[3],
-                                   pfhrgb_tuple_[4], pfhrgb_tuple_[5], pfhrgb_tuple_[6]))
-        continue;
+      if (!use_cache_ || !feature_cache_->find (indices[i_idx], indices[j_idx], pfhrgb_tuple_.data ()))
+      {
+        // Compute the pair NNi to NNj
+        if (!computeRGBPairFeatures (cloud, normals, indices[i_idx], indices[j_idx],
+                                     pfhrgb_tuple_[0], pfhrgb_tuple_[1], pfhrgb_tuple_[2], pfhrgb_tuple_[3],
+                                     pfhrgb_tuple_[4], pfhrgb_tuple_[5], pfhrgb_tuple_[6]))
+          continue;
+
+        if (use_cache_)
+          feature_cache_->insert (indices[i_idx], indices[j_idx], pfhrgb_tuple_.data ());
+      }
 
       // Normalize the f1, f2, f3, f5, f6, f7 features and push them in the histogram
       f_index_[0] = static_cast<int> (floor (nr_split * ((pfhrgb_tuple_[0] + M_PI) * d_pi_)));
@@ -144,6 +150,10 @@ pcl::PFHRGBEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudO
   pfhrgb_histogram_.setZero (2 * nr_subdiv_ * nr_subdiv_ * nr_subdiv_);
   pfhrgb_tuple_.setZero (7);
 
+  // Clear the feature cache
+  if (use_cache_)
+    feature_cache_->reset (max_cache_size_);
+
   // Allocate enough space to hold the results
   // \note This resize is irrelevant for a radiusSearch ().
   std::vector<int> nn_indices (k_);
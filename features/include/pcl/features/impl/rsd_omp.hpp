@@ -0,0 +1,85 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_RSD_OMP_H_
+#define PCL_FEATURES_IMPL_RSD_OMP_H_
+
+#include <pcl/features/rsd_omp.h>
+#include <pcl/features/impl/rsd.hpp>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::RSDEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  // Check if search_radius_ was set
+  if (search_radius_ < 0)
+  {
+    PCL_ERROR ("[pcl::%s::computeFeature] A search radius needs to be set!\n", getClassName ().c_str ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
+  const int nr_subdiv = getNrSubdivisions ();
+  const double plane_radius = getPlaneRadius ();
+  const bool save_histograms = getSaveHistograms ();
+
+  // Every thread writes its histogram at the position of its query, so the list is allocated upfront
+  if (save_histograms)
+    histograms_.reset (new std::vector<Eigen::MatrixXf, Eigen::aligned_allocator<Eigen::MatrixXf> > (indices_->size ()));
+
+  // Iterating over the entire index vector
+#pragma omp parallel for schedule (dynamic, 64) num_threads (threads_)
+  for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
+  {
+    // List of indices and corresponding squared distances for a neighborhood
+    // \note resize is irrelevant for a radiusSearch ().
+    std::vector<int> nn_indices;
+    std::vector<float> nn_sqr_dists;
+
+    // Compute and store r_min and r_max in the output cloud
+    this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_sqr_dists);
+    if (save_histograms)
+      (*histograms_)[idx] = computeRSD (normals_, nn_indices, nn_sqr_dists, search_radius_, nr_subdiv, plane_radius, output.points[idx], true);
+    else
+      computeRSD (normals_, nn_indices, nn_sqr_dists, search_radius_, nr_subdiv, plane_radius, output.points[idx], false);
+  }
+}
+
+#define PCL_INSTANTIATE_RSDEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::RSDEstimationOMP<T,NT,OutT>;
+
+#endif    // PCL_FEATURES_IMPL_RSD_OMP_H_
@@ -0,0 +1,140 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_SEGMENT_FEATURES_H_
+#define PCL_FEATURES_IMPL_SEGMENT_FEATURES_H_
+
+#include <pcl/features/segment_features.h>
+#include <pcl/search/pcl_search.h>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Implementation of \ref pcl::computeSegmentFeatures, with the point types of the estimator
+      * deduced from its Feature base class, since the estimators redefine some of its types.
+      */
+    template <typename FeatureT, typename PointInT, typename PointOutT> void
+    computeSegmentFeatures (const FeatureT &estimator,
+                            const pcl::Feature<PointInT, PointOutT> &,
+                            const std::vector<pcl::PointIndices> &segments,
+                            std::vector<pcl::PointCloud<PointOutT> > &outputs,
+                            unsigned int nr_threads)
+    {
+      outputs.resize (segments.size ());
+      FeatureT prototype (estimator);
+      typename pcl::PointCloud<PointInT>::ConstPtr input = prototype.getInputCloud ();
+      if (!input)
+      {
+        PCL_ERROR ("[pcl::computeSegmentFeatures] No input dataset was given to the estimator!\n");
+        for (size_t i = 0; i < outputs.size (); ++i)
+        {
+          outputs[i].width = outputs[i].height = 0;
+          outputs[i].points.clear ();
+        }
+        return;
+      }
+
+      // Build the search method once; the copies of the estimator share it, and would otherwise each build
+      // their own, or set its input cloud concurrently
+      typename pcl::PointCloud<PointInT>::ConstPtr surface = prototype.getSearchSurface ();
+      if (!surface)
+        surface = input;
+      typename pcl::search::Search<PointInT>::Ptr tree = prototype.getSearchMethod ();
+      if (!tree)
+      {
+        if (surface->isOrganized () && input->isOrganized ())
+          tree.reset (new pcl::search::OrganizedNeighbor<PointInT> ());
+        else
+          tree.reset (new pcl::search::KdTree<PointInT> (false));
+        prototype.setSearchMethod (tree);
+      }
+      if (tree->getInputCloud () != surface)
+        tree->setInputCloud (surface);
+
+      const int nr_segments = static_cast<int> (segments.size ());
+#pragma omp parallel num_threads (nr_threads == 0 ? 1 : nr_threads)
+      {
+        FeatureT segment_estimator (prototype);
+#pragma omp for schedule (dynamic, 1)
+        for (int i = 0; i < nr_segments; ++i)
+        {
+          segment_estimator.setIndices (boost::shared_ptr<std::vector<int> > (new std::vector<int> (segments[i].indices)));
+          segment_estimator.compute (outputs[i]);
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename FeatureT> void
+pcl::computeSegmentFeatures (const FeatureT &estimator,
+                             const std::vector<pcl::PointIndices> &segments,
+                             std::vector<typename FeatureT::PointCloudOut> &outputs,
+                             unsigned int nr_threads)
+{
+  pcl::detail::computeSegmentFeatures (estimator, estimator, segments, outputs, nr_threads);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename FeatureT> void
+pcl::computeSegmentFeatures (const FeatureT &estimator,
+                             const std::vector<pcl::PointIndices> &segments,
+                             typename FeatureT::PointCloudOut &output,
+                             unsigned int nr_threads)
+{
+  std::vector<typename FeatureT::PointCloudOut> outputs;
+  computeSegmentFeatures (estimator, segments, outputs, nr_threads);
+
+  output.points.assign (segments.size (), typename FeatureT::PointCloudOut::PointType ());
+  output.width = static_cast<uint32_t> (output.points.size ());
+  output.height = 1;
+  output.is_dense = true;
+  for (size_t i = 0; i < outputs.size (); ++i)
+  {
+    if (outputs[i].points.empty ())
+    {
+      output.is_dense = false;
+      continue;
+    }
+    output.points[i] = outputs[i].points[0];
+    output.header = outputs[i].header;
+  }
+}
+
+#endif  //#ifndef PCL_FEATURES_IMPL_SEGMENT_FEATURES_H_
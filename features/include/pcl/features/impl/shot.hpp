@@ -55,6 +55,9 @@
 const double zeroDoubleEps15 = 1E-15;
 const float zeroFloatEps8 = 1E-8f;
 
+// Number of neighbors processed together by the packet (SIMD) parts of the descriptor computation.
+const int shotNeighborBlockSize = 64;
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 /** \brief Check if val1 and val2 are equals.
   *
@@ -201,10 +204,24 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::createBinDistan
   //if (!pcl_isfinite (current_frame.rf[0]) || !pcl_isfinite (current_frame.rf[4]) || !pcl_isfinite (current_frame.rf[11]))
     //return;
 
+  const Eigen::Vector3f z_axis = current_frame.z_axis.getNormalVector3fMap ();
+  Eigen::Matrix<float, 3, Eigen::Dynamic> neighbor_normals (3, shotNeighborBlockSize);
+  Eigen::Matrix<float, 1, Eigen::Dynamic> cosines (1, shotNeighborBlockSize);
+
   for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
+    // Compute the cosines of a whole block of neighbors with a single matrix product
+    size_t block_index = i_idx % shotNeighborBlockSize;
+    if (block_index == 0)
+    {
+      int block_size = static_cast<int> (std::min (indices.size () - i_idx, static_cast<size_t> (shotNeighborBlockSize)));
+      for (int j = 0; j < block_size; ++j)
+        neighbor_normals.col (j) = normals_->points[indices[i_idx + j]].getNormalVector3fMap ();
+      cosines.leftCols (block_size).noalias () = z_axis.transpose () * neighbor_normals.leftCols (block_size);
+    }
+
     //double cosineDesc = feat[i].rf[6]*normal[0] + feat[i].rf[7]*normal[1] + feat[i].rf[8]*normal[2];
-    double cosineDesc = normals_->points[indices[i_idx]].getNormalVector4fMap ().dot (current_frame.z_axis.getNormalVector4fMap ());
+    double cosineDesc = cosines[block_index];
 
     if (cosineDesc > 1.0)
       cosineDesc = 1.0;
@@ -215,6 +232,42 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::createBinDistan
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::computeLocalCoordinates (
+    const std::vector<int> &indices,
+    const std::vector<float> &sqr_dists,
+    const int index,
+    Eigen::Matrix<float, 4, Eigen::Dynamic> &local_coordinates) const
+{
+  const Eigen::Vector4f& central_point = (*input_)[(*indices_)[index]].getVector4fMap ();
+  const PointRFT& current_frame = (*frames_)[index];
+
+  // The axes of the local reference frame as rows. The last column is zero, so that the fourth coordinate of
+  // the points is ignored, and the last row is overwritten by the distances.
+  Eigen::Matrix4f rf = Eigen::Matrix4f::Zero ();
+  rf.block<1, 3> (0, 0) = current_frame.x_axis.getNormalVector3fMap ().transpose ();
+  rf.block<1, 3> (1, 0) = current_frame.y_axis.getNormalVector3fMap ().transpose ();
+  rf.block<1, 3> (2, 0) = current_frame.z_axis.getNormalVector3fMap ().transpose ();
+
+  const int nr_neighbors = static_cast<int> (indices.size ());
+  local_coordinates.resize (4, nr_neighbors);
+  if (nr_neighbors == 0)
+    return;
+
+  Eigen::Matrix<float, 4, Eigen::Dynamic> deltas (4, shotNeighborBlockSize);
+  for (int begin = 0; begin < nr_neighbors; begin += shotNeighborBlockSize)
+  {
+    int block_size = std::min (nr_neighbors - begin, shotNeighborBlockSize);
+    for (int j = 0; j < block_size; ++j)
+      deltas.col (j) = surface_->points[indices[begin + j]].getVector4fMap () - central_point;
+    local_coordinates.middleCols (begin, block_size).noalias () = rf * deltas.leftCols (block_size);
+  }
+
+  // Compute the Euclidean norms
+  local_coordinates.row (3) = Eigen::Map<const Eigen::Matrix<float, 1, Eigen::Dynamic> > (&sqr_dists[0], nr_neighbors).array ().sqrt ().matrix ();
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::normalizeHistogram (
@@ -238,23 +291,22 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::interpolateSing
     const int nr_bins,
     Eigen::VectorXf &shot)
 {
-  const Eigen::Vector4f& central_point = (*input_)[(*indices_)[index]].getVector4fMap ();
-  const PointRFT& current_frame = (*frames_)[index];
+  // Express all the neighbors in the local reference frame first, with packet operations, so that only the
+  // binning is left to the per neighbor loop
+  Eigen::Matrix<float, 4, Eigen::Dynamic> local_coordinates;
+  this->computeLocalCoordinates (indices, sqr_dists, index, local_coordinates);
 
   for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
-    Eigen::Vector4f delta = surface_->points[indices[i_idx]].getVector4fMap () - central_point;
-    delta[3] = 0;
-
-    // Compute the Euclidean norm
-   double distance = sqrt (sqr_dists[i_idx]);
+    // The Euclidean norm is in the last row
+    double distance = local_coordinates (3, i_idx);
 
     if (areEquals (distance, 0.0))
       continue;
 
-    double xInFeatRef = delta.dot (current_frame.x_axis.getNormalVector4fMap ());
-    double yInFeatRef = delta.dot (current_frame.y_axis.getNormalVector4fMap ());
-    double zInFeatRef = delta.dot (current_frame.z_axis.getNormalVector4fMap ());
+    double xInFeatRef = local_coordinates (0, i_idx);
+    double yInFeatRef = local_coordinates (1, i_idx);
+    double zInFeatRef = local_coordinates (2, i_idx);
 
     // To avoid numerical problems afterwards
     if (fabs (yInFeatRef) < 1E-30)
@@ -408,25 +460,24 @@ pcl::SHOTEstimation<pcl::PointXYZRGBA, PointNT, PointOutT, PointRFT>::interpolat
   const int nr_bins_color,
   Eigen::VectorXf &shot)
 {
-  const Eigen::Vector4f &central_point = (*input_)[(*indices_)[index]].getVector4fMap ();
-  const PointRFT& current_frame = (*frames_)[index];
-
   int shapeToColorStride = nr_grid_sector_*(nr_bins_shape+1);
 
+  // Express all the neighbors in the local reference frame first, with packet operations, so that only the
+  // binning is left to the per neighbor loop
+  Eigen::Matrix<float, 4, Eigen::Dynamic> local_coordinates;
+  this->computeLocalCoordinates (indices, sqr_dists, index, local_coordinates);
+
   for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
   {
-    Eigen::Vector4f delta = surface_->points[indices[i_idx]].getVector4fMap () - central_point;
-    delta[3] = 0;
-
-    // Compute the Euclidean norm
-    double distance = sqrt (sqr_dists[i_idx]);
+    // The Euclidean norm is in the last row
+    double distance = local_coordinates (3, i_idx);
 
     if (areEquals (distance, 0.0))
       continue;
 
-    double xInFeatRef = delta.dot (current_frame.x_axis.getNormalVector4fMap ());
-    double yInFeatRef = delta.dot (current_frame.y_axis.getNormalVector4fMap ());
-    double zInFeatRef = delta.dot (current_frame.z_axis.getNormalVector4fMap ());
+    double xInFeatRef = local_coordinates (0, i_idx);
+    double yInFeatRef = local_coordinates (1, i_idx);
+    double zInFeatRef = local_coordinates (2, i_idx);
 
     // To avoid numerical problems afterwards
     if (fabs (yInFeatRef) < 1E-30)
@@ -627,28 +678,9 @@ pcl::SHOTEstimation<pcl::PointXYZRGBA, PointNT, PointOutT, PointRFT>::computePoi
     return;
   }
 
-  const PointRFT& current_frame = frames_->points[index];
-  //if (!pcl_isfinite (current_frame.rf[0]) || !pcl_isfinite (current_frame.rf[4]) || !pcl_isfinite (current_frame.rf[11]))
-    //return;
-
   //If shape description is enabled, compute the bins activated by each neighbor of the current feature in the shape histogram
   if (b_describe_shape_)
-  {
-    binDistanceShape.resize (nNeighbors);
-
-    for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
-    {
-      //feat[i].rf[6]*normal[0] + feat[i].rf[7]*normal[1] + feat[i].rf[8]*normal[2];
-      double cosineDesc = normals_->points[indices[i_idx]].getNormalVector4fMap ().dot (current_frame.z_axis.getNormalVector4fMap ());
-
-      if (cosineDesc > 1.0)
-        cosineDesc = 1.0;
-      if (cosineDesc < - 1.0)
-        cosineDesc = - 1.0;
-
-      binDistanceShape[i_idx] = ((1.0 + cosineDesc) * nr_shape_bins_) / 2;
-    }
-  }
+    this->createBinDistanceShape (index, indices, binDistanceShape);
 
   //If color description is enabled, compute the bins activated by each neighbor of the current feature in the color histogram
   if (b_describe_color_)
@@ -815,8 +847,7 @@ pcl::SHOTEstimation<pcl::PointXYZRGBA, PointNT, PointOutT, PointRFT>::computeFea
         this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
     {
       // Copy into the resultant cloud
-      for (int d = 0; d < shot_.size (); ++d)
-        output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+      copySHOTDescriptor (Eigen::VectorXf::Constant (descLength_, std::numeric_limits<float>::quiet_NaN ()), output.points[idx]);
       for (int d = 0; d < 9; ++d)
         output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
 
@@ -828,8 +859,7 @@ pcl::SHOTEstimation<pcl::PointXYZRGBA, PointNT, PointOutT, PointRFT>::computeFea
     computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_);
 
     // Copy into the resultant cloud
-    for (int d = 0; d < shot_.size (); ++d)
-      output.points[idx].descriptor[d] = shot_[d];
+    copySHOTDescriptor (shot_, output.points[idx]);
     for (int d = 0; d < 9; ++d)
       output.points[idx].rf[d] = frames_->points[idx].rf[ (4*(d/3) + (d%3)) ];
   }
@@ -953,8 +983,7 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::computeFeature
         this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
     {
       // Copy into the resultant cloud
-      for (int d = 0; d < shot_.size (); ++d)
-        output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+      copySHOTDescriptor (Eigen::VectorXf::Constant (descLength_, std::numeric_limits<float>::quiet_NaN ()), output.points[idx]);
       for (int d = 0; d < 9; ++d)
         output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
 
@@ -966,8 +995,7 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::computeFeature
     computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_);
 
     // Copy into the resultant cloud
-    for (int d = 0; d < shot_.size (); ++d)
-      output.points[idx].descriptor[d] = shot_[d];
+    copySHOTDescriptor (shot_, output.points[idx]);
     for (int d = 0; d < 9; ++d)
       output.points[idx].rf[d] = frames_->points[idx].rf[ (4*(d/3) + (d%3)) ];
   }
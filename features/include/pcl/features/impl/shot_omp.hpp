@@ -95,8 +95,7 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
         this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
     {
       // Copy into the resultant cloud
-      for (int d = 0; d < shot[tid].size (); ++d)
-        output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+      copySHOTDescriptor (Eigen::VectorXf::Constant (descLength_, std::numeric_limits<float>::quiet_NaN ()), output.points[idx]);
       for (int d = 0; d < 9; ++d)
         output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
 
@@ -108,8 +107,7 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
     this->computePointSHOT (idx, nn_indices, nn_dists, shot[tid]);
 
 	// Copy into the resultant cloud
-    for (int d = 0; d < shot[tid].size (); ++d)
-      output.points[idx].descriptor[d] = shot[tid][d];
+    copySHOTDescriptor (shot[tid], output.points[idx]);
     for (int d = 0; d < 9; ++d)
       output.points[idx].rf[d] = frames_->points[idx].rf[ (4*(d/3) + (d%3)) ];
   }
@@ -172,8 +170,7 @@ pcl::SHOTEstimationOMP<pcl::PointXYZRGBA, PointNT, PointOutT, PointRFT>::compute
         this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
     {
       // Copy into the resultant cloud
-      for (int d = 0; d < shot[tid].size (); ++d)
-        output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+      copySHOTDescriptor (Eigen::VectorXf::Constant (descLength_, std::numeric_limits<float>::quiet_NaN ()), output.points[idx]);
       for (int d = 0; d < 9; ++d)
         output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
 
@@ -185,8 +182,7 @@ pcl::SHOTEstimationOMP<pcl::PointXYZRGBA, PointNT, PointOutT, PointRFT>::compute
     this->computePointSHOT (idx, nn_indices, nn_dists, shot[tid]);
 
     // Copy into the resultant cloud
-    for (int d = 0; d < shot[tid].size (); ++d)
-      output.points[idx].descriptor[d] = shot[tid][d];
+    copySHOTDescriptor (shot[tid], output.points[idx]);
     for (int d = 0; d < 9; ++d)
       output.points[idx].rf[d] = frames_->points[idx].rf[ (4*(d/3) + (d%3)) ];
   }
@@ -114,6 +114,26 @@ pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::geodesicFixedRadiusS
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::sortGeodesicNeighborhoods (
+    std::vector<std::vector<std::pair<float, int> > > &neighborhoods)
+{
+  const float max_scale = *std::max_element (scale_values_.begin (), scale_values_.end ());
+  const int nr_points = static_cast<int> (geodesic_distances_.size ());
+  neighborhoods.resize (nr_points);
+#pragma omp parallel for schedule (dynamic, 64) num_threads (threads_)
+  for (int point_i = 0; point_i < nr_points; ++point_i)
+  {
+    neighborhoods[point_i].clear ();
+    for (int i = 0; i < nr_points; ++i)
+      if (i != point_i && geodesic_distances_[point_i][i] < max_scale)
+        neighborhoods[point_i].push_back (std::make_pair (geodesic_distances_[point_i][i], i));
+    std::sort (neighborhoods[point_i].begin (), neighborhoods[point_i].end ());
+  }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::computeRegionsOfInterest (std::list<IndicesPtr> &rois)
@@ -140,37 +160,38 @@ pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::computeF ()
 
   // declare and initialize data structure
   F_scales_.resize (scale_values_.size ());
+  const int nr_points = static_cast<int> (input_->points.size ());
   std::vector<float> point_density (input_->points.size ()),
           F (input_->points.size ());
-  std::vector<std::vector<float> > phi (input_->points.size ());
-  std::vector<float> phi_row (input_->points.size ());
+  std::vector<std::vector<float> > phi (input_->points.size (), std::vector<float> (input_->points.size ()));
 
   for (size_t scale_i = 0; scale_i < scale_values_.size (); ++scale_i)
   {
     float scale_squared = scale_values_[scale_i] * scale_values_[scale_i];
 
     // calculate point density for each point x_i
-    for (size_t point_i = 0; point_i < input_->points.size (); ++point_i)
+#pragma omp parallel for schedule (dynamic, 64) num_threads (threads_)
+    for (int point_i = 0; point_i < nr_points; ++point_i)
     {
       float point_density_i = 0.0;
-      for (size_t point_j = 0; point_j < input_->points.size (); ++point_j)
+      for (int point_j = 0; point_j < nr_points; ++point_j)
       {
         float d_g = geodesic_distances_[point_i][point_j];
         float phi_i_j = 1.0f / sqrtf (2.0f * static_cast<float> (M_PI) * scale_squared) * expf ( (-1) * d_g*d_g / (2.0f * scale_squared));
 
         point_density_i += phi_i_j;
-        phi_row[point_j] = phi_i_j;
+        phi[point_i][point_j] = phi_i_j;
       }
       point_density[point_i] = point_density_i;
-      phi[point_i] = phi_row;
     }
 
     // compute weights for each pair (x_i, x_j), evaluate the operator A_hat
-    for (size_t point_i = 0; point_i < input_->points.size (); ++point_i)
+#pragma omp parallel for schedule (dynamic, 64) num_threads (threads_)
+    for (int point_i = 0; point_i < nr_points; ++point_i)
     {
       float A_hat_normalization = 0.0;
       PointT A_hat; A_hat.x = A_hat.y = A_hat.z = 0.0;
-      for (size_t point_j = 0; point_j < input_->points.size (); ++point_j)
+      for (int point_j = 0; point_j < nr_points; ++point_j)
       {
         float phi_hat_i_j = phi[point_i][point_j] / (point_density[point_i] * point_density[point_j]);
         A_hat_normalization += phi_hat_i_j;
@@ -199,18 +220,26 @@ pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::extractExtrema (std:
   std::vector<std::vector<bool> > is_min (scale_values_.size ()),
       is_max (scale_values_.size ());
 
+  // The geodesic neighborhoods of all the scales are prefixes of the ones at the largest scale
+  std::vector<std::vector<std::pair<float, int> > > neighborhoods;
+  sortGeodesicNeighborhoods (neighborhoods);
+  const int nr_points = static_cast<int> (input_->points.size ());
+
   // for each point, check if it is a local extrema on each scale
   for (size_t scale_i = 0; scale_i < scale_values_.size (); ++scale_i)
   {
-    std::vector<bool> is_min_scale (input_->points.size ()),
+    // std::vector<bool> packs its elements and cannot be written to in parallel
+    std::vector<char> is_min_scale (input_->points.size ()),
         is_max_scale (input_->points.size ());
-    for (size_t point_i = 0; point_i < input_->points.size (); ++point_i)
+    const std::pair<float, int> scale_bound (scale_values_[scale_i], -1);
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+    for (int point_i = 0; point_i < nr_points; ++point_i)
     {
-      std::vector<int> nn_indices;
-      geodesicFixedRadiusSearch (point_i, scale_values_[scale_i], nn_indices);
+      std::vector<std::pair<float, int> >::const_iterator nn_end =
+        std::lower_bound (neighborhoods[point_i].begin (), neighborhoods[point_i].end (), scale_bound);
       bool is_max_point = true, is_min_point = true;
-      for (std::vector<int>::iterator nn_it = nn_indices.begin (); nn_it != nn_indices.end (); ++nn_it)
-        if (F_scales_[scale_i][point_i] < F_scales_[scale_i][*nn_it])
+      for (std::vector<std::pair<float, int> >::const_iterator nn_it = neighborhoods[point_i].begin (); nn_it != nn_end; ++nn_it)
+        if (F_scales_[scale_i][point_i] < F_scales_[scale_i][nn_it->second])
           is_max_point = false;
         else
           is_min_point = false;
@@ -219,8 +248,8 @@ pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::extractExtrema (std:
       is_max_scale[point_i] = is_max_point;
     }
 
-    is_min[scale_i] = is_min_scale;
-    is_max[scale_i] = is_max_scale;
+    is_min[scale_i].assign (is_min_scale.begin (), is_min_scale.end ());
+    is_max[scale_i].assign (is_max_scale.begin (), is_max_scale.end ());
   }
 
   // look for points that are min/max over three consecutive scales
@@ -234,9 +263,14 @@ pcl::StatisticalMultiscaleInterestRegionExtraction<PointT>::extractExtrema (std:
         IndicesPtr region (new std::vector<int>);
         region->push_back (static_cast<int> (point_i));
 
-        // and also add its scale-sized geodesic neighborhood
+        // and also add its scale-sized geodesic neighborhood, in the order of the points
         std::vector<int> nn_indices;
-        geodesicFixedRadiusSearch (point_i, scale_values_[scale_i], nn_indices);
+        std::vector<std::pair<float, int> >::const_iterator nn_end =
+          std::lower_bound (neighborhoods[point_i].begin (), neighborhoods[point_i].end (),
+                            std::make_pair (scale_values_[scale_i], -1));
+        for (std::vector<std::pair<float, int> >::const_iterator nn_it = neighborhoods[point_i].begin (); nn_it != nn_end; ++nn_it)
+          nn_indices.push_back (nn_it->second);
+        std::sort (nn_indices.begin (), nn_indices.end ());
         region->insert (region->end (), nn_indices.begin (), nn_indices.end ());
         rois.push_back (region);
       }
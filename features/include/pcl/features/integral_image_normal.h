@@ -97,6 +97,7 @@ namespace pcl
         , vpy_ (0.0f)
         , vpz_ (0.0f)
         , use_sensor_origin_ (true)
+        , threads_ (1)
       {
         feature_name_ = "IntegralImagesNormalEstimation";
         tree_.reset ();
@@ -113,6 +114,24 @@ namespace pcl
       void
       setRectSize (const int width, const int height);
 
+      /** \brief Set the number of threads used to compute the normals of the rows of the image. The integral
+        * images are built with the same number of threads, when they are (re)initialized by setInputCloud or
+        * a change of the normal estimation method.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads)
+      {
+        threads_ = (nr_threads == 0) ? 1 : nr_threads;
+      }
+
+      /** \brief Get the number of threads used to compute the normals. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Computes the normal at the specified position.
         * \param[in] pos_x x position (pixel)
         * \param[in] pos_y y position (pixel)
@@ -340,6 +359,23 @@ namespace pcl
       bool
       initCompute ();
 
+      /** \brief The number of threads used to compute the normals. */
+      unsigned int threads_;
+
+      /** \brief Computes the normal at the specified position, for a given size of the neighborhood region. This
+        * does not modify the estimator, and can thus be called from several threads once the data structures of the
+        * chosen normal estimation method have been initialized.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the neighborhood region
+        * \param[in] rect_height the height of the neighborhood region
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormal (const int pos_x, const int pos_y, const unsigned point_index,
+                          const int rect_width, const int rect_height, PointOutT &normal) const;
+
       /** \brief Internal initialization method for COVARIANCE_MATRIX estimation. */
       void
       initCovarianceMatrixMethod ();
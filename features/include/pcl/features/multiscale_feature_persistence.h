@@ -72,7 +72,10 @@ namespace pcl
       /** \brief Empty constructor */
       MultiscaleFeaturePersistence ();
 
-      /** \brief Method that calls computeFeatureAtScale () for each scale parameter */
+      /** \brief Method that calls computeFeatureAtScale () for each scale parameter.
+       * The neighborhoods are searched for once, at the largest scale, and sorted by distance; the
+       * neighborhoods of the smaller scales are prefixes of those (see \ref pcl::search::NeighborhoodCache).
+       */
       void
       computeFeaturesAtAllScales ();
 
@@ -137,6 +140,16 @@ namespace pcl
       inline NormType
       getDistanceMetric () { return distance_metric_; }
 
+      /** \brief Set the number of threads to use for searching the neighborhoods and for the statistics over the features
+       * \param nr_threads the number of hardware threads to use (0 sets the value back to 1)
+       */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads to use for searching the neighborhoods and for the statistics over the features */
+      inline unsigned int
+      getNumberOfThreads () { return threads_; }
+
 
     private:
       /** \brief Checks if all the necessary input was given and the computations can successfully start */
@@ -187,6 +200,9 @@ namespace pcl
       std::vector<float> mean_feature_;
       FeatureRepresentationConstPtr feature_representation_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Two structures in which to hold the results of the unique feature extraction process.
        * They are superfluous with respect to each other, but improve the time performance of the algorithm
        */
@@ -59,9 +59,10 @@ namespace pcl
       // =====STRUCTS/CLASSES=====
       struct Parameters
       {
-        Parameters() : support_size(-1.0f), rotation_invariant(true) {}
+        Parameters() : support_size(-1.0f), rotation_invariant(true), max_no_of_threads(1) {}
         float support_size;
         bool rotation_invariant;
+        int max_no_of_threads;  //!< The maximum number of threads this code is allowed to use with OpenMP
       };
       
       // =====CONSTRUCTOR & DESTRUCTOR=====
@@ -103,6 +103,25 @@ namespace pcl
     solvePlaneParameters (covariance_matrix, xyz_centroid, plane_parameters, curvature);
   }
 
+  /** \brief Compute the Least-Squares plane normals and surface curvatures of a batch of neighborhoods.
+    * When SSE is available, the covariance matrices of 4 neighborhoods are accumulated together, and their
+    * smallest eigenvalues and eigenvectors are obtained with the closed form solution of \ref eigen33
+    * evaluated in the same registers. The results match the ones of \ref computePointNormal up to the
+    * floating point rounding.
+    * \param[in] cloud the input point cloud
+    * \param[in] nn_indices the point cloud indices of all the neighborhoods, one after the other
+    * \param[in] nn_offsets the neighborhood i is made of the indices nn_indices[nn_offsets[i]] up to
+    * nn_indices[nn_offsets[i + 1]] (excluded), hence the size of nn_offsets is the number of neighborhoods + 1
+    * \param[out] normals_curvatures the normal and curvature of each neighborhood, stored as 4 consecutive
+    * floats (nx, ny, nz, curvature). Neighborhoods without any finite point are set to NaN.
+    * \param[in] nr_threads the number of hardware threads to use
+    * \ingroup features
+    */
+  template <typename PointT> void
+  computePointNormals (const pcl::PointCloud<PointT> &cloud,
+                       const std::vector<int> &nn_indices, const std::vector<int> &nn_offsets,
+                       std::vector<float> &normals_curvatures, unsigned int nr_threads = 1);
+
   /** \brief Flip (in place) the estimated normal of a point towards a given viewpoint
     * \param point a given point
     * \param vp_x the X coordinate of the viewpoint
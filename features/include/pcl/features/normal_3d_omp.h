@@ -60,40 +60,55 @@ namespace pcl
       using NormalEstimation<PointInT, PointOutT>::k_;
       using NormalEstimation<PointInT, PointOutT>::search_parameter_;
       using NormalEstimation<PointInT, PointOutT>::surface_;
+      using NormalEstimation<PointInT, PointOutT>::tree_;
       using NormalEstimation<PointInT, PointOutT>::getViewPoint;
 
       typedef typename NormalEstimation<PointInT, PointOutT>::PointCloudOut PointCloudOut;
 
     public:
-      /** \brief Empty constructor. */
-      NormalEstimationOMP () : threads_ (1) 
+      /** \brief Empty constructor. Uses one thread per processor. */
+      NormalEstimationOMP () : threads_ (0) 
       {
         feature_name_ = "NormalEstimationOMP";
       };
 
       /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (-1 sets the value back to automatic)
+        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
         */
-      NormalEstimationOMP (unsigned int nr_threads) : threads_ (1)
+      NormalEstimationOMP (unsigned int nr_threads) : threads_ (0)
       {
         setNumberOfThreads (nr_threads);
         feature_name_ = "NormalEstimationOMP";
       }
 
       /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (-1 sets the value back to automatic)
+        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic, i.e., one
+        * thread per processor)
         */
       inline void 
       setNumberOfThreads (unsigned int nr_threads)
       { 
-        if (nr_threads == 0)
-          nr_threads = 1;
         threads_ = nr_threads; 
       }
 
 
     protected:
-      /** \brief The number of threads the scheduler should use. */
+      /** \brief Look up the neighborhoods of a block of query points with a single batched search, so that the
+        * search method can share work between neighboring queries (e.g. the image tiles of OrganizedNeighbor).
+        * \param[in] queries the indices of the query points in the input cloud
+        * \param[out] nn_indices the indices of the neighbors of all the queries, in the search surface
+        * \param[out] nn_dists the squared distances to the neighbors of all the queries
+        * \param[out] nn_offsets the start of the neighbors of each query in \a nn_indices (size: queries + 1)
+        */
+      void
+      searchForNeighborsBatch (const std::vector<int> &queries, std::vector<int> &nn_indices,
+                               std::vector<float> &nn_dists, std::vector<int> &nn_offsets) const;
+
+      /** \brief Get the number of threads to run on: \a threads_, or the number of processors if it is 0. */
+      unsigned int
+      getThreadsToUse () const;
+
+      /** \brief The number of threads the scheduler should use (0 for one per processor). */
       unsigned int threads_;
 
     private:
@@ -127,6 +142,8 @@ namespace pcl
       using NormalEstimationOMP<PointInT, pcl::Normal>::surface_;
       using NormalEstimationOMP<PointInT, pcl::Normal>::getViewPoint;
       using NormalEstimationOMP<PointInT, pcl::Normal>::threads_;
+      using NormalEstimationOMP<PointInT, pcl::Normal>::getThreadsToUse;
+      using NormalEstimationOMP<PointInT, pcl::Normal>::searchForNeighborsBatch;
       using NormalEstimationOMP<PointInT, pcl::Normal>::compute;
 
       /** \brief Default constructor.
@@ -134,7 +151,7 @@ namespace pcl
       NormalEstimationOMP () : NormalEstimationOMP<PointInT, pcl::Normal> () {}
 
       /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (-1 sets the value back to automatic)
+        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
         */
       NormalEstimationOMP (unsigned int nr_threads) : NormalEstimationOMP<PointInT, pcl::Normal> (nr_threads) {}
 
@@ -0,0 +1,228 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_PAIR_FEATURE_CACHE_H_
+#define PCL_FEATURES_PAIR_FEATURE_CACHE_H_
+
+#include <pcl/pcl_macros.h>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Thread safe cache of the features computed for pairs of points, used by the PFH family of
+    * descriptors to avoid recomputing the same pair on overlapping neighborhoods.
+    *
+    * The entries are keyed on the ordered pair of point indices (p, q), since the pair features are not
+    * symmetric. They are spread over a number of shards, each one an open addressing table with linear probing,
+    * guarded by its own mutex, so that several threads can query and fill the cache at the same time.
+    *
+    * The tables grow on demand, up to the given memory budget. Once a shard is full, a new entry replaces the
+    * entry found at its home slot. The number of hits, misses and replaced entries is counted, which helps to
+    * decide whether a cache pays off on a given dataset.
+    *
+    * \note The indices stored in the cache refer to one cloud; call \ref clear before using it on another one.
+    * \ingroup features
+    */
+  template <int N>
+  class PairFeatureCache : boost::noncopyable
+  {
+    public:
+      typedef boost::shared_ptr<PairFeatureCache<N> > Ptr;
+      typedef boost::shared_ptr<const PairFeatureCache<N> > ConstPtr;
+
+      /** \brief Constructor.
+        * \param[in] memory_budget the maximum number of bytes used by the entries
+        * \param[in] nr_shards the number of independently locked tables, rounded up to a power of two
+        */
+      PairFeatureCache (size_t memory_budget = 64ul * 1024ul * 1024ul, unsigned int nr_shards = 64)
+        : shards_ ()
+        , mutexes_ ()
+        , shard_bits_ (0)
+        , max_shard_size_ (0)
+        , memory_budget_ (0)
+      {
+        while ((1u << shard_bits_) < nr_shards && shard_bits_ < 16)
+          ++shard_bits_;
+        shards_.resize (1u << shard_bits_);
+        mutexes_.reset (new boost::mutex[shards_.size ()]);
+        setMemoryBudget (memory_budget);
+      }
+
+      /** \brief Set the maximum number of bytes used by the entries. All the entries are removed.
+        * \param[in] memory_budget the memory budget in bytes
+        */
+      void
+      setMemoryBudget (size_t memory_budget);
+
+      /** \brief Get the maximum number of bytes used by the entries. */
+      inline size_t
+      getMemoryBudget () const
+      {
+        return (memory_budget_);
+      }
+
+      /** \brief Get the maximum number of entries the cache can hold. */
+      inline size_t
+      getCapacity () const
+      {
+        return (max_shard_size_ * shards_.size ());
+      }
+
+      /** \brief Get the number of bytes currently allocated for the entries. */
+      size_t
+      getMemoryUsage () const;
+
+      /** \brief Get the number of bytes used by one entry. */
+      static inline size_t
+      getEntrySize ()
+      {
+        return (sizeof (Entry));
+      }
+
+      /** \brief Look up the features of a pair of points.
+        * \param[in] p the index of the first point (source)
+        * \param[in] q the index of the second point (target)
+        * \param[out] features the N features of the pair, left untouched if the pair is not in the cache
+        * \return true if the pair was found
+        */
+      bool
+      find (int p, int q, float *features);
+
+      /** \brief Store the features of a pair of points.
+        * \param[in] p the index of the first point (source)
+        * \param[in] q the index of the second point (target)
+        * \param[in] features the N features of the pair
+        */
+      void
+      insert (int p, int q, const float *features);
+
+      /** \brief Remove all the entries and reset the counters. The allocated memory is kept. */
+      void
+      clear ();
+
+      /** \brief Remove all the entries and reset the counters, and limit the cache to a number of entries. The
+        * allocated memory is kept if the limit did not change. Called by the PFH family before every compute.
+        * \param[in] max_entries the maximum number of entries
+        */
+      void
+      reset (size_t max_entries);
+
+      /** \brief Get the number of successful lookups since the last \ref clear. */
+      unsigned long
+      getHits () const;
+
+      /** \brief Get the number of failed lookups since the last \ref clear. */
+      unsigned long
+      getMisses () const;
+
+      /** \brief Get the number of entries replaced by newer ones since the last \ref clear. */
+      unsigned long
+      getEvictions () const;
+
+      /** \brief Get the number of entries currently held by the cache. */
+      size_t
+      size () const;
+
+    protected:
+      /** \brief A cached pair. A negative \a p marks an empty slot. */
+      struct Entry
+      {
+        int p;
+        int q;
+        float features[N];
+      };
+
+      /** \brief An open addressing table and its counters, guarded by the mutex of the same index. */
+      struct Shard
+      {
+        Shard () : entries (), size (0), hits (0), misses (0), evictions (0) {}
+
+        std::vector<Entry> entries;
+        size_t size;
+        unsigned long hits;
+        unsigned long misses;
+        unsigned long evictions;
+      };
+
+      /** \brief Mix the two indices of a pair into a 32 bit hash. */
+      static inline unsigned int
+      hash (int p, int q)
+      {
+        unsigned int h = static_cast<unsigned int> (p) * 2654435761u ^ static_cast<unsigned int> (q) * 2246822519u;
+        h ^= h >> 15;
+        h *= 2246822519u;
+        h ^= h >> 13;
+        return (h);
+      }
+
+      /** \brief Insert an entry into a table of a power of two size, replacing its home slot if no free slot is
+        * found within the probing distance.
+        * \return true if an entry was replaced
+        */
+      bool
+      insertEntry (std::vector<Entry> &entries, unsigned int h, const Entry &entry, size_t &size) const;
+
+      /** \brief Double the size of the table of a shard, without going over \a max_shard_size_. */
+      void
+      grow (Shard &shard) const;
+
+      /** \brief The maximum number of slots visited by a lookup or an insertion. */
+      static const int max_probes_ = 16;
+
+      /** \brief The shards, selected by the low bits of the hash. */
+      std::vector<Shard> shards_;
+
+      /** \brief One mutex per shard. */
+      boost::scoped_array<boost::mutex> mutexes_;
+
+      /** \brief The base 2 logarithm of the number of shards. */
+      unsigned int shard_bits_;
+
+      /** \brief The maximum number of slots of a shard, a power of two. */
+      size_t max_shard_size_;
+
+      /** \brief The maximum number of bytes used by the entries. */
+      size_t memory_budget_;
+  };
+}
+
+#include <pcl/features/impl/pair_feature_cache.hpp>
+
+#endif  //#ifndef PCL_FEATURES_PAIR_FEATURE_CACHE_H_
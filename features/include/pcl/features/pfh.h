@@ -42,7 +42,7 @@
 
 #include <pcl/point_types.h>
 #include <pcl/features/feature.h>
-#include <map>
+#include <pcl/features/pair_feature_cache.h>
 
 namespace pcl
 {
@@ -91,8 +91,7 @@ namespace pcl
     *     doesn't have finite 3D coordinates. Therefore, any point that contains
     *     NaN data on x, y, or z, will have its PFH feature property set to NaN.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref FPFHEstimationOMP for examples on parallel implementations of the FPFH (Fast Point Feature Histogram).
+    * \note See \ref PFHEstimationOMP for a parallel implementation.
     *
     * \author Radu B. Rusu
     * \ingroup features
@@ -113,25 +112,27 @@ namespace pcl
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
       typedef typename Feature<PointInT, PointOutT>::PointCloudIn  PointCloudIn;
 
+      typedef PairFeatureCache<4> FeatureCache;
+      typedef typename FeatureCache::Ptr FeatureCachePtr;
+
       /** \brief Empty constructor. 
         * Sets \a use_cache_ to false, \a nr_subdiv_ to 5, and the internal maximum cache size to 1GB.
         */
       PFHEstimation () : 
         nr_subdiv_ (5), 
         pfh_histogram_ (),
-        pfh_tuple_ (),
         d_pi_ (1.0f / (2.0f * static_cast<float> (M_PI))), 
-        feature_map_ (),
-        key_list_ (),
-        // Default 1GB memory size. Need to set it to something more conservative.
-        max_cache_size_ ((1ul*1024ul*1024ul*1024ul) / sizeof (std::pair<std::pair<int, int>, Eigen::Vector4f>)),
+        // The memory is only reserved by computeFeature, and only if the cache is used
+        feature_cache_ (new FeatureCache (0)),
+        // Default 1GB memory size. The tables grow on demand, so this is only an upper bound.
+        max_cache_size_ (static_cast<unsigned int> ((1ul*1024ul*1024ul*1024ul) / FeatureCache::getEntrySize ())),
         use_cache_ (false)
       {
         feature_name_ = "PFHEstimation";
       };
 
-      /** \brief Set the maximum internal cache size. Defaults to 2GB worth of entries.
-        * \param[in] cache_size maximum cache size 
+      /** \brief Set the maximum internal cache size. Defaults to 1GB worth of entries.
+        * \param[in] cache_size maximum cache size, in number of entries
         */
       inline void
       setMaximumCacheSize (unsigned int cache_size)
@@ -170,6 +171,15 @@ namespace pcl
         return (use_cache_);
       }
 
+      /** \brief Get the internal cache, e.g. to read its hit and miss counters after \ref compute.
+        * The cache is cleared at the beginning of every \ref compute call.
+        */
+      inline FeatureCachePtr
+      getInternalCache () const
+      {
+        return (feature_cache_);
+      }
+
       /** \brief Compute the 4-tuple representation containing the three angles and one distance between two points
         * represented by Cartesian coordinates and normals.
         * \note For explanations about the features, please see the literature mentioned above (the order of the
@@ -190,6 +200,8 @@ namespace pcl
 
       /** \brief Estimate the PFH (Point Feature Histograms) individual signatures of the three angular (f1, f2, f3)
         * features for a given point based on its spatial neighborhood of 3D points with normals
+        * \note The method does not modify the state of the estimator, and the internal cache is thread safe, so
+        * it may be called concurrently from several threads.
         * \param[in] cloud the dataset containing the XYZ Cartesian coordinates of the two points
         * \param[in] normals the dataset containing the surface normals at each point in \a cloud
         * \param[in] indices the k-neighborhood point indices in the dataset
@@ -201,6 +213,10 @@ namespace pcl
                                 const std::vector<int> &indices, int nr_split, Eigen::VectorXf &pfh_histogram);
 
     protected:
+      /** \brief Empty the internal cache and apply the maximum cache size, if the cache is used. */
+      void
+      resetInternalCache ();
+
       /** \brief Estimate the Point Feature Histograms (PFH) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
         * setSearchMethod ()
@@ -215,22 +231,13 @@ namespace pcl
       /** \brief Placeholder for a point's PFH signature. */
       Eigen::VectorXf pfh_histogram_;
 
-      /** \brief Placeholder for a PFH 4-tuple. */
-      Eigen::Vector4f pfh_tuple_;
-
-      /** \brief Placeholder for a histogram index. */
-      int f_index_[3];
-
       /** \brief Float constant = 1.0 / (2.0 * M_PI) */
       float d_pi_; 
 
-      /** \brief Internal hashmap, used to optimize efficiency of redundant computations. */
-      std::map<std::pair<int, int>, Eigen::Vector4f, std::less<std::pair<int, int> >, Eigen::aligned_allocator<Eigen::Vector4f> > feature_map_;
-
-      /** \brief Queue of pairs saved, used to constrain memory usage. */
-      std::queue<std::pair<int, int> > key_list_;
+      /** \brief Internal cache of pair features, used to optimize efficiency of redundant computations. */
+      FeatureCachePtr feature_cache_;
 
-      /** \brief Maximum size of internal cache memory. */
+      /** \brief Maximum number of entries of the internal cache. */
       unsigned int max_cache_size_;
 
       /** \brief Set to true to use the internal cache for removing redundant computations. */
@@ -265,8 +272,7 @@ namespace pcl
     *     doesn't have finite 3D coordinates. Therefore, any point that contains
     *     NaN data on x, y, or z, will have its PFH feature property set to NaN.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref FPFHEstimationOMP for examples on parallel implementations of the FPFH (Fast Point Feature Histogram).
+    * \note See \ref PFHEstimationOMP for a parallel implementation.
     *
     * \author Radu B. Rusu
     * \ingroup features
@@ -285,8 +291,7 @@ namespace pcl
       using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::normals_;
       using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::computePointPFHSignature;
       using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::compute;
-      using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::feature_map_;
-      using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::key_list_;
+      using PFHEstimation<PointInT, PointNT, pcl::PFHSignature125>::feature_cache_;
 
     private:
       /** \brief Estimate the Point Feature Histograms (PFH) descriptors at a set of points given by
@@ -39,6 +39,7 @@
 #define PCL_PFHRGB_H_
 
 #include <pcl/features/feature.h>
+#include <pcl/features/pair_feature_cache.h>
 
 namespace pcl
 {
@@ -60,13 +61,60 @@ namespace pcl
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
 
+      typedef PairFeatureCache<7> FeatureCache;
+      typedef typename FeatureCache::Ptr FeatureCachePtr;
 
       PFHRGBEstimation ()
-        : nr_subdiv_ (5), pfhrgb_histogram_ (), pfhrgb_tuple_ (), d_pi_ (1.0f / (2.0f * static_cast<float> (M_PI)))
+        : nr_subdiv_ (5), pfhrgb_histogram_ (), pfhrgb_tuple_ (), d_pi_ (1.0f / (2.0f * static_cast<float> (M_PI))),
+          feature_cache_ (new FeatureCache (0)),
+          max_cache_size_ (static_cast<unsigned int> ((1ul*1024ul*1024ul*1024ul) / FeatureCache::getEntrySize ())),
+          use_cache_ (false)
       {
         feature_name_ = "PFHRGBEstimation";
       }
 
+      /** \brief Set the maximum internal cache size. Defaults to 1GB worth of entries.
+        * \param[in] cache_size maximum cache size, in number of entries
+        */
+      inline void
+      setMaximumCacheSize (unsigned int cache_size)
+      {
+        max_cache_size_ = cache_size;
+      }
+
+      /** \brief Get the maximum internal cache size. */
+      inline unsigned int
+      getMaximumCacheSize ()
+      {
+        return (max_cache_size_);
+      }
+
+      /** \brief Set whether to use an internal cache of the pair features, which are computed several times when
+        * the neighborhoods of the query points overlap.
+        * \param[in] use_cache set to true to use the internal cache, false otherwise
+        */
+      inline void
+      setUseInternalCache (bool use_cache)
+      {
+        use_cache_ = use_cache;
+      }
+
+      /** \brief Get whether the internal cache is used or not for computing the PFHRGB features. */
+      inline bool
+      getUseInternalCache ()
+      {
+        return (use_cache_);
+      }
+
+      /** \brief Get the internal cache, e.g. to read its hit and miss counters after \ref compute.
+        * The cache is cleared at the beginning of every \ref compute call.
+        */
+      inline FeatureCachePtr
+      getInternalCache () const
+      {
+        return (feature_cache_);
+      }
+
       bool
       computeRGBPairFeatures (const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals,
                               int p_idx, int q_idx,
@@ -96,6 +144,15 @@ namespace pcl
       /** \brief Float constant = 1.0 / (2.0 * M_PI) */
       float d_pi_;
 
+      /** \brief Internal cache of pair features, used to optimize efficiency of redundant computations. */
+      FeatureCachePtr feature_cache_;
+
+      /** \brief Maximum number of entries of the internal cache. */
+      unsigned int max_cache_size_;
+
+      /** \brief Set to true to use the internal cache for removing redundant computations. */
+      bool use_cache_;
+
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud 
         */
@@ -51,8 +51,7 @@ namespace pcl
     *
     * The recommended PointOutT is pcl::PrincipalCurvatures.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref NormalEstimationOMP for an example on how to extend this to parallel implementations.
+    * \note See \ref PrincipalCurvaturesEstimationOMP for a parallel implementation.
     *
     * \author Radu B. Rusu, Jared Glover
     * \ingroup features
@@ -74,13 +73,7 @@ namespace pcl
       typedef pcl::PointCloud<PointInT> PointCloudIn;
 
       /** \brief Empty constructor. */
-      PrincipalCurvaturesEstimation () : 
-        projected_normals_ (), 
-        xyz_centroid_ (Eigen::Vector3f::Zero ()), 
-        demean_ (Eigen::Vector3f::Zero ()),
-        covariance_matrix_ (Eigen::Matrix3f::Zero ()),
-        eigenvector_ (Eigen::Vector3f::Zero ()),
-        eigenvalues_ (Eigen::Vector3f::Zero ())
+      PrincipalCurvaturesEstimation ()
       {
         feature_name_ = "PrincipalCurvaturesEstimation";
       };
@@ -100,7 +93,7 @@ namespace pcl
       void
       computePointPrincipalCurvatures (const pcl::PointCloud<PointNT> &normals,
                                        int p_idx, const std::vector<int> &indices,
-                                       float &pcx, float &pcy, float &pcz, float &pc1, float &pc2);
+                                       float &pcx, float &pcy, float &pcz, float &pc1, float &pc2) const;
 
     protected:
 
@@ -113,23 +106,6 @@ namespace pcl
       computeFeature (PointCloudOut &output);
 
     private:
-      /** \brief A pointer to the input dataset that contains the point normals of the XYZ dataset. */
-      std::vector<Eigen::Vector3f> projected_normals_;
-
-      /** \brief SSE aligned placeholder for the XYZ centroid of a surface patch. */
-      Eigen::Vector3f xyz_centroid_;
-
-      /** \brief Temporary point placeholder. */
-      Eigen::Vector3f demean_;
-
-      /** \brief Placeholder for the 3x3 covariance matrix at each surface patch. */
-      EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix_;
-
-      /** \brief SSE aligned eigenvectors placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvector_;
-      /** \brief eigenvalues placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvalues_;
-
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud
         */
@@ -140,8 +116,7 @@ namespace pcl
   /** \brief PrincipalCurvaturesEstimation estimates the directions (eigenvectors) and magnitudes (eigenvalues) of
     * principal surface curvatures for a given point cloud dataset containing points and normals.
     *
-    * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref NormalEstimationOMP for an example on how to extend this to parallel implementations.
+    * \note See \ref PrincipalCurvaturesEstimationOMP for a parallel implementation.
     *
     * \author Radu B. Rusu, Jared Glover
     * \ingroup features
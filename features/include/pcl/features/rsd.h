@@ -119,7 +119,7 @@ namespace pcl
     * </li>
     * </ul>
     *
-    * @note The code is stateful as we do not expect this class to be multicore parallelized.
+    * @note See \ref RSDEstimationOMP for a parallel implementation.
     * \author Zoltan-Csaba Marton
     * \ingroup features
     */
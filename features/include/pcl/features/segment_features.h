@@ -0,0 +1,94 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_SEGMENT_FEATURES_H_
+#define PCL_FEATURES_SEGMENT_FEATURES_H_
+
+#include <pcl/features/feature.h>
+#include <pcl/PointIndices.h>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Compute a global descriptor, such as VFH, CVFH, ESF or CRH, for each of a list of segments of a
+    * point cloud, in parallel.
+    *
+    * The estimator is set up once for the whole cloud (input cloud, normals, search method and parameters) and
+    * each thread describes its share of the segments with its own copy of it, giving each segment as the
+    * indices of the estimator. The search method is shared by the threads, so it is built before the segments
+    * are computed. A typical use is to describe all the clusters of a frame at once:
+    * \code
+    * pcl::VFHEstimation<pcl::PointXYZ, pcl::Normal, pcl::VFHSignature308> vfh;
+    * vfh.setInputCloud (cloud);
+    * vfh.setInputNormals (normals);
+    * std::vector<pcl::PointCloud<pcl::VFHSignature308> > signatures;
+    * pcl::computeSegmentFeatures (vfh, cluster_indices, signatures, 4);
+    * \endcode
+    *
+    * \note The estimator must not hold state which depends on the segment, such as the centroid given to
+    * CRHEstimation::setCentroid ().
+    * \param[in] estimator the feature estimator, ready to be given the compute () command
+    * \param[in] segments the indices of the points of each segment in the input cloud of \a estimator
+    * \param[out] outputs the signatures of each segment (several for CVFH)
+    * \param[in] nr_threads the number of threads to use
+    * \ingroup features
+    */
+  template <typename FeatureT> void
+  computeSegmentFeatures (const FeatureT &estimator,
+                          const std::vector<pcl::PointIndices> &segments,
+                          std::vector<typename FeatureT::PointCloudOut> &outputs,
+                          unsigned int nr_threads = 1);
+
+  /** \brief Compute a global descriptor with a single signature per segment, such as VFH, ESF or CRH, for
+    * each of a list of segments of a point cloud, in parallel. See \ref computeSegmentFeatures.
+    * \param[in] estimator the feature estimator, ready to be given the compute () command
+    * \param[in] segments the indices of the points of each segment in the input cloud of \a estimator
+    * \param[out] output the signature of each segment, in the order of the segments. The signature of a
+    * segment which could not be described is left value initialized.
+    * \param[in] nr_threads the number of threads to use
+    * \ingroup features
+    */
+  template <typename FeatureT> void
+  computeSegmentFeatures (const FeatureT &estimator,
+                          const std::vector<pcl::PointIndices> &segments,
+                          typename FeatureT::PointCloudOut &output,
+                          unsigned int nr_threads = 1);
+}
+
+#include <pcl/features/impl/segment_features.hpp>
+
+#endif  //#ifndef PCL_FEATURES_SEGMENT_FEATURES_H_
@@ -44,10 +44,87 @@
 
 namespace pcl
 {
+  /** \brief Quantize the bins of a SHOT signature to 8 bits. The bins are divided by the largest one, returned in
+    * \a scale, so that it maps to 255. A signature with non finite bins gets a zero descriptor and a NaN scale.
+    * \param[in] bins the SHOT signature
+    * \param[in] size the number of bins
+    * \param[out] descriptor the quantized bins
+    * \param[out] scale the value of a quantized bin of 255
+    * \ingroup features
+    */
+  inline void
+  quantizeSHOT (const float *bins, size_t size, std::vector<uint8_t> &descriptor, float &scale)
+  {
+    descriptor.resize (size);
+    scale = 0.0f;
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (!pcl_isfinite (bins[i]))
+      {
+        std::fill (descriptor.begin (), descriptor.end (), static_cast<uint8_t> (0));
+        scale = std::numeric_limits<float>::quiet_NaN ();
+        return;
+      }
+      scale = (std::max) (scale, bins[i]);
+    }
+
+    const float factor = (scale > 0.0f) ? 255.0f / scale : 0.0f;
+    for (size_t i = 0; i < size; ++i)
+      descriptor[i] = static_cast<uint8_t> ((std::max) (bins[i], 0.0f) * factor + 0.5f);
+  }
+
+  /** \brief Quantize a SHOT signature to 8 bits per bin, see \ref quantizeSHOT.
+    * \param[in] shot the SHOT signature
+    * \param[out] quantized the quantized signature, with the same local reference frame
+    * \ingroup features
+    */
+  inline void
+  quantizeSHOT (const pcl::SHOT &shot, pcl::SHOTQuantized &quantized)
+  {
+    quantizeSHOT (shot.descriptor.empty () ? NULL : &shot.descriptor[0], shot.descriptor.size (),
+                  quantized.descriptor, quantized.scale);
+    std::copy (shot.rf, shot.rf + 9, quantized.rf);
+  }
+
+  /** \brief Recover an approximation of a SHOT signature from its quantized version.
+    * \param[in] quantized the quantized signature
+    * \param[out] shot the SHOT signature, with the same local reference frame
+    * \ingroup features
+    */
+  inline void
+  dequantizeSHOT (const pcl::SHOTQuantized &quantized, pcl::SHOT &shot)
+  {
+    shot.descriptor.resize (quantized.descriptor.size ());
+    const float factor = quantized.scale / 255.0f;
+    for (size_t i = 0; i < quantized.descriptor.size (); ++i)
+      shot.descriptor[i] = static_cast<float> (quantized.descriptor[i]) * factor;
+    std::copy (quantized.rf, quantized.rf + 9, shot.rf);
+  }
+
+  /** \brief Copy the bins of a SHOT signature into the descriptor of an output point, which must already hold
+    * shot.size () bins.
+    * \ingroup features
+    */
+  template <typename PointOutT> inline void
+  copySHOTDescriptor (const Eigen::VectorXf &shot, PointOutT &point)
+  {
+    for (int d = 0; d < shot.size (); ++d)
+      point.descriptor[d] = shot[d];
+  }
+
+  /** \brief Quantize the bins of a SHOT signature into the descriptor of a pcl::SHOTQuantized point.
+    * \ingroup features
+    */
+  inline void
+  copySHOTDescriptor (const Eigen::VectorXf &shot, pcl::SHOTQuantized &point)
+  {
+    quantizeSHOT (shot.data (), shot.size (), point.descriptor, point.scale);
+  }
+
   /** \brief SHOTEstimation estimates the Signature of Histograms of OrienTations (SHOT) descriptor for
     * a given point cloud dataset containing points and normals.
     *
-    * The suggested PointOutT is pcl::SHOT.
+    * The suggested PointOutT is pcl::SHOT, or pcl::SHOTQuantized to store the bins on 8 bits.
     *
     * \note If you use this code in any academic work, please cite:
     *
@@ -141,6 +218,20 @@ namespace pcl
                                 const int nr_bins,
                                 Eigen::VectorXf &shot);
 
+      /** \brief Express the neighbors of a point in its local reference frame. The neighbors are projected a
+        * block at a time with packet (SIMD) operations.
+        * \param[in] indices the neighborhood point indices
+        * \param[in] sqr_dists the neighborhood point distances
+        * \param[in] index the index of the point in indices_
+        * \param[out] local_coordinates the x, y and z coordinates of each neighbor in the local reference frame,
+        * followed by its Euclidean distance to the point, one column per neighbor
+        */
+      void
+      computeLocalCoordinates (const std::vector<int> &indices,
+                               const std::vector<float> &sqr_dists,
+                               const int index,
+                               Eigen::Matrix<float, 4, Eigen::Dynamic> &local_coordinates) const;
+
       /** \brief Normalize the SHOT histogram.
         * \param[in,out] shot the SHOT histogram
         * \param[in] desc_length the length of the histogram
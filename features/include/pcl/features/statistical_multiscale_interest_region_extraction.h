@@ -69,7 +69,7 @@ namespace pcl
 
       /** \brief Empty constructor */
       StatisticalMultiscaleInterestRegionExtraction () :
-        scale_values_ (), geodesic_distances_ (), F_scales_ ()
+        scale_values_ (), geodesic_distances_ (), F_scales_ (), threads_ (1)
       {};
 
       /** \brief Method that generates the underlying nearest neighbor graph based on the
@@ -94,6 +94,16 @@ namespace pcl
       inline std::vector<float>
       getScalesVector () { return scale_values_; }
 
+      /** \brief Set the number of threads to use for the statistics and the extrema at each scale
+       * \param nr_threads the number of hardware threads to use (0 sets the value back to 1)
+       */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads to use for the statistics and the extrema at each scale */
+      inline unsigned int
+      getNumberOfThreads () { return threads_; }
+
 
     private:
       /** \brief Checks if all the necessary input was given and the computations can successfully start */
@@ -105,6 +115,12 @@ namespace pcl
                                  float &radius,
                                  std::vector<int> &result_indices);
 
+      /** \brief Get the neighbors of each point within the largest scale, sorted by geodesic distance, so that
+       * the neighbors within a smaller scale are a prefix of them
+       */
+      void
+      sortGeodesicNeighborhoods (std::vector<std::vector<std::pair<float, int> > > &neighborhoods);
+
       void
       computeF ();
 
@@ -116,6 +132,9 @@ namespace pcl
       std::vector<float> scale_values_;
       std::vector<std::vector<float> > geodesic_distances_;
       std::vector<std::vector<float> > F_scales_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
@@ -160,7 +160,7 @@ namespace pcl
         * \param[out] desc descriptor to compute
         */
       void
-      computePointDescriptor (size_t index, std::vector<float> &desc);
+      computePointDescriptor (size_t index, std::vector<float> &desc) const;
 
       /** \brief Initialize computation by allocating all the intervals and the volume lookup table. */
       virtual bool
@@ -374,11 +374,16 @@ void
 Narf::extractForInterestPoints (const RangeImage& range_image, const PointCloud<InterestPoint>& interest_points,
                                 int descriptor_size, float support_size, bool rotation_invariant, std::vector<Narf*>& feature_list)
 {
+  // Collect the features of every interest point separately and append them in order afterwards, so that the
+  // result does not depend on the thread scheduling
+  int no_of_interest_points = static_cast<int> (interest_points.points.size ());
+  std::vector<std::vector<Narf*> > feature_lists (no_of_interest_points);
   # pragma omp parallel for num_threads(max_no_of_threads) default(shared) schedule(dynamic, 10)
   //!!! nizar 20110408 : for OpenMP sake on MSVC this must be kept signed
-  for (int interest_point_idx = 0; interest_point_idx < int (interest_points.points.size ()); ++interest_point_idx)
+  for (int interest_point_idx = 0; interest_point_idx < no_of_interest_points; ++interest_point_idx)
   {
     Vector3fMapConst point = interest_points.points[interest_point_idx].getVector3fMap ();
+    std::vector<Narf*>& point_feature_list = feature_lists[interest_point_idx];
     
     Narf* feature = new Narf;
     if (!feature->extractFromRangeImage(range_image, point, descriptor_size, support_size))
@@ -388,10 +393,7 @@ Narf::extractForInterestPoints (const RangeImage& range_image, const PointCloud<
     else {
       if (!rotation_invariant)
       {
-#       pragma omp critical
-        {
-          feature_list.push_back(feature);
-        }
+        point_feature_list.push_back(feature);
       }
       else {
         vector<float> rotations, strengths;
@@ -409,16 +411,15 @@ Narf::extractForInterestPoints (const RangeImage& range_image, const PointCloud<
               delete feature2;
               continue;
             }
-#           pragma omp critical
-            {
-              feature_list.push_back(feature2);
-            }
+            point_feature_list.push_back(feature2);
           }
         }
         delete feature;
       }
     }
   }
+  for (size_t i = 0; i < feature_lists.size (); ++i)
+    feature_list.insert (feature_list.end (), feature_lists[i].begin (), feature_lists[i].end ());
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -93,28 +93,40 @@ NarfDescriptor::computeFeature(NarfDescriptor::PointCloudOut& output)
     output.points.clear ();
     return;
   }
-  std::vector<Narf*> feature_list;
+  // Every query point (or every image row) collects its features in its own list, so that the threads do not
+  // have to synchronize and the output has the same order as in the single threaded case
+  int width = range_image_->width;
+  std::vector<std::vector<Narf*> > feature_lists;
   if (indices_)
   {
-    for (size_t indices_idx=0; indices_idx<indices_->size(); ++indices_idx)
+    int no_of_indices = static_cast<int> (indices_->size ());
+    feature_lists.resize (no_of_indices);
+#   pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
+    for (int indices_idx=0; indices_idx<no_of_indices; ++indices_idx)
     {
       int point_index = (*indices_)[indices_idx];
-      int y=point_index/range_image_->width, x=point_index - y*range_image_->width;
+      int y=point_index/width, x=point_index - y*width;
       Narf::extractFromRangeImageAndAddToList(*range_image_, static_cast<float> (x), static_cast<float> (y), 36, parameters_.support_size,
-                                              parameters_.rotation_invariant, feature_list);
+                                              parameters_.rotation_invariant, feature_lists[indices_idx]);
     }
   }
   else
   {
-    for (unsigned int y=0; y<range_image_->height; ++y)
+    int height = range_image_->height;
+    feature_lists.resize (height);
+#   pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 1)
+    for (int y=0; y<height; ++y)
     {
-      for (unsigned int x=0; x<range_image_->width; ++x)
+      for (int x=0; x<width; ++x)
       {
         Narf::extractFromRangeImageAndAddToList(*range_image_, static_cast<float> (x), static_cast<float> (y), 36, parameters_.support_size,
-                                                parameters_.rotation_invariant, feature_list);
+                                                parameters_.rotation_invariant, feature_lists[y]);
       }
     }
   }
+  std::vector<Narf*> feature_list;
+  for (size_t i=0; i<feature_lists.size(); ++i)
+    feature_list.insert (feature_list.end (), feature_lists[i].begin (), feature_lists[i].end ());
   
   // Copy to NARF36 struct
   output.points.resize(feature_list.size());
@@ -39,6 +39,7 @@ using std::cout;
 using std::cerr;
 #include <map>
 #include <set>
+#include <algorithm>
 #include <cmath>
 #include <Eigen/Geometry>
 #include <pcl/pcl_macros.h>
@@ -192,11 +193,16 @@ RangeImageBorderExtractor::extractBorderScoreImages ()
 float* 
 RangeImageBorderExtractor::updatedScoresAccordingToNeighborValues (const float* border_scores) const
 {
-  float* new_scores = new float[range_image_->width*range_image_->height];
-  float* new_scores_ptr = new_scores;
-  for (int y=0; y < static_cast<int> (range_image_->height); ++y) 
-    for (int x=0; x < static_cast<int> (range_image_->width); ++x) 
+  int width  = range_image_->width,
+      height = range_image_->height;
+  float* new_scores = new float[width*height];
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
+  for (int y=0; y < height; ++y) 
+  {
+    float* new_scores_ptr = new_scores + y*width;
+    for (int x=0; x < width; ++x) 
       *(new_scores_ptr++) = updatedScoreAccordingToNeighborValues(x, y, border_scores);
+  }
   return (new_scores);
 }
 
@@ -238,10 +244,21 @@ RangeImageBorderExtractor::findAndEvaluateShadowBorders ()
   
   int width  = range_image_->width,
       height = range_image_->height;
-  shadow_border_informations_ = new ShadowBorderIndices*[width*height];
-  for (int y = 0; y < static_cast<int> (height); ++y) 
+  int size = width*height;
+  shadow_border_informations_ = new ShadowBorderIndices*[size];
+  
+  // The left/right checks only look at pixels in the same row, but the top/bottom checks read the opposite
+  // direction's scores in other rows, which may be rescaled concurrently. Only negative scores can become a
+  // shadow border and those are never changed here, so reading from a copy gives the same result.
+  float* border_scores_top_copy    = new float[size];
+  float* border_scores_bottom_copy = new float[size];
+  std::copy (border_scores_top_, border_scores_top_+size, border_scores_top_copy);
+  std::copy (border_scores_bottom_, border_scores_bottom_+size, border_scores_bottom_copy);
+  
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
+  for (int y = 0; y < height; ++y) 
   {
-    for (int x = 0; x < static_cast<int> (width); ++x) 
+    for (int x = 0; x < width; ++x) 
     {
       int index = y*width+x;
       ShadowBorderIndices*& shadow_border_indices = shadow_border_informations_[index];
@@ -258,18 +275,21 @@ RangeImageBorderExtractor::findAndEvaluateShadowBorders ()
         shadow_border_indices = (shadow_border_indices==NULL ? new ShadowBorderIndices : shadow_border_indices);
         shadow_border_indices->right = shadow_border_idx;
       }
-      if (changeScoreAccordingToShadowBorderValue(x, y, 0, -1, border_scores_top_, border_scores_bottom_, shadow_border_idx))
+      if (changeScoreAccordingToShadowBorderValue(x, y, 0, -1, border_scores_top_, border_scores_bottom_copy, shadow_border_idx))
       {
         shadow_border_indices = (shadow_border_indices==NULL ? new ShadowBorderIndices : shadow_border_indices);
         shadow_border_indices->top = shadow_border_idx;
       }
-      if (changeScoreAccordingToShadowBorderValue(x, y, 0, 1, border_scores_bottom_, border_scores_top_, shadow_border_idx))
+      if (changeScoreAccordingToShadowBorderValue(x, y, 0, 1, border_scores_bottom_, border_scores_top_copy, shadow_border_idx))
       {
         shadow_border_indices = (shadow_border_indices==NULL ? new ShadowBorderIndices : shadow_border_indices);
         shadow_border_indices->bottom = shadow_border_idx;
       }
     }
   }
+  
+  delete[] border_scores_top_copy;
+  delete[] border_scores_bottom_copy;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -283,6 +303,7 @@ RangeImageBorderExtractor::getAnglesImageForBorderDirections ()
       array_size = width*height;
   float* angles_image = new float[array_size];
   
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -320,6 +341,7 @@ RangeImageBorderExtractor::getAnglesImageForSurfaceChangeDirections ()
       array_size = width*height;
   float* angles_image = new float[array_size];
   
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -380,9 +402,13 @@ RangeImageBorderExtractor::classifyBorders ()
   border_descriptions_->is_dense = true;
   border_descriptions_->points.resize(size, initial_border_description);
   
-  for (int y = 0; y < static_cast<int> (height); ++y) 
+  // Left/right borders only mark pixels in their own row, top/bottom borders only pixels in their own column.
+  // So the rows are handled in parallel first and then the columns, in tiles of neighboring columns to keep the
+  // memory accesses local. The traits are only ever set, so the result does not depend on the order.
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
+  for (int y = 0; y < height; ++y) 
   {
-    for (int x = 0; x < static_cast<int> (width); ++x) 
+    for (int x = 0; x < width; ++x) 
     {
       int index = y*width+x;
       BorderDescription& border_description = border_descriptions_->points[index];
@@ -419,39 +445,52 @@ RangeImageBorderExtractor::classifyBorders ()
           veil_point[BORDER_TRAIT__VEIL_POINT] = veil_point[BORDER_TRAIT__VEIL_POINT_LEFT] = true;
         }
       }
-      
-      shadow_border_index = shadow_border_indices->top;
-      if (shadow_border_index >= 0 && checkIfMaximum(x, y, 0, -1, border_scores_top_, shadow_border_index))
+    }
+  }
+  
+  const int tile_width = 16;
+  int no_of_tiles = (width+tile_width-1) / tile_width;
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
+  for (int tile_idx = 0; tile_idx < no_of_tiles; ++tile_idx) 
+  {
+    int tile_x_min = tile_idx*tile_width,
+        tile_x_max = (std::min) (tile_x_min+tile_width, width);
+    for (int y = 0; y < height; ++y) 
+    {
+      for (int x = tile_x_min; x < tile_x_max; ++x) 
       {
-        BorderTraits& shadow_traits = border_descriptions_->points[shadow_border_index].traits;
-        border_traits[BORDER_TRAIT__OBSTACLE_BORDER] = border_traits[BORDER_TRAIT__OBSTACLE_BORDER_TOP] = true;
-        shadow_traits[BORDER_TRAIT__SHADOW_BORDER] = shadow_traits[BORDER_TRAIT__SHADOW_BORDER_BOTTOM] = true;
-        for (int index3=index-width; index3>shadow_border_index; index3-=width)
+        int index = y*width+x;
+        ShadowBorderIndices* shadow_border_indices = shadow_border_informations_[index];
+        if (shadow_border_indices == NULL)
+          continue;
+        BorderTraits& border_traits = border_descriptions_->points[index].traits;
+        
+        int shadow_border_index = shadow_border_indices->top;
+        if (shadow_border_index >= 0 && checkIfMaximum(x, y, 0, -1, border_scores_top_, shadow_border_index))
         {
-          //cout << "Adding veil point at "<<(index3-index)%width<<","<<(index3-index)/width<<".\n";
-          BorderTraits& veil_point = border_descriptions_->points[index3].traits;
-          veil_point[BORDER_TRAIT__VEIL_POINT] = veil_point[BORDER_TRAIT__VEIL_POINT_BOTTOM] = true;
+          BorderTraits& shadow_traits = border_descriptions_->points[shadow_border_index].traits;
+          border_traits[BORDER_TRAIT__OBSTACLE_BORDER] = border_traits[BORDER_TRAIT__OBSTACLE_BORDER_TOP] = true;
+          shadow_traits[BORDER_TRAIT__SHADOW_BORDER] = shadow_traits[BORDER_TRAIT__SHADOW_BORDER_BOTTOM] = true;
+          for (int index3=index-width; index3>shadow_border_index; index3-=width)
+          {
+            BorderTraits& veil_point = border_descriptions_->points[index3].traits;
+            veil_point[BORDER_TRAIT__VEIL_POINT] = veil_point[BORDER_TRAIT__VEIL_POINT_BOTTOM] = true;
+          }
         }
-      }
-      
-      shadow_border_index = shadow_border_indices->bottom;
-      if (shadow_border_index >= 0 && checkIfMaximum(x, y, 0, 1, border_scores_bottom_, shadow_border_index))
-      {
-        BorderTraits& shadow_traits = border_descriptions_->points[shadow_border_index].traits;
-        border_traits[BORDER_TRAIT__OBSTACLE_BORDER] = border_traits[BORDER_TRAIT__OBSTACLE_BORDER_BOTTOM] = true;
-        shadow_traits[BORDER_TRAIT__SHADOW_BORDER] = shadow_traits[BORDER_TRAIT__SHADOW_BORDER_TOP] = true;
-        for (int index3=index+width; index3<shadow_border_index; index3+=width)
+        
+        shadow_border_index = shadow_border_indices->bottom;
+        if (shadow_border_index >= 0 && checkIfMaximum(x, y, 0, 1, border_scores_bottom_, shadow_border_index))
         {
-          //cout << "Adding veil point at "<<(index3-index)%width<<","<<(index3-index)/width<<".\n";
-          BorderTraits& veil_point = border_descriptions_->points[index3].traits;
-          veil_point[BORDER_TRAIT__VEIL_POINT] = veil_point[BORDER_TRAIT__VEIL_POINT_TOP] = true;
+          BorderTraits& shadow_traits = border_descriptions_->points[shadow_border_index].traits;
+          border_traits[BORDER_TRAIT__OBSTACLE_BORDER] = border_traits[BORDER_TRAIT__OBSTACLE_BORDER_BOTTOM] = true;
+          shadow_traits[BORDER_TRAIT__SHADOW_BORDER] = shadow_traits[BORDER_TRAIT__SHADOW_BORDER_TOP] = true;
+          for (int index3=index+width; index3<shadow_border_index; index3+=width)
+          {
+            BorderTraits& veil_point = border_descriptions_->points[index3].traits;
+            veil_point[BORDER_TRAIT__VEIL_POINT] = veil_point[BORDER_TRAIT__VEIL_POINT_TOP] = true;
+          }
         }
       }
-      
-      //if (border_traits[BORDER_TRAIT__OBSTACLE_BORDER])
-      //{
-        //border_points.push_back(&border_description);
-      //}
     }
   }
 }
@@ -470,6 +509,7 @@ RangeImageBorderExtractor::calculateBorderDirections ()
       height = range_image_->height,
       size   = width*height;
   border_directions_ = new Eigen::Vector3f*[size];
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -482,6 +522,7 @@ RangeImageBorderExtractor::calculateBorderDirections ()
   int radius = parameters_.pixel_radius_border_direction;
   int minimum_weight = radius+1;
   float min_cos_angle=cosf(deg2rad(120.0f));
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
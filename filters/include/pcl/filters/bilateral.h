@@ -44,6 +44,12 @@
 namespace pcl
 {
   /** \brief A bilateral filter implementation for point cloud data. Uses the intensity data channel.
+    *
+    * By default the filter averages the intensities of the neighbors found with a radius search around every
+    * point. With \a setApproximate, the intensities are instead splatted onto a sparse bilateral grid (sampled at
+    * \a sigma_s in space and \a sigma_r in intensity), blurred, and interpolated back at the points, which takes
+    * linear time in the number of points whatever the window size. For organized clouds, the approximate filter
+    * can also smooth the depth of the points (see \a setFilterDepth).
     * \note For more information please see 
     * <b>C. Tomasi and R. Manduchi. Bilateral Filtering for Gray and Color Images.
     * In Proceedings of the IEEE International Conference on Computer Vision,
@@ -65,7 +71,10 @@ namespace pcl
         */
       BilateralFilter () : sigma_s_ (0), 
                            sigma_r_ (std::numeric_limits<double>::max ()),
-                           tree_ ()
+                           tree_ (),
+                           approximate_ (false),
+                           filter_depth_ (false),
+                           threads_ (1)
       {
       }
 
@@ -126,7 +135,59 @@ namespace pcl
         tree_ = tree;
       }
 
+      /** \brief Set whether to use the (linear time) bilateral grid approximation instead of the exact filter.
+        * \param[in] approximate true to use the bilateral grid, false (default) for the exact filter
+        */
+      inline void
+      setApproximate (bool approximate)
+      {
+        approximate_ = approximate;
+      }
+
+      /** \brief Get whether the bilateral grid approximation is used. */
+      inline bool
+      getApproximate () const
+      {
+        return (approximate_);
+      }
+
+      /** \brief Set whether the approximate filter also smooths the depth of the points of organized clouds. The
+        * depth is measured along the viewing direction given by the sensor_origin_ and sensor_orientation_ of the
+        * cloud, and the points are moved along their ray from the sensor origin, so that they stay in their pixel.
+        * Unorganized clouds only get their intensity smoothed.
+        * \param[in] filter_depth true to smooth the depth as well, false (default) to smooth the intensity only
+        */
+      inline void
+      setFilterDepth (bool filter_depth)
+      {
+        filter_depth_ = filter_depth;
+      }
+
+      /** \brief Get whether the approximate filter also smooths the depth of the points of organized clouds. */
+      inline bool
+      getFilterDepth () const
+      {
+        return (filter_depth_);
+      }
+
+      /** \brief Set the number of threads used to filter the points. The output is the same for any number of
+        * threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to filter the points. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     private:
+      /** \brief Filter the input data with the bilateral grid approximation.
+        * \param[out] output the resultant point cloud message
+        * \return false if the grid would be too large for the extents of the data
+        */
+      bool
+      applyApproximateFilter (PointCloud &output);
 
       /** \brief The bilateral filter Gaussian distance kernel.
         * \param[in] x the spatial distance (distance or intensity)
@@ -145,6 +206,15 @@ namespace pcl
 
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
+
+      /** \brief Whether to use the bilateral grid approximation. */
+      bool approximate_;
+
+      /** \brief Whether the approximate filter smooths the depth of organized clouds as well. */
+      bool filter_depth_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
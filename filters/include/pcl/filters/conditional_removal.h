@@ -54,6 +54,64 @@ namespace pcl
     } CompareOp;
   }
 
+  template<typename PointT> class ComparisonBase;
+  template<typename PointT> class ConditionBase;
+
+  namespace detail
+  {
+    //////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief One instruction of a compiled condition. A condition tree is compiled into a
+      * postfix program: every comparison pushes a mask with its result for a block of points,
+      * and AND/OR instructions replace the top \a nr_operands masks with their combination.
+      */
+    template<typename PointT>
+    struct ConditionInstruction
+    {
+      typedef enum
+      {
+        CONSTANT_TRUE,          // push a mask of true values
+        FIELD,                  // compare the field of type \a datatype at \a offset with \a value
+        EVALUATE_COMPARISON,    // call comparison->evaluate () for every point
+        EVALUATE_CONDITION,     // call condition->evaluate () for every point
+        AND,
+        OR
+      } Kind;
+
+      ConditionInstruction (Kind kind = CONSTANT_TRUE) :
+        kind (kind), datatype (0), offset (0), compare_in_double (false), op (ComparisonOps::EQ),
+        value (0.0), nr_operands (0), comparison (NULL), condition (NULL)
+      {
+      }
+
+      /** \brief The kind of the instruction. */
+      Kind kind;
+
+      /** \brief The sensor_msgs::PointField type of the compared field. */
+      uint8_t datatype;
+
+      /** \brief The byte offset of the compared field in the point. */
+      uint32_t offset;
+
+      /** \brief Compare the field value with \a value as a double, instead of casting \a value to the field type. */
+      bool compare_in_double;
+
+      /** \brief The comparison operator. */
+      ComparisonOps::CompareOp op;
+
+      /** \brief The value the field is compared to. */
+      double value;
+
+      /** \brief The number of masks an AND/OR instruction combines. */
+      int nr_operands;
+
+      /** \brief The comparison evaluated by an EVALUATE_COMPARISON instruction. */
+      const ComparisonBase<PointT> *comparison;
+
+      /** \brief The condition evaluated by an EVALUATE_CONDITION instruction. */
+      const ConditionBase<PointT> *condition;
+    };
+  }
+
   //////////////////////////////////////////////////////////////////////////////////////////
   /** \brief A datatype that enables type-correct comparisons. */
   template<typename PointT>
@@ -72,6 +130,14 @@ namespace pcl
         */
       int
       compare (const PointT& p, const double& val);
+
+      /** \brief Get the sensor_msgs::PointField type of the data. */
+      inline uint8_t
+      getDatatype () const { return (datatype_); }
+
+      /** \brief Get the byte offset of the data in the point. */
+      inline uint32_t
+      getOffset () const { return (offset_); }
     protected:
       /** \brief The type of data. */
       uint8_t datatype_;
@@ -108,6 +174,14 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const = 0;
 
+      /** \brief Append the instructions that evaluate this comparison to a compiled condition.
+        * The default implementation calls \a evaluate for every point, so comparisons that do not
+        * override it must be safe to evaluate from several threads at once.
+        * \param[in,out] program the compiled condition to append to
+        */
+      virtual void
+      compile (std::vector<detail::ConditionInstruction<PointT> > &program) const;
+
     protected:
       /** \brief True if capable. */
       bool capable_;
@@ -171,6 +245,12 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const;
 
+      /** \brief Append a typed comparison of the field to a compiled condition.
+        * \param[in,out] program the compiled condition to append to
+        */
+      virtual void
+      compile (std::vector<detail::ConditionInstruction<PointT> > &program) const;
+
     protected:
       /** \brief All types (that we care about) can be represented as a double. */
       double compare_val_;
@@ -211,6 +291,12 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const;
 
+      /** \brief Append a comparison of the color component to a compiled condition.
+        * \param[in,out] program the compiled condition to append to
+        */
+      virtual void
+      compile (std::vector<detail::ConditionInstruction<PointT> > &program) const;
+
     protected:
       /** \brief The name of the component. */
       std::string component_name_;
@@ -473,6 +559,13 @@ namespace pcl
       virtual bool
       evaluate (const PointT &point) const = 0;
 
+      /** \brief Append the instructions that evaluate this condition to a compiled condition.
+        * The default implementation calls \a evaluate for every point.
+        * \param[in,out] program the compiled condition to append to
+        */
+      virtual void
+      compile (std::vector<detail::ConditionInstruction<PointT> > &program) const;
+
     protected:
       /** \brief True if capable. */
       bool capable_;
@@ -510,6 +603,12 @@ namespace pcl
         */
       virtual bool
       evaluate (const PointT &point) const;
+
+      /** \brief Append the comparisons and nested conditions, followed by their AND, to a compiled condition.
+        * \param[in,out] program the compiled condition to append to
+        */
+      virtual void
+      compile (std::vector<detail::ConditionInstruction<PointT> > &program) const;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////
@@ -538,6 +637,12 @@ namespace pcl
         */
       virtual bool
       evaluate (const PointT &point) const;
+
+      /** \brief Append the comparisons and nested conditions, followed by their OR, to a compiled condition.
+        * \param[in,out] program the compiled condition to append to
+        */
+      virtual void
+      compile (std::vector<detail::ConditionInstruction<PointT> > &program) const;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////
@@ -558,6 +663,11 @@ namespace pcl
     * to a PointCloud field name, or a color component in rgb color space or
     * hsi color space.
     *
+    * Before filtering, the condition tree is compiled into a flat program of
+    * typed field comparisons, which is evaluated on blocks of points (in
+    * parallel, see \a setNumberOfThreads) instead of walking the tree with
+    * virtual calls for every point.
+    *
     * Here is an example usage:
     *  // Build the condition
     *  pcl::ConditionAnd<PointT>::Ptr range_cond (new pcl::ConditionAnd<PointT> ());
@@ -598,7 +708,7 @@ namespace pcl
         */
       ConditionalRemoval (int extract_removed_indices = false) :
         Filter<PointT>::Filter (extract_removed_indices), capable_ (false), keep_organized_ (false), condition_ (),
-        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ())
+        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ()), threads_ (1)
       {
         filter_name_ = "ConditionalRemoval";
       }
@@ -610,7 +720,7 @@ namespace pcl
         */
       ConditionalRemoval (ConditionBasePtr condition, bool extract_removed_indices = false) :
         Filter<PointT>::Filter (extract_removed_indices), capable_ (false), keep_organized_ (false), condition_ (),
-        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ())
+        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ()), threads_ (1)
       {
         filter_name_ = "ConditionalRemoval";
         setCondition (condition);
@@ -656,6 +766,17 @@ namespace pcl
       void
       setCondition (ConditionBasePtr condition);
 
+      /** \brief Set the number of threads used to evaluate the condition. The output is the same for any number
+        * of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to evaluate the condition. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief Filter a Point Cloud.
         * \param output the resultant point cloud message
@@ -663,6 +784,14 @@ namespace pcl
       void
       applyFilter (PointCloud &output);
 
+      /** \brief Evaluate the compiled condition on a set of input points.
+        * \param[in] indices the indices of the points to evaluate, or NULL for the points [0, nr_points)
+        * \param[in] nr_points the number of points to evaluate
+        * \param[out] passed passed[i] is true if the i-th point meets the condition
+        */
+      void
+      evaluateCondition (const int *indices, size_t nr_points, std::vector<char> &passed) const;
+
       typedef typename pcl::traits::fieldList<PointT>::type FieldList;
 
       /** \brief True if capable. */
@@ -680,6 +809,9 @@ namespace pcl
         * the correct field type. 
         */
       float user_filter_value_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
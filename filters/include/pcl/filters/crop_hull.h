@@ -66,7 +66,10 @@ namespace pcl
         hull_polygons_(),
         hull_cloud_(),
         dim_(3),
-        crop_outside_(true)
+        crop_outside_(true),
+        threads_(1),
+        bvh_nodes_(),
+        bvh_polygons_()
       {
         filter_name_ = "CropHull";
       }
@@ -127,6 +130,17 @@ namespace pcl
         crop_outside_ = crop_outside;
       }
 
+      /** \brief Set the number of threads used to classify the points. The output is the same for any number of
+        * threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to classify the points. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief Filter the input points using the 2D or 3D polygon hull.
         * \param[out] output The set of points that passed the filter
@@ -141,6 +155,18 @@ namespace pcl
       applyFilter (std::vector<int> &indices);
 
     private:  
+      /** \brief A node of the bounding volume hierarchy over the hull polygons. Leaves hold the polygons
+        * bvh_polygons_[first, first + count), inner nodes (count == 0) have their left child right after them
+        * and their right child at index \a first.
+        */
+      struct BVHNode
+      {
+        Eigen::Vector3f min_pt;
+        Eigen::Vector3f max_pt;
+        int first;
+        int count;
+      };
+
       /** \brief Return the size of the hull point cloud in line with coordinate axes.
         * This is used to choose the 2D projection to use when cropping to a 2d
         * polygon.
@@ -189,6 +215,33 @@ namespace pcl
       void
       applyFilter3D (std::vector<int> &indices);
 
+      /** \brief Decide for every input point whether it passes the 2D polygon filter, in parallel.
+        * \param[out] keep keep[i] is true if the point (*indices_)[i] passes the filter
+        */
+      template<unsigned PlaneDim1, unsigned PlaneDim2> void
+      classifyPoints2D (std::vector<char> &keep) const;
+
+      /** \brief Decide for every input point whether it passes the 3D polygon hull filter, in parallel. The
+        * rays are only tested against the polygons whose bounding box they pass through, found with a
+        * bounding volume hierarchy over the hull, which gives the same crossing counts as testing all the
+        * polygons.
+        * \param[out] keep keep[i] is true if the point (*indices_)[i] passes the filter
+        */
+      void
+      classifyPoints3D (std::vector<char> &keep);
+
+      /** \brief Build the bounding volume hierarchy over the (triangular) hull polygons. */
+      void
+      buildBVH ();
+
+      /** \brief Count the hull polygons crossed by a ray, using the bounding volume hierarchy.
+        * \param[in] point Point from which the ray is cast.
+        * \param[in] ray   Vector in direction of ray.
+        * \param[in] tolerance Amount by which the bounding boxes are grown, to cover rounding errors.
+        */
+      size_t
+      countRayCrossings (const PointT& point, const Eigen::Vector3f& ray, float tolerance) const;
+
       /** \brief Test an individual point against a 2D polygon.
         * PlaneDim1 and PlaneDim2 specify the x/y/z coordinate axes to use.
         * \param[in] point Point to test against the polygon.
@@ -228,6 +281,15 @@ namespace pcl
        * false, those inside will be removed.
        */
       bool crop_outside_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief The nodes of the bounding volume hierarchy over the hull polygons, root first. */
+      std::vector<BVHNode> bvh_nodes_;
+
+      /** \brief The indices of the hull polygons, in the order of the bounding volume hierarchy leaves. */
+      std::vector<int> bvh_polygons_;
   };
 
 } // namespace pcl
@@ -0,0 +1,207 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_FILTER_CHAIN_H_
+#define PCL_FILTERS_FILTER_CHAIN_H_
+
+#include <pcl/filters/filter_indices.h>
+#include <boost/function.hpp>
+
+namespace pcl
+{
+  /** \brief @b FilterChain applies a sequence of filters to a point cloud, without copying the points that pass
+    * one stage before running the next one.
+    *
+    * There are three kinds of stages:
+    *  - \a FilterIndices stages (PassThrough, CropBox, CropHull, ...), added with \a addFilterIndices. Each one is
+    *    given the indices of the points that passed the previous stages through \a setIndices, and returns the
+    *    indices of the points that pass it.
+    *  - predicates, added with \a addPredicate. Consecutive predicates are evaluated together in a single
+    *    (parallel) pass over the remaining points.
+    *  - filters that create a new point cloud (VoxelGrid, StatisticalOutlierRemoval, ...), added with
+    *    \a addFilter. Their output becomes the input of the next stage.
+    *
+    * Only the final point cloud is materialized, in addition to the output of the \a addFilter stages. The
+    * result is the same as applying the stages one after the other, each one to the output cloud of the
+    * previous one.
+    *
+    * Here is an example usage:
+    *  boost::shared_ptr<pcl::PassThrough<PointT> > pass (new pcl::PassThrough<PointT>);
+    *  pass->setFilterFieldName ("z");
+    *  pass->setFilterLimits (0.0, 3.0);
+    *  boost::shared_ptr<pcl::VoxelGrid<PointT> > grid (new pcl::VoxelGrid<PointT>);
+    *  grid->setLeafSize (0.01f, 0.01f, 0.01f);
+    *  boost::shared_ptr<pcl::StatisticalOutlierRemoval<PointT> > sor (new pcl::StatisticalOutlierRemoval<PointT>);
+    *  sor->setMeanK (8);
+    *  sor->setStddevMulThresh (1.0);
+    *
+    *  pcl::FilterChain<PointT> chain;
+    *  chain.addFilterIndices (pass);
+    *  chain.addFilter (grid, true);
+    *  chain.addFilter (sor);
+    *  chain.setInputCloud (cloud);
+    *  chain.filter (cloud_filtered);
+    *
+    * \ingroup filters
+    */
+  template<typename PointT>
+  class FilterChain : public Filter<PointT>
+  {
+    using Filter<PointT>::input_;
+    using Filter<PointT>::indices_;
+    using Filter<PointT>::filter_name_;
+    using Filter<PointT>::getClassName;
+
+    typedef typename Filter<PointT>::PointCloud PointCloud;
+    typedef typename PointCloud::Ptr PointCloudPtr;
+    typedef typename PointCloud::ConstPtr PointCloudConstPtr;
+
+    public:
+      typedef boost::shared_ptr<FilterChain<PointT> > Ptr;
+      typedef boost::shared_ptr<const FilterChain<PointT> > ConstPtr;
+
+      typedef typename Filter<PointT>::Ptr FilterPtr;
+      typedef boost::shared_ptr<FilterIndices<PointT> > FilterIndicesPtr;
+
+      /** \brief A predicate that decides whether a point passes. It has to be safe to call from several threads
+        * at once.
+        */
+      typedef boost::function<bool (const PointT &)> Predicate;
+
+      /** \brief Empty constructor. */
+      FilterChain () : stages_ (), threads_ (1)
+      {
+        filter_name_ = "FilterChain";
+      }
+
+      /** \brief Append a filter that selects points to the chain.
+        * \param[in] filter the filter, which is given the input cloud and the indices of the points that passed
+        * the previous stages
+        */
+      void
+      addFilterIndices (const FilterIndicesPtr &filter);
+
+      /** \brief Append a predicate to the chain.
+        * \param[in] predicate the predicate that the points have to meet to pass
+        */
+      void
+      addPredicate (const Predicate &predicate);
+
+      /** \brief Append a filter that creates a new point cloud to the chain.
+        * \param[in] filter the filter
+        * \param[in] restrict_to_indices if true, the filter is given the input cloud and the indices of the points
+        * that passed the previous stages through setIndices, without copying them. This is only correct for filters
+        * whose output depends on the indexed points alone, like VoxelGrid. If false (default), the points that
+        * passed the previous stages are copied into a new cloud for the filter, as filters that look at the
+        * neighbors of a point (e.g. StatisticalOutlierRemoval) would otherwise see the removed points too.
+        */
+      void
+      addFilter (const FilterPtr &filter, bool restrict_to_indices = false);
+
+      /** \brief Remove all the stages. */
+      inline void
+      clear () { stages_.clear (); }
+
+      /** \brief Get the number of stages in the chain. */
+      inline size_t
+      size () const { return (stages_.size ()); }
+
+      /** \brief Set the number of threads used to evaluate the predicates. The output is the same for any number
+        * of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to evaluate the predicates. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+    protected:
+      /** \brief A stage of the chain. */
+      struct Stage
+      {
+        typedef enum
+        {
+          INDICES,
+          PREDICATE,
+          CLOUD
+        } Kind;
+
+        Stage (Kind kind) : kind (kind), filter_indices (), filter (), restrict_to_indices (false), predicate () {}
+
+        /** \brief The kind of the stage. */
+        Kind kind;
+
+        /** \brief The filter of an INDICES stage. */
+        FilterIndicesPtr filter_indices;
+
+        /** \brief The filter of a CLOUD stage. */
+        FilterPtr filter;
+
+        /** \brief Whether the filter of a CLOUD stage is given the indices of the points instead of a copy. */
+        bool restrict_to_indices;
+
+        /** \brief The predicate of a PREDICATE stage. */
+        Predicate predicate;
+      };
+
+      /** \brief Apply all the stages to the input points.
+        * \param[out] output the resultant filtered point cloud
+        */
+      void
+      applyFilter (PointCloud &output);
+
+      /** \brief Keep the points that meet the predicates of the stages [first_stage, last_stage), in parallel.
+        * \param[in] cloud the point cloud
+        * \param[in,out] indices the indices of the points to test, in order; the indices of the points that pass
+        * are kept, in the same order
+        * \param[in] first_stage the first predicate stage
+        * \param[in] last_stage one past the last predicate stage
+        */
+      void
+      applyPredicates (const PointCloud &cloud, std::vector<int> &indices, size_t first_stage, size_t last_stage) const;
+
+      /** \brief The stages of the chain, in order. */
+      std::vector<Stage> stages_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+  };
+}
+
+#endif  // PCL_FILTERS_FILTER_CHAIN_H_
@@ -39,6 +39,7 @@
 #define PCL_FILTERS_BILATERAL_IMPL_H_
 
 #include <pcl/filters/bilateral.h>
+#include <boost/unordered_map.hpp>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> double
@@ -76,6 +77,14 @@ pcl::BilateralFilter<PointT>::applyFilter (PointCloud &output)
     PCL_ERROR ("[pcl::BilateralFilter::applyFilter] Need a sigma_s value given before continuing.\n");
     return;
   }
+
+  if (approximate_)
+  {
+    if (applyApproximateFilter (output))
+      return;
+    PCL_WARN ("[pcl::BilateralFilter::applyFilter] The data is too large for the bilateral grid, using the exact filter.\n");
+  }
+
   // In case a search method has not been given, initialize it using some defaults
   if (!tree_)
   {
@@ -88,21 +97,209 @@ pcl::BilateralFilter<PointT>::applyFilter (PointCloud &output)
   }
   tree_->setInputCloud (input_);
 
-  std::vector<int> k_indices;
-  std::vector<float> k_distances;
-
   // Copy the input data into the output
   output = *input_;
 
   // For all the indices given (equal to the entire cloud if none given)
-  for (size_t i = 0; i < indices_->size (); ++i)
+  const int nr_indices = static_cast<int> (indices_->size ());
+#pragma omp parallel num_threads (threads_)
+  {
+    std::vector<int> k_indices;
+    std::vector<float> k_distances;
+
+#pragma omp for schedule (dynamic, 256)
+    for (int i = 0; i < nr_indices; ++i)
+    {
+      // Perform a radius search to find the nearest neighbors
+      tree_->radiusSearch ((*indices_)[i], sigma_s_ * 2, k_indices, k_distances);
+
+      // Overwrite the intensity value with the computed average
+      output.points[(*indices_)[i]].intensity = static_cast<float> (computePointWeight ((*indices_)[i], k_indices, k_distances));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::BilateralFilter<PointT>::applyApproximateFilter (PointCloud &output)
+{
+  // The vertices of the grid are packed in 64 bit keys, 16 bits per dimension (x, y, z, intensity)
+  const int max_cells = 0xFFFF - 2;
+  const int nr_points = static_cast<int> (input_->points.size ());
+  const bool filter_depth = filter_depth_ && input_->isOrganized ();
+  if (filter_depth_ && !filter_depth)
+    PCL_WARN ("[pcl::BilateralFilter::applyApproximateFilter] The depth can only be filtered for organized clouds, smoothing the intensity only.\n");
+  // The values accumulated at every vertex: the weight, the weighted intensity and the weighted depth
+  const int nr_values = filter_depth ? 3 : 2;
+
+  // The depth is measured along the viewing direction of the sensor, from its origin
+  const Eigen::Vector3f sensor_origin = input_->sensor_origin_.template head<3> ();
+  const Eigen::Vector3f view_axis = input_->sensor_orientation_ * Eigen::Vector3f::UnitZ ();
+  std::vector<float> depths (filter_depth ? nr_points : 0);
+
+  // Compute the grid coordinates of the points: space is sampled at sigma_s, intensity at sigma_r
+  std::vector<float> coords (4 * nr_points);
+  std::vector<char> valid (nr_points);
+  const double inv_sigma_s = 1.0 / sigma_s_, inv_sigma_r = 1.0 / sigma_r_;
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int i = 0; i < nr_points; ++i)
+  {
+    const PointT &point = input_->points[i];
+    valid[i] = pcl_isfinite (point.x) && pcl_isfinite (point.y) && pcl_isfinite (point.z) && pcl_isfinite (point.intensity);
+    coords[4 * i + 0] = static_cast<float> (point.x * inv_sigma_s);
+    coords[4 * i + 1] = static_cast<float> (point.y * inv_sigma_s);
+    coords[4 * i + 2] = static_cast<float> (point.z * inv_sigma_s);
+    coords[4 * i + 3] = static_cast<float> (point.intensity * inv_sigma_r);
+    if (filter_depth)
+      depths[i] = view_axis.dot (point.getVector3fMap () - sensor_origin);
+  }
+
+  // Shift the coordinates so that the grid starts at 0
+  float min_c[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX }, max_c[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+  for (int i = 0; i < nr_points; ++i)
+  {
+    if (!valid[i])
+      continue;
+    for (int d = 0; d < 4; ++d)
+    {
+      min_c[d] = std::min (min_c[d], coords[4 * i + d]);
+      max_c[d] = std::max (max_c[d], coords[4 * i + d]);
+    }
+  }
+  for (int d = 0; d < 4; ++d)
+  {
+    min_c[d] = floorf (min_c[d]);
+    if (max_c[d] - min_c[d] > static_cast<float> (max_cells))
+      return (false);
+  }
+#pragma omp parallel for schedule (static) num_threads (threads_)
+  for (int i = 0; i < nr_points; ++i)
+    for (int d = 0; d < 4; ++d)
+      coords[4 * i + d] -= min_c[d];
+
+  // Splat the points onto the 16 vertices of their grid cell, with multilinear weights
+  boost::unordered_map<uint64_t, int> vertex_ids;
+  std::vector<uint64_t> vertex_keys;
+  std::vector<double> values;
+  for (int i = 0; i < nr_points; ++i)
+  {
+    if (!valid[i])
+      continue;
+    const float *c = &coords[4 * i];
+    const int cell[4] = { static_cast<int> (c[0]), static_cast<int> (c[1]), static_cast<int> (c[2]), static_cast<int> (c[3]) };
+    const float frac[4] = { c[0] - cell[0], c[1] - cell[1], c[2] - cell[2], c[3] - cell[3] };
+    const uint64_t cell_key = static_cast<uint64_t> (cell[0]) | (static_cast<uint64_t> (cell[1]) << 16) |
+                              (static_cast<uint64_t> (cell[2]) << 32) | (static_cast<uint64_t> (cell[3]) << 48);
+    for (int corner = 0; corner < 16; ++corner)
+    {
+      uint64_t key = cell_key;
+      double weight = 1.0;
+      for (int d = 0; d < 4; ++d)
+      {
+        if (corner & (1 << d))
+        {
+          key += static_cast<uint64_t> (1) << (16 * d);
+          weight *= frac[d];
+        }
+        else
+          weight *= 1.0 - frac[d];
+      }
+
+      std::pair<boost::unordered_map<uint64_t, int>::iterator, bool> inserted =
+        vertex_ids.insert (std::make_pair (key, static_cast<int> (vertex_keys.size ())));
+      if (inserted.second)
+      {
+        vertex_keys.push_back (key);
+        values.resize (values.size () + nr_values, 0.0);
+      }
+      double *vertex_values = &values[inserted.first->second * nr_values];
+      vertex_values[0] += weight;
+      vertex_values[1] += weight * input_->points[i].intensity;
+      if (filter_depth)
+        vertex_values[2] += weight * depths[i];
+    }
+  }
+
+  // Blur the grid with a [1 2 1] / 4 kernel along every dimension. Vertices without points hold zeros.
+  const int nr_vertices = static_cast<int> (vertex_keys.size ());
+  std::vector<double> blurred (values.size ());
+  for (int d = 0; d < 4; ++d)
+  {
+    const uint64_t step = static_cast<uint64_t> (1) << (16 * d);
+#pragma omp parallel for schedule (dynamic, 1024) num_threads (threads_)
+    for (int v = 0; v < nr_vertices; ++v)
+    {
+      const uint64_t key = vertex_keys[v];
+      const double *value = &values[v * nr_values];
+      double *result = &blurred[v * nr_values];
+      for (int k = 0; k < nr_values; ++k)
+        result[k] = 0.5 * value[k];
+
+      // The coordinates are at least 0, so the previous vertex is only looked up if the coordinate is positive
+      if (((key >> (16 * d)) & 0xFFFF) > 0)
+      {
+        boost::unordered_map<uint64_t, int>::const_iterator it = vertex_ids.find (key - step);
+        if (it != vertex_ids.end ())
+          for (int k = 0; k < nr_values; ++k)
+            result[k] += 0.25 * values[it->second * nr_values + k];
+      }
+      boost::unordered_map<uint64_t, int>::const_iterator it = vertex_ids.find (key + step);
+      if (it != vertex_ids.end ())
+        for (int k = 0; k < nr_values; ++k)
+          result[k] += 0.25 * values[it->second * nr_values + k];
+    }
+    values.swap (blurred);
+  }
+
+  // Copy the input data into the output
+  output = *input_;
+
+  // Slice: interpolate the blurred grid at the points that have to be filtered
+  const int nr_indices = static_cast<int> (indices_->size ());
+#pragma omp parallel for schedule (dynamic, 1024) num_threads (threads_)
+  for (int i = 0; i < nr_indices; ++i)
   {
-    // Perform a radius search to find the nearest neighbors
-    tree_->radiusSearch ((*indices_)[i], sigma_s_ * 2, k_indices, k_distances);
+    const int pid = (*indices_)[i];
+    if (!valid[pid])
+      continue;
+    const float *c = &coords[4 * pid];
+    const int cell[4] = { static_cast<int> (c[0]), static_cast<int> (c[1]), static_cast<int> (c[2]), static_cast<int> (c[3]) };
+    const float frac[4] = { c[0] - cell[0], c[1] - cell[1], c[2] - cell[2], c[3] - cell[3] };
+    const uint64_t cell_key = static_cast<uint64_t> (cell[0]) | (static_cast<uint64_t> (cell[1]) << 16) |
+                              (static_cast<uint64_t> (cell[2]) << 32) | (static_cast<uint64_t> (cell[3]) << 48);
+    double sum[3] = { 0.0, 0.0, 0.0 };
+    for (int corner = 0; corner < 16; ++corner)
+    {
+      uint64_t key = cell_key;
+      double weight = 1.0;
+      for (int d = 0; d < 4; ++d)
+      {
+        if (corner & (1 << d))
+        {
+          key += static_cast<uint64_t> (1) << (16 * d);
+          weight *= frac[d];
+        }
+        else
+          weight *= 1.0 - frac[d];
+      }
+      // Every corner of the cell of a point has been splatted to
+      const double *vertex_values = &values[vertex_ids.find (key)->second * nr_values];
+      for (int k = 0; k < nr_values; ++k)
+        sum[k] += weight * vertex_values[k];
+    }
 
-    // Overwrite the intensity value with the computed average
-    output.points[(*indices_)[i]].intensity = computePointWeight ((*indices_)[i], k_indices, k_distances);
+    // The point contributes to its own vertices, so the weight is positive
+    PointT &point = output.points[pid];
+    point.intensity = static_cast<float> (sum[1] / sum[0]);
+    if (filter_depth)
+    {
+      // Move the point along its viewing ray, which goes through the sensor origin
+      const float depth = static_cast<float> (sum[2] / sum[0]);
+      if (depths[pid] != 0)
+        point.getVector3fMap () = sensor_origin + (point.getVector3fMap () - sensor_origin) * (depth / depths[pid]);
+    }
   }
+  return (true);
 }
  
 #define PCL_INSTANTIATE_BilateralFilter(T) template class PCL_EXPORTS pcl::BilateralFilter<T>;
@@ -41,8 +41,147 @@
 #include <pcl/common/io.h>
 #include <boost/shared_ptr.hpp>
 #include <vector>
+#include <algorithm>
 #include <Eigen/Geometry>
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief The number of points a compiled condition is evaluated on at once. */
+    const int condition_block_size = 256;
+
+    /** \brief Compare a field of a block of points with a value, with the semantics of
+      * PointDataAtOffset::compare: the value is first converted to the comparison type V.
+      */
+    template <typename T, typename V, typename PointT> void
+    compareFieldBlock (const PointT *points, const int *indices, int nr_points, uint32_t offset,
+                       ComparisonOps::CompareOp op, V value, uint8_t *mask)
+    {
+      // Gather the field values, so that the comparisons run over a contiguous array
+      V values[condition_block_size];
+      for (int i = 0; i < nr_points; ++i)
+      {
+        T pt_val;
+        memcpy (&pt_val, reinterpret_cast<const uint8_t*> (&points[indices[i]]) + offset, sizeof (T));
+        values[i] = static_cast<V> (pt_val);
+      }
+
+      switch (op)
+      {
+        case ComparisonOps::GT :
+          for (int i = 0; i < nr_points; ++i)
+            mask[i] = values[i] > value;
+          break;
+        case ComparisonOps::GE :
+          for (int i = 0; i < nr_points; ++i)
+            mask[i] = !(values[i] < value);
+          break;
+        case ComparisonOps::LT :
+          for (int i = 0; i < nr_points; ++i)
+            mask[i] = values[i] < value;
+          break;
+        case ComparisonOps::LE :
+          for (int i = 0; i < nr_points; ++i)
+            mask[i] = !(values[i] > value);
+          break;
+        case ComparisonOps::EQ :
+          for (int i = 0; i < nr_points; ++i)
+            mask[i] = !(values[i] < value) & !(values[i] > value);
+          break;
+        default:
+          std::fill (mask, mask + nr_points, uint8_t (0));
+      }
+    }
+
+    /** \brief Run a FIELD instruction of a compiled condition on a block of points. */
+    template <typename T, typename PointT> inline void
+    compareFieldBlock (const ConditionInstruction<PointT> &instruction, const PointT *points,
+                       const int *indices, int nr_points, uint8_t *mask)
+    {
+      if (instruction.compare_in_double)
+        compareFieldBlock<T, double> (points, indices, nr_points, instruction.offset, instruction.op,
+                                      instruction.value, mask);
+      else
+        compareFieldBlock<T, T> (points, indices, nr_points, instruction.offset, instruction.op,
+                                 static_cast<T> (instruction.value), mask);
+    }
+
+    /** \brief Run a compiled condition on a block of points.
+      * \param[in] program the compiled condition
+      * \param[in] points the point data
+      * \param[in] indices the indices of the (at most condition_block_size) points of the block
+      * \param[in] nr_points the number of points in the block
+      * \param[out] stack room for the deepest mask stack of the program, condition_block_size
+      * bytes per mask; the result is left in the first mask
+      */
+    template <typename PointT> void
+    runConditionProgram (const std::vector<ConditionInstruction<PointT> > &program, const PointT *points,
+                         const int *indices, int nr_points, uint8_t *stack)
+    {
+      typedef ConditionInstruction<PointT> Instruction;
+      uint8_t *top = stack;
+      for (size_t p = 0; p < program.size (); ++p)
+      {
+        const Instruction &instruction = program[p];
+        switch (instruction.kind)
+        {
+          case Instruction::CONSTANT_TRUE :
+            std::fill (top, top + nr_points, uint8_t (1));
+            break;
+          case Instruction::FIELD :
+            switch (instruction.datatype)
+            {
+              case sensor_msgs::PointField::INT8 :
+                compareFieldBlock<int8_t> (instruction, points, indices, nr_points, top); break;
+              case sensor_msgs::PointField::UINT8 :
+                compareFieldBlock<uint8_t> (instruction, points, indices, nr_points, top); break;
+              case sensor_msgs::PointField::INT16 :
+                compareFieldBlock<int16_t> (instruction, points, indices, nr_points, top); break;
+              case sensor_msgs::PointField::UINT16 :
+                compareFieldBlock<uint16_t> (instruction, points, indices, nr_points, top); break;
+              case sensor_msgs::PointField::INT32 :
+                compareFieldBlock<int32_t> (instruction, points, indices, nr_points, top); break;
+              case sensor_msgs::PointField::UINT32 :
+                compareFieldBlock<uint32_t> (instruction, points, indices, nr_points, top); break;
+              case sensor_msgs::PointField::FLOAT32 :
+                compareFieldBlock<float> (instruction, points, indices, nr_points, top); break;
+              default :
+                compareFieldBlock<double> (instruction, points, indices, nr_points, top); break;
+            }
+            break;
+          case Instruction::EVALUATE_COMPARISON :
+            for (int i = 0; i < nr_points; ++i)
+              top[i] = instruction.comparison->evaluate (points[indices[i]]);
+            break;
+          case Instruction::EVALUATE_CONDITION :
+            for (int i = 0; i < nr_points; ++i)
+              top[i] = instruction.condition->evaluate (points[indices[i]]);
+            break;
+          case Instruction::AND :
+          case Instruction::OR :
+          {
+            // Combine the top nr_operands masks into the lowest of them
+            top -= (instruction.nr_operands) * condition_block_size;
+            for (int k = 1; k < instruction.nr_operands; ++k)
+            {
+              const uint8_t *mask = top + k * condition_block_size;
+              if (instruction.kind == Instruction::AND)
+                for (int i = 0; i < nr_points; ++i)
+                  top[i] &= mask[i];
+              else
+                for (int i = 0; i < nr_points; ++i)
+                  top[i] |= mask[i];
+            }
+            break;
+          }
+        }
+        top += condition_block_size;
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -133,6 +272,25 @@ pcl::FieldComparison<PointT>::evaluate (const PointT &point) const
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FieldComparison<PointT>::compile (std::vector<detail::ConditionInstruction<PointT> > &program) const
+{
+  if (!this->capable_ || point_data_->getDatatype () < sensor_msgs::PointField::INT8 ||
+      point_data_->getDatatype () > sensor_msgs::PointField::FLOAT64)
+  {
+    ComparisonBase<PointT>::compile (program);
+    return;
+  }
+
+  detail::ConditionInstruction<PointT> instruction (detail::ConditionInstruction<PointT>::FIELD);
+  instruction.datatype = point_data_->getDatatype ();
+  instruction.offset = point_data_->getOffset ();
+  instruction.op = op_;
+  instruction.value = compare_val_;
+  program.push_back (instruction);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -225,6 +383,26 @@ pcl::PackedRGBComparison<PointT>::evaluate (const PointT &point) const
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PackedRGBComparison<PointT>::compile (std::vector<detail::ConditionInstruction<PointT> > &program) const
+{
+  // A NaN compare value fails every comparison in evaluate, unlike in a FIELD instruction
+  if (!capable_ || !pcl_isfinite (compare_val_))
+  {
+    ComparisonBase<PointT>::compile (program);
+    return;
+  }
+
+  detail::ConditionInstruction<PointT> instruction (detail::ConditionInstruction<PointT>::FIELD);
+  instruction.datatype = sensor_msgs::PointField::UINT8;
+  instruction.offset = component_offset_;
+  instruction.compare_in_double = true;
+  instruction.op = op_;
+  instruction.value = compare_val_;
+  program.push_back (instruction);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -301,42 +479,31 @@ pcl::PackedHSIComparison<PointT>::PackedHSIComparison (
 template <typename PointT> bool
 pcl::PackedHSIComparison<PointT>::evaluate (const PointT &point) const
 {
-  // Since this is a const function, we can't make these data members because we change them here
-  static uint32_t rgb_val_ = 0;
-  static uint8_t r_ = 0;
-  static uint8_t g_ = 0;
-  static uint8_t b_ = 0;
-  static int8_t h_ = 0;
-  static uint8_t s_ = 0;
-  static uint8_t i_ = 0;
-
+  // The values are computed for every point (instead of being cached in static variables),
+  // so that the comparison can be evaluated from several threads at once
   // We know that rgb data is 32 bit aligned (verified in the ctor) so...
   const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&point);
   const uint32_t* rgb_data = reinterpret_cast<const uint32_t*> (pt_data + rgb_offset_);
-  uint32_t new_rgb_val = *rgb_data;
+  uint32_t rgb_val_ = *rgb_data;
 
-  if (rgb_val_ != new_rgb_val) 
-  { // avoid having to redo this calc, if possible
-    rgb_val_ = new_rgb_val;
-    // extract r,g,b
-    r_ = static_cast <uint8_t> (rgb_val_ >> 16); 
-    g_ = static_cast <uint8_t> (rgb_val_ >> 8);
-    b_ = static_cast <uint8_t> (rgb_val_);
+  // extract r,g,b
+  uint8_t r_ = static_cast <uint8_t> (rgb_val_ >> 16); 
+  uint8_t g_ = static_cast <uint8_t> (rgb_val_ >> 8);
+  uint8_t b_ = static_cast <uint8_t> (rgb_val_);
 
-    // definitions taken from http://en.wikipedia.org/wiki/HSL_and_HSI
-    float hx = (2.0f * r_ - g_ - b_) / 4.0f;  // hue x component -127 to 127
-    float hy = static_cast<float> (g_ - b_) * 111.0f / 255.0f; // hue y component -111 to 111
-    h_ = static_cast<int8_t> (atan2(hy, hx) * 128.0f / M_PI);
+  // definitions taken from http://en.wikipedia.org/wiki/HSL_and_HSI
+  float hx = (2.0f * r_ - g_ - b_) / 4.0f;  // hue x component -127 to 127
+  float hy = static_cast<float> (g_ - b_) * 111.0f / 255.0f; // hue y component -111 to 111
+  int8_t h_ = static_cast<int8_t> (atan2(hy, hx) * 128.0f / M_PI);
 
-    int32_t i = (r_+g_+b_)/3; // 0 to 255
-    i_ = static_cast<uint8_t> (i);
+  int32_t i = (r_+g_+b_)/3; // 0 to 255
+  uint8_t i_ = static_cast<uint8_t> (i);
 
-    int32_t m;  // min(r,g,b)
-    m = (r_ < g_) ? r_ : g_;
-    m = (m < b_) ? m : b_;
+  int32_t m;  // min(r,g,b)
+  m = (r_ < g_) ? r_ : g_;
+  m = (m < b_) ? m : b_;
 
-    s_ = static_cast<uint8_t> ((i == 0) ? 0 : 255 - (m * 255) / i); // saturation 0 to 255
-  }
+  uint8_t s_ = static_cast<uint8_t> ((i == 0) ? 0 : 255 - (m * 255) / i); // saturation 0 to 255
 
   float my_val = 0;
 
@@ -600,6 +767,17 @@ pcl::PointDataAtOffset<PointT>::compare (const PointT& p, const double& val)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ComparisonBase<PointT>::compile (std::vector<detail::ConditionInstruction<PointT> > &program) const
+{
+  detail::ConditionInstruction<PointT> instruction (detail::ConditionInstruction<PointT>::EVALUATE_COMPARISON);
+  instruction.comparison = this;
+  program.push_back (instruction);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -620,6 +798,15 @@ pcl::ConditionBase<PointT>::addCondition (Ptr condition)
   conditions_.push_back (condition);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionBase<PointT>::compile (std::vector<detail::ConditionInstruction<PointT> > &program) const
+{
+  detail::ConditionInstruction<PointT> instruction (detail::ConditionInstruction<PointT>::EVALUATE_CONDITION);
+  instruction.condition = this;
+  program.push_back (instruction);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -637,6 +824,28 @@ pcl::ConditionAnd<PointT>::evaluate (const PointT &point) const
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionAnd<PointT>::compile (std::vector<detail::ConditionInstruction<PointT> > &program) const
+{
+  typedef detail::ConditionInstruction<PointT> Instruction;
+  // An empty AND is true
+  if (comparisons_.empty () && conditions_.empty ())
+  {
+    program.push_back (Instruction (Instruction::CONSTANT_TRUE));
+    return;
+  }
+
+  for (size_t i = 0; i < comparisons_.size (); ++i)
+    comparisons_[i]->compile (program);
+  for (size_t i = 0; i < conditions_.size (); ++i)
+    conditions_[i]->compile (program);
+
+  Instruction instruction (Instruction::AND);
+  instruction.nr_operands = static_cast<int> (comparisons_.size () + conditions_.size ());
+  program.push_back (instruction);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -656,6 +865,28 @@ pcl::ConditionOr<PointT>::evaluate (const PointT &point) const
   return (false);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionOr<PointT>::compile (std::vector<detail::ConditionInstruction<PointT> > &program) const
+{
+  typedef detail::ConditionInstruction<PointT> Instruction;
+  // An empty OR is true as well, see evaluate ()
+  if (comparisons_.empty () && conditions_.empty ())
+  {
+    program.push_back (Instruction (Instruction::CONSTANT_TRUE));
+    return;
+  }
+
+  for (size_t i = 0; i < comparisons_.size (); ++i)
+    comparisons_[i]->compile (program);
+  for (size_t i = 0; i < conditions_.size (); ++i)
+    conditions_[i]->compile (program);
+
+  Instruction instruction (Instruction::OR);
+  instruction.nr_operands = static_cast<int> (comparisons_.size () + conditions_.size ());
+  program.push_back (instruction);
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -666,6 +897,51 @@ pcl::ConditionalRemoval<PointT>::setCondition (ConditionBasePtr condition)
   capable_ = condition_->isCapable ();
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionalRemoval<PointT>::evaluateCondition (
+    const int *indices, size_t nr_points, std::vector<char> &passed) const
+{
+  typedef detail::ConditionInstruction<PointT> Instruction;
+
+  // Compile the condition here rather than in setCondition, as it may have been modified since
+  std::vector<Instruction> program;
+  condition_->compile (program);
+
+  // Find the number of masks the program needs at most
+  int depth = 0, max_depth = 0;
+  for (size_t p = 0; p < program.size (); ++p)
+  {
+    if (program[p].kind == Instruction::AND || program[p].kind == Instruction::OR)
+      depth -= program[p].nr_operands - 1;
+    else
+      ++depth;
+    max_depth = std::max (max_depth, depth);
+  }
+
+  passed.resize (nr_points);
+  const int nr_blocks = static_cast<int> ((nr_points + detail::condition_block_size - 1) / detail::condition_block_size);
+  const PointT *points = input_->points.empty () ? NULL : &input_->points[0];
+
+#pragma omp parallel num_threads (threads_)
+  {
+    std::vector<uint8_t> stack (max_depth * detail::condition_block_size);
+    std::vector<int> block_indices (detail::condition_block_size);
+#pragma omp for schedule (dynamic, 16)
+    for (int b = 0; b < nr_blocks; ++b)
+    {
+      const size_t begin = static_cast<size_t> (b) * detail::condition_block_size;
+      const int nr_block_points = static_cast<int> (std::min (nr_points - begin, size_t (detail::condition_block_size)));
+      for (int i = 0; i < nr_block_points; ++i)
+        block_indices[i] = indices ? indices[begin + i] : static_cast<int> (begin + i);
+
+      detail::runConditionProgram (program, points, &block_indices[0], nr_block_points, &stack[0]);
+      for (int i = 0; i < nr_block_points; ++i)
+        passed[begin + i] = static_cast<char> (stack[i]);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
@@ -706,9 +982,13 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
 
   int nr_p = 0;
   int nr_removed_p = 0;
+  std::vector<char> passed;
 
   if (!keep_organized_)
   {
+    evaluateCondition (Filter<PointT>::indices_->empty () ? NULL : &(*Filter<PointT>::indices_)[0],
+                       Filter<PointT>::indices_->size (), passed);
+
     for (size_t cp = 0; cp < Filter<PointT>::indices_->size (); ++cp)
     {
       // Check if the point is invalid
@@ -724,7 +1004,7 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
         continue;
       }
 
-      if (condition_->evaluate (input_->points[(*Filter < PointT > ::indices_)[cp]]))
+      if (passed[cp])
       {
         pcl::for_each_type<FieldList> (
                                        pcl::NdConcatenateFunctor<PointT, PointT> (
@@ -749,11 +1029,16 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
   {
     std::vector<int> indices = *Filter<PointT>::indices_;
     std::sort (indices.begin (), indices.end ());   //TODO: is this necessary or can we assume the indices to be sorted?
+
+    // Only the indexed points are evaluated, passed[ci] holding the result of indices[ci]
+    evaluateCondition (indices.empty () ? NULL : &indices[0], indices.size (), passed);
+
     size_t ci = 0;
     for (size_t cp = 0; cp < input_->points.size (); ++cp)
     {
       if (cp == static_cast<size_t> (indices[ci]))
       {
+        size_t cur_ci = ci;
         if (ci < indices.size ())
         {
           ci++;
@@ -764,7 +1049,7 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
         // copy all the fields
         pcl::for_each_type<FieldList> (pcl::NdConcatenateFunctor<PointT, PointT> (input_->points[cp],
                                                                                   output.points[cp]));
-        if (!condition_->evaluate (input_->points[cp]))
+        if (!passed[cur_ci])
         {
           output.points[cp].getVector4fMap ().setConstant (user_filter_value_);
 
@@ -44,6 +44,9 @@
 template<typename PointT> void
 pcl::CropHull<PointT>::applyFilter (PointCloud &output)
 {
+  // The points that pass the filter are appended below
+  output.clear ();
+
   if (dim_ == 2)
   {
     // in this case we are assuming all the points lie in the same plane as the
@@ -69,6 +72,9 @@ pcl::CropHull<PointT>::applyFilter (PointCloud &output)
 template<typename PointT> void
 pcl::CropHull<PointT>::applyFilter (std::vector<int> &indices)
 {
+  // The points that pass the filter are appended below
+  indices.clear ();
+
   if (dim_ == 2)
   {
     // in this case we are assuming all the points lie in the same plane as the
@@ -121,29 +127,11 @@ pcl::CropHull<PointT>::getHullCloudRange ()
 template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void 
 pcl::CropHull<PointT>::applyFilter2D (PointCloud &output)
 {
+  std::vector<char> keep;
+  classifyPoints2D<PlaneDim1,PlaneDim2> (keep);
   for (size_t index = 0; index < indices_->size (); index++)
-  {
-    // iterate over polygons faster than points because we expect this data
-    // to be, in general, more cache-local - the point cloud might be huge
-    size_t poly;
-    for (poly = 0; poly < hull_polygons_.size (); poly++)
-    {
-      if (isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (
-              input_->points[(*indices_)[index]], hull_polygons_[poly], *hull_cloud_
-         ))
-      {
-        if (crop_outside_)
-          output.push_back (input_->points[(*indices_)[index]]);
-        // once a point has tested +ve for being inside one polygon, we can
-        // stop checking the others:
-        break;
-      }
-    }
-    // If we're removing points *inside* the hull, only remove points that
-    // haven't been found inside any polygons
-    if (poly == hull_polygons_.size () && !crop_outside_)
+    if (keep[index])
       output.push_back (input_->points[(*indices_)[index]]);
-  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -151,33 +139,100 @@ template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void
 pcl::CropHull<PointT>::applyFilter2D (std::vector<int> &indices)
 {
   // see comments in (PointCloud& output) overload
+  std::vector<char> keep;
+  classifyPoints2D<PlaneDim1,PlaneDim2> (keep);
+  for (size_t index = 0; index < indices_->size (); index++)
+    if (keep[index])
+      indices.push_back ((*indices_)[index]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void 
+pcl::CropHull<PointT>::applyFilter3D (PointCloud &output)
+{
+  std::vector<char> keep;
+  classifyPoints3D (keep);
+  for (size_t index = 0; index < indices_->size (); index++)
+    if (keep[index])
+      output.push_back (input_->points[(*indices_)[index]]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void 
+pcl::CropHull<PointT>::applyFilter3D (std::vector<int> &indices)
+{
+  // see comments in applyFilter3D (PointCloud& output)
+  std::vector<char> keep;
+  classifyPoints3D (keep);
   for (size_t index = 0; index < indices_->size (); index++)
+    if (keep[index])
+      indices.push_back ((*indices_)[index]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> void 
+pcl::CropHull<PointT>::classifyPoints2D (std::vector<char> &keep) const
+{
+  // A point outside of the bounding box of a polygon can not be inside of it, so the boxes are checked first
+  const int nr_polygons = static_cast<int> (hull_polygons_.size ());
+  std::vector<float> boxes (4 * nr_polygons);
+  for (int poly = 0; poly < nr_polygons; poly++)
   {
-    size_t poly;
-    for (poly = 0; poly < hull_polygons_.size (); poly++)
+    float *box = &boxes[4 * poly];
+    box[0] = box[1] = std::numeric_limits<float>::max ();
+    box[2] = box[3] = -std::numeric_limits<float>::max ();
+    const std::vector<uint32_t> &vertices = hull_polygons_[poly].vertices;
+    for (size_t i = 0; i < vertices.size (); i++)
     {
-      if (isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (
-              input_->points[(*indices_)[index]], hull_polygons_[poly], *hull_cloud_
-         ))
-      {
-        if (crop_outside_)      
-          indices.push_back ((*indices_)[index]);
-        break;
-      }
+      const Eigen::Vector3f vertex = hull_cloud_->points[vertices[i]].getVector3fMap ();
+      box[0] = std::min (box[0], vertex[PlaneDim1]);
+      box[1] = std::min (box[1], vertex[PlaneDim2]);
+      box[2] = std::max (box[2], vertex[PlaneDim1]);
+      box[3] = std::max (box[3], vertex[PlaneDim2]);
     }
-    if (poly == hull_polygons_.size () && !crop_outside_)
-      indices.push_back ((*indices_)[index]);
+  }
+
+  const int nr_points = static_cast<int> (indices_->size ());
+  keep.resize (nr_points);
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int index = 0; index < nr_points; index++)
+  {
+    const PointT &point = input_->points[(*indices_)[index]];
+    const float x = point.getVector3fMap ()[PlaneDim1], y = point.getVector3fMap ()[PlaneDim2];
+    // iterate over polygons faster than points because we expect this data
+    // to be, in general, more cache-local - the point cloud might be huge
+    bool inside = false;
+    for (int poly = 0; poly < nr_polygons && !inside; poly++)
+    {
+      const float *box = &boxes[4 * poly];
+      if (x < box[0] || y < box[1] || x > box[2] || y > box[3] || hull_polygons_[poly].vertices.empty ())
+        continue;
+      // once a point has tested +ve for being inside one polygon, we can
+      // stop checking the others:
+      inside = isPointIn2DPolyWithVertIndices<PlaneDim1,PlaneDim2> (point, hull_polygons_[poly], *hull_cloud_);
+    }
+    // If we're removing points *inside* the hull, only remove points that
+    // haven't been found inside any polygons
+    keep[index] = (inside == crop_outside_);
   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void 
-pcl::CropHull<PointT>::applyFilter3D (PointCloud &output)
+pcl::CropHull<PointT>::classifyPoints3D (std::vector<char> &keep)
 {
-  // This algorithm could definitely be sped up using kdtree/octree
-  // information, if that is available!
+  buildBVH ();
 
-  for (size_t index = 0; index < indices_->size (); index++)
+  // The rounding errors of the ray-polygon intersections grow with the magnitude of the coordinates, the
+  // bounding boxes are grown accordingly so that no crossing found by rayTriangleIntersect gets lost
+  float hull_scale = 0.0f;
+  if (!bvh_nodes_.empty ())
+    hull_scale = std::max (bvh_nodes_[0].min_pt.cwiseAbs ().maxCoeff (), bvh_nodes_[0].max_pt.cwiseAbs ().maxCoeff ());
+
+  const int nr_points = static_cast<int> (indices_->size ());
+  keep.resize (nr_points);
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int index = 0; index < nr_points; index++)
   {
     // test ray-crossings for three random rays, and take vote of crossings
     // counts to determine if each point is inside the hull: the vote avoids
@@ -187,50 +242,166 @@ pcl::CropHull<PointT>::applyFilter3D (PointCloud &output)
     // hit the edge between polygons than coordinate-axis aligned rays would
     // be.
     size_t crossings[3] = {0,0,0};
-    Eigen::Vector3f rays[3] = 
+    const Eigen::Vector3f rays[3] = 
     {
       Eigen::Vector3f (0.264882f,  0.688399f, 0.675237f),
       Eigen::Vector3f (0.0145419f, 0.732901f, 0.68018f),
       Eigen::Vector3f (0.856514f,  0.508771f, 0.0868081f)
     };
 
-    for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
+    const PointT &point = input_->points[(*indices_)[index]];
+    if (pcl_isfinite (point.x) && pcl_isfinite (point.y) && pcl_isfinite (point.z))
+    {
+      const float tolerance = 1e-4f * (point.getVector3fMap ().cwiseAbs ().maxCoeff () + hull_scale);
       for (size_t ray = 0; ray < 3; ray++)
-        crossings[ray] += rayTriangleIntersect
-          (input_->points[(*indices_)[index]], rays[ray], hull_polygons_[poly], *hull_cloud_);
+        crossings[ray] = countRayCrossings (point, rays[ray], tolerance);
+    }
+    else
+    {
+      // The bounding boxes can not be checked for invalid points, test all the polygons as before
+      for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
+        for (size_t ray = 0; ray < 3; ray++)
+          crossings[ray] += rayTriangleIntersect (point, rays[ray], hull_polygons_[poly], *hull_cloud_);
+    }
 
-    if (crop_outside_ && (crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1)
-      output.push_back (input_->points[(*indices_)[index]]);
-    else if (!crop_outside_)
-      output.push_back (input_->points[(*indices_)[index]]);
+    const bool inside = (crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1;
+    keep[index] = (inside == crop_outside_);
   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void 
-pcl::CropHull<PointT>::applyFilter3D (std::vector<int> &indices)
+pcl::CropHull<PointT>::buildBVH ()
 {
-  // see comments in applyFilter3D (PointCloud& output)
-  for (size_t index = 0; index < indices_->size (); index++)
+  const int nr_polygons = static_cast<int> (hull_polygons_.size ());
+  bvh_nodes_.clear ();
+  bvh_polygons_.resize (nr_polygons);
+  if (nr_polygons == 0)
+    return;
+
+  // Bounding boxes and centers of the polygons
+  std::vector<Eigen::Vector3f> poly_min (nr_polygons), poly_max (nr_polygons), poly_center (nr_polygons);
+  for (int poly = 0; poly < nr_polygons; poly++)
   {
-    size_t crossings[3] = {0,0,0};
-    Eigen::Vector3f rays[3] = 
+    bvh_polygons_[poly] = poly;
+    const std::vector<uint32_t> &vertices = hull_polygons_[poly].vertices;
+    poly_min[poly].setConstant (std::numeric_limits<float>::max ());
+    poly_max[poly].setConstant (-std::numeric_limits<float>::max ());
+    for (size_t i = 0; i < vertices.size (); i++)
     {
-      Eigen::Vector3f(0.264882f,  0.688399f, 0.675237f),
-      Eigen::Vector3f(0.0145419f, 0.732901f, 0.68018f),
-      Eigen::Vector3f(0.856514f,  0.508771f, 0.0868081f)
-    };
+      const Eigen::Vector3f vertex = hull_cloud_->points[vertices[i]].getVector3fMap ();
+      poly_min[poly] = poly_min[poly].cwiseMin (vertex);
+      poly_max[poly] = poly_max[poly].cwiseMax (vertex);
+    }
+    poly_center[poly] = 0.5f * (poly_min[poly] + poly_max[poly]);
+  }
 
-    for (size_t poly = 0; poly < hull_polygons_.size (); poly++)
-      for (size_t ray = 0; ray < 3; ray++)
-        crossings[ray] += rayTriangleIntersect
-          (input_->points[(*indices_)[index]], rays[ray], hull_polygons_[poly], *hull_cloud_);
+  // The nodes are created depth first, so that the left child of a node always directly follows it. Every
+  // task is a range of bvh_polygons_ and the node whose right child it becomes (-1 for left children).
+  const int max_leaf_size = 4;
+  std::vector<int> tasks;
+  tasks.push_back (0); tasks.push_back (nr_polygons); tasks.push_back (-1);
+  std::vector<std::pair<float, int> > keys;
+  while (!tasks.empty ())
+  {
+    const int parent = tasks.back (); tasks.pop_back ();
+    const int end = tasks.back (); tasks.pop_back ();
+    const int begin = tasks.back (); tasks.pop_back ();
 
-    if (crop_outside_ && (crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1)
-      indices.push_back ((*indices_)[index]);
-    else if (!crop_outside_)
-      indices.push_back ((*indices_)[index]);
+    const int node_index = static_cast<int> (bvh_nodes_.size ());
+    if (parent >= 0)
+      bvh_nodes_[parent].first = node_index;
+    BVHNode node;
+    node.min_pt.setConstant (std::numeric_limits<float>::max ());
+    node.max_pt.setConstant (-std::numeric_limits<float>::max ());
+    Eigen::Vector3f center_min = node.min_pt, center_max = node.max_pt;
+    for (int i = begin; i < end; i++)
+    {
+      const int poly = bvh_polygons_[i];
+      node.min_pt = node.min_pt.cwiseMin (poly_min[poly]);
+      node.max_pt = node.max_pt.cwiseMax (poly_max[poly]);
+      center_min = center_min.cwiseMin (poly_center[poly]);
+      center_max = center_max.cwiseMax (poly_center[poly]);
+    }
+
+    int axis;
+    const float extent = (center_max - center_min).maxCoeff (&axis);
+    if (end - begin <= max_leaf_size || !(extent > 0.0f))
+    {
+      node.first = begin;
+      node.count = end - begin;
+      bvh_nodes_.push_back (node);
+      continue;
+    }
+    node.first = -1;
+    node.count = 0;
+    bvh_nodes_.push_back (node);
+
+    // Split at the median of the polygon centers along the longest axis
+    keys.resize (end - begin);
+    for (int i = begin; i < end; i++)
+      keys[i - begin] = std::make_pair (poly_center[bvh_polygons_[i]][axis], bvh_polygons_[i]);
+    const int middle = (begin + end) / 2;
+    std::nth_element (keys.begin (), keys.begin () + (middle - begin), keys.end ());
+    for (int i = begin; i < end; i++)
+      bvh_polygons_[i] = keys[i - begin].second;
+
+    tasks.push_back (middle); tasks.push_back (end); tasks.push_back (node_index);
+    tasks.push_back (begin); tasks.push_back (middle); tasks.push_back (-1);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> size_t
+pcl::CropHull<PointT>::countRayCrossings (const PointT& point, const Eigen::Vector3f& ray, float tolerance) const
+{
+  if (bvh_nodes_.empty ())
+    return (0);
+
+  const Eigen::Vector3f p = point.getVector3fMap ();
+  size_t crossings = 0;
+  // The median split keeps the depth of the hierarchy logarithmic in the number of polygons
+  int stack[64];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0)
+  {
+    const int node_index = stack[--stack_size];
+    const BVHNode &node = bvh_nodes_[node_index];
+
+    // Does the ray (p + r * ray, r >= 0) pass through the (grown) bounding box of the node?
+    float r_min = 0.0f, r_max = std::numeric_limits<float>::max ();
+    bool hit = true;
+    for (int k = 0; k < 3 && hit; k++)
+    {
+      const float low = node.min_pt[k] - tolerance - p[k], high = node.max_pt[k] + tolerance - p[k];
+      if (ray[k] == 0.0f)
+      {
+        hit = (low <= 0.0f && high >= 0.0f);
+        continue;
+      }
+      float r1 = low / ray[k], r2 = high / ray[k];
+      if (r1 > r2)
+        std::swap (r1, r2);
+      r_min = std::max (r_min, r1);
+      r_max = std::min (r_max, r2);
+      hit = (r_min <= r_max);
+    }
+    if (!hit)
+      continue;
+
+    if (node.count > 0)
+    {
+      for (int i = node.first; i < node.first + node.count; i++)
+        crossings += rayTriangleIntersect (point, ray, hull_polygons_[bvh_polygons_[i]], *hull_cloud_);
+    }
+    else
+    {
+      stack[stack_size++] = node.first;
+      stack[stack_size++] = node_index + 1;
+    }
   }
+  return (crossings);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,179 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_FILTER_CHAIN_H_
+#define PCL_FILTERS_IMPL_FILTER_CHAIN_H_
+
+#include <pcl/filters/filter_chain.h>
+#include <pcl/common/io.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FilterChain<PointT>::addFilterIndices (const FilterIndicesPtr &filter)
+{
+  Stage stage (Stage::INDICES);
+  stage.filter_indices = filter;
+  stages_.push_back (stage);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FilterChain<PointT>::addPredicate (const Predicate &predicate)
+{
+  Stage stage (Stage::PREDICATE);
+  stage.predicate = predicate;
+  stages_.push_back (stage);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FilterChain<PointT>::addFilter (const FilterPtr &filter, bool restrict_to_indices)
+{
+  Stage stage (Stage::CLOUD);
+  stage.filter = filter;
+  stage.restrict_to_indices = restrict_to_indices;
+  stages_.push_back (stage);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FilterChain<PointT>::applyPredicates (
+    const PointCloud &cloud, std::vector<int> &indices, size_t first_stage, size_t last_stage) const
+{
+  const int nr_points = static_cast<int> (indices.size ());
+  std::vector<char> passed (nr_points);
+
+#pragma omp parallel for schedule (dynamic, 1024) num_threads (threads_)
+  for (int i = 0; i < nr_points; ++i)
+  {
+    const PointT &point = cloud.points[indices[i]];
+    bool pass = true;
+    for (size_t s = first_stage; s < last_stage && pass; ++s)
+      pass = stages_[s].predicate (point);
+    passed[i] = pass;
+  }
+
+  // Compact the indices, keeping their order
+  int nr_passed = 0;
+  for (int i = 0; i < nr_points; ++i)
+    if (passed[i])
+      indices[nr_passed++] = indices[i];
+  indices.resize (nr_passed);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FilterChain<PointT>::applyFilter (PointCloud &output)
+{
+  // The current cloud and the indices of its points that passed the stages so far
+  PointCloudConstPtr cloud = input_;
+  IndicesPtr indices (new std::vector<int> (*indices_));
+  // Whether indices holds every point of cloud, in order
+  bool all_points = (indices_->size () == input_->points.size ());
+  for (size_t i = 0; all_points && i < indices->size (); ++i)
+    all_points = ((*indices)[i] == static_cast<int> (i));
+
+  size_t s = 0;
+  while (s < stages_.size ())
+  {
+    const Stage &stage = stages_[s];
+    switch (stage.kind)
+    {
+      case Stage::PREDICATE:
+      {
+        // Evaluate all the consecutive predicates in one pass
+        size_t last = s + 1;
+        while (last < stages_.size () && stages_[last].kind == Stage::PREDICATE)
+          ++last;
+        applyPredicates (*cloud, *indices, s, last);
+        all_points = all_points && indices->size () == cloud->points.size ();
+        s = last;
+        continue;
+      }
+      case Stage::INDICES:
+      {
+        IndicesPtr passed (new std::vector<int>);
+        stage.filter_indices->setInputCloud (cloud);
+        stage.filter_indices->setIndices (indices);
+        stage.filter_indices->filter (*passed);
+        indices = passed;
+        all_points = false;
+        break;
+      }
+      case Stage::CLOUD:
+      {
+        PointCloudConstPtr stage_input = cloud;
+        IndicesPtr stage_indices = indices;
+        if (!stage.restrict_to_indices && !all_points)
+        {
+          PointCloudPtr copy (new PointCloud);
+          pcl::copyPointCloud (*cloud, *indices, *copy);
+          stage_input = copy;
+          stage_indices.reset (new std::vector<int> (copy->points.size ()));
+          for (size_t i = 0; i < stage_indices->size (); ++i)
+            (*stage_indices)[i] = static_cast<int> (i);
+        }
+        stage.filter->setInputCloud (stage_input);
+        stage.filter->setIndices (stage_indices);
+
+        // The last stage writes the final output directly
+        if (s + 1 == stages_.size ())
+        {
+          stage.filter->filter (output);
+          return;
+        }
+
+        PointCloudPtr stage_output (new PointCloud);
+        stage.filter->filter (*stage_output);
+        cloud = stage_output;
+        indices.reset (new std::vector<int> (cloud->points.size ()));
+        for (size_t i = 0; i < indices->size (); ++i)
+          (*indices)[i] = static_cast<int> (i);
+        all_points = true;
+        break;
+      }
+    }
+    ++s;
+  }
+
+  // Materialize the points that passed all the stages
+  pcl::copyPointCloud (*cloud, *indices, output);
+}
+
+#define PCL_INSTANTIATE_FilterChain(T) template class PCL_EXPORTS pcl::FilterChain<T>;
+
+#endif    // PCL_FILTERS_IMPL_FILTER_CHAIN_H_
@@ -40,6 +40,57 @@
 
 #include <pcl/filters/radius_outlier_removal.h>
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Count the neighbors of every query point within a given radius, the point itself included. The
+      * counts are bounded to \a max_nn, so that the search can stop as soon as a point is known to have enough
+      * neighbors. The neighbors are searched for in blocks of queries with the batch search of \a tree, which
+      * bounds the memory used by the results. Query points with invalid coordinates get a count of 0.
+      * \param[in] tree the spatial locator, set up with \a cloud as input
+      * \param[in] cloud the input point cloud
+      * \param[in] indices the indices of the query points in \a cloud
+      * \param[in] radius the search radius
+      * \param[in] max_nn the maximum number of neighbors to count for a point (at least 1)
+      * \param[out] nr_neighbors the number of neighbors of every query point
+      * \param[in] nr_threads the number of threads to use
+      */
+    template <typename PointT> void
+    countRadiusNeighbors (const pcl::search::Search<PointT> &tree, const pcl::PointCloud<PointT> &cloud,
+                          const std::vector<int> &indices, double radius, unsigned int max_nn,
+                          std::vector<int> &nr_neighbors, unsigned int nr_threads)
+    {
+      nr_neighbors.assign (indices.size (), 0);
+      const int block_size = 16384;
+      std::vector<int> queries, query_positions;
+      std::vector<int> nn_indices, nn_offsets;
+      std::vector<float> nn_dists;
+      for (int block_begin = 0; block_begin < static_cast<int> (indices.size ()); block_begin += block_size)
+      {
+        int block_end = std::min (block_begin + block_size, static_cast<int> (indices.size ()));
+        queries.clear ();
+        query_positions.clear ();
+        for (int cp = block_begin; cp < block_end; ++cp)
+        {
+          const PointT &point = cloud.points[indices[cp]];
+          if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+            continue;
+          queries.push_back (indices[cp]);
+          query_positions.push_back (cp);
+        }
+        // An empty list of queries would stand for the whole cloud
+        if (queries.empty ())
+          continue;
+        tree.batchRadiusSearch (cloud, queries, radius, nn_indices, nn_dists, nn_offsets, max_nn, nr_threads);
+
+        for (int q = 0; q < static_cast<int> (queries.size ()); ++q)
+          nr_neighbors[query_positions[q]] = nn_offsets[q + 1] - nn_offsets[q];
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::RadiusOutlierRemoval<PointT>::applyFilter (PointCloud &output)
@@ -63,9 +114,11 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilter (PointCloud &output)
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_);
 
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
+  // Count the neighbors of every point. A point needs no more than min_pts_radius_ neighbors to be kept, so the
+  // search for its neighbors can stop there
+  std::vector<int> nr_neighbors;
+  pcl::detail::countRadiusNeighbors (*tree_, *input_, *indices_, search_radius_,
+                                     static_cast<unsigned int> (std::max (min_pts_radius_, 1)), nr_neighbors, threads_);
 
 
   output.points.resize (input_->points.size ());      // reserve enough space
@@ -77,9 +130,8 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilter (PointCloud &output)
   // Go over all the points and check which doesn't have enough neighbors
   for (int cp = 0; cp < static_cast<int>(indices_->size ()); ++cp)
   {
-    int k = tree_->radiusSearch ((*indices_)[cp], search_radius_, nn_indices, nn_dists);
     // Check if the number of neighbors is larger than the user imposed limit
-    if (k < min_pts_radius_)
+    if (nr_neighbors[cp] < min_pts_radius_)
     {
       if (extract_removed_indices_)
       {
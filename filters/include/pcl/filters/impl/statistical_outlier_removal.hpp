@@ -40,6 +40,75 @@
 
 #include <pcl/filters/statistical_outlier_removal.h>
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Compute the mean distance of every query point to its k nearest neighbors (the point itself
+      * excluded). The neighbors are searched for in blocks of queries with the batch search of \a tree, which
+      * bounds the memory used by the results. Query points with invalid coordinates get a mean distance of 0.
+      * \param[in] tree the spatial locator, set up with \a cloud as input
+      * \param[in] cloud the input point cloud
+      * \param[in] indices the indices of the query points in \a cloud
+      * \param[in] mean_k the number of neighbors (including the query point) to search for
+      * \param[out] distances the mean distance of every query point to its neighbors
+      * \param[in] nr_threads the number of threads to use
+      * \return the number of query points for which the search failed
+      */
+    template <typename PointT> int
+    computeMeanNeighborDistances (const pcl::search::Search<PointT> &tree, const pcl::PointCloud<PointT> &cloud,
+                                  const std::vector<int> &indices, int mean_k, std::vector<float> &distances,
+                                  unsigned int nr_threads)
+    {
+      distances.assign (indices.size (), 0.0f);
+      int nr_failed = 0;
+      const int block_size = 16384;
+      std::vector<int> queries, query_positions;
+      std::vector<int> nn_indices;
+      std::vector<float> nn_dists;
+      for (int block_begin = 0; block_begin < static_cast<int> (indices.size ()); block_begin += block_size)
+      {
+        int block_end = std::min (block_begin + block_size, static_cast<int> (indices.size ()));
+        queries.clear ();
+        query_positions.clear ();
+        for (int cp = block_begin; cp < block_end; ++cp)
+        {
+          const PointT &point = cloud.points[indices[cp]];
+          if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+            continue;
+          queries.push_back (indices[cp]);
+          query_positions.push_back (cp);
+        }
+        // An empty list of queries would stand for the whole cloud
+        if (queries.empty ())
+          continue;
+        tree.batchNearestKSearch (cloud, queries, mean_k, nn_indices, nn_dists, nr_threads);
+
+#pragma omp parallel for schedule (static) num_threads (nr_threads) reduction (+:nr_failed)
+        for (int q = 0; q < static_cast<int> (queries.size ()); ++q)
+        {
+          // Missing neighbors are padded with -1
+          int nr_found = 0;
+          while (nr_found < mean_k && nn_indices[q * mean_k + nr_found] != -1)
+            ++nr_found;
+          if (nr_found == 0)
+          {
+            ++nr_failed;
+            continue;
+          }
+
+          // Minimum distance (if mean_k == 2) or mean distance
+          double dist_sum = 0;
+          for (int j = 1; j < nr_found; ++j)
+            dist_sum += sqrt (nn_dists[q * mean_k + j]);
+          distances[query_positions[q]] = static_cast<float> (dist_sum / std::max (mean_k - 1, 1));
+        }
+      }
+      return (nr_failed);
+    }
+  }
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -72,35 +141,12 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilter (PointCloud &output)
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_);
 
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (mean_k_);
-  std::vector<float> nn_dists (mean_k_);
-
-  std::vector<float> distances (indices_->size ());
   // Go over all the points and calculate the mean or smallest distance
-  for (size_t cp = 0; cp < indices_->size (); ++cp)
-  {
-    if (!pcl_isfinite (input_->points[(*indices_)[cp]].x) ||
-        !pcl_isfinite (input_->points[(*indices_)[cp]].y) ||
-        !pcl_isfinite (input_->points[(*indices_)[cp]].z))
-    {
-      distances[cp] = 0;
-      continue;
-    }
-
-    if (tree_->nearestKSearch ((*indices_)[cp], mean_k_, nn_indices, nn_dists) == 0)
-    {
-      distances[cp] = 0;
-      PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
-      continue;
-    }
-
-    // Minimum distance (if mean_k_ == 2) or mean distance
-    double dist_sum = 0;
-    for (int j = 1; j < mean_k_; ++j)
-      dist_sum += sqrt (nn_dists[j]);
-    distances[cp] = static_cast<float> (dist_sum / (mean_k_ - 1));
-  }
+  std::vector<float> distances;
+  int nr_failed = pcl::detail::computeMeanNeighborDistances (*tree_, *input_, *indices_, mean_k_, distances, threads_);
+  if (nr_failed > 0)
+    PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed for %d points.\n",
+              getClassName ().c_str (), mean_k_, nr_failed);
 
   // Estimate the mean and the standard deviation of the distance vector
   double mean, stddev;
@@ -40,6 +40,7 @@
 
 #include <pcl/common/common.h>
 #include <pcl/filters/voxel_grid.h>
+#include <limits>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -119,15 +120,105 @@ pcl::getMinMax3D (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
   max_pt = max_p;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::getMinMax3D (const typename pcl::PointCloud<PointT>::ConstPtr &cloud, const std::vector<int> &indices,
+                  const std::string &distance_field_name, float min_distance, float max_distance,
+                  Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt, bool limit_negative)
+{
+  Eigen::Array4f min_p, max_p;
+  min_p.setConstant (FLT_MAX);
+  max_p.setConstant (-FLT_MAX);
+
+  // Get the fields list and the distance field index
+  std::vector<sensor_msgs::PointField> fields;
+  int distance_idx = pcl::getFieldIndex (*cloud, distance_field_name, fields);
+
+  float distance_value;
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    const PointT &point = cloud->points[indices[i]];
+
+    // Get the distance value
+    const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&point);
+    memcpy (&distance_value, pt_data + fields[distance_idx].offset, sizeof (float));
+
+    if (limit_negative)
+    {
+      // Use a threshold for cutting out points which inside the interval
+      if ((distance_value < max_distance) && (distance_value > min_distance))
+        continue;
+    }
+    else
+    {
+      // Use a threshold for cutting out points which are too close/far away
+      if ((distance_value > max_distance) || (distance_value < min_distance))
+        continue;
+    }
+
+    // Check if the point is invalid (if dense, no need to check for NaNs)
+    if (!cloud->is_dense &&
+        (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z)))
+      continue;
+
+    // Create the point structure and get the min/max
+    pcl::Array4fMapConst pt = point.getArray4fMap ();
+    min_p = min_p.min (pt);
+    max_p = max_p.max (pt);
+  }
+  min_pt = min_p;
+  max_pt = max_p;
+}
+
 struct cloud_point_index_idx 
 {
-  unsigned int idx;
+  uint64_t idx;
   unsigned int cloud_point_index;
 
-  cloud_point_index_idx (unsigned int idx_, unsigned int cloud_point_index_) : idx (idx_), cloud_point_index (cloud_point_index_) {}
+  cloud_point_index_idx () : idx (0), cloud_point_index (0) {}
+  cloud_point_index_idx (uint64_t idx_, unsigned int cloud_point_index_) : idx (idx_), cloud_point_index (cloud_point_index_) {}
   bool operator < (const cloud_point_index_idx &p) const { return (idx < p.idx); }
 };
 
+/** \brief Leaf index given to the points that are discarded during the first pass of VoxelGrid. */
+const uint64_t invalid_leaf_idx = std::numeric_limits<uint64_t>::max ();
+
+/** \brief Remove the discarded points (leaf index \a invalid_leaf_idx) from index_vector, keeping the order. */
+inline void
+removeInvalidLeafIndices (std::vector<cloud_point_index_idx> &index_vector)
+{
+  size_t nr_valid = 0;
+  for (size_t cp = 0; cp < index_vector.size (); ++cp)
+    if (index_vector[cp].idx != invalid_leaf_idx)
+      index_vector[nr_valid++] = index_vector[cp];
+  index_vector.resize (nr_valid);
+}
+
+/** \brief Sort index_vector by leaf index in linear time, using a LSD radix sort over the bytes of the leaf
+  * indices. Bytes above the largest leaf index are skipped, so small grids need only 2 or 3 passes. The sort
+  * is stable: the points of a leaf stay in input order, which makes the centroids independent of the sort.
+  */
+inline void
+radixSortLeafIndices (std::vector<cloud_point_index_idx> &index_vector)
+{
+  uint64_t max_idx = 0;
+  for (size_t cp = 0; cp < index_vector.size (); ++cp)
+    max_idx = std::max (max_idx, index_vector[cp].idx);
+
+  std::vector<cloud_point_index_idx> buffer (index_vector.size ());
+  for (int shift = 0; shift < 64 && (max_idx >> shift) != 0; shift += 8)
+  {
+    size_t bucket_begin[257] = {0};
+    for (size_t cp = 0; cp < index_vector.size (); ++cp)
+      ++bucket_begin[((index_vector[cp].idx >> shift) & 0xff) + 1];
+    for (int b = 0; b < 256; ++b)
+      bucket_begin[b + 1] += bucket_begin[b];
+    for (size_t cp = 0; cp < index_vector.size (); ++cp)
+      buffer[bucket_begin[(index_vector[cp].idx >> shift) & 0xff]++] = index_vector[cp];
+    index_vector.swap (buffer);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
@@ -148,24 +239,57 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   Eigen::Vector4f min_p, max_p;
   // Get the minimum and maximum dimensions
   if (!filter_field_name_.empty ()) // If we don't want to process the entire cloud...
-    getMinMax3D<PointT>(input_, filter_field_name_, static_cast<float> (filter_limit_min_), static_cast<float> (filter_limit_max_), min_p, max_p, filter_limit_negative_);
+    getMinMax3D<PointT>(input_, *indices_, filter_field_name_, static_cast<float> (filter_limit_min_), static_cast<float> (filter_limit_max_), min_p, max_p, filter_limit_negative_);
   else
-    getMinMax3D<PointT>(*input_, min_p, max_p);
+    getMinMax3D<PointT>(*input_, *indices_, min_p, max_p);
 
-  // Compute the minimum and maximum bounding box values
-  min_b_[0] = static_cast<int> (floor (min_p[0] * inverse_leaf_size_[0]));
-  max_b_[0] = static_cast<int> (floor (max_p[0] * inverse_leaf_size_[0]));
-  min_b_[1] = static_cast<int> (floor (min_p[1] * inverse_leaf_size_[1]));
-  max_b_[1] = static_cast<int> (floor (max_p[1] * inverse_leaf_size_[1]));
-  min_b_[2] = static_cast<int> (floor (min_p[2] * inverse_leaf_size_[2]));
-  max_b_[2] = static_cast<int> (floor (max_p[2] * inverse_leaf_size_[2]));
+  // Compute the minimum and maximum bounding box values. The grid coordinates are integers, so the bounding box 
+  // must not span more leaves than an int can count along any axis.
+  for (int d = 0; d < 3; ++d)
+  {
+    double min_bd = floor (static_cast<double> (min_p[d]) * inverse_leaf_size_[d]);
+    double max_bd = floor (static_cast<double> (max_p[d]) * inverse_leaf_size_[d]);
+    if (min_bd < std::numeric_limits<int>::min () || max_bd > std::numeric_limits<int>::max () || 
+        max_bd - min_bd + 1 > std::numeric_limits<int>::max ())
+    {
+      PCL_WARN ("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName ().c_str ());
+      output.width = output.height = 0;
+      output.points.clear ();
+      return;
+    }
+    min_b_[d] = static_cast<int> (min_bd);
+    max_b_[d] = static_cast<int> (max_bd);
+  }
 
   // Compute the number of divisions needed along all axis
   div_b_ = max_b_ - min_b_ + Eigen::Vector4i::Ones ();
   div_b_[3] = 0;
 
-  // Set up the division multiplier
-  divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  // The leaf indices are computed on 64 bits, so that large bounding boxes do not overflow
+  if (static_cast<double> (div_b_[0]) * static_cast<double> (div_b_[1]) * static_cast<double> (div_b_[2]) >= 
+      static_cast<double> (invalid_leaf_idx))
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName ().c_str ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+  uint64_t leaf_mul_y = static_cast<uint64_t> (div_b_[0]);
+  uint64_t leaf_mul_z = static_cast<uint64_t> (div_b_[0]) * static_cast<uint64_t> (div_b_[1]);
+
+  // The leaf layout is indexed with integers by getCentroidIndexAt, getNeighborCentroidIndices, etc. It is only 
+  // saved, and the division multiplier only set, when every leaf index fits in an int.
+  bool save_leaf_layout = save_leaf_layout_;
+  if (leaf_mul_z * static_cast<uint64_t> (div_b_[2]) <= static_cast<uint64_t> (std::numeric_limits<int>::max ()))
+    divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  else
+  {
+    divb_mul_.setZero ();
+    leaf_layout_.clear ();
+    if (save_leaf_layout)
+      PCL_WARN ("[pcl::%s::applyFilter] Too many leaves to index the leaf layout with integers. The leaf layout is not saved.\n", getClassName ().c_str ());
+    save_leaf_layout = false;
+  }
 
   int centroid_size = 4;
   if (downsample_all_data_)
@@ -183,8 +307,9 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
     centroid_size += 3;
   }
 
-  std::vector<cloud_point_index_idx> index_vector;
-  index_vector.reserve(input_->points.size());
+  // Every point gets a slot, so that the first pass can run in parallel. Discarded points are removed afterwards.
+  int nr_points = static_cast<int> (indices_->size ());
+  std::vector<cloud_point_index_idx> index_vector (nr_points);
 
   // If we don't want to process the entire cloud, but rather filter points far away from the viewpoint first...
   if (!filter_field_name_.empty ())
@@ -198,17 +323,20 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
     // First pass: go over all points and insert them into the index_vector vector
     // with calculated idx. Points with the same idx value will contribute to the
     // same point of resulting CloudPoint
-    for (unsigned int cp = 0; cp < static_cast<unsigned int> (input_->points.size ()); ++cp)
+#pragma omp parallel for num_threads (threads_)
+    for (int cp = 0; cp < nr_points; ++cp)
     {
+      const int pi = (*indices_)[cp];
+      index_vector[cp] = cloud_point_index_idx (invalid_leaf_idx, pi);
       if (!input_->is_dense)
         // Check if the point is invalid
-        if (!pcl_isfinite (input_->points[cp].x) || 
-            !pcl_isfinite (input_->points[cp].y) || 
-            !pcl_isfinite (input_->points[cp].z))
+        if (!pcl_isfinite (input_->points[pi].x) || 
+            !pcl_isfinite (input_->points[pi].y) || 
+            !pcl_isfinite (input_->points[pi].z))
           continue;
 
       // Get the distance value
-      const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&input_->points[cp]);
+      const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&input_->points[pi]);
       float distance_value = 0;
       memcpy (&distance_value, pt_data + fields[distance_idx].offset, sizeof (float));
 
@@ -225,13 +353,12 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
           continue;
       }
       
-      int ijk0 = static_cast<int> (floor (input_->points[cp].x * inverse_leaf_size_[0]) - min_b_[0]);
-      int ijk1 = static_cast<int> (floor (input_->points[cp].y * inverse_leaf_size_[1]) - min_b_[1]);
-      int ijk2 = static_cast<int> (floor (input_->points[cp].z * inverse_leaf_size_[2]) - min_b_[2]);
+      int ijk0 = static_cast<int> (floor (input_->points[pi].x * inverse_leaf_size_[0]) - min_b_[0]);
+      int ijk1 = static_cast<int> (floor (input_->points[pi].y * inverse_leaf_size_[1]) - min_b_[1]);
+      int ijk2 = static_cast<int> (floor (input_->points[pi].z * inverse_leaf_size_[2]) - min_b_[2]);
 
       // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.push_back (cloud_point_index_idx (static_cast<unsigned int> (idx), cp));
+      index_vector[cp].idx = ijk0 + ijk1 * leaf_mul_y + ijk2 * leaf_mul_z;
     }
   }
   // No distance filtering, process all data
@@ -240,49 +367,54 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
     // First pass: go over all points and insert them into the index_vector vector
     // with calculated idx. Points with the same idx value will contribute to the
     // same point of resulting CloudPoint
-    for (unsigned int cp = 0; cp < static_cast<unsigned int> (input_->points.size ()); ++cp)
+#pragma omp parallel for num_threads (threads_)
+    for (int cp = 0; cp < nr_points; ++cp)
     {
+      const int pi = (*indices_)[cp];
+      index_vector[cp] = cloud_point_index_idx (invalid_leaf_idx, pi);
       if (!input_->is_dense)
         // Check if the point is invalid
-        if (!pcl_isfinite (input_->points[cp].x) || 
-            !pcl_isfinite (input_->points[cp].y) || 
-            !pcl_isfinite (input_->points[cp].z))
+        if (!pcl_isfinite (input_->points[pi].x) || 
+            !pcl_isfinite (input_->points[pi].y) || 
+            !pcl_isfinite (input_->points[pi].z))
           continue;
 
-      int ijk0 = static_cast<int> (floor (input_->points[cp].x * inverse_leaf_size_[0]) - min_b_[0]);
-      int ijk1 = static_cast<int> (floor (input_->points[cp].y * inverse_leaf_size_[1]) - min_b_[1]);
-      int ijk2 = static_cast<int> (floor (input_->points[cp].z * inverse_leaf_size_[2]) - min_b_[2]);
+      int ijk0 = static_cast<int> (floor (input_->points[pi].x * inverse_leaf_size_[0]) - min_b_[0]);
+      int ijk1 = static_cast<int> (floor (input_->points[pi].y * inverse_leaf_size_[1]) - min_b_[1]);
+      int ijk2 = static_cast<int> (floor (input_->points[pi].z * inverse_leaf_size_[2]) - min_b_[2]);
 
       // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.push_back (cloud_point_index_idx (static_cast<unsigned int> (idx), cp));
+      index_vector[cp].idx = ijk0 + ijk1 * leaf_mul_y + ijk2 * leaf_mul_z;
     }
   }
+  removeInvalidLeafIndices (index_vector);
 
   // Second pass: sort the index_vector vector using value representing target cell as index
   // in effect all points belonging to the same output cell will be next to each other
-  std::sort (index_vector.begin (), index_vector.end (), std::less<cloud_point_index_idx> ());
+  radixSortLeafIndices (index_vector);
 
-  // Third pass: count output cells
+  // Third pass: find the first entry of each output cell
   // we need to skip all the same, adjacenent idx values
-  unsigned int total = 0;
-  unsigned int index = 0;
-  while (index < index_vector.size ()) 
+  std::vector<unsigned int> first_index;
+  unsigned int cp = 0;
+  while (cp < index_vector.size ()) 
   {
-    unsigned int i = index + 1;
-    while (i < index_vector.size () && index_vector[i].idx == index_vector[index].idx) 
+    first_index.push_back (cp);
+    unsigned int i = cp + 1;
+    while (i < index_vector.size () && index_vector[i].idx == index_vector[cp].idx) 
       ++i;
-    ++total;
-    index = i;
+    cp = i;
   }
+  int total = static_cast<int> (first_index.size ());
+  first_index.push_back (static_cast<unsigned int> (index_vector.size ()));
 
   // Fourth pass: compute centroids, insert them into their final position
   output.points.resize (total);
-  if (save_leaf_layout_)
+  if (save_leaf_layout)
   {
     try
     {
-      leaf_layout_.resize (div_b_[0]*div_b_[1]*div_b_[2], -1);
+      leaf_layout_.resize (leaf_mul_z * div_b_[2], -1);
     }
     catch (std::bad_alloc&)
     {
@@ -296,42 +428,24 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
     }
   }
   
-  index = 0;
-  Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
-  Eigen::VectorXf temporary = Eigen::VectorXf::Zero (centroid_size);
-
-  for (unsigned int cp = 0; cp < index_vector.size ();)
+  // Cells are independent, and each one writes only its own output point
+#pragma omp parallel num_threads (threads_)
   {
-    // calculate centroid - sum values from all input points, that have the same idx value in index_vector array
-    if (!downsample_all_data_) 
-    {
-      centroid[0] = input_->points[index_vector[cp].cloud_point_index].x;
-      centroid[1] = input_->points[index_vector[cp].cloud_point_index].y;
-      centroid[2] = input_->points[index_vector[cp].cloud_point_index].z;
-    }
-    else 
-    {
-      // ---[ RGB special case
-      if (rgba_index >= 0)
-      {
-        // Fill r/g/b data, assuming that the order is BGRA
-        pcl::RGB rgb;
-        memcpy (&rgb, reinterpret_cast<const char*> (&input_->points[index_vector[cp].cloud_point_index]) + rgba_index, sizeof (RGB));
-        centroid[centroid_size-3] = rgb.r;
-        centroid[centroid_size-2] = rgb.g;
-        centroid[centroid_size-1] = rgb.b;
-      }
-      pcl::for_each_type <FieldList> (NdCopyPointEigenFunctor <PointT> (input_->points[index_vector[cp].cloud_point_index], centroid));
-    }
+    Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
+    Eigen::VectorXf temporary = Eigen::VectorXf::Zero (centroid_size);
 
-    unsigned int i = cp + 1;
-    while (i < index_vector.size () && index_vector[i].idx == index_vector[cp].idx) 
+#pragma omp for schedule (static)
+    for (int index = 0; index < total; ++index)
     {
+      unsigned int cp = first_index[index];
+      unsigned int cell_end = first_index[index + 1];
+
+      // calculate centroid - sum values from all input points, that have the same idx value in index_vector array
       if (!downsample_all_data_) 
       {
-        centroid[0] += input_->points[index_vector[i].cloud_point_index].x;
-        centroid[1] += input_->points[index_vector[i].cloud_point_index].y;
-        centroid[2] += input_->points[index_vector[i].cloud_point_index].z;
+        centroid[0] = input_->points[index_vector[cp].cloud_point_index].x;
+        centroid[1] = input_->points[index_vector[cp].cloud_point_index].y;
+        centroid[2] = input_->points[index_vector[cp].cloud_point_index].z;
       }
       else 
       {
@@ -340,51 +454,73 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
         {
           // Fill r/g/b data, assuming that the order is BGRA
           pcl::RGB rgb;
-          memcpy (&rgb, reinterpret_cast<const char*> (&input_->points[index_vector[i].cloud_point_index]) + rgba_index, sizeof (RGB));
-          temporary[centroid_size-3] = rgb.r;
-          temporary[centroid_size-2] = rgb.g;
-          temporary[centroid_size-1] = rgb.b;
+          memcpy (&rgb, reinterpret_cast<const char*> (&input_->points[index_vector[cp].cloud_point_index]) + rgba_index, sizeof (RGB));
+          centroid[centroid_size-3] = rgb.r;
+          centroid[centroid_size-2] = rgb.g;
+          centroid[centroid_size-1] = rgb.b;
         }
-        pcl::for_each_type <FieldList> (NdCopyPointEigenFunctor <PointT> (input_->points[index_vector[i].cloud_point_index], temporary));
-        centroid += temporary;
+        pcl::for_each_type <FieldList> (NdCopyPointEigenFunctor <PointT> (input_->points[index_vector[cp].cloud_point_index], centroid));
       }
-      ++i;
-    }
 
-    // index is centroid final position in resulting PointCloud
-    if (save_leaf_layout_)
-      leaf_layout_[index_vector[cp].idx] = index;
+      for (unsigned int i = cp + 1; i < cell_end; ++i)
+      {
+        if (!downsample_all_data_) 
+        {
+          centroid[0] += input_->points[index_vector[i].cloud_point_index].x;
+          centroid[1] += input_->points[index_vector[i].cloud_point_index].y;
+          centroid[2] += input_->points[index_vector[i].cloud_point_index].z;
+        }
+        else 
+        {
+          // ---[ RGB special case
+          if (rgba_index >= 0)
+          {
+            // Fill r/g/b data, assuming that the order is BGRA
+            pcl::RGB rgb;
+            memcpy (&rgb, reinterpret_cast<const char*> (&input_->points[index_vector[i].cloud_point_index]) + rgba_index, sizeof (RGB));
+            temporary[centroid_size-3] = rgb.r;
+            temporary[centroid_size-2] = rgb.g;
+            temporary[centroid_size-1] = rgb.b;
+          }
+          pcl::for_each_type <FieldList> (NdCopyPointEigenFunctor <PointT> (input_->points[index_vector[i].cloud_point_index], temporary));
+          centroid += temporary;
+        }
+      }
 
-    centroid /= static_cast<float> (i - cp);
+      // index is centroid final position in resulting PointCloud
+      if (save_leaf_layout)
+        leaf_layout_[index_vector[cp].idx] = index;
 
-    // store centroid
-    // Do we need to process all the fields?
-    if (!downsample_all_data_) 
-    {
-      output.points[index].x = centroid[0];
-      output.points[index].y = centroid[1];
-      output.points[index].z = centroid[2];
-    }
-    else 
-    {
-      pcl::for_each_type<FieldList> (pcl::NdCopyEigenPointFunctor <PointT> (centroid, output.points[index]));
-      // ---[ RGB special case
-      if (rgba_index >= 0) 
+      centroid /= static_cast<float> (cell_end - cp);
+
+      // store centroid
+      // Do we need to process all the fields?
+      if (!downsample_all_data_) 
+      {
+        output.points[index].x = centroid[0];
+        output.points[index].y = centroid[1];
+        output.points[index].z = centroid[2];
+      }
+      else 
       {
-        // pack r/g/b into rgb
-        float r = centroid[centroid_size-3], g = centroid[centroid_size-2], b = centroid[centroid_size-1];
-        int rgb = (static_cast<int> (r) << 16) | (static_cast<int> (g) << 8) | static_cast<int> (b);
-        memcpy (reinterpret_cast<char*> (&output.points[index]) + rgba_index, &rgb, sizeof (float));
+        pcl::for_each_type<FieldList> (pcl::NdCopyEigenPointFunctor <PointT> (centroid, output.points[index]));
+        // ---[ RGB special case
+        if (rgba_index >= 0) 
+        {
+          // pack r/g/b into rgb
+          float r = centroid[centroid_size-3], g = centroid[centroid_size-2], b = centroid[centroid_size-1];
+          int rgb = (static_cast<int> (r) << 16) | (static_cast<int> (g) << 8) | static_cast<int> (b);
+          memcpy (reinterpret_cast<char*> (&output.points[index]) + rgba_index, &rgb, sizeof (float));
+        }
       }
     }
-    cp = i;
-    ++index;
   }
   output.width = static_cast<uint32_t> (output.points.size ());
 }
 
 #define PCL_INSTANTIATE_VoxelGrid(T) template class PCL_EXPORTS pcl::VoxelGrid<T>;
-#define PCL_INSTANTIATE_getMinMax3D(T) template PCL_EXPORTS void pcl::getMinMax3D<T> (const pcl::PointCloud<T>::ConstPtr &, const std::string &, float, float, Eigen::Vector4f &, Eigen::Vector4f &, bool);
+#define PCL_INSTANTIATE_getMinMax3D(T) template PCL_EXPORTS void pcl::getMinMax3D<T> (const pcl::PointCloud<T>::ConstPtr &, const std::string &, float, float, Eigen::Vector4f &, Eigen::Vector4f &, bool); \
+  template PCL_EXPORTS void pcl::getMinMax3D<T> (const pcl::PointCloud<T>::ConstPtr &, const std::vector<int> &, const std::string &, float, float, Eigen::Vector4f &, Eigen::Vector4f &, bool);
 
 #endif    // PCL_FILTERS_IMPL_VOXEL_GRID_H_
 
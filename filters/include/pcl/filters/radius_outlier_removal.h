@@ -72,7 +72,7 @@ namespace pcl
     public:
       /** \brief Empty constructor. */
       RadiusOutlierRemoval (bool extract_removed_indices = false) :
-        Filter<PointT>::Filter (extract_removed_indices), search_radius_ (0.0), min_pts_radius_ (1), tree_ ()
+        Filter<PointT>::Filter (extract_removed_indices), search_radius_ (0.0), min_pts_radius_ (1), tree_ (), threads_ (1)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -113,6 +113,18 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Set the number of threads used to count the neighbors of the points. The neighbors are counted
+        * in blocks of points with the batch search of the spatial locator, which for organized clouds uses a window
+        * in the image instead of a kd-tree. The output is the same for any number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to count the neighbors of the points. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The nearest neighbors search radius for each point. */
       double search_radius_;
@@ -125,6 +137,9 @@ namespace pcl
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Apply the filter
         * \param output the resultant point cloud message
         */
@@ -159,7 +174,7 @@ namespace pcl
       /** \brief Empty constructor. */
       RadiusOutlierRemoval (bool extract_removed_indices = false) :
         Filter<sensor_msgs::PointCloud2>::Filter (extract_removed_indices), 
-        search_radius_ (0.0), min_pts_radius_ (1), tree_ ()
+        search_radius_ (0.0), min_pts_radius_ (1), tree_ (), threads_ (1)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -199,6 +214,18 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Set the number of threads used to count the neighbors of the points. The neighbors are counted
+        * in blocks of points with the batch search of the spatial locator, which for organized clouds uses a window
+        * in the image instead of a kd-tree. The output is the same for any number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to count the neighbors of the points. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The nearest neighbors search radius for each point. */
       double search_radius_;
@@ -211,6 +238,9 @@ namespace pcl
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       void
       applyFilter (PointCloud2 &output);
   };
@@ -76,7 +76,7 @@ namespace pcl
     public:
       /** \brief Empty constructor. */
       StatisticalOutlierRemoval (bool extract_removed_indices = false) :
-        Filter<PointT>::Filter (extract_removed_indices), mean_k_ (2), std_mul_ (0.0), tree_ (), negative_ (false)
+        Filter<PointT>::Filter (extract_removed_indices), mean_k_ (2), std_mul_ (0.0), tree_ (), negative_ (false), threads_ (1)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
@@ -134,6 +134,19 @@ namespace pcl
         return (negative_);
       }
 
+      /** \brief Set the number of threads used to search for the nearest neighbors of the points. The
+        * neighborhoods are searched for in blocks of points with the batch search of the spatial locator, which for
+        * organized clouds uses a window in the image instead of a kd-tree. The output is the same for any number of
+        * threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to search for the nearest neighbors of the points. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The number of points to use for mean distance estimation. */
       int mean_k_;
@@ -148,6 +161,9 @@ namespace pcl
       /** \brief If true, the outliers will be returned instead of the inliers (default: false). */
       bool negative_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Apply the filter
         * \param output the resultant point cloud message
         */
@@ -185,7 +201,7 @@ namespace pcl
       /** \brief Empty constructor. */
       StatisticalOutlierRemoval (bool extract_removed_indices = false) :
         Filter<sensor_msgs::PointCloud2>::Filter (extract_removed_indices), mean_k_ (2), 
-        std_mul_ (0.0), tree_ (), negative_ (false)
+        std_mul_ (0.0), tree_ (), negative_ (false), threads_ (1)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
@@ -244,6 +260,19 @@ namespace pcl
         return (negative_);
       }
 
+      /** \brief Set the number of threads used to search for the nearest neighbors of the points. The
+        * neighborhoods are searched for in blocks of points with the batch search of the spatial locator, which for
+        * organized clouds uses a window in the image instead of a kd-tree. The output is the same for any number of
+        * threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to search for the nearest neighbors of the points. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The number of points to use for mean distance estimation. */
       int mean_k_;
@@ -259,6 +288,9 @@ namespace pcl
       /** \brief If true, the outliers will be returned instead of the inliers (default: false). */
       bool negative_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       void
       applyFilter (PointCloud2 &output);
   };
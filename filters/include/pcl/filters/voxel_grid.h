@@ -78,6 +78,40 @@ namespace pcl
                const std::string &distance_field_name, float min_distance, float max_distance, 
                Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt, bool limit_negative = false);
 
+  /** \brief Obtain the maximum and minimum points in 3D from a subset of a given point cloud.
+    * \param[in] cloud the pointer to a sensor_msgs::PointCloud2 dataset
+    * \param[in] indices the indices of the points to use from \a cloud
+    * \param[in] x_idx the index of the X channel
+    * \param[in] y_idx the index of the Y channel
+    * \param[in] z_idx the index of the Z channel
+    * \param[out] min_pt the minimum data point 
+    * \param[out] max_pt the maximum data point
+    */
+  PCL_EXPORTS void 
+  getMinMax3D (const sensor_msgs::PointCloud2ConstPtr &cloud, const std::vector<int> &indices, 
+               int x_idx, int y_idx, int z_idx, Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt);
+
+  /** \brief Obtain the maximum and minimum points in 3D from a subset of a given point cloud. 
+    * \note Performs internal data filtering as well.
+    * \param[in] cloud the pointer to a sensor_msgs::PointCloud2 dataset
+    * \param[in] indices the indices of the points to use from \a cloud
+    * \param[in] x_idx the index of the X channel
+    * \param[in] y_idx the index of the Y channel
+    * \param[in] z_idx the index of the Z channel
+    * \param[in] distance_field_name the name of the dimension to filter data along to
+    * \param[in] min_distance the minimum acceptable value in \a distance_field_name data
+    * \param[in] max_distance the maximum acceptable value in \a distance_field_name data
+    * \param[out] min_pt the minimum data point 
+    * \param[out] max_pt the maximum data point
+    * \param[in] limit_negative \b false if data \b inside of the [min_distance; max_distance] interval should be
+    * considered, \b true otherwise.
+    */
+  PCL_EXPORTS void 
+  getMinMax3D (const sensor_msgs::PointCloud2ConstPtr &cloud, const std::vector<int> &indices, 
+               int x_idx, int y_idx, int z_idx, 
+               const std::string &distance_field_name, float min_distance, float max_distance, 
+               Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt, bool limit_negative = false);
+
   /** \brief Get the relative cell indices of the "upper half" 13 neighbors.
     * \note Useful in combination with getNeighborCentroidIndices() from \ref VoxelGrid
     * \ingroup filters
@@ -145,6 +179,23 @@ namespace pcl
                const std::string &distance_field_name, float min_distance, float max_distance,
                Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt, bool limit_negative = false);
 
+  /** \brief Get the minimum and maximum values on each of the 3 (x-y-z) dimensions
+    * in a given pointcloud, without considering points outside of a distance threshold from the laser origin
+    * \param[in] cloud the point cloud data message
+    * \param[in] indices the vector of point indices to use from \a cloud
+    * \param[in] distance_field_name the field name that contains the distance values
+    * \param[in] min_distance the minimum distance a point will be considered from
+    * \param[in] max_distance the maximum distance a point will be considered to
+    * \param[out] min_pt the resultant minimum bounds
+    * \param[out] max_pt the resultant maximum bounds
+    * \param[in] limit_negative if set to true, then all points outside of the interval (min_distance;max_distace) are considered
+    * \ingroup filters
+    */
+  template <typename PointT> void 
+  getMinMax3D (const typename pcl::PointCloud<PointT>::ConstPtr &cloud, const std::vector<int> &indices,
+               const std::string &distance_field_name, float min_distance, float max_distance,
+               Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt, bool limit_negative = false);
+
   /** \brief VoxelGrid assembles a local 3D grid over a given PointCloud, and downsamples + filters the data.
     *
     * The VoxelGrid class creates a *3D voxel grid* (think about a voxel
@@ -154,6 +205,8 @@ namespace pcl
     * a bit slower than approximating them with the center of the voxel, but it
     * represents the underlying surface more accurately.
     *
+    * Only the points given through \a setIndices are downsampled.
+    *
     * \author Radu B. Rusu, Bastian Steder
     * \ingroup filters
     */
@@ -185,7 +238,8 @@ namespace pcl
         filter_field_name_ (""), 
         filter_limit_min_ (-FLT_MAX), 
         filter_limit_max_ (FLT_MAX),
-        filter_limit_negative_ (false)
+        filter_limit_negative_ (false),
+        threads_ (1)
       {
         filter_name_ = "VoxelGrid";
       }
@@ -241,7 +295,8 @@ namespace pcl
       inline bool 
       getDownsampleAllData () { return (downsample_all_data_); }
 
-      /** \brief Set to true if leaf layout information needs to be saved for later access.
+      /** \brief Set to true if leaf layout information needs to be saved for later access. The layout is not saved
+        * (and a warning is printed) if the grid has more leaves than an int can index.
         * \param[in] save_leaf_layout the new value (true/false)
         */
       inline void 
@@ -420,6 +475,18 @@ namespace pcl
         return (filter_limit_negative_);
       }
 
+      /** \brief Set the number of threads used to bin the points and to compute the centroids. The points are
+        * sorted into their leaves with a linear time radix sort, and each leaf is processed independently, so the
+        * output is the same for any number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to bin the points and to compute the centroids. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The size of a leaf. */
       Eigen::Vector4f leaf_size_;
@@ -451,6 +518,9 @@ namespace pcl
       /** \brief Set to true if we want to return the data outside (\a filter_limit_min_;\a filter_limit_max_). Default: false. */
       bool filter_limit_negative_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       typedef typename pcl::traits::fieldList<PointT>::type FieldList;
 
       /** \brief Downsample a Point Cloud using a voxelized grid approach
@@ -469,6 +539,8 @@ namespace pcl
     * a bit slower than approximating them with the center of the voxel, but it
     * represents the underlying surface more accurately.
     *
+    * Only the points given through \a setIndices are downsampled.
+    *
     * \author Radu B. Rusu, Bastian Steder, Radoslaw Cybulski
     * \ingroup filters
     */
@@ -497,7 +569,8 @@ namespace pcl
         filter_field_name_ (""), 
         filter_limit_min_ (-FLT_MAX), 
         filter_limit_max_ (FLT_MAX),
-        filter_limit_negative_ (false)
+        filter_limit_negative_ (false),
+        threads_ (1)
       {
         filter_name_ = "VoxelGrid";
       }
@@ -553,7 +626,8 @@ namespace pcl
       inline bool 
       getDownsampleAllData () { return (downsample_all_data_); }
 
-      /** \brief Set to true if leaf layout information needs to be saved for later access.
+      /** \brief Set to true if leaf layout information needs to be saved for later access. The layout is not saved
+        * (and a warning is printed) if the grid has more leaves than an int can index.
         * \param[in] save_leaf_layout the new value (true/false)
         */
       inline void 
@@ -754,6 +828,18 @@ namespace pcl
         return (filter_limit_negative_);
       }
 
+      /** \brief Set the number of threads used to bin the points and to compute the centroids. The points are
+        * sorted into their leaves with a linear time radix sort, and each leaf is processed independently, so the
+        * output is the same for any number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to bin the points and to compute the centroids. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The size of a leaf. */
       Eigen::Vector4f leaf_size_;
@@ -791,6 +877,9 @@ namespace pcl
       /** \brief Set to true if we want to return the data outside (\a filter_limit_min_;\a filter_limit_max_). Default: false. */
       bool filter_limit_negative_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Downsample a Point Cloud using a voxelized grid approach
         * \param[out] output the resultant point cloud
         */
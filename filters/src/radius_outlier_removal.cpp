@@ -76,9 +76,11 @@ pcl::RadiusOutlierRemoval<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &o
   }
   tree_->setInputCloud (cloud);
 
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
+  // Count the neighbors of every point. A point needs no more than min_pts_radius_ neighbors to be kept, so the
+  // search for its neighbors can stop there
+  std::vector<int> nr_neighbors;
+  pcl::detail::countRadiusNeighbors (*tree_, *cloud, *indices_, search_radius_,
+                                     static_cast<unsigned int> (std::max (min_pts_radius_, 1)), nr_neighbors, threads_);
 
   // Copy the common fields
   output.is_bigendian = input_->is_bigendian;
@@ -93,9 +95,8 @@ pcl::RadiusOutlierRemoval<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &o
   // Go over all the points and check which doesn't have enough neighbors
   for (int cp = 0; cp < static_cast<int> (indices_->size ()); ++cp)
   {
-    int k = tree_->radiusSearch ((*indices_)[cp], search_radius_, nn_indices, nn_dists);
     // Check if the number of neighbors is larger than the user imposed limit
-    if (k < min_pts_radius_)
+    if (nr_neighbors[cp] < min_pts_radius_)
     {
       if (extract_removed_indices_)
       {
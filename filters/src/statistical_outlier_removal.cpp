@@ -77,35 +77,12 @@ pcl::StatisticalOutlierRemoval<sensor_msgs::PointCloud2>::applyFilter (PointClou
 
   tree_->setInputCloud (cloud);
 
-  // Allocate enough space to hold the results
-  std::vector<int> nn_indices (mean_k_);
-  std::vector<float> nn_dists (mean_k_);
-
-  std::vector<float> distances (indices_->size ());
   // Go over all the points and calculate the mean or smallest distance
-  for (size_t cp = 0; cp < indices_->size (); ++cp)
-  {
-    if (!pcl_isfinite (cloud->points[(*indices_)[cp]].x) || !pcl_isfinite (cloud->points[(*indices_)[cp]].y)
-        ||
-        !pcl_isfinite (cloud->points[(*indices_)[cp]].z))
-    {
-      distances[cp] = 0;
-      continue;
-    }
-
-    if (tree_->nearestKSearch ((*indices_)[cp], mean_k_, nn_indices, nn_dists) == 0)
-    {
-      distances[cp] = 0;
-      PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
-      continue;
-    }
-
-    // Minimum distance (if mean_k_ == 2) or mean distance
-    double dist_sum = 0;
-    for (int j = 1; j < mean_k_; ++j)
-      dist_sum += sqrt (nn_dists[j]);
-    distances[cp] = static_cast<float> (dist_sum / (mean_k_ - 1));
-  }
+  std::vector<float> distances;
+  int nr_failed = pcl::detail::computeMeanNeighborDistances (*tree_, *cloud, *indices_, mean_k_, distances, threads_);
+  if (nr_failed > 0)
+    PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed for %d points.\n",
+              getClassName ().c_str (), mean_k_, nr_failed);
 
   // Estimate the mean and the standard deviation of the distance vector
   double mean, stddev;
@@ -170,6 +170,113 @@ pcl::getMinMax3D (const sensor_msgs::PointCloud2ConstPtr &cloud, int x_idx, int
   max_pt = max_p;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::getMinMax3D (const sensor_msgs::PointCloud2ConstPtr &cloud, const std::vector<int> &indices,
+                  int x_idx, int y_idx, int z_idx, Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt)
+{
+  // @todo fix this
+  if (cloud->fields[x_idx].datatype != sensor_msgs::PointField::FLOAT32 || 
+      cloud->fields[y_idx].datatype != sensor_msgs::PointField::FLOAT32 ||
+      cloud->fields[z_idx].datatype != sensor_msgs::PointField::FLOAT32)
+  {
+    PCL_ERROR ("[pcl::getMinMax3D] XYZ dimensions are not float type!\n");
+    return;
+  }
+
+  Eigen::Array4f min_p, max_p;
+  min_p.setConstant (FLT_MAX);
+  max_p.setConstant (-FLT_MAX);
+
+  Eigen::Array4f pt = Eigen::Array4f::Zero ();
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    int point_offset = indices[i] * cloud->point_step;
+
+    // Unoptimized memcpys: assume fields x, y, z are in random order
+    memcpy (&pt[0], &cloud->data[point_offset + cloud->fields[x_idx].offset], sizeof (float));
+    memcpy (&pt[1], &cloud->data[point_offset + cloud->fields[y_idx].offset], sizeof (float));
+    memcpy (&pt[2], &cloud->data[point_offset + cloud->fields[z_idx].offset], sizeof (float));
+    // Check if the point is invalid
+    if (!pcl_isfinite (pt[0]) || 
+        !pcl_isfinite (pt[1]) || 
+        !pcl_isfinite (pt[2]))
+      continue;
+    min_p = (min_p.min) (pt);
+    max_p = (max_p.max) (pt);
+  }
+  min_pt = min_p;
+  max_pt = max_p;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::getMinMax3D (const sensor_msgs::PointCloud2ConstPtr &cloud, const std::vector<int> &indices,
+                  int x_idx, int y_idx, int z_idx,
+                  const std::string &distance_field_name, float min_distance, float max_distance,
+                  Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt, bool limit_negative)
+{
+  // @todo fix this
+  if (cloud->fields[x_idx].datatype != sensor_msgs::PointField::FLOAT32 || 
+      cloud->fields[y_idx].datatype != sensor_msgs::PointField::FLOAT32 ||
+      cloud->fields[z_idx].datatype != sensor_msgs::PointField::FLOAT32)
+  {
+    PCL_ERROR ("[pcl::getMinMax3D] XYZ dimensions are not float type!\n");
+    return;
+  }
+
+  Eigen::Array4f min_p, max_p;
+  min_p.setConstant (FLT_MAX);
+  max_p.setConstant (-FLT_MAX);
+
+  // Get the distance field index
+  int distance_idx = pcl::getFieldIndex (*cloud, distance_field_name);
+
+  // @todo fix this
+  if (cloud->fields[distance_idx].datatype != sensor_msgs::PointField::FLOAT32)
+  {
+    PCL_ERROR ("[pcl::getMinMax3D] Filtering dimensions is not float type!\n");
+    return;
+  }
+
+  Eigen::Array4f pt = Eigen::Array4f::Zero ();
+  float distance_value = 0;
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    int point_offset = indices[i] * cloud->point_step;
+
+    // Get the distance value
+    memcpy (&distance_value, &cloud->data[point_offset + cloud->fields[distance_idx].offset], sizeof (float));
+
+    if (limit_negative)
+    {
+      // Use a threshold for cutting out points which inside the interval
+      if ((distance_value < max_distance) && (distance_value > min_distance))
+        continue;
+    }
+    else
+    {
+      // Use a threshold for cutting out points which are too close/far away
+      if ((distance_value > max_distance) || (distance_value < min_distance))
+        continue;
+    }
+
+    // Unoptimized memcpys: assume fields x, y, z are in random order
+    memcpy (&pt[0], &cloud->data[point_offset + cloud->fields[x_idx].offset], sizeof (float));
+    memcpy (&pt[1], &cloud->data[point_offset + cloud->fields[y_idx].offset], sizeof (float));
+    memcpy (&pt[2], &cloud->data[point_offset + cloud->fields[z_idx].offset], sizeof (float));
+    // Check if the point is invalid
+    if (!pcl_isfinite (pt[0]) || 
+        !pcl_isfinite (pt[1]) || 
+        !pcl_isfinite (pt[2]))
+      continue;
+    min_p = (min_p.min) (pt);
+    max_p = (max_p.max) (pt);
+  }
+  min_pt = min_p;
+  max_pt = max_p;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::VoxelGrid<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &output)
@@ -182,7 +289,8 @@ pcl::VoxelGrid<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &output)
     output.data.clear ();
     return;
   }
-  int nr_points  = input_->width * input_->height;
+  // Only the indexed points are downsampled
+  int nr_points = static_cast<int> (indices_->size ());
 
   // Copy the header (and thus the frame_id) + allocate enough space for points
   output.height         = 1;                    // downsampling breaks the organized structure
@@ -217,34 +325,68 @@ pcl::VoxelGrid<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &output)
   Eigen::Vector4f min_p, max_p;
   // Get the minimum and maximum dimensions
   if (!filter_field_name_.empty ()) // If we don't want to process the entire cloud...
-    getMinMax3D (input_, x_idx_, y_idx_, z_idx_, filter_field_name_, 
+    getMinMax3D (input_, *indices_, x_idx_, y_idx_, z_idx_, filter_field_name_, 
                  static_cast<float> (filter_limit_min_), 
                  static_cast<float> (filter_limit_max_), min_p, max_p, filter_limit_negative_);
   else
-    getMinMax3D (input_, x_idx_, y_idx_, z_idx_, min_p, max_p);
+    getMinMax3D (input_, *indices_, x_idx_, y_idx_, z_idx_, min_p, max_p);
 
-  // Compute the minimum and maximum bounding box values
-  min_b_[0] = static_cast<int> (floor (min_p[0] * inverse_leaf_size_[0]));
-  max_b_[0] = static_cast<int> (floor (max_p[0] * inverse_leaf_size_[0]));
-  min_b_[1] = static_cast<int> (floor (min_p[1] * inverse_leaf_size_[1]));
-  max_b_[1] = static_cast<int> (floor (max_p[1] * inverse_leaf_size_[1]));
-  min_b_[2] = static_cast<int> (floor (min_p[2] * inverse_leaf_size_[2]));
-  max_b_[2] = static_cast<int> (floor (max_p[2] * inverse_leaf_size_[2]));
+  // Compute the minimum and maximum bounding box values. The grid coordinates are integers, so the bounding box 
+  // must not span more leaves than an int can count along any axis.
+  for (int d = 0; d < 3; ++d)
+  {
+    double min_bd = floor (static_cast<double> (min_p[d]) * inverse_leaf_size_[d]);
+    double max_bd = floor (static_cast<double> (max_p[d]) * inverse_leaf_size_[d]);
+    if (min_bd < std::numeric_limits<int>::min () || max_bd > std::numeric_limits<int>::max () || 
+        max_bd - min_bd + 1 > std::numeric_limits<int>::max ())
+    {
+      PCL_WARN ("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName ().c_str ());
+      output.width = output.height = 0;
+      output.data.clear ();
+      return;
+    }
+    min_b_[d] = static_cast<int> (min_bd);
+    max_b_[d] = static_cast<int> (max_bd);
+  }
 
   // Compute the number of divisions needed along all axis
   div_b_ = max_b_ - min_b_ + Eigen::Vector4i::Ones ();
   div_b_[3] = 0;
 
-  std::vector<cloud_point_index_idx> index_vector;
-  index_vector.reserve (nr_points);
+  // The leaf indices are computed on 64 bits, so that large bounding boxes do not overflow
+  if (static_cast<double> (div_b_[0]) * static_cast<double> (div_b_[1]) * static_cast<double> (div_b_[2]) >= 
+      static_cast<double> (invalid_leaf_idx))
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName ().c_str ());
+    output.width = output.height = 0;
+    output.data.clear ();
+    return;
+  }
+  uint64_t leaf_mul_y = static_cast<uint64_t> (div_b_[0]);
+  uint64_t leaf_mul_z = static_cast<uint64_t> (div_b_[0]) * static_cast<uint64_t> (div_b_[1]);
+
+  // The leaf layout is indexed with integers by getCentroidIndexAt, getNeighborCentroidIndices, etc. It is only 
+  // saved, and the division multiplier only set, when every leaf index fits in an int.
+  bool save_leaf_layout = save_leaf_layout_;
+  if (leaf_mul_z * static_cast<uint64_t> (div_b_[2]) <= static_cast<uint64_t> (std::numeric_limits<int>::max ()))
+    divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  else
+  {
+    divb_mul_.setZero ();
+    leaf_layout_.clear ();
+    if (save_leaf_layout)
+      PCL_WARN ("[pcl::%s::applyFilter] Too many leaves to index the leaf layout with integers. The leaf layout is not saved.\n", getClassName ().c_str ());
+    save_leaf_layout = false;
+  }
+
+  // Every point gets a slot, so that the first pass can run in parallel. Discarded points are removed afterwards.
+  std::vector<cloud_point_index_idx> index_vector (nr_points);
 
-  // Create the first xyz_offset, and set up the division multiplier
+  // Set up the xyz offsets
   Eigen::Array4i xyz_offset (input_->fields[x_idx_].offset,
                              input_->fields[y_idx_].offset,
                              input_->fields[z_idx_].offset,
                              0);
-  divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
-  Eigen::Vector4f pt  = Eigen::Vector4f::Zero ();
 
   int centroid_size = 4;
   if (downsample_all_data_)
@@ -265,6 +407,7 @@ pcl::VoxelGrid<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &output)
   }
 
   // If we don't want to process the entire cloud, but rather filter points far away from the viewpoint first...
+  int distance_offset = -1;
   if (!filter_field_name_.empty ())
   {
     // Get the distance field index
@@ -278,117 +421,88 @@ pcl::VoxelGrid<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &output)
       output.data.clear ();
       return;
     }
+    distance_offset = input_->fields[distance_idx].offset;
+  }
+
+  // First pass: go over all points and insert them into the index_vector vector
+  // with calculated idx. Points with the same idx value will contribute to the
+  // same point of resulting CloudPoint
+#pragma omp parallel for num_threads (threads_)
+  for (int cp = 0; cp < nr_points; ++cp)
+  {
+    const int pi = (*indices_)[cp];
+    index_vector[cp] = cloud_point_index_idx (invalid_leaf_idx, pi);
+    int point_offset = pi * input_->point_step;
 
-    // First pass: go over all points and insert them into the index_vector vector
-    // with calculated idx. Points with the same idx value will contribute to the
-    // same point of resulting CloudPoint
-    float distance_value = 0;
-    for (int cp = 0; cp < nr_points; ++cp)
+    if (distance_offset >= 0)
     {
-      int point_offset = cp * input_->point_step;
       // Get the distance value
-      memcpy (&distance_value, &input_->data[point_offset + input_->fields[distance_idx].offset], sizeof (float));
+      float distance_value = 0;
+      memcpy (&distance_value, &input_->data[point_offset + distance_offset], sizeof (float));
 
       if (filter_limit_negative_)
       {
         // Use a threshold for cutting out points which inside the interval
         if (distance_value < filter_limit_max_ && distance_value > filter_limit_min_)
-        {
-          xyz_offset += input_->point_step;
           continue;
-        }
       }
       else
       {
         // Use a threshold for cutting out points which are too close/far away
         if (distance_value > filter_limit_max_ || distance_value < filter_limit_min_)
-        {
-          xyz_offset += input_->point_step;
           continue;
-        }
-      }
-
-      // Unoptimized memcpys: assume fields x, y, z are in random order
-      memcpy (&pt[0], &input_->data[xyz_offset[0]], sizeof (float));
-      memcpy (&pt[1], &input_->data[xyz_offset[1]], sizeof (float));
-      memcpy (&pt[2], &input_->data[xyz_offset[2]], sizeof (float));
-
-      // Check if the point is invalid
-      if (!pcl_isfinite (pt[0]) || 
-          !pcl_isfinite (pt[1]) || 
-          !pcl_isfinite (pt[2]))
-      {
-        xyz_offset += input_->point_step;
-        continue;
       }
+    }
 
-      int ijk0 = static_cast<int> (floor (pt[0] * inverse_leaf_size_[0]) - min_b_[0]);
-      int ijk1 = static_cast<int> (floor (pt[1] * inverse_leaf_size_[1]) - min_b_[1]);
-      int ijk2 = static_cast<int> (floor (pt[2] * inverse_leaf_size_[2]) - min_b_[2]);
-      // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.push_back (cloud_point_index_idx (idx, cp));
+    // Unoptimized memcpys: assume fields x, y, z are in random order
+    Eigen::Vector4f pt = Eigen::Vector4f::Zero ();
+    memcpy (&pt[0], &input_->data[point_offset + xyz_offset[0]], sizeof (float));
+    memcpy (&pt[1], &input_->data[point_offset + xyz_offset[1]], sizeof (float));
+    memcpy (&pt[2], &input_->data[point_offset + xyz_offset[2]], sizeof (float));
 
-      xyz_offset += input_->point_step;
-    }
-  }
-  // No distance filtering, process all data
-  else
-  {
-    // First pass: go over all points and insert them into the right leaf
-    for (int cp = 0; cp < nr_points; ++cp)
-    {
-      // Unoptimized memcpys: assume fields x, y, z are in random order
-      memcpy (&pt[0], &input_->data[xyz_offset[0]], sizeof (float));
-      memcpy (&pt[1], &input_->data[xyz_offset[1]], sizeof (float));
-      memcpy (&pt[2], &input_->data[xyz_offset[2]], sizeof (float));
-
-      // Check if the point is invalid
-      if (!pcl_isfinite (pt[0]) || 
-          !pcl_isfinite (pt[1]) || 
-          !pcl_isfinite (pt[2]))
-      {
-        xyz_offset += input_->point_step;
-        continue;
-      }
+    // Check if the point is invalid
+    if (!pcl_isfinite (pt[0]) || 
+        !pcl_isfinite (pt[1]) || 
+        !pcl_isfinite (pt[2]))
+      continue;
 
-      int ijk0 = static_cast<int> (floor (pt[0] * inverse_leaf_size_[0]) - min_b_[0]);
-      int ijk1 = static_cast<int> (floor (pt[1] * inverse_leaf_size_[1]) - min_b_[1]);
-      int ijk2 = static_cast<int> (floor (pt[2] * inverse_leaf_size_[2]) - min_b_[2]);
-      // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.push_back (cloud_point_index_idx (idx, cp));
-      xyz_offset += input_->point_step;
-    }
+    int ijk0 = static_cast<int> (floor (pt[0] * inverse_leaf_size_[0]) - min_b_[0]);
+    int ijk1 = static_cast<int> (floor (pt[1] * inverse_leaf_size_[1]) - min_b_[1]);
+    int ijk2 = static_cast<int> (floor (pt[2] * inverse_leaf_size_[2]) - min_b_[2]);
+    // Compute the centroid leaf index
+    index_vector[cp].idx = ijk0 + ijk1 * leaf_mul_y + ijk2 * leaf_mul_z;
   }
+  removeInvalidLeafIndices (index_vector);
 
   // Second pass: sort the index_vector vector using value representing target cell as index
   // in effect all points belonging to the same output cell will be next to each other
-  std::sort (index_vector.begin (), index_vector.end (), std::less<cloud_point_index_idx> ());
+  radixSortLeafIndices (index_vector);
 
-  // Third pass: count output cells
+  // Third pass: find the first entry of each output cell
   // we need to skip all the same, adjacenent idx values
-  unsigned int total=0;
-  unsigned int index=0;
-  while (index < index_vector.size ()) 
+  std::vector<unsigned int> first_index;
+  unsigned int cp = 0;
+  while (cp < index_vector.size ()) 
   {
-    unsigned int i = index + 1;
-    while (i < index_vector.size () && index_vector[i].idx == index_vector[index].idx) 
+    first_index.push_back (cp);
+    unsigned int i = cp + 1;
+    while (i < index_vector.size () && index_vector[i].idx == index_vector[cp].idx) 
       ++i;
-    ++total;
-    index = i;
+    cp = i;
   }
+  int total = static_cast<int> (first_index.size ());
+  first_index.push_back (static_cast<unsigned int> (index_vector.size ()));
 
   // Fourth pass: compute centroids, insert them into their final position
   output.width = total;
   output.row_step = output.point_step * output.width;
   output.data.resize (output.width * output.point_step);
 
-  if (save_leaf_layout_) 
+  if (save_leaf_layout) 
   {
     try
     {
-      leaf_layout_.resize (div_b_[0]*div_b_[1]*div_b_[2], -1);
+      leaf_layout_.resize (leaf_mul_z * div_b_[2], -1);
     }
     catch (std::bad_alloc&)
     {
@@ -412,53 +526,30 @@ pcl::VoxelGrid<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &output)
     // If not, we must have created a new xyzw cloud
     xyz_offset = Eigen::Array4i (0, 4, 8, 12);
 
-  index=0;
-  Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
-  Eigen::VectorXf temporary = Eigen::VectorXf::Zero (centroid_size);
-
-  for (unsigned int cp = 0; cp < index_vector.size ();)
+  // Cells are independent, and each one writes only its own output point
+#pragma omp parallel num_threads (threads_)
   {
-    int point_offset = index_vector[cp].cloud_point_index * input_->point_step;
-    // Do we need to process all the fields?
-    if (!downsample_all_data_) 
-    {
-      memcpy (&pt[0], &input_->data[point_offset+input_->fields[x_idx_].offset], sizeof (float));
-      memcpy (&pt[1], &input_->data[point_offset+input_->fields[y_idx_].offset], sizeof (float));
-      memcpy (&pt[2], &input_->data[point_offset+input_->fields[z_idx_].offset], sizeof (float));
-      centroid[0] = pt[0];
-      centroid[1] = pt[1];
-      centroid[2] = pt[2];
-      centroid[3] = 0;
-    }
-    else
-    {
-      // ---[ RGB special case
-      // fill extra r/g/b centroid field
-      if (rgba_index >= 0)
-      {
-        pcl::RGB rgb;
-        memcpy (&rgb, &input_->data[point_offset + input_->fields[rgba_index].offset], sizeof (RGB));
-        centroid[centroid_size-3] = rgb.r;
-        centroid[centroid_size-2] = rgb.g;
-        centroid[centroid_size-1] = rgb.b;
-      }
-      // Copy all the fields
-      for (unsigned int d = 0; d < input_->fields.size (); ++d)
-        memcpy (&centroid[d], &input_->data[point_offset + input_->fields[d].offset], field_sizes_[d]);
-    }
+    Eigen::Vector4f pt = Eigen::Vector4f::Zero ();
+    Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
+    Eigen::VectorXf temporary = Eigen::VectorXf::Zero (centroid_size);
 
-    unsigned int i = cp + 1;
-    while (i < index_vector.size () && index_vector[i].idx == index_vector[cp].idx) 
+#pragma omp for schedule (static)
+    for (int index = 0; index < total; ++index)
     {
-      int point_offset = index_vector[i].cloud_point_index * input_->point_step;
+      unsigned int cp = first_index[index];
+      unsigned int cell_end = first_index[index + 1];
+
+      int point_offset = index_vector[cp].cloud_point_index * input_->point_step;
+      // Do we need to process all the fields?
       if (!downsample_all_data_) 
       {
         memcpy (&pt[0], &input_->data[point_offset+input_->fields[x_idx_].offset], sizeof (float));
         memcpy (&pt[1], &input_->data[point_offset+input_->fields[y_idx_].offset], sizeof (float));
         memcpy (&pt[2], &input_->data[point_offset+input_->fields[z_idx_].offset], sizeof (float));
-        centroid[0] += pt[0];
-        centroid[1] += pt[1];
-        centroid[2] += pt[2];
+        centroid[0] = pt[0];
+        centroid[1] = pt[1];
+        centroid[2] = pt[2];
+        centroid[3] = 0;
       }
       else
       {
@@ -468,52 +559,79 @@ pcl::VoxelGrid<sensor_msgs::PointCloud2>::applyFilter (PointCloud2 &output)
         {
           pcl::RGB rgb;
           memcpy (&rgb, &input_->data[point_offset + input_->fields[rgba_index].offset], sizeof (RGB));
-          temporary[centroid_size-3] = rgb.r;
-          temporary[centroid_size-2] = rgb.g;
-          temporary[centroid_size-1] = rgb.b;
+          centroid[centroid_size-3] = rgb.r;
+          centroid[centroid_size-2] = rgb.g;
+          centroid[centroid_size-1] = rgb.b;
         }
         // Copy all the fields
         for (unsigned int d = 0; d < input_->fields.size (); ++d)
-          memcpy (&temporary[d], &input_->data[point_offset + input_->fields[d].offset], field_sizes_[d]);
-        centroid+=temporary;
+          memcpy (&centroid[d], &input_->data[point_offset + input_->fields[d].offset], field_sizes_[d]);
       }
-      ++i;
-    }
 
-	  // Save leaf layout information for fast access to cells relative to current position
-    if (save_leaf_layout_)
-      leaf_layout_[index_vector[cp].idx] = index;
+      for (unsigned int i = cp + 1; i < cell_end; ++i)
+      {
+        int point_offset = index_vector[i].cloud_point_index * input_->point_step;
+        if (!downsample_all_data_) 
+        {
+          memcpy (&pt[0], &input_->data[point_offset+input_->fields[x_idx_].offset], sizeof (float));
+          memcpy (&pt[1], &input_->data[point_offset+input_->fields[y_idx_].offset], sizeof (float));
+          memcpy (&pt[2], &input_->data[point_offset+input_->fields[z_idx_].offset], sizeof (float));
+          centroid[0] += pt[0];
+          centroid[1] += pt[1];
+          centroid[2] += pt[2];
+        }
+        else
+        {
+          // ---[ RGB special case
+          // fill extra r/g/b centroid field
+          if (rgba_index >= 0)
+          {
+            pcl::RGB rgb;
+            memcpy (&rgb, &input_->data[point_offset + input_->fields[rgba_index].offset], sizeof (RGB));
+            temporary[centroid_size-3] = rgb.r;
+            temporary[centroid_size-2] = rgb.g;
+            temporary[centroid_size-1] = rgb.b;
+          }
+          // Copy all the fields
+          for (unsigned int d = 0; d < input_->fields.size (); ++d)
+            memcpy (&temporary[d], &input_->data[point_offset + input_->fields[d].offset], field_sizes_[d]);
+          centroid+=temporary;
+        }
+      }
 
-    // Normalize the centroid
-    centroid /= static_cast<float> (i - cp);
+      // Save leaf layout information for fast access to cells relative to current position
+      if (save_leaf_layout)
+        leaf_layout_[index_vector[cp].idx] = index;
 
-    // Do we need to process all the fields?
-    if (!downsample_all_data_)
-    {
-      // Copy the data
-      memcpy (&output.data[xyz_offset[0]], &centroid[0], sizeof (float));
-      memcpy (&output.data[xyz_offset[1]], &centroid[1], sizeof (float));
-      memcpy (&output.data[xyz_offset[2]], &centroid[2], sizeof (float));
-      xyz_offset += output.point_step;
-    }
-    else
-    {
-      int point_offset = index * output.point_step;
-      // Copy all the fields
-      for (size_t d = 0; d < output.fields.size (); ++d)
-        memcpy (&output.data[point_offset + output.fields[d].offset], &centroid[d], field_sizes_[d]);
-
-      // ---[ RGB special case
-      // full extra r/g/b centroid field
-      if (rgba_index >= 0) 
+      // Normalize the centroid
+      centroid /= static_cast<float> (cell_end - cp);
+
+      // Do we need to process all the fields?
+      if (!downsample_all_data_)
       {
-        float r = centroid[centroid_size-3], g = centroid[centroid_size-2], b = centroid[centroid_size-1];
-        int rgb = (static_cast<int> (r) << 16) | (static_cast<int> (g) << 8) | static_cast<int> (b);
-        memcpy (&output.data[point_offset + output.fields[rgba_index].offset], &rgb, sizeof (float));
+        // Copy the data
+        int point_offset = index * output.point_step;
+        memcpy (&output.data[point_offset + xyz_offset[0]], &centroid[0], sizeof (float));
+        memcpy (&output.data[point_offset + xyz_offset[1]], &centroid[1], sizeof (float));
+        memcpy (&output.data[point_offset + xyz_offset[2]], &centroid[2], sizeof (float));
+      }
+      else
+      {
+        int point_offset = index * output.point_step;
+        // Copy all the fields
+        for (size_t d = 0; d < output.fields.size (); ++d)
+          memcpy (&output.data[point_offset + output.fields[d].offset], &centroid[d], field_sizes_[d]);
+
+        // ---[ RGB special case
+        // full extra r/g/b centroid field
+        if (rgba_index >= 0) 
+        {
+          float r = centroid[centroid_size-3], g = centroid[centroid_size-2], b = centroid[centroid_size-1];
+          int rgb = (static_cast<int> (r) << 16) | (static_cast<int> (g) << 8) | static_cast<int> (b);
+          memcpy (&output.data[point_offset + output.fields[rgba_index].offset], &rgb, sizeof (float));
+        }
       }
     }
-    cp = i;
-    ++index;
   }
 }
 
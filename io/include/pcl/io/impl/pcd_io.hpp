@@ -120,6 +120,31 @@ pcl::PCDWriter::generateHeader (const pcl::PointCloud<PointT> &cloud, const int
   return (oss.str ());
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::string
+pcl::PCDWriter::generateHeaderBinary (const pcl::PointCloud<PointT> &cloud, const int nr_points)
+{
+  // Describe the memory layout of PointT. The gaps between the fields are written out as padding.
+  sensor_msgs::PointCloud2 blob;
+  std::vector<sensor_msgs::PointField> fields;
+  pcl::getFields (cloud, fields);
+  for (size_t i = 0; i < fields.size (); ++i)
+    if (fields[i].name != "_")
+      blob.fields.push_back (fields[i]);
+  blob.point_step = static_cast<uint32_t> (sizeof (PointT));
+  if (nr_points != std::numeric_limits<int>::max ())
+  {
+    blob.width  = nr_points;
+    blob.height = 1;
+  }
+  else
+  {
+    blob.width  = cloud.width;
+    blob.height = cloud.height;
+  }
+  return (generateHeaderBinary (blob, cloud.sensor_origin_, cloud.sensor_orientation_));
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::PCDWriter::writeBinary (const std::string &file_name, 
@@ -132,7 +157,13 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
   }
   int data_idx = 0;
   std::ostringstream oss;
-  oss << generateHeader<PointT> (cloud) << "DATA binary\n";
+  if (point_layout_)
+  {
+    oss << generateHeaderBinary<PointT> (cloud);
+    appendDataBinary (oss);
+  }
+  else
+    oss << generateHeader<PointT> (cloud) << "DATA binary\n";
   oss.flush ();
   data_idx = static_cast<int> (oss.tellp ());
 
@@ -171,7 +202,9 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
   }
   fields.resize (nri);
   
-  data_size = cloud.points.size () * fsize;
+  // With the point layout, the records keep the padding of PointT, which is left zeroed in the new file
+  size_t record_size = point_layout_ ? sizeof (PointT) : fsize;
+  data_size = cloud.points.size () * record_size;
 
   // Prepare the map
 #if _WIN32
@@ -213,6 +246,14 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
   char *out = &map[0] + data_idx;
   for (size_t i = 0; i < cloud.points.size (); ++i)
   {
+    if (point_layout_)
+    {
+      // Only the fields are copied, so that the padding bytes stay zero
+      for (size_t j = 0; j < fields.size (); ++j)
+        memcpy (out + fields[j].offset, reinterpret_cast<const char*> (&cloud.points[i]) + fields[j].offset, fields_sizes[j]);
+      out += record_size;
+      continue;
+    }
     int nrj = 0;
     for (size_t j = 0; j < fields.size (); ++j)
     {
@@ -598,7 +639,13 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
   }
   int data_idx = 0;
   std::ostringstream oss;
-  oss << generateHeader<PointT> (cloud, static_cast<int> (indices.size ())) << "DATA binary\n";
+  if (point_layout_)
+  {
+    oss << generateHeaderBinary<PointT> (cloud, static_cast<int> (indices.size ()));
+    appendDataBinary (oss);
+  }
+  else
+    oss << generateHeader<PointT> (cloud, static_cast<int> (indices.size ())) << "DATA binary\n";
   oss.flush ();
   data_idx = static_cast<int> (oss.tellp ());
 
@@ -637,7 +684,9 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
   }
   fields.resize (nri);
   
-  data_size = indices.size () * fsize;
+  // With the point layout, the records keep the padding of PointT, which is left zeroed in the new file
+  size_t record_size = point_layout_ ? sizeof (PointT) : fsize;
+  data_size = indices.size () * record_size;
 
   // Prepare the map
 #if _WIN32
@@ -679,6 +728,14 @@ pcl::PCDWriter::writeBinary (const std::string &file_name,
   // Copy the data
   for (size_t i = 0; i < indices.size (); ++i)
   {
+    if (point_layout_)
+    {
+      // Only the fields are copied, so that the padding bytes stay zero
+      for (size_t j = 0; j < fields.size (); ++j)
+        memcpy (out + fields[j].offset, reinterpret_cast<const char*> (&cloud.points[indices[i]]) + fields[j].offset, fields_sizes[j]);
+      out += record_size;
+      continue;
+    }
     int nrj = 0;
     for (size_t j = 0; j < fields.size (); ++j)
     {
@@ -868,5 +925,81 @@ pcl::PCDWriter::writeASCII (const std::string &file_name,
   return (0);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDReader::readView (const std::string &file_name, pcl::PCDCloudView<PointT> &view, const int offset)
+{
+  sensor_msgs::PointCloud2 blob;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  view = pcl::PCDCloudView<PointT> ();
+  int res = readHeader (file_name, blob, view.sensor_origin_, view.sensor_orientation_, 
+                        pcd_version, data_type, data_idx, offset);
+  if (res < 0)
+    return (res);
+
+  view.width  = blob.width;
+  view.height = blob.height;
+  size_t nr_points = blob.width * blob.height;
+
+  // The binary records can be used in place only if they are laid out exactly like PointT
+  bool layout_matches = (data_type == 1 && blob.point_step == sizeof (PointT));
+  if (layout_matches)
+  {
+    std::vector<sensor_msgs::PointField> fields;
+    pcl::getFields<PointT> (fields);
+    for (size_t i = 0; i < fields.size () && layout_matches; ++i)
+    {
+      if (fields[i].name == "_")
+        continue;
+      int d = pcl::getFieldIndex (blob, fields[i].name);
+      layout_matches = (d != -1 &&
+                        blob.fields[d].offset   == fields[i].offset &&
+                        blob.fields[d].datatype == fields[i].datatype &&
+                        blob.fields[d].count    == fields[i].count);
+    }
+  }
+
+  if (!layout_matches)
+  {
+    // Fall back to a regular read, and let the view own the converted points
+    boost::shared_ptr<pcl::PointCloud<PointT> > cloud (new pcl::PointCloud<PointT>);
+    res = read (file_name, *cloud, offset);
+    if (res < 0)
+      return (res);
+    view.is_dense = cloud->is_dense;
+    view.points_  = cloud->points.empty () ? NULL : &cloud->points[0];
+    view.size_    = cloud->points.size ();
+    view.storage_ = cloud;
+    return (0);
+  }
+
+  PCDFileMapping::Ptr mapping (new PCDFileMapping);
+  if (!mapping->map (file_name, data_idx + nr_points * blob.point_step))
+  {
+    PCL_ERROR ("[pcl::PCDReader::readView] Could not map file %s.\n", file_name.c_str ());
+    return (-1);
+  }
+  const char *data = mapping->data () + data_idx;
+  view.size_ = nr_points;
+
+  // The mapping itself starts on a page boundary, so the offset decides the alignment
+  if (data_idx % 16 == 0)
+  {
+    view.points_  = reinterpret_cast<const PointT*> (data);
+    view.storage_ = mapping;
+    view.mapped_  = true;
+    return (0);
+  }
+
+  // Aligned types cannot live at this offset: make a single copy into aligned storage
+  boost::shared_ptr<pcl::PointCloud<PointT> > cloud (new pcl::PointCloud<PointT>);
+  cloud->points.resize (nr_points);
+  memcpy (&cloud->points[0], data, nr_points * sizeof (PointT));
+  view.points_  = &cloud->points[0];
+  view.storage_ = cloud;
+  return (0);
+}
+
 #endif  //#ifndef PCL_IO_PCD_IO_H_
 
@@ -42,9 +42,172 @@
 
 #include <pcl/point_cloud.h>
 #include <pcl/io/file_io.h>
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <stdexcept>
 
 namespace pcl
 {
+  /** \brief Read-only memory mapping of the first bytes of a file. The pages
+    * are unmapped when the object is destroyed, so hand it around through a
+    * shared pointer to keep the mapped data alive.
+    * \ingroup io
+    */
+  class PCL_EXPORTS PCDFileMapping : boost::noncopyable
+  {
+    public:
+      typedef boost::shared_ptr<PCDFileMapping> Ptr;
+      typedef boost::shared_ptr<const PCDFileMapping> ConstPtr;
+
+      /** \brief Empty constructor. */
+      PCDFileMapping () : map_ (NULL), size_ (0) {}
+
+      /** \brief Destructor. Unmaps the file. */
+      ~PCDFileMapping () { unmap (); }
+
+      /** \brief Map the first \a size bytes of a file read-only.
+        * \param[in] file_name the name of the file to map
+        * \param[in] size the number of bytes to map, starting at the beginning of the file
+        * \return true on success, false if the file could not be opened, is
+        * smaller than \a size or could not be mapped
+        */
+      bool
+      map (const std::string &file_name, size_t size);
+
+      /** \brief Unmap the file (if mapped). */
+      void
+      unmap ();
+
+      /** \brief Get a pointer to the beginning of the mapped data. */
+      inline const char*
+      data () const { return (map_); }
+
+      /** \brief Get the number of bytes mapped. */
+      inline size_t
+      size () const { return (size_); }
+
+      /** \brief Check whether a file is currently mapped. */
+      inline bool
+      isMapped () const { return (map_ != NULL); }
+
+    private:
+      /** \brief The start of the mapped region. */
+      char *map_;
+
+      /** \brief The size of the mapped region in bytes. */
+      size_t size_;
+  };
+
+  /** \brief Read-only view of the points stored in a PCD file, as returned by
+    * \ref PCDReader::readView. When the on-disk records of a binary PCD file
+    * match the memory layout of PointT, the points are used directly from the
+    * memory mapped file, and no copy is made. Otherwise the view owns a
+    * regular copy of the data. In both cases the storage is shared between
+    * all copies of a view and released together with the last of them.
+    *
+    * \note The file must not be modified while a mapped view is alive.
+    * \ingroup io
+    */
+  template <typename PointT>
+  class PCDCloudView
+  {
+    public:
+      typedef boost::shared_ptr<PCDCloudView<PointT> > Ptr;
+      typedef boost::shared_ptr<const PCDCloudView<PointT> > ConstPtr;
+      typedef const PointT* const_iterator;
+
+      /** \brief Empty constructor. */
+      PCDCloudView () : width (0), height (0), is_dense (false),
+                        sensor_origin_ (Eigen::Vector4f::Zero ()), 
+                        sensor_orientation_ (Eigen::Quaternionf::Identity ()),
+                        storage_ (), points_ (NULL), size_ (0), mapped_ (false)
+      {}
+
+      inline const_iterator begin () const { return (points_); }
+      inline const_iterator end ()   const { return (points_ + size_); }
+
+      /** \brief Get the number of points in the view. */
+      inline size_t size () const { return (size_); }
+
+      /** \brief Check whether the view contains no points. */
+      inline bool empty () const { return (size_ == 0); }
+
+      /** \brief Check whether the view is organized (e.g., arranged in a structured grid). */
+      inline bool isOrganized () const { return (height > 1); }
+
+      /** \brief Check whether the points are read directly from the mapped file. */
+      inline bool isMapped () const { return (mapped_); }
+
+      inline const PointT& 
+      operator[] (size_t n) const { return (points_[n]); }
+
+      /** \brief Obtain the n-th point, with bounds checking. */
+      inline const PointT&
+      at (size_t n) const
+      {
+        if (n >= size_)
+          throw std::out_of_range ("[pcl::PCDCloudView::at] Point index out of range");
+        return (points_[n]);
+      }
+
+      /** \brief Obtain the point given by the (column, row) coordinates. Only works on organized 
+        * datasets (those that have height != 1).
+        * \param[in] column the column coordinate
+        * \param[in] row the row coordinate
+        */
+      inline const PointT&
+      at (int column, int row) const
+      {
+        if (height > 1)
+          return (at (row * width + column));
+        else
+          throw IsNotDenseException ("Can't use 2D indexing with a unorganized point cloud");
+      }
+
+      /** \brief Copy the points (and the header information) into a regular point cloud. */
+      void
+      copyTo (pcl::PointCloud<PointT> &cloud) const
+      {
+        cloud.points.assign (begin (), end ());
+        cloud.width = width;
+        cloud.height = height;
+        cloud.is_dense = is_dense;
+        cloud.sensor_origin_ = sensor_origin_;
+        cloud.sensor_orientation_ = sensor_orientation_;
+      }
+
+      /** \brief The point cloud width (if organized as an image-structure). */
+      uint32_t width;
+      /** \brief The point cloud height (if organized as an image-structure). */
+      uint32_t height;
+
+      /** \brief True if no points are invalid (e.g., have NaN or Inf values). A
+        * mapped view does not scan its data and always reports false. */
+      bool is_dense;
+
+      /** \brief Sensor acquisition pose (origin/translation). */
+      Eigen::Vector4f    sensor_origin_;
+      /** \brief Sensor acquisition pose (rotation). */
+      Eigen::Quaternionf sensor_orientation_;
+
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+      /** \brief Keeps the file mapping or the owned copy of the points alive. */
+      boost::shared_ptr<const void> storage_;
+
+      /** \brief Pointer to the first point. */
+      const PointT *points_;
+
+      /** \brief The number of points. */
+      size_t size_;
+
+      /** \brief True if \a points_ points into a file mapping. */
+      bool mapped_;
+
+      friend class PCDReader;
+  };
+
   /** \brief Point Cloud Data (PCD) file format reader.
     * \author Radu Bogdan Rusu
     * \ingroup io
@@ -53,7 +216,7 @@ namespace pcl
   {
     public:
       /** Empty constructor */      
-      PCDReader () : FileReader () {}
+      PCDReader () : FileReader (), threads_ (1) {}
       /** Empty destructor */      
       ~PCDReader () {}
       /** \brief Various PCD file versions.
@@ -83,6 +246,12 @@ namespace pcl
         PCD_V7 = 1
       };
 
+      /** \brief Callback receiving the batches of \ref readBatches: the batch
+        * of points, and the index of its first point in the file. Return
+        * false to stop reading.
+        */
+      typedef boost::function<bool (const sensor_msgs::PointCloud2 &, unsigned int)> BatchCallback;
+
       /** \brief Read a point cloud data header from a PCD file. 
         *
         * Load only the meta information (number of points, their types, etc),
@@ -97,7 +266,7 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed) 
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary compressed chunked) 
         * \param[out] data_idx the offset of cloud data within the file
         * \param[in] offset the offset of where to expect the PCD Header in the
         * file (optional parameter). One usage example for setting the offset
@@ -127,7 +296,7 @@ namespace pcl
         * \param[in] file_name the name of the file to load
         * \param[out] cloud the resultant point cloud dataset (only the properties will be filled)
         * \param[out] pcd_version the PCD version of the file (either PCD_V6 or PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed) 
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary compressed chunked) 
         * \param[out] data_idx the offset of cloud data within the file
         * \param[in] offset the offset of where to expect the PCD Header in the
         * file (optional parameter). One usage example for setting the offset
@@ -236,6 +405,96 @@ namespace pcl
         */
       int
       readEigen (const std::string &file_name, pcl::PointCloud<Eigen::MatrixXf> &cloud, const int offset = 0);
+
+      /** \brief Read a point cloud from a PCD file as a read-only view, without
+        * copying the data if possible.
+        *
+        * If the file is stored as uncompressed binary data, its fields match
+        * the layout of PointT (names, types, counts and offsets, with the same
+        * record size as sizeof (PointT)) and the data starts on a 16 byte
+        * boundary, the view points straight into a memory mapping of the
+        * file. The pages are loaded lazily by the operating system, and the
+        * mapping lives for as long as any copy of the view does. Any other
+        * file is read through \ref read and converted into storage owned by
+        * the view, so a view is always returned when the file can be read.
+        *
+        * \param[in] file_name the name of the file containing the actual PointCloud data
+        * \param[out] view the resultant point cloud view
+        * \param[in] offset the offset of where to expect the PCD Header in the
+        * file (optional parameter). One usage example for setting the offset
+        * parameter is for reading data from a TAR "archive containing multiple
+        * PCD files: TAR files always add a 512 byte header in front of the
+        * actual file, so set the offset to the next byte after the header
+        * (e.g., 513).
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      template<typename PointT> int
+      readView (const std::string &file_name, pcl::PCDCloudView<PointT> &view, const int offset = 0);
+
+      /** \brief Read a contiguous range of points from a PCD file into an
+        * unorganized sensor_msgs/PointCloud2.
+        *
+        * Binary data is copied straight from a mapping of the file, and for
+        * binary_compressed_chunked files only the chunks that overlap the
+        * range are decompressed. ASCII and binary_compressed files have to be
+        * read as a whole before the range is extracted.
+        *
+        * \param[in] file_name the name of the file containing the actual PointCloud data
+        * \param[out] cloud the resultant PointCloud message holding the range of points
+        * \param[in] first_point the index of the first point to read
+        * \param[in] nr_points the number of points to read
+        * \param[in] offset the offset of where to expect the PCD Header in the
+        * file (optional parameter)
+        *
+        * \return
+        *  * < 0 (-1) on error (including a range that exceeds the points in the file)
+        *  * == 0 on success
+        */
+      int
+      readRange (const std::string &file_name, sensor_msgs::PointCloud2 &cloud, 
+                 unsigned int first_point, unsigned int nr_points, const int offset = 0);
+
+      /** \brief Stream the points of a PCD file through a callback, in batches
+        * of (at most) \a batch_size points.
+        *
+        * Unorganized clouds are delivered as unorganized batches. Organized
+        * clouds are delivered as ranges of whole rows (at least one row per
+        * batch), i.e. as organized clouds of the original width. Only one
+        * batch is kept in memory for ASCII, binary and binary_compressed_chunked
+        * files; binary_compressed files hold a single compressed block and have
+        * to be decompressed as a whole first.
+        *
+        * \param[in] file_name the name of the file containing the actual PointCloud data
+        * \param[in] batch_size the maximum number of points per batch
+        * \param[in] callback the function receiving each batch, which returns
+        * false to stop reading. The batch is only valid during the call.
+        * \param[in] offset the offset of where to expect the PCD Header in the
+        * file (optional parameter)
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      readBatches (const std::string &file_name, unsigned int batch_size, 
+                   const BatchCallback &callback, const int offset = 0);
+
+      /** \brief Set the number of threads used to decompress binary_compressed_chunked data.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to decompress binary_compressed_chunked data. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+    private:
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 
   /** \brief Point Cloud Data (PCD) file format writer.
@@ -245,7 +504,7 @@ namespace pcl
   class PCL_EXPORTS PCDWriter : public FileWriter
   {
     public:
-      PCDWriter() : FileWriter(), map_synchronization_(false) {}
+      PCDWriter() : FileWriter(), map_synchronization_(false), point_layout_ (false), threads_ (1), compression_chunk_size_ (65536) {}
       ~PCDWriter() {}
 
       /** \brief Set whether mmap() synchornization via msync() is desired before munmap() calls. 
@@ -262,6 +521,40 @@ namespace pcl
         map_synchronization_ = sync;
       }
 
+      /** \brief Set whether the templated binary writers store the points with the memory layout of PointT,
+        * i.e., with their padding bytes (written as zeros), instead of packing the fields. Such files are bigger,
+        * but PCDReader::readView can use their points in place, without copying them.
+        * Default: false
+        * \param[in] point_layout set to true to store the points with the memory layout of PointT
+        */
+      inline void
+      setBinaryPointLayout (bool point_layout) { point_layout_ = point_layout; }
+
+      /** \brief Get whether the templated binary writers store the points with the memory layout of PointT. */
+      inline bool
+      getBinaryPointLayout () const { return (point_layout_); }
+
+      /** \brief Set the number of threads used to compress binary_compressed_chunked data.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to compress binary_compressed_chunked data. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+      /** \brief Set the number of points stored in each independently compressed
+        * chunk of a binary_compressed_chunked file (default: 65536).
+        * \param[in] nr_points the number of points per chunk (0 sets the value back to the default)
+        */
+      inline void
+      setCompressionChunkSize (unsigned int nr_points) { compression_chunk_size_ = (nr_points == 0) ? 65536 : nr_points; }
+
+      /** \brief Get the number of points stored in each compressed chunk. */
+      inline unsigned int
+      getCompressionChunkSize () const { return (compression_chunk_size_); }
+
       /** \brief Generate the header of a PCD file format
         * \param[in] cloud the point cloud data message
         * \param[in] origin the sensor acquisition origin
@@ -272,6 +565,17 @@ namespace pcl
                             const Eigen::Vector4f &origin, 
                             const Eigen::Quaternionf &orientation);
 
+      /** \brief Generate the header of a binary PCD file format that stores the points with the memory layout of
+        * PointT, i.e., with its padding bytes as "_" fields, so that they can be read in place by PCDReader::readView.
+        * Used by the templated binary writers when \ref setBinaryPointLayout is on.
+        * \param[in] cloud the point cloud data
+        * \param[in] nr_points if given, use this to fill in WIDTH, HEIGHT (=1), and POINTS in the header
+        * By default, nr_points is set to INTMAX, and the data in the header is used instead.
+        */
+      template <typename PointT> std::string
+      generateHeaderBinary (const pcl::PointCloud<PointT> &cloud, 
+                            const int nr_points = std::numeric_limits<int>::max ());
+
       /** \brief Generate the header of a BINARY_COMPRESSED PCD file format
         * \param[in] cloud the point cloud data message
         * \param[in] origin the sensor acquisition origin
@@ -358,6 +662,36 @@ namespace pcl
                              const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (), 
                              const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
 
+      /** \brief Save point cloud data to a PCD file containing n-D points, in BINARY_COMPRESSED_CHUNKED format
+        *
+        * The points are split into chunks of \ref getCompressionChunkSize points
+        * that are compressed independently, using \ref getNumberOfThreads
+        * threads. Chunks can be decompressed in parallel and read on their
+        * own (see PCDReader::readRange). Chunks that do not compress are
+        * stored as they are.
+        *
+        * \param[in] file_name the output file name
+        * \param[in] cloud the point cloud data message
+        * \param[in] origin the sensor acquisition origin
+        * \param[in] orientation the sensor acquisition orientation
+        */
+      int 
+      writeBinaryCompressedChunked (const std::string &file_name, const sensor_msgs::PointCloud2 &cloud,
+                                    const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (), 
+                                    const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
+      /** \brief Save point cloud data to a PCD file containing n-D points, in BINARY_COMPRESSED_CHUNKED format
+        * \param[in] file_name the output file name
+        * \param[in] cloud the point cloud data
+        */
+      template <typename PointT> inline int 
+      writeBinaryCompressedChunked (const std::string &file_name, const pcl::PointCloud<PointT> &cloud)
+      {
+        sensor_msgs::PointCloud2 blob;
+        pcl::toROSMsg (cloud, blob);
+        return (writeBinaryCompressedChunked (file_name, blob, cloud.sensor_origin_, cloud.sensor_orientation_));
+      }
+
       /** \brief Save point cloud data to a PCD file containing n-D points
         * \param[in] file_name the output file name
         * \param[in] cloud the point cloud data message
@@ -548,9 +882,25 @@ namespace pcl
       }
 
     private:
+      /** \brief Append the DATA line of a binary PCD file to a header. The header is padded with a comment line
+        * so that the binary data starts on a 16 byte boundary, which lets PCDReader::readView use it in place.
+        * \param[in,out] oss the stream holding the header
+        */
+      static void
+      appendDataBinary (std::ostringstream &oss);
+
       /** \brief Set to true if msync() should be called before munmap(). Prevents data loss on NFS systems. */
       bool map_synchronization_;
 
+      /** \brief Set to true if the templated binary writers store the points with the memory layout of PointT. */
+      bool point_layout_;
+
+      /** \brief The number of threads used to compress chunked data. */
+      unsigned int threads_;
+
+      /** \brief The number of points in each compressed chunk. */
+      unsigned int compression_chunk_size_;
+
       typedef std::pair<std::string, pcl::ChannelProperties> pair_channel_properties;
       /** \brief Internal structure used to sort the ChannelProperties in the
         * cloud.channels map based on their offset. 
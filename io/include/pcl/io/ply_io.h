@@ -82,6 +82,12 @@ namespace pcl
         PLY_V0 = 0,
         PLY_V1 = 1
       };
+
+      /** \brief Callback receiving the batches of \ref readBatches: the batch
+        * of points, and the index of its first vertex in the file. Return
+        * false to stop delivering batches.
+        */
+      typedef boost::function<bool (const sensor_msgs::PointCloud2 &, unsigned int)> BatchCallback;
       
       PLYReader ()
         : FileReader ()
@@ -96,6 +102,10 @@ namespace pcl
         , range_count_ (0)
         , range_grid_vertex_indices_element_index_ (0)
         , rgb_offset_before_ (0)
+        , batch_size_ (0)
+        , batch_callback_ ()
+        , batch_first_point_ (0)
+        , batch_stopped_ (false)
       {}
 
       PLYReader (const PLYReader &p)
@@ -110,6 +120,10 @@ namespace pcl
         , range_count_ (0)
         , range_grid_vertex_indices_element_index_ (0)
         , rgb_offset_before_ (0)
+        , batch_size_ (0)
+        , batch_callback_ ()
+        , batch_first_point_ (0)
+        , batch_stopped_ (false)
       {
         *this = p;
       }
@@ -214,6 +228,24 @@ namespace pcl
         pcl::fromROSMsg (blob, cloud);
         return (0);
       }
+
+      /** \brief Stream the vertices of a PLY file through a callback, in
+        * unorganized batches of (at most) \a batch_size points.
+        *
+        * Only one batch is kept in memory. The range_grid element of organized
+        * PLY files is ignored, so their vertices are delivered as stored.
+        *
+        * \param[in] file_name the name of the file containing the actual PointCloud data
+        * \param[in] batch_size the maximum number of points per batch
+        * \param[in] callback the function receiving each batch, which returns
+        * false to stop delivering batches. The batch is only valid during the call.
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      readBatches (const std::string &file_name, unsigned int batch_size, const BatchCallback &callback);
       
     private:
       ::pcl::io::ply::ply_parser parser_;
@@ -430,6 +462,10 @@ namespace pcl
       void
       objInfoCallback (const std::string& line);
 
+      /** Hand the vertices read so far to the batch callback and start a new batch */
+      void
+      flushBatch ();
+
       /// origin
       Eigen::Vector4f origin_;
 
@@ -444,6 +480,11 @@ namespace pcl
       std::vector<std::vector <int> > *range_grid_;
       size_t range_count_, range_grid_vertex_indices_element_index_;
       size_t rgb_offset_before_;
+      //streaming artifacts (batch_size_ == 0 when reading the whole cloud)
+      size_t batch_size_;
+      BatchCallback batch_callback_;
+      size_t batch_first_point_;
+      bool batch_stopped_;
       
     public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
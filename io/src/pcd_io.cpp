@@ -49,6 +49,7 @@
 #include <boost/filesystem.hpp>
 
 #include <cstring>
+#include <algorithm>
 #include <cerrno>
 
 #ifdef _WIN32
@@ -64,6 +65,354 @@
 # define pcl_lseek(fd,offset,origin) lseek(fd,offset,origin)
 #endif
 
+namespace
+{
+  /** \brief Order point fields by their offset in the point record. */
+  bool
+  fieldOffsetLess (const sensor_msgs::PointField &a, const sensor_msgs::PointField &b)
+  {
+    return (a.offset < b.offset);
+  }
+
+  /** \brief Get the fields that are stored in compressed PCD data, i.e., all but the padding.
+    * \param[in] cloud the point cloud message holding the field description
+    * \param[out] fields the non-padding fields
+    * \param[out] fields_sizes the size in bytes of each field (size * count)
+    * \return the size in bytes of a packed point
+    */
+  size_t
+  getPackedFields (const sensor_msgs::PointCloud2 &cloud, 
+                   std::vector<sensor_msgs::PointField> &fields, std::vector<int> &fields_sizes)
+  {
+    size_t fsize = 0;
+    fields.clear ();
+    fields_sizes.clear ();
+    for (size_t i = 0; i < cloud.fields.size (); ++i)
+    {
+      if (cloud.fields[i].name == "_")
+        continue;
+      fields.push_back (cloud.fields[i]);
+      fields_sizes.push_back (cloud.fields[i].count * pcl::getFieldSize (cloud.fields[i].datatype));
+      fsize += fields_sizes.back ();
+    }
+    return (fsize);
+  }
+
+  /** \brief Decode a range of points from binary_compressed_chunked PCD data.
+    *
+    * The data starts with the number of chunks and the number of points per
+    * chunk, followed by a (compressed size, uncompressed size) pair for each
+    * chunk and the chunks themselves. Every chunk holds the fields of its
+    * points one after the other (XXYYZZ), and is stored uncompressed when
+    * both sizes are equal. Only the chunks overlapping the range are decoded.
+    *
+    * \param[in] data the data following the DATA line of the file
+    * \param[in] data_size the number of bytes available at \a data
+    * \param[in] total_points the number of points stored in the file
+    * \param[in] first_point the first point to decode
+    * \param[in] nr_threads the number of threads used to decompress the chunks
+    * \param[in,out] cloud the output cloud, with fields, point_step and data
+    * (sized for the points of the range) already set
+    * \return 0 on success, -1 on corrupted data
+    */
+  int
+  decodeCompressedChunks (const char *data, size_t data_size, size_t total_points, 
+                          size_t first_point, unsigned int nr_threads, 
+                          sensor_msgs::PointCloud2 &cloud)
+  {
+    std::vector<sensor_msgs::PointField> fields;
+    std::vector<int> fields_sizes;
+    size_t fsize = getPackedFields (cloud, fields, fields_sizes);
+    size_t nr_points = cloud.data.size () / cloud.point_step;
+    if (nr_points == 0)
+      return (0);
+
+    unsigned int nr_chunks, chunk_points;
+    if (data_size < 2 * sizeof (unsigned int))
+      return (-1);
+    memcpy (&nr_chunks, &data[0], sizeof (unsigned int));
+    memcpy (&chunk_points, &data[4], sizeof (unsigned int));
+    if (chunk_points == 0 || nr_chunks != (total_points + chunk_points - 1) / chunk_points)
+      return (-1);
+
+    // Locate the chunks
+    std::vector<unsigned int> table (2 * nr_chunks);
+    size_t chunk_offset = (2 + table.size ()) * sizeof (unsigned int);
+    if (data_size < chunk_offset)
+      return (-1);
+    memcpy (&table[0], &data[8], table.size () * sizeof (unsigned int));
+    std::vector<size_t> offsets (nr_chunks + 1, chunk_offset);
+    for (size_t c = 0; c < nr_chunks; ++c)
+      offsets[c + 1] = offsets[c] + table[2 * c];
+    if (data_size < offsets.back ())
+      return (-1);
+
+    int first_chunk = static_cast<int> (first_point / chunk_points);
+    int last_chunk  = static_cast<int> ((first_point + nr_points - 1) / chunk_points);
+    int errors = 0;
+#pragma omp parallel num_threads (nr_threads)
+    {
+      std::vector<char> planes;
+#pragma omp for schedule (dynamic)
+      for (int c = first_chunk; c <= last_chunk; ++c)
+      {
+        size_t chunk_begin = static_cast<size_t> (c) * chunk_points;
+        size_t chunk_size  = std::min (static_cast<size_t> (chunk_points), total_points - chunk_begin);
+        unsigned int compressed_size = table[2 * c], uncompressed_size = table[2 * c + 1];
+        if (uncompressed_size != chunk_size * fsize)
+        {
+#pragma omp atomic
+          ++errors;
+          continue;
+        }
+
+        const char *src = &data[offsets[c]];
+        if (compressed_size != uncompressed_size)
+        {
+          planes.resize (uncompressed_size);
+          if (pcl::lzfDecompress (src, compressed_size, &planes[0], uncompressed_size) != uncompressed_size)
+          {
+#pragma omp atomic
+            ++errors;
+            continue;
+          }
+          src = &planes[0];
+        }
+
+        // Unpack the xxyyzz to xyz, for the points that fall inside the range
+        size_t begin = std::max (chunk_begin, first_point);
+        size_t end   = std::min (chunk_begin + chunk_size, first_point + nr_points);
+        const char *plane = src;
+        for (size_t j = 0; j < fields.size (); ++j)
+        {
+          const char *in = plane + (begin - chunk_begin) * fields_sizes[j];
+          for (size_t i = begin; i < end; ++i, in += fields_sizes[j])
+            memcpy (&cloud.data[(i - first_point) * cloud.point_step + fields[j].offset], in, fields_sizes[j]);
+          plane += fields_sizes[j] * chunk_size;
+        }
+      }
+    }
+    return (errors == 0 ? 0 : -1);
+  }
+
+  /** \brief Copy the tokens of an ASCII PCD line into the given point of a cloud.
+    * \param[in] st the tokens of the line
+    * \param[in,out] cloud the cloud holding the field description and the data
+    * \param[in] idx the index of the point to fill in
+    */
+  void
+  copyASCIIPoint (const std::vector<std::string> &st, sensor_msgs::PointCloud2 &cloud, unsigned int idx)
+  {
+    size_t total = 0;
+    // Copy data
+    for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+    {
+      // Ignore invalid padded dimensions that are inherited from binary data
+      if (cloud.fields[d].name == "_")
+      {
+        total += cloud.fields[d].count; // jump over this many elements in the string token
+        continue;
+      }
+      for (unsigned int c = 0; c < cloud.fields[d].count; ++c)
+      {
+        switch (cloud.fields[d].datatype)
+        {
+          case sensor_msgs::PointField::INT8:
+          {
+            pcl::copyStringValue<pcl::traits::asType<sensor_msgs::PointField::INT8>::type> (
+                st.at (total + c), cloud, idx, d, c);
+            break;
+          }
+          case sensor_msgs::PointField::UINT8:
+          {
+            pcl::copyStringValue<pcl::traits::asType<sensor_msgs::PointField::UINT8>::type> (
+                st.at (total + c), cloud, idx, d, c);
+            break;
+          }
+          case sensor_msgs::PointField::INT16:
+          {
+            pcl::copyStringValue<pcl::traits::asType<sensor_msgs::PointField::INT16>::type> (
+                st.at (total + c), cloud, idx, d, c);
+            break;
+          }
+          case sensor_msgs::PointField::UINT16:
+          {
+            pcl::copyStringValue<pcl::traits::asType<sensor_msgs::PointField::UINT16>::type> (
+                st.at (total + c), cloud, idx, d, c);
+            break;
+          }
+          case sensor_msgs::PointField::INT32:
+          {
+            pcl::copyStringValue<pcl::traits::asType<sensor_msgs::PointField::INT32>::type> (
+                st.at (total + c), cloud, idx, d, c);
+            break;
+          }
+          case sensor_msgs::PointField::UINT32:
+          {
+            pcl::copyStringValue<pcl::traits::asType<sensor_msgs::PointField::UINT32>::type> (
+                st.at (total + c), cloud, idx, d, c);
+            break;
+          }
+          case sensor_msgs::PointField::FLOAT32:
+          {
+            pcl::copyStringValue<pcl::traits::asType<sensor_msgs::PointField::FLOAT32>::type> (
+                st.at (total + c), cloud, idx, d, c);
+            break;
+          }
+          case sensor_msgs::PointField::FLOAT64:
+          {
+            pcl::copyStringValue<pcl::traits::asType<sensor_msgs::PointField::FLOAT64>::type> (
+                st.at (total + c), cloud, idx, d, c);
+            break;
+          }
+          default:
+            PCL_WARN ("[pcl::PCDReader] Incorrect field data type specified (%d)!\n",cloud.fields[d].datatype);
+            break;
+        }
+      }
+      total += cloud.fields[d].count; // jump over this many elements in the string token
+    }
+  }
+
+  /** \brief Check all values of a cloud for NaN/Inf values and set is_dense accordingly. */
+  void
+  updateIsDense (sensor_msgs::PointCloud2 &cloud)
+  {
+    cloud.is_dense = true;
+    if (cloud.width * cloud.height == 0)
+      return;
+    int point_size = static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
+    for (uint32_t i = 0; i < cloud.width * cloud.height; ++i)
+    {
+      for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+      {
+        for (uint32_t c = 0; c < cloud.fields[d].count; ++c)
+        {
+          switch (cloud.fields[d].datatype)
+          {
+            case sensor_msgs::PointField::INT8:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<sensor_msgs::PointField::INT8>::type>(cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case sensor_msgs::PointField::UINT8:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<sensor_msgs::PointField::UINT8>::type>(cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case sensor_msgs::PointField::INT16:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<sensor_msgs::PointField::INT16>::type>(cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case sensor_msgs::PointField::UINT16:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<sensor_msgs::PointField::UINT16>::type>(cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case sensor_msgs::PointField::INT32:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<sensor_msgs::PointField::INT32>::type>(cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case sensor_msgs::PointField::UINT32:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<sensor_msgs::PointField::UINT32>::type>(cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case sensor_msgs::PointField::FLOAT32:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<sensor_msgs::PointField::FLOAT32>::type>(cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case sensor_msgs::PointField::FLOAT64:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<sensor_msgs::PointField::FLOAT64>::type>(cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PCDFileMapping::map (const std::string &file_name, size_t size)
+{
+  unmap ();
+
+  int fd = pcl_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+    return (false);
+
+  // Make sure that the file is large enough to back the requested mapping
+  size_t file_size = static_cast<size_t> (pcl_lseek (fd, 0, SEEK_END));
+  if (size == 0)
+    size = file_size;
+  if (size == 0 || file_size < size)
+  {
+    PCL_ERROR ("[pcl::PCDFileMapping::map] File %s is truncated (%lu bytes, expected at least %lu)!\n", 
+               file_name.c_str (), static_cast<unsigned long> (file_size), static_cast<unsigned long> (size));
+    pcl_close (fd);
+    return (false);
+  }
+
+#ifdef _WIN32
+  HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  if (fm == NULL)
+  {
+    pcl_close (fd);
+    return (false);
+  }
+  char *map = static_cast<char*>(MapViewOfFile (fm, FILE_MAP_READ, 0, 0, size));
+  // The view keeps a reference to the mapping object, so the handles can go
+  CloseHandle (fm);
+  if (map == NULL)
+  {
+    pcl_close (fd);
+    return (false);
+  }
+#else
+  char *map = static_cast<char*> (mmap (0, size, PROT_READ, MAP_SHARED, fd, 0));
+  if (map == reinterpret_cast<char*> (-1))    // MAP_FAILED
+  {
+    pcl_close (fd);
+    return (false);
+  }
+#endif
+  // The mapping stays valid after the descriptor is closed
+  pcl_close (fd);
+
+  map_  = map;
+  size_ = size;
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDFileMapping::unmap ()
+{
+  if (map_ == NULL)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile (map_);
+#else
+  munmap (map_, size_);
+#endif
+  map_  = NULL;
+  size_ = 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDReader::readHeader (const std::string &file_name, sensor_msgs::PointCloud2 &cloud, 
@@ -279,8 +628,6 @@ pcl::PCDReader::readHeader (const std::string &file_name, sensor_msgs::PointClou
       if (line_type.substr (0, 6) == "POINTS")
       {
         sstream >> nr_points;
-        // Need to allocate: N * point_step
-        cloud.data.resize (nr_points * cloud.point_step);
         continue;
       }
 
@@ -288,7 +635,9 @@ pcl::PCDReader::readHeader (const std::string &file_name, sensor_msgs::PointClou
       if (line_type.substr (0, 4) == "DATA")
       {
         data_idx = static_cast<int> (fs.tellg ());
-        if (st.at (1).substr (0, 17) == "binary_compressed")
+        if (st.at (1).substr (0, 25) == "binary_compressed_chunked")
+          data_type = 3;
+        else if (st.at (1).substr (0, 17) == "binary_compressed")
          data_type = 2;
         else
           if (st.at (1).substr (0, 6) == "binary")
@@ -555,7 +904,9 @@ pcl::PCDReader::readHeaderEigen (const std::string &file_name, pcl::PointCloud<E
       if (line_type.substr (0, 4) == "DATA")
       {
         data_idx = static_cast<int> (fs.tellg ());
-        if (st.at (1).substr (0, 17) == "binary_compressed")
+        if (st.at (1).substr (0, 25) == "binary_compressed_chunked")
+          data_type = 3;
+        else if (st.at (1).substr (0, 17) == "binary_compressed")
          data_type = 2;
         else
           if (st.at (1).substr (0, 6) == "binary")
@@ -630,6 +981,9 @@ pcl::PCDReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
   // Get the number of points the cloud should have
   unsigned int nr_points = cloud.width * cloud.height;
 
+  // Need to allocate: N * point_step (readHeader only fills in the meta information)
+  cloud.data.resize (nr_points * cloud.point_step);
+
   // Setting the is_dense property to true by default
   cloud.is_dense = true;
 
@@ -670,75 +1024,7 @@ pcl::PCDReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
           break;
         }
 
-        size_t total = 0;
-        // Copy data
-        for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
-        {
-          // Ignore invalid padded dimensions that are inherited from binary data
-          if (cloud.fields[d].name == "_")
-          {
-            total += cloud.fields[d].count; // jump over this many elements in the string token
-            continue;
-          }
-          for (unsigned int c = 0; c < cloud.fields[d].count; ++c)
-          {
-            switch (cloud.fields[d].datatype)
-            {
-              case sensor_msgs::PointField::INT8:
-              {
-                copyStringValue<pcl::traits::asType<sensor_msgs::PointField::INT8>::type> (
-                    st.at (total + c), cloud, idx, d, c);
-                break;
-              }
-              case sensor_msgs::PointField::UINT8:
-              {
-                copyStringValue<pcl::traits::asType<sensor_msgs::PointField::UINT8>::type> (
-                    st.at (total + c), cloud, idx, d, c);
-                break;
-              }
-              case sensor_msgs::PointField::INT16:
-              {
-                copyStringValue<pcl::traits::asType<sensor_msgs::PointField::INT16>::type> (
-                    st.at (total + c), cloud, idx, d, c);
-                break;
-              }
-              case sensor_msgs::PointField::UINT16:
-              {
-                copyStringValue<pcl::traits::asType<sensor_msgs::PointField::UINT16>::type> (
-                    st.at (total + c), cloud, idx, d, c);
-                break;
-              }
-              case sensor_msgs::PointField::INT32:
-              {
-                copyStringValue<pcl::traits::asType<sensor_msgs::PointField::INT32>::type> (
-                    st.at (total + c), cloud, idx, d, c);
-                break;
-              }
-              case sensor_msgs::PointField::UINT32:
-              {
-                copyStringValue<pcl::traits::asType<sensor_msgs::PointField::UINT32>::type> (
-                    st.at (total + c), cloud, idx, d, c);
-                break;
-              }
-              case sensor_msgs::PointField::FLOAT32:
-              {
-                copyStringValue<pcl::traits::asType<sensor_msgs::PointField::FLOAT32>::type> (
-                    st.at (total + c), cloud, idx, d, c);
-                break;
-              }
-              case sensor_msgs::PointField::FLOAT64:
-              {
-                copyStringValue<pcl::traits::asType<sensor_msgs::PointField::FLOAT64>::type> (
-                    st.at (total + c), cloud, idx, d, c);
-                break;
-              }
-              default:
-                PCL_WARN ("[pcl::PCDReader::read] Incorrect field data type specified (%d)!\n",cloud.fields[d].datatype);
-                break;
-            }
-          }
-          total += cloud.fields[d].count; // jump over this many elements in the string token
-        }
+        copyASCIIPoint (st, cloud, idx);
         idx++;
       }
     }
@@ -752,6 +1038,23 @@ pcl::PCDReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
     fs.close ();
 
   }
+  /// ---[ Binary compressed chunked mode only
+  else if (data_type == 3)
+  {
+    // The size of the compressed data is not known up front, so map the whole file
+    PCDFileMapping mapping;
+    if (!mapping.map (file_name, 0) || mapping.size () < data_idx)
+    {
+      PCL_ERROR ("[pcl::PCDReader::read] Could not map file %s.\n", file_name.c_str ());
+      return (-1);
+    }
+    if (decodeCompressedChunks (mapping.data () + data_idx, mapping.size () - data_idx, 
+                                nr_points, 0, threads_, cloud) < 0)
+    {
+      PCL_ERROR ("[pcl::PCDReader::read] Corrupted binary_compressed_chunked data in %s!\n", file_name.c_str ());
+      return (-1);
+    }
+  }
   else 
   /// ---[ Binary mode only
   /// We must re-open the file and read with mmap () for binary
@@ -900,68 +1203,8 @@ pcl::PCDReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
   if (data_type == 0)
     return (0);
 
-  int point_size = static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
   // Once copied, we need to go over each field and check if it has NaN/Inf values and assign cloud.is_dense to true or false
-  for (uint32_t i = 0; i < cloud.width * cloud.height; ++i)
-  {
-    for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
-    {
-      for (uint32_t c = 0; c < cloud.fields[d].count; ++c)
-      {
-        switch (cloud.fields[d].datatype)
-        {
-          case sensor_msgs::PointField::INT8:
-          {
-            if (!isValueFinite<pcl::traits::asType<sensor_msgs::PointField::INT8>::type>(cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case sensor_msgs::PointField::UINT8:
-          {
-            if (!isValueFinite<pcl::traits::asType<sensor_msgs::PointField::UINT8>::type>(cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case sensor_msgs::PointField::INT16:
-          {
-            if (!isValueFinite<pcl::traits::asType<sensor_msgs::PointField::INT16>::type>(cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case sensor_msgs::PointField::UINT16:
-          {
-            if (!isValueFinite<pcl::traits::asType<sensor_msgs::PointField::UINT16>::type>(cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case sensor_msgs::PointField::INT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<sensor_msgs::PointField::INT32>::type>(cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case sensor_msgs::PointField::UINT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<sensor_msgs::PointField::UINT32>::type>(cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case sensor_msgs::PointField::FLOAT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<sensor_msgs::PointField::FLOAT32>::type>(cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case sensor_msgs::PointField::FLOAT64:
-          {
-            if (!isValueFinite<pcl::traits::asType<sensor_msgs::PointField::FLOAT64>::type>(cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-        }
-      }
-    }
-  }
+  updateIsDense (cloud);
 
   return (0);
 }
@@ -1086,7 +1329,7 @@ pcl::PCDReader::readEigen (const std::string &file_name, pcl::PointCloud<Eigen::
 #endif
 
     /// ---[ Binary compressed mode only
-    if (data_type == 2)
+    if (data_type == 2 || data_type == 3)
       throw pcl::IOException ("[pcl::PCDReader::readEigen] PCD binary_compressed mode not implemented for Eigen::MatrixXf!");
     else
     {
@@ -1159,6 +1402,190 @@ pcl::PCDReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readBatches (const std::string &file_name, unsigned int batch_size, 
+                             const BatchCallback &callback, const int offset)
+{
+  sensor_msgs::PointCloud2 batch;
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  int res = readHeader (file_name, batch, origin, orientation, pcd_version, data_type, data_idx, offset);
+  if (res < 0)
+    return (res);
+
+  if (batch_size == 0)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readBatches] The batch size must be larger than 0!\n");
+    return (-1);
+  }
+
+  const uint32_t width = batch.width, height = batch.height;
+  const size_t total_points = static_cast<size_t> (width) * height;
+  // Organized clouds are delivered in whole rows
+  if (height > 1)
+    batch_size = std::max (batch_size / width, 1u) * width;
+
+  std::ifstream fs;
+  PCDFileMapping mapping;
+  sensor_msgs::PointCloud2 cloud;
+  if (data_type == 0 || data_type == 1)
+  {
+    fs.open (file_name.c_str (), std::ios::binary);
+    if (!fs.is_open () || fs.fail ())
+    {
+      PCL_ERROR ("[pcl::PCDReader::readBatches] Could not open file %s.\n", file_name.c_str ());
+      return (-1);
+    }
+    fs.seekg (data_idx);
+  }
+  else if (data_type == 3)
+  {
+    if (!mapping.map (file_name, 0) || mapping.size () < data_idx)
+    {
+      PCL_ERROR ("[pcl::PCDReader::readBatches] Could not map file %s.\n", file_name.c_str ());
+      return (-1);
+    }
+  }
+  else
+  {
+    // A single binary_compressed block can only be decompressed as a whole
+    res = read (file_name, cloud, origin, orientation, pcd_version, offset);
+    if (res < 0)
+      return (res);
+  }
+
+  std::string line;
+  std::vector<std::string> st;
+  for (size_t first_point = 0; first_point < total_points; first_point += batch_size)
+  {
+    uint32_t nr_points = static_cast<uint32_t> (std::min (static_cast<size_t> (batch_size), total_points - first_point));
+    batch.width    = (height > 1) ? width : nr_points;
+    batch.height   = (height > 1) ? nr_points / width : 1;
+    batch.row_step = batch.point_step * batch.width;
+    batch.data.resize (static_cast<size_t> (nr_points) * batch.point_step);
+    batch.is_dense = true;
+
+    switch (data_type)
+    {
+      case 0:
+      {
+        uint32_t idx = 0;
+        while (idx < nr_points && getline (fs, line))
+        {
+          // Ignore empty lines
+          boost::trim (line);
+          if (line == "")
+            continue;
+          boost::split (st, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
+          copyASCIIPoint (st, batch, idx++);
+        }
+        if (idx != nr_points)
+        {
+          PCL_ERROR ("[pcl::PCDReader::readBatches] Number of points read (%lu) is different than expected (%lu)\n", 
+                     static_cast<unsigned long> (first_point + idx), static_cast<unsigned long> (total_points));
+          return (-1);
+        }
+        break;
+      }
+      case 1:
+      {
+        if (!fs.read (reinterpret_cast<char*> (&batch.data[0]), batch.data.size ()))
+        {
+          PCL_ERROR ("[pcl::PCDReader::readBatches] File %s is truncated!\n", file_name.c_str ());
+          return (-1);
+        }
+        updateIsDense (batch);
+        break;
+      }
+      case 2:
+      {
+        memcpy (&batch.data[0], &cloud.data[first_point * cloud.point_step], batch.data.size ());
+        updateIsDense (batch);
+        break;
+      }
+      default:
+      {
+        if (decodeCompressedChunks (mapping.data () + data_idx, mapping.size () - data_idx, 
+                                    total_points, first_point, threads_, batch) < 0)
+        {
+          PCL_ERROR ("[pcl::PCDReader::readBatches] Corrupted binary_compressed_chunked data in %s!\n", file_name.c_str ());
+          return (-1);
+        }
+        updateIsDense (batch);
+        break;
+      }
+    }
+
+    if (!callback (batch, static_cast<unsigned int> (first_point)))
+      break;
+  }
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readRange (const std::string &file_name, sensor_msgs::PointCloud2 &cloud, 
+                           unsigned int first_point, unsigned int nr_points, const int offset)
+{
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  int res = readHeader (file_name, cloud, origin, orientation, pcd_version, data_type, data_idx, offset);
+  if (res < 0)
+    return (res);
+
+  size_t total_points = cloud.width * cloud.height;
+  if (static_cast<size_t> (first_point) + nr_points > total_points)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readRange] Points [%u, %u) are out of range, %s contains %lu points!\n", 
+               first_point, first_point + nr_points, file_name.c_str (), static_cast<unsigned long> (total_points));
+    return (-1);
+  }
+
+  if (data_type == 1 || data_type == 3)
+  {
+    // Binary data is read straight from the mapping, and only the chunks holding the range are decompressed
+    PCDFileMapping mapping;
+    size_t map_size = (data_type == 1) ? data_idx + total_points * cloud.point_step : 0;
+    if (!mapping.map (file_name, map_size) || mapping.size () < data_idx)
+    {
+      PCL_ERROR ("[pcl::PCDReader::readRange] Could not map file %s.\n", file_name.c_str ());
+      return (-1);
+    }
+    cloud.data.resize (static_cast<size_t> (nr_points) * cloud.point_step);
+    if (data_type == 1)
+    {
+      if (!cloud.data.empty ())
+        memcpy (&cloud.data[0], mapping.data () + data_idx + static_cast<size_t> (first_point) * cloud.point_step, cloud.data.size ());
+    }
+    else if (decodeCompressedChunks (mapping.data () + data_idx, mapping.size () - data_idx, 
+                                     total_points, first_point, threads_, cloud) < 0)
+    {
+      PCL_ERROR ("[pcl::PCDReader::readRange] Corrupted binary_compressed_chunked data in %s!\n", file_name.c_str ());
+      return (-1);
+    }
+  }
+  else
+  {
+    // ASCII and binary_compressed data can only be read as a whole
+    res = read (file_name, cloud, origin, orientation, pcd_version, offset);
+    if (res < 0)
+      return (res);
+    cloud.data.erase (cloud.data.begin () + (static_cast<size_t> (first_point) + nr_points) * cloud.point_step, cloud.data.end ());
+    cloud.data.erase (cloud.data.begin (), cloud.data.begin () + static_cast<size_t> (first_point) * cloud.point_step);
+  }
+
+  cloud.width    = nr_points;
+  cloud.height   = 1;
+  cloud.row_step = cloud.point_step * nr_points;
+  updateIsDense (cloud);
+  return (0);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::string
 pcl::PCDWriter::generateHeaderASCII (const sensor_msgs::PointCloud2 &cloud, 
@@ -1283,23 +1710,28 @@ pcl::PCDWriter::generateHeaderBinary (const sensor_msgs::PointCloud2 &cloud,
     return ("");
   }
 
+  // The fields are described in the order of their bytes in the records, e.g., the normal of PointXYZRGBNormal
+  // comes before its rgb field even though it is registered after it
+  std::vector<sensor_msgs::PointField> fields (cloud.fields);
+  std::sort (fields.begin (), fields.end (), fieldOffsetLess);
+
   std::stringstream field_names, field_types, field_sizes, field_counts;
   // Check if the size of the fields is smaller than the size of the point step
   unsigned int toffset = 0;
-  for (size_t i = 0; i < cloud.fields.size (); ++i)
+  for (size_t i = 0; i < fields.size (); ++i)
   {
     // If field offsets do not match, then we need to create fake fields
-    if (toffset != cloud.fields[i].offset)
+    if (toffset != fields[i].offset)
     {
       // If we're at the last "valid" field
       int fake_offset = (i == 0) ? 
         // Use the current_field offset
-        (cloud.fields[i].offset)
+        (fields[i].offset)
         :
         // Else, do cur_field.offset - prev_field.offset + sizeof (prev_field)
-        (cloud.fields[i].offset - 
-        (cloud.fields[i-1].offset + 
-         cloud.fields[i-1].count * getFieldSize (cloud.fields[i].datatype)));
+        (fields[i].offset - 
+        (fields[i-1].offset + 
+         fields[i-1].count * getFieldSize (fields[i-1].datatype)));
       
       toffset += fake_offset;
 
@@ -1310,11 +1742,11 @@ pcl::PCDWriter::generateHeaderBinary (const sensor_msgs::PointCloud2 &cloud,
     }
 
     // Add the regular dimension
-    toffset += cloud.fields[i].count * getFieldSize (cloud.fields[i].datatype);
-    field_names << " " << cloud.fields[i].name;
-    field_sizes << " " << pcl::getFieldSize (cloud.fields[i].datatype);
-    field_types << " " << pcl::getFieldType (cloud.fields[i].datatype);
-    int count = abs (static_cast<int> (cloud.fields[i].count));
+    toffset += fields[i].count * getFieldSize (fields[i].datatype);
+    field_names << " " << fields[i].name;
+    field_sizes << " " << pcl::getFieldSize (fields[i].datatype);
+    field_types << " " << pcl::getFieldType (fields[i].datatype);
+    int count = abs (static_cast<int> (fields[i].count));
     if (count == 0) count = 1;  // check for 0 counts (coming from older converter code)
     field_counts << " " << count;
   }
@@ -1501,6 +1933,21 @@ pcl::PCDWriter::writeASCII (const std::string &file_name, const sensor_msgs::Poi
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDWriter::appendDataBinary (std::ostringstream &oss)
+{
+  // Pad the header with a comment line so that the binary data starts on a 16 byte
+  // boundary, which lets PCDReader::readView use the mapped points in place
+  size_t header_size = static_cast<size_t> (oss.tellp ()) + strlen ("DATA binary\n");
+  size_t padding = (16 - header_size % 16) % 16;
+  if (padding == 1)
+    padding += 16;
+  if (padding > 0)
+    oss << "#" << std::string (padding - 2, ' ') << "\n";
+  oss << "DATA binary\n";
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDWriter::writeBinary (const std::string &file_name, const sensor_msgs::PointCloud2 &cloud,
@@ -1515,7 +1962,8 @@ pcl::PCDWriter::writeBinary (const std::string &file_name, const sensor_msgs::Po
   std::ostringstream oss;
   oss.imbue (std::locale::classic ());
 
-  oss << generateHeaderBinary (cloud, origin, orientation) << "DATA binary\n";
+  oss << generateHeaderBinary (cloud, origin, orientation);
+  appendDataBinary (oss);
   oss.flush();
   data_idx = static_cast<unsigned int> (oss.tellp ());
 
@@ -1782,6 +2230,84 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, const senso
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeBinaryCompressedChunked (const std::string &file_name, const sensor_msgs::PointCloud2 &cloud,
+                                              const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
+{
+  if (cloud.data.empty ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Input point cloud has no data!\n");
+    return (-1);
+  }
+
+  std::vector<sensor_msgs::PointField> fields;
+  std::vector<int> fields_sizes;
+  size_t fsize = getPackedFields (cloud, fields, fields_sizes);
+  size_t nr_points = cloud.width * cloud.height;
+  unsigned int chunk_points = compression_chunk_size_;
+  unsigned int nr_chunks = static_cast<unsigned int> ((nr_points + chunk_points - 1) / chunk_points);
+
+  std::ofstream fs;
+  fs.open (file_name.c_str (), std::ios::binary);
+  if (!fs.is_open () || fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Could not open file '%s' for writing!\n", file_name.c_str ());
+    return (-1);
+  }
+  fs << generateHeaderBinaryCompressed (cloud, origin, orientation) << "DATA binary_compressed_chunked\n";
+  fs.write (reinterpret_cast<const char*> (&nr_chunks), sizeof (unsigned int));
+  fs.write (reinterpret_cast<const char*> (&chunk_points), sizeof (unsigned int));
+  // The chunk size table is filled in once all the chunks are written
+  std::streampos table_pos = fs.tellp ();
+  std::vector<unsigned int> table (2 * nr_chunks, 0);
+  fs.write (reinterpret_cast<const char*> (&table[0]), table.size () * sizeof (unsigned int));
+
+  // Every chunk is reordered from XYZRGBXYZRGB to XXYYZZRGBRGB and compressed on its own. The chunks are written
+  // in order as soon as they are compressed, so only one chunk per thread is kept in memory.
+#pragma omp parallel num_threads (threads_)
+  {
+    std::vector<char> planes, compressed;
+#pragma omp for ordered schedule (dynamic)
+    for (int c = 0; c < static_cast<int> (nr_chunks); ++c)
+    {
+      size_t chunk_begin = static_cast<size_t> (c) * chunk_points;
+      size_t chunk_size  = std::min (static_cast<size_t> (chunk_points), nr_points - chunk_begin);
+      unsigned int raw_size = static_cast<unsigned int> (chunk_size * fsize);
+      planes.resize (raw_size);
+      char *out = &planes[0];
+      for (size_t j = 0; j < fields.size (); ++j)
+        for (size_t i = chunk_begin; i < chunk_begin + chunk_size; ++i, out += fields_sizes[j])
+          memcpy (out, &cloud.data[i * cloud.point_step + fields[j].offset], fields_sizes[j]);
+
+      // Keep the chunk uncompressed if LZF cannot make it any smaller
+      compressed.resize (raw_size);
+      unsigned int compressed_size = pcl::lzfCompress (&planes[0], raw_size, &compressed[0], raw_size - 1);
+      const char *chunk = &compressed[0];
+      if (compressed_size == 0)
+      {
+        chunk = &planes[0];
+        compressed_size = raw_size;
+      }
+      table[2 * c]     = compressed_size;
+      table[2 * c + 1] = raw_size;
+
+#pragma omp ordered
+      fs.write (chunk, compressed_size);
+    }
+  }
+
+  fs.seekp (table_pos);
+  fs.write (reinterpret_cast<const char*> (&table[0]), table.size () * sizeof (unsigned int));
+  fs.close ();
+  if (fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Error writing to file '%s'!\n", file_name.c_str ());
+    return (-1);
+  }
+  return (0);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::string
 pcl::PCDWriter::generateHeaderEigen (const pcl::PointCloud<Eigen::MatrixXf> &cloud, 
@@ -74,7 +74,7 @@ pcl::PLYReader::elementDefinitionCallback (const std::string& element_name, std:
     cloud_->is_dense = true;
     return (boost::tuple<boost::function<void ()>, boost::function<void ()> > (0, 0));
   }
-  else if (element_name == "range_grid")
+  else if (element_name == "range_grid" && batch_size_ == 0)
   {
     (*range_grid_).resize (count);
     range_count_ = 0;
@@ -91,8 +91,12 @@ pcl::PLYReader::elementDefinitionCallback (const std::string& element_name, std:
 bool
 pcl::PLYReader::endHeaderCallback ()
 {
-  cloud_->data.resize (cloud_->point_step * cloud_->width * cloud_->height);
-  return (cloud_->data.size () == cloud_->point_step * cloud_->width * cloud_->height);
+  size_t nr_points = cloud_->width * cloud_->height;
+  // When streaming, only hold one batch of vertices
+  if (batch_size_ > 0)
+    nr_points = std::min (nr_points, batch_size_);
+  cloud_->data.resize (cloud_->point_step * nr_points);
+  return (cloud_->data.size () == cloud_->point_step * nr_points);
 }
 
 void
@@ -229,7 +233,7 @@ namespace pcl
   boost::tuple<boost::function<void (pcl::io::ply::uint8)>, boost::function<void (pcl::io::ply::int32)>, boost::function<void ()> >
   pcl::PLYReader::listPropertyDefinitionCallback (const std::string& element_name, const std::string& property_name)
   {
-    if ((element_name == "range_grid") && (property_name == "vertex_indices")) {
+    if ((element_name == "range_grid") && (property_name == "vertex_indices") && (batch_size_ == 0)) {
       return boost::tuple<boost::function<void (pcl::io::ply::uint8)>, boost::function<void (pcl::io::ply::int32)>, boost::function<void ()> > (
         boost::bind (&pcl::PLYReader::rangeGridVertexIndicesBeginCallback, this, _1),
         boost::bind (&pcl::PLYReader::rangeGridVertexIndicesElementCallback, this, _1),
@@ -302,6 +306,25 @@ void
 pcl::PLYReader::vertexEndCallback ()
 {
   ++vertex_count_;
+  if (batch_size_ > 0 && vertex_count_ == batch_size_)
+    flushBatch ();
+}
+
+void
+pcl::PLYReader::flushBatch ()
+{
+  if (!batch_stopped_)
+  {
+    // The batch only covers the vertices read so far
+    cloud_->width    = static_cast<uint32_t> (vertex_count_);
+    cloud_->height   = 1;
+    cloud_->row_step = cloud_->point_step * cloud_->width;
+    cloud_->data.resize (cloud_->point_step * vertex_count_);
+    batch_stopped_ = !batch_callback_ (*cloud_, static_cast<unsigned int> (batch_first_point_));
+    cloud_->data.resize (cloud_->point_step * batch_size_);
+  }
+  batch_first_point_ += vertex_count_;
+  vertex_count_ = 0;
 }
 
 void
@@ -445,6 +468,38 @@ pcl::PLYReader::read (const std::string &file_name, sensor_msgs::PointCloud2 &cl
   return (0);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PLYReader::readBatches (const std::string &file_name, unsigned int batch_size, const BatchCallback &callback)
+{
+  if (batch_size == 0)
+  {
+    PCL_ERROR ("[pcl::PLYReader::readBatches] The batch size must be larger than 0!\n");
+    return (-1);
+  }
+
+  sensor_msgs::PointCloud2 batch;
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int ply_version, data_type;
+  unsigned int data_idx;
+
+  batch_size_ = batch_size;
+  batch_callback_ = callback;
+  batch_first_point_ = 0;
+  batch_stopped_ = false;
+
+  // The parser reads the vertices along with the header, handing over every full batch
+  int res = readHeader (file_name, batch, origin, orientation, ply_version, data_type, data_idx);
+  // Deliver the last, partial batch
+  if (res == 0 && vertex_count_ > 0)
+    flushBatch ();
+
+  batch_size_ = 0;
+  batch_callback_ = BatchCallback ();
+  return (res);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 
 std::string
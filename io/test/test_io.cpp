@@ -720,6 +720,181 @@ TEST (PCL, PCDReaderWriter)
   EXPECT_FLOAT_EQ (cloud.points[nr_p - 1].intensity, last.intensity); // test for fromROSMsg ()
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDReaderView)
+{
+  PointCloud<PointXYZ> cloud;
+  cloud.width  = 64;
+  cloud.height = 48;
+  cloud.points.resize (cloud.width * cloud.height);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    cloud.points[i].x = static_cast<float> (i);
+    cloud.points[i].y = static_cast<float> (2 * i);
+    cloud.points[i].z = static_cast<float> (3 * i);
+  }
+  sensor_msgs::PointCloud2 cloud_blob;
+  toROSMsg (cloud, cloud_blob);
+
+  PCDWriter writer;
+  PCDReader reader;
+
+  // Binary data with the same layout as PointXYZ is used in place
+  writer.write ("test_pcl_io_view.pcd", cloud_blob, Eigen::Vector4f::Zero (), Eigen::Quaternionf::Identity (), true);
+  PCDCloudView<PointXYZ> view;
+  EXPECT_EQ (reader.readView ("test_pcl_io_view.pcd", view), 0);
+  EXPECT_TRUE (view.isMapped ());
+  EXPECT_EQ (view.width, cloud.width);
+  EXPECT_EQ (view.height, cloud.height);
+  ASSERT_EQ (view.size (), cloud.points.size ());
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    EXPECT_EQ (view[i].x, cloud.points[i].x);
+    EXPECT_EQ (view[i].y, cloud.points[i].y);
+    EXPECT_EQ (view[i].z, cloud.points[i].z);
+  }
+  EXPECT_EQ (view.at (63, 47).z, cloud.at (63, 47).z);
+
+  // The mapping outlives the view it was read into
+  {
+    PCDCloudView<PointXYZ> copy = view;
+    view = PCDCloudView<PointXYZ> ();
+    EXPECT_EQ (copy[copy.size () - 1].y, cloud.points.back ().y);
+  }
+
+  // ASCII data and mismatching point types are converted into owned storage
+  writer.write ("test_pcl_io_view.pcd", cloud_blob, Eigen::Vector4f::Zero (), Eigen::Quaternionf::Identity (), false);
+  EXPECT_EQ (reader.readView ("test_pcl_io_view.pcd", view), 0);
+  EXPECT_FALSE (view.isMapped ());
+  ASSERT_EQ (view.size (), cloud.points.size ());
+  EXPECT_EQ (view[100].y, cloud.points[100].y);
+
+  PCDCloudView<PointXYZRGB> rgb_view;
+  EXPECT_EQ (reader.readView ("test_pcl_io_view.pcd", rgb_view), 0);
+  EXPECT_FALSE (rgb_view.isMapped ());
+  EXPECT_EQ (rgb_view[100].z, cloud.points[100].z);
+
+  // By default, the templated binary writers pack the fields, so their files are copied
+  savePCDFileBinary ("test_pcl_io_view.pcd", cloud);
+  EXPECT_EQ (reader.readView ("test_pcl_io_view.pcd", view), 0);
+  EXPECT_FALSE (view.isMapped ());
+  ASSERT_EQ (view.size (), cloud.points.size ());
+  EXPECT_EQ (view[100].y, cloud.points[100].y);
+  EXPECT_EQ (view[view.size () - 1].z, cloud.points.back ().z);
+
+  // With the point layout, they store the points like PointT, so their files are mapped as well
+  writer.setBinaryPointLayout (true);
+  writer.write ("test_pcl_io_view.pcd", cloud, true);
+  EXPECT_EQ (reader.readView ("test_pcl_io_view.pcd", view), 0);
+  EXPECT_TRUE (view.isMapped ());
+  ASSERT_EQ (view.size (), cloud.points.size ());
+  EXPECT_EQ (view[100].y, cloud.points[100].y);
+  EXPECT_EQ (view[view.size () - 1].z, cloud.points.back ().z);
+
+  std::vector<int> indices (10);
+  for (int i = 0; i < 10; ++i)
+    indices[i] = 3 * i;
+  writer.write ("test_pcl_io_view.pcd", cloud, indices, true);
+  EXPECT_EQ (reader.readView ("test_pcl_io_view.pcd", view), 0);
+  EXPECT_TRUE (view.isMapped ());
+  ASSERT_EQ (view.size (), indices.size ());
+  EXPECT_EQ (view[9].x, cloud.points[27].x);
+
+  PointCloud<PointXYZRGBNormal> cloud_normals;
+  cloud_normals.width  = 10;
+  cloud_normals.height = 1;
+  cloud_normals.points.resize (10);
+  for (size_t i = 0; i < cloud_normals.points.size (); ++i)
+  {
+    cloud_normals.points[i].x = static_cast<float> (i);
+    cloud_normals.points[i].normal_z = static_cast<float> (2 * i);
+    cloud_normals.points[i].curvature = static_cast<float> (3 * i);
+  }
+  writer.write ("test_pcl_io_view.pcd", cloud_normals, true);
+  PCDCloudView<PointXYZRGBNormal> normals_view;
+  EXPECT_EQ (reader.readView ("test_pcl_io_view.pcd", normals_view), 0);
+  EXPECT_TRUE (normals_view.isMapped ());
+  ASSERT_EQ (normals_view.size (), cloud_normals.points.size ());
+  EXPECT_EQ (normals_view[7].normal_z, cloud_normals.points[7].normal_z);
+  EXPECT_EQ (normals_view[7].curvature, cloud_normals.points[7].curvature);
+
+  // And read back into regular clouds
+  PointCloud<PointXYZRGBNormal> cloud_normals_read;
+  EXPECT_EQ (reader.read ("test_pcl_io_view.pcd", cloud_normals_read), 0);
+  ASSERT_EQ (cloud_normals_read.points.size (), cloud_normals.points.size ());
+  EXPECT_EQ (cloud_normals_read.points[7].x, cloud_normals.points[7].x);
+  EXPECT_EQ (cloud_normals_read.points[7].normal_z, cloud_normals.points[7].normal_z);
+  EXPECT_EQ (cloud_normals_read.points[7].curvature, cloud_normals.points[7].curvature);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+collectBatch (const sensor_msgs::PointCloud2 &batch, unsigned int first_point, 
+              PointCloud<PointXYZ> *cloud, std::vector<uint32_t> *heights)
+{
+  EXPECT_EQ (first_point, cloud->points.size ());
+  PointCloud<PointXYZ> points;
+  fromROSMsg (batch, points);
+  cloud->points.insert (cloud->points.end (), points.points.begin (), points.points.end ());
+  heights->push_back (batch.height);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ReadBatches)
+{
+  PointCloud<PointXYZ> cloud;
+  cloud.width  = 64;
+  cloud.height = 48;
+  cloud.points.resize (cloud.width * cloud.height);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    cloud.points[i].x = static_cast<float> (i);
+    cloud.points[i].y = static_cast<float> (2 * i);
+    cloud.points[i].z = static_cast<float> (3 * i);
+  }
+  sensor_msgs::PointCloud2 cloud_blob;
+  toROSMsg (cloud, cloud_blob);
+
+  PCDWriter writer;
+  PCDReader reader;
+  PointCloud<PointXYZ> streamed;
+  std::vector<uint32_t> heights;
+
+  // Organized clouds come in whole rows: 1000 points hold 15 rows of 64
+  writer.write ("test_pcl_io_batches.pcd", cloud_blob, Eigen::Vector4f::Zero (), Eigen::Quaternionf::Identity (), true);
+  EXPECT_EQ (reader.readBatches ("test_pcl_io_batches.pcd", 1000, boost::bind (&collectBatch, _1, _2, &streamed, &heights)), 0);
+  ASSERT_EQ (streamed.points.size (), cloud.points.size ());
+  ASSERT_EQ (heights.size (), size_t (4));
+  EXPECT_EQ (heights[0], uint32_t (15));
+  EXPECT_EQ (heights[3], uint32_t (3));
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+    EXPECT_EQ (streamed.points[i].z, cloud.points[i].z);
+
+  // Unorganized ASCII data
+  cloud_blob.width  = cloud.width * cloud.height;
+  cloud_blob.height = 1;
+  writer.write ("test_pcl_io_batches.pcd", cloud_blob, Eigen::Vector4f::Zero (), Eigen::Quaternionf::Identity (), false);
+  streamed.points.clear ();
+  heights.clear ();
+  EXPECT_EQ (reader.readBatches ("test_pcl_io_batches.pcd", 1000, boost::bind (&collectBatch, _1, _2, &streamed, &heights)), 0);
+  ASSERT_EQ (streamed.points.size (), cloud.points.size ());
+  EXPECT_EQ (heights.size (), size_t (4));
+  EXPECT_EQ (streamed.points.back ().y, cloud.points.back ().y);
+
+  // PLY vertices
+  PLYWriter ply_writer;
+  ply_writer.write ("test_pcl_io_batches.ply", cloud_blob, Eigen::Vector4f::Zero (), Eigen::Quaternionf::Identity (), true, false);
+  PLYReader ply_reader;
+  streamed.points.clear ();
+  heights.clear ();
+  EXPECT_EQ (ply_reader.readBatches ("test_pcl_io_batches.ply", 1000, boost::bind (&collectBatch, _1, _2, &streamed, &heights)), 0);
+  ASSERT_EQ (streamed.points.size (), cloud.points.size ());
+  EXPECT_EQ (heights.size (), size_t (4));
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+    EXPECT_EQ (streamed.points[i].x, cloud.points[i].x);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PCDReaderWriterEigen)
 {
@@ -1186,6 +1361,86 @@ TEST (PCL, LZFExtended)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LZFChunked)
+{
+  PointCloud<PointXYZRGBNormal> cloud, cloud2;
+  cloud.width  = 640;
+  cloud.height = 480;
+  cloud.points.resize (cloud.width * cloud.height);
+  cloud.is_dense = true;
+
+  srand (static_cast<unsigned int> (time (NULL)));
+  size_t nr_p = cloud.points.size ();
+  // Smooth coordinates compress well, random normals do not
+  for (size_t i = 0; i < nr_p; ++i)
+  {
+    cloud.points[i].x = static_cast<float> (i % cloud.width);
+    cloud.points[i].y = static_cast<float> (i / cloud.width);
+    cloud.points[i].z = 1.0f;
+    cloud.points[i].normal_x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].normal_y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].normal_z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    cloud.points[i].rgb = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+  }
+
+  sensor_msgs::PointCloud2 blob;
+  pcl::toROSMsg (cloud, blob);
+
+  PCDWriter writer;
+  writer.setNumberOfThreads (4);
+  writer.setCompressionChunkSize (10000);
+  int res = writer.writeBinaryCompressedChunked ("test_pcl_io_compressed.pcd", blob);
+  EXPECT_EQ (res, 0);
+
+  PCDReader reader;
+  reader.setNumberOfThreads (4);
+  reader.read<PointXYZRGBNormal> ("test_pcl_io_compressed.pcd", cloud2);
+
+  EXPECT_EQ (cloud2.width, blob.width);
+  EXPECT_EQ (cloud2.height, blob.height);
+  EXPECT_EQ (cloud2.is_dense, cloud.is_dense);
+  ASSERT_EQ (cloud2.points.size (), cloud.points.size ());
+
+  for (size_t i = 0; i < cloud2.points.size (); ++i)
+  {
+    EXPECT_EQ (cloud2.points[i].x, cloud.points[i].x);
+    EXPECT_EQ (cloud2.points[i].y, cloud.points[i].y);
+    EXPECT_EQ (cloud2.points[i].z, cloud.points[i].z);
+    EXPECT_EQ (cloud2.points[i].normal_x, cloud.points[i].normal_x);
+    EXPECT_EQ (cloud2.points[i].normal_y, cloud.points[i].normal_y);
+    EXPECT_EQ (cloud2.points[i].normal_z, cloud.points[i].normal_z);
+    EXPECT_EQ (cloud2.points[i].rgb, cloud.points[i].rgb);
+  }
+
+  // Random access to a range spanning two chunks
+  sensor_msgs::PointCloud2 range_blob;
+  res = reader.readRange ("test_pcl_io_compressed.pcd", range_blob, 9990, 20);
+  EXPECT_EQ (res, 0);
+  fromROSMsg (range_blob, cloud2);
+  EXPECT_EQ (cloud2.width, uint32_t (20));
+  EXPECT_EQ (cloud2.height, uint32_t (1));
+  ASSERT_EQ (cloud2.points.size (), size_t (20));
+  for (size_t i = 0; i < cloud2.points.size (); ++i)
+  {
+    EXPECT_EQ (cloud2.points[i].x, cloud.points[9990 + i].x);
+    EXPECT_EQ (cloud2.points[i].y, cloud.points[9990 + i].y);
+    EXPECT_EQ (cloud2.points[i].normal_z, cloud.points[9990 + i].normal_z);
+  }
+  EXPECT_LT (reader.readRange ("test_pcl_io_compressed.pcd", range_blob, nr_p - 10, 20), 0);
+
+  // The PointT entry point writes the same file, with any number of threads
+  writer.setNumberOfThreads (1);
+  res = writer.writeBinaryCompressedChunked ("test_pcl_io_compressed_2.pcd", cloud);
+  EXPECT_EQ (res, 0);
+  std::ifstream file_mt ("test_pcl_io_compressed.pcd", std::ios::binary), file ("test_pcl_io_compressed_2.pcd", std::ios::binary);
+  std::string data_mt ((std::istreambuf_iterator<char> (file_mt)), std::istreambuf_iterator<char> ());
+  std::string data ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+  EXPECT_FALSE (data.empty ());
+  EXPECT_TRUE (data == data_mt);
+  remove ("test_pcl_io_compressed_2.pcd");
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, Locale)
 {
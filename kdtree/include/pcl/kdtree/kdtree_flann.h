@@ -198,6 +198,47 @@ namespace pcl
       radiusSearch (const PointT &point, double radius, std::vector<int> &k_indices,
                     std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
 
+      /** \brief Search for the k-nearest neighbors of a batch of query points, using several threads.
+        * Each thread converts a contiguous block of queries to the FLANN representation and searches it with a
+        * single FLANN call, writing directly into the output arrays. The neighbors of the i-th query point are
+        * stored at [i * k, (i + 1) * k) in \a k_indices and \a k_sqr_distances. If less than \a k points are in
+        * the tree, the remaining entries are set to -1 and std::numeric_limits<float>::max ().
+        *
+        * \attention This method assumes valid (i.e., finite) query points.
+        *
+        * \param[in] cloud the point cloud holding the query points
+        * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+        * \param[in] k the number of neighbors to search for
+        * \param[out] k_indices the resultant indices of the neighboring points (size: number of queries * \a k)
+        * \param[out] k_sqr_distances the resultant squared distances to the neighboring points (size: number of queries * \a k)
+        * \param[in] nr_threads the number of threads used to process the queries
+        */
+      void
+      batchNearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                           std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                           unsigned int nr_threads = 1) const;
+
+      /** \brief Search for all the neighbors of a batch of query points in a given radius, using several threads.
+        * The neighbors of the i-th query point are stored at [offsets[i], offsets[i + 1]) in \a k_indices and
+        * \a k_sqr_distances. Every thread keeps its own query and result buffers, so that each query needs a single
+        * pass through the tree.
+        *
+        * \attention This method assumes valid (i.e., finite) query points.
+        *
+        * \param[in] cloud the point cloud holding the query points
+        * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+        * \param[in] radius the radius of the sphere bounding the neighbors
+        * \param[out] k_indices the resultant indices of the neighboring points, for all queries
+        * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, for all queries
+        * \param[out] offsets the start of the neighbors of each query in \a k_indices (size: number of queries + 1)
+        * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+        * \param[in] nr_threads the number of threads used to process the queries
+        */
+      void
+      batchRadiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                         std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                         std::vector<int> &offsets, unsigned int max_nn = 0, unsigned int nr_threads = 1) const;
+
     private:
       /** \brief Internal cleanup method. */
       void 
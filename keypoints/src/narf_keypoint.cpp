@@ -35,6 +35,7 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <pcl/keypoints/narf_keypoint.h>
 #include <pcl/features/range_image_border_extractor.h>
 #include <pcl/pcl_macros.h>
@@ -310,7 +311,8 @@ NarfKeypoint::calculateCompleteInterestImage ()
       //interest_image[i] = -1.0f;
     
     const int angle_histogram_size = 18;
-    float* angle_histogram = new float[angle_histogram_size];
+    // A vector, so that firstprivate gives every thread its own histogram rather than a copy of a shared pointer
+    std::vector<float> angle_histogram (angle_histogram_size);
     
     std::vector<bool> was_touched;
     was_touched.resize (array_size, false);
@@ -353,7 +355,7 @@ NarfKeypoint::calculateCompleteInterestImage ()
       neighbors_to_check.push_back (index);
       was_touched[index] = true;
       
-      memset (angle_histogram, 0, angle_histogram_size*sizeof (float));
+      std::fill (angle_histogram.begin (), angle_histogram.end (), 0.0f);
       for (size_t neighbors_to_check_idx=0; neighbors_to_check_idx<neighbors_to_check.size (); ++neighbors_to_check_idx)
       {
         int index2 = neighbors_to_check[neighbors_to_check_idx];
@@ -440,7 +442,6 @@ NarfKeypoint::calculateCompleteInterestImage ()
       }
     }
     
-    delete[] angle_histogram;
     border_extractor.getParameters ().max_no_of_threads = original_max_no_of_threads;
   }
   
@@ -485,6 +486,7 @@ NarfKeypoint::calculateSparseInterestImage ()
   
   interest_image_ = new float[array_size];
   
+# pragma omp parallel for default (shared) num_threads (parameters_.max_no_of_threads) schedule (static)
   for (int index=0; index<array_size; ++index)
   {
     interest_image_[index] = 0.0f;
@@ -497,7 +499,8 @@ NarfKeypoint::calculateSparseInterestImage ()
   }
   
   const int angle_histogram_size = 18;
-  float* angle_histogram = new float[angle_histogram_size];
+  // A vector, so that firstprivate gives every thread its own histogram rather than a copy of a shared pointer
+  std::vector<float> angle_histogram (angle_histogram_size);
   std::vector<std::vector<std::pair<int, float> > > angle_elements (angle_histogram_size);
   std::vector<bool> relevant_point_still_valid;
   
@@ -719,7 +722,6 @@ NarfKeypoint::calculateSparseInterestImage ()
       }
     }
   }
-  delete[] angle_histogram;
   
   border_extractor.getParameters ().max_no_of_threads = original_max_no_of_threads;
 }
@@ -747,118 +749,128 @@ NarfKeypoint::calculateInterestPoints ()
   is_interest_point_image_.resize (size, false);
   
   typedef double RealForPolynomial;
-  PolynomialCalculationsT<RealForPolynomial> polynomial_calculations;
-  BivariatePolynomialT<RealForPolynomial> polynomial (2);
-  std::vector<Eigen::Matrix<RealForPolynomial, 3, 1> > sample_points;
-  std::vector<RealForPolynomial> x_values, y_values;
-  std::vector<int> types;
-  std::vector<bool> invalid_beams, old_invalid_beams;
   
-  pcl::PointCloud<InterestPoint>::VectorType tmp_interest_points;
-  for (int y=0; y<height; ++y)
+  // Every row collects its own candidates, so that they are sorted in the same order for any number of threads
+  std::vector<pcl::PointCloud<InterestPoint>::VectorType> row_interest_points (height);
+# pragma omp parallel num_threads (parameters_.max_no_of_threads) default (shared)
   {
-    for (int x=0; x<width; ++x)
+    PolynomialCalculationsT<RealForPolynomial> polynomial_calculations;
+    BivariatePolynomialT<RealForPolynomial> polynomial (2);
+    std::vector<Eigen::Matrix<RealForPolynomial, 3, 1> > sample_points;
+    std::vector<RealForPolynomial> x_values, y_values;
+    std::vector<int> types;
+    std::vector<bool> invalid_beams, old_invalid_beams;
+    
+#   pragma omp for schedule (dynamic, 1)
+    for (int y=0; y<height; ++y)
     {
-      int index = y*width + x;
-      float interest_value = interest_image_[index];
-      if (interest_value < parameters_.min_interest_value)
-        continue;
-      const PointWithRange& point = range_image.getPoint (index);
-      bool is_maximum = true;
-      for (int y2=y-1; y2<=y+1&&is_maximum&&parameters_.do_non_maximum_suppression; ++y2)
+      for (int x=0; x<width; ++x)
       {
-        for (int x2=x-1; x2<=x+1; ++x2)
+        int index = y*width + x;
+        float interest_value = interest_image_[index];
+        if (interest_value < parameters_.min_interest_value)
+          continue;
+        const PointWithRange& point = range_image.getPoint (index);
+        bool is_maximum = true;
+        for (int y2=y-1; y2<=y+1&&is_maximum&&parameters_.do_non_maximum_suppression; ++y2)
         {
-          if (!range_image.isInImage (x2,y2))
-            continue;
-          int index2 = y2*width + x2;
-          float interest_value2 = interest_image_[index2];
-          if (interest_value2 <= interest_value)
-            continue;
-          is_maximum = false;
-          break;
+          for (int x2=x-1; x2<=x+1; ++x2)
+          {
+            if (!range_image.isInImage (x2,y2))
+              continue;
+            int index2 = y2*width + x2;
+            float interest_value2 = interest_image_[index2];
+            if (interest_value2 <= interest_value)
+              continue;
+            is_maximum = false;
+            break;
+          }
         }
-      }
-      if (!is_maximum)
-        continue;
+        if (!is_maximum)
+          continue;
       
-      PointWithRange keypoint_3d = point;
-      int keypoint_x_int=x, keypoint_y_int=y;
+        PointWithRange keypoint_3d = point;
+        int keypoint_x_int=x, keypoint_y_int=y;
       
-      int no_of_polynomial_approximations_per_point = parameters_.no_of_polynomial_approximations_per_point;
-      if (!parameters_.do_non_maximum_suppression)
-        no_of_polynomial_approximations_per_point = 0;
+        int no_of_polynomial_approximations_per_point = parameters_.no_of_polynomial_approximations_per_point;
+        if (!parameters_.do_non_maximum_suppression)
+          no_of_polynomial_approximations_per_point = 0;
       
-      for (int poly_step=0; poly_step<no_of_polynomial_approximations_per_point; ++poly_step)
-      {
-        sample_points.clear ();
-        invalid_beams.clear ();
-        old_invalid_beams.clear ();
-        for (int radius=0, stop=false;  !stop;  ++radius) 
+        for (int poly_step=0; poly_step<no_of_polynomial_approximations_per_point; ++poly_step)
         {
-          std::swap (invalid_beams, old_invalid_beams);
-          propagateInvalidBeams (radius, old_invalid_beams, invalid_beams);
-          int x2=keypoint_x_int-radius-1, y2=keypoint_y_int-radius;  // Top left - 1
-          stop = true;
-          for (int i=0; (radius==0&&i==0) || i<8*radius; ++i)
+          sample_points.clear ();
+          invalid_beams.clear ();
+          old_invalid_beams.clear ();
+          for (int radius=0, stop=false;  !stop;  ++radius) 
           {
-            if (i<=2*radius) ++x2; else if (i<=4*radius) ++y2; else if (i<=6*radius) --x2; else --y2;
-            if (invalid_beams[i] || !range_image.isValid (x2, y2))
-              continue;
-            int index2 = y2*width + x2;
-            const BorderTraits& neighbor_border_traits = border_descriptions.points[index2].traits;
-            if (neighbor_border_traits[BORDER_TRAIT__SHADOW_BORDER] || neighbor_border_traits[BORDER_TRAIT__VEIL_POINT])
-            {
-              invalid_beams[i] = true;
-              continue;
-            }
-            const PointWithRange& neighbor = range_image.getPoint (index2);
-            float distance_squared = squaredEuclideanDistance (point, neighbor);
-            if (distance_squared>max_distance_squared)
+            std::swap (invalid_beams, old_invalid_beams);
+            propagateInvalidBeams (radius, old_invalid_beams, invalid_beams);
+            int x2=keypoint_x_int-radius-1, y2=keypoint_y_int-radius;  // Top left - 1
+            stop = true;
+            for (int i=0; (radius==0&&i==0) || i<8*radius; ++i)
             {
-              invalid_beams[i] = true;
-              continue;
-            }
-            stop = false; // There is a point in range -> Have to check further distances
+              if (i<=2*radius) ++x2; else if (i<=4*radius) ++y2; else if (i<=6*radius) --x2; else --y2;
+              if (invalid_beams[i] || !range_image.isValid (x2, y2))
+                continue;
+              int index2 = y2*width + x2;
+              const BorderTraits& neighbor_border_traits = border_descriptions.points[index2].traits;
+              if (neighbor_border_traits[BORDER_TRAIT__SHADOW_BORDER] || neighbor_border_traits[BORDER_TRAIT__VEIL_POINT])
+              {
+                invalid_beams[i] = true;
+                continue;
+              }
+              const PointWithRange& neighbor = range_image.getPoint (index2);
+              float distance_squared = squaredEuclideanDistance (point, neighbor);
+              if (distance_squared>max_distance_squared)
+              {
+                invalid_beams[i] = true;
+                continue;
+              }
+              stop = false; // There is a point in range -> Have to check further distances
             
-            float interest_value2 = interest_image_[index2];
-            sample_points.push_back (Eigen::Vector3d (x2-keypoint_x_int, y2-keypoint_y_int, interest_value2));
+              float interest_value2 = interest_image_[index2];
+              sample_points.push_back (Eigen::Vector3d (x2-keypoint_x_int, y2-keypoint_y_int, interest_value2));
+            }
           }
-        }
-        if (!polynomial_calculations.bivariatePolynomialApproximation (sample_points, 2, polynomial))
-          continue;
+          if (!polynomial_calculations.bivariatePolynomialApproximation (sample_points, 2, polynomial))
+            continue;
 
-        polynomial.findCriticalPoints (x_values, y_values, types);
+          polynomial.findCriticalPoints (x_values, y_values, types);
         
-        if (!types.empty () && types[0]==0)
-        {
-          float keypoint_x = static_cast<float> (x_values[0]+keypoint_x_int),
-                keypoint_y = static_cast<float> (y_values[0]+keypoint_y_int);
+          if (!types.empty () && types[0]==0)
+          {
+            float keypoint_x = static_cast<float> (x_values[0]+keypoint_x_int),
+                  keypoint_y = static_cast<float> (y_values[0]+keypoint_y_int);
           
-          keypoint_x_int = static_cast<int> (pcl_lrint (keypoint_x));
-          keypoint_y_int = static_cast<int> (pcl_lrint (keypoint_y));
+            keypoint_x_int = static_cast<int> (pcl_lrint (keypoint_x));
+            keypoint_y_int = static_cast<int> (pcl_lrint (keypoint_y));
           
-          range_image.calculate3DPoint (keypoint_x, keypoint_y, keypoint_3d);
-          if (!pcl_isfinite (keypoint_3d.range))
+            range_image.calculate3DPoint (keypoint_x, keypoint_y, keypoint_3d);
+            if (!pcl_isfinite (keypoint_3d.range))
+            {
+              keypoint_3d = point;
+              break;
+            }
+          }
+          else
           {
-            keypoint_3d = point;
             break;
           }
         }
-        else
-        {
-          break;
-        }
-      }
       
-      InterestPoint interest_point;
-      interest_point.getVector3fMap () = keypoint_3d.getVector3fMap ();
-      interest_point.strength = interest_value;
-      interest_point.strength = interest_value;
-      tmp_interest_points.push_back (interest_point);
+        InterestPoint interest_point;
+        interest_point.getVector3fMap () = keypoint_3d.getVector3fMap ();
+        interest_point.strength = interest_value;
+        interest_point.strength = interest_value;
+        row_interest_points[y].push_back (interest_point);
+      }
     }
   }
   
+  pcl::PointCloud<InterestPoint>::VectorType tmp_interest_points;
+  for (int y=0; y<height; ++y)
+    tmp_interest_points.insert (tmp_interest_points.end (), row_interest_points[y].begin (), row_interest_points[y].end ());
+  
   std::sort (tmp_interest_points.begin (), tmp_interest_points.end (), isBetterInterestPoint);
   
   float min_distance_squared = powf (parameters_.min_distance_between_interest_points*parameters_.support_size, 2);
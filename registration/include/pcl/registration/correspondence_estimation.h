@@ -85,6 +85,7 @@ namespace pcl
           corr_name_ (),
           tree_ (new pcl::KdTreeFLANN<PointTarget>),
           target_ (),
+          threads_ (1),
           point_representation_ ()
         {
         }
@@ -109,6 +110,18 @@ namespace pcl
           point_representation_ = point_representation;
         }
 
+        /** \brief Set the number of threads used to search for correspondences. The default (1) runs the
+          * original serial loop. Any other value splits the query points between \a nr_threads OpenMP threads,
+          * each with its own search buffers. The output is identical to the serial path.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+        /** \brief Get the number of threads used to search for correspondences. */
+        inline unsigned int
+        getNumberOfThreads () const { return (threads_); }
+
         /** \brief Determine the correspondences between input and target cloud.
           * \param[out] correspondences the found correspondences (index of query point, index of target point, distance)
           * \param[in] max_distance maximum distance between correspondences
@@ -133,6 +146,9 @@ namespace pcl
         /** \brief The input point cloud dataset target. */
         PointCloudTargetConstPtr target_;
 
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+
         /** \brief Abstract class get name method. */
         inline const std::string& 
         getClassName () const { return (corr_name_); }
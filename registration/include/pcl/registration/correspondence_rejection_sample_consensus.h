@@ -43,6 +43,8 @@
 #include <pcl/sample_consensus/ransac.h>
 #include <pcl/sample_consensus/sac_model_registration.h>
 
+#include <boost/unordered_map.hpp>
+
 namespace pcl
 {
   namespace registration
@@ -69,9 +71,14 @@ namespace pcl
         CorrespondenceRejectorSampleConsensus () :
           inlier_threshold_ (0.05),
           max_iterations_ (0),
+          keep_all_on_few_inliers_ (true),
           input_ (),
           target_ (),
-          best_transformation_ ()
+          best_transformation_ (),
+          source_indices_ (),
+          target_indices_ (),
+          inliers_ (),
+          index_to_correspondence_ ()
         {
           rejection_name_ = "CorrespondenceRejectorSampleConsensus";
         }
@@ -124,6 +131,17 @@ namespace pcl
         inline int 
         getMaxIterations () { return max_iterations_; };
 
+        /** \brief Set whether all the original correspondences are returned when RANSAC finds fewer than 3 
+          * inliers (the default), or only the inliers that were found.
+          * \param[in] keep_all true to fall back to the original correspondences, false to keep the inliers only
+          */
+        inline void 
+        setKeepAllOnFewInliers (bool keep_all) { keep_all_on_few_inliers_ = keep_all; };
+
+        /** \brief Get whether all the original correspondences are returned when RANSAC finds fewer than 3 inliers. */
+        inline bool 
+        getKeepAllOnFewInliers () { return keep_all_on_few_inliers_; };
+
         /** \brief Get the best transformation after RANSAC rejection.
           * \return The homogeneous 4x4 transformation yielding the largest number of inliers.
           */
@@ -145,10 +163,23 @@ namespace pcl
 
         int max_iterations_;
 
+        bool keep_all_on_few_inliers_;
+
         PointCloudConstPtr input_;
         PointCloudConstPtr target_;
 
         Eigen::Matrix4f best_transformation_;
+
+        /** \brief The source and target indices of the correspondences, reused from one call to the next. The
+          * registration model and the RANSAC estimator are still created in every call.
+          */
+        std::vector<int> source_indices_, target_indices_;
+
+        /** \brief The inliers of the RANSAC model, reused from one call to the next. */
+        std::vector<int> inliers_;
+
+        /** \brief Maps the source index of a correspondence to its position, reused from one call to the next. */
+        boost::unordered_map<int, int> index_to_correspondence_;
       public:
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     };
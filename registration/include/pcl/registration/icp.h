@@ -43,6 +43,7 @@
 #include <pcl/sample_consensus/sac_model_registration.h>
 #include <pcl/registration/registration.h>
 #include <pcl/registration/transformation_estimation_svd.h>
+#include <pcl/registration/correspondence_rejection_sample_consensus.h>
 
 namespace pcl
 {
@@ -74,6 +75,10 @@ namespace pcl
     * // Set the euclidean distance difference epsilon (criterion 3)
     * icp.setEuclideanFitnessEpsilon (1);
     *
+    * // Optionally, replace the default RANSAC rejection by a chain of correspondence rejectors
+    * pcl::registration::CorrespondenceRejector::Ptr rej_dist (new pcl::registration::CorrespondenceRejectorDistance);
+    * icp.addCorrespondenceRejector (rej_dist);
+    *
     * // Perform the alignment
     * icp.align (cloud_source_registered);
     *
@@ -97,14 +102,68 @@ namespace pcl
     typedef PointIndices::ConstPtr PointIndicesConstPtr;
 
     public:
+      typedef pcl::registration::CorrespondenceRejector::Ptr CorrespondenceRejectorPtr;
+
+      /** \brief Time spent (in milliseconds) in the different stages of one ICP iteration. */
+      struct IterationTiming
+      {
+        IterationTiming () : correspondence_search (0), rejection (0), estimation (0), total (0) {}
+
+        /** \brief Nearest neighbor search for all the source points. */
+        double correspondence_search;
+        /** \brief Correspondence rejection (the whole rejector chain). */
+        double rejection;
+        /** \brief Transformation estimation and transformation of the source. */
+        double estimation;
+        /** \brief The complete iteration. */
+        double total;
+      };
+
       /** \brief Empty constructor. */
-      IterativeClosestPoint () 
+      IterativeClosestPoint () :
+        correspondence_rejectors_ (),
+        iteration_timings_ (),
+        input_transformed_ (new PointCloudSource),
+        correspondences_ (new pcl::Correspondences),
+        remaining_correspondences_ (new pcl::Correspondences),
+        source_indices_ (),
+        target_indices_ (),
+        rejector_ransac_ (new pcl::registration::CorrespondenceRejectorSampleConsensus<PointSource>)
       {
         reg_name_ = "IterativeClosestPoint";
         ransac_iterations_ = 1000;
+        // Like the RANSAC rejection ICP always did, keep only the inliers, so that too few of them stop the alignment
+        rejector_ransac_->setKeepAllOnFewInliers (false);
         transformation_estimation_.reset (new pcl::registration::TransformationEstimationSVD<PointSource, PointTarget>);
       };
 
+      /** \brief Append a correspondence rejector to the rejection chain. The rejectors are applied in the order
+        * in which they were added, each one on the correspondences left by the previous one. If the chain is
+        * empty, the correspondences are filtered with RANSAC, using \ref setRANSACIterations and 
+        * \ref setRANSACOutlierRejectionThreshold (setting 0 RANSAC iterations disables it). That default rejection
+        * keeps only the RANSAC inliers, even if there are too few of them to continue.
+        * \note CorrespondenceRejectorSampleConsensus rejectors in the chain get their source and target clouds
+        * set by ICP.
+        * \param[in] rejector the correspondence rejector to add
+        */
+      inline void
+      addCorrespondenceRejector (const CorrespondenceRejectorPtr &rejector)
+      {
+        correspondence_rejectors_.push_back (rejector);
+      }
+
+      /** \brief Get the list of correspondence rejectors applied in every iteration. */
+      inline const std::vector<CorrespondenceRejectorPtr>&
+      getCorrespondenceRejectors () const { return (correspondence_rejectors_); }
+
+      /** \brief Remove all the correspondence rejectors, reverting to the default RANSAC based rejection. */
+      inline void
+      clearCorrespondenceRejectors () { correspondence_rejectors_.clear (); }
+
+      /** \brief Get the timings of every iteration of the last \ref align call. */
+      inline const std::vector<IterationTiming>&
+      getIterationTimings () const { return (iteration_timings_); }
+
     protected:
       /** \brief Rigid transformation computation method  with initial guess.
         * \param output the transformed input point cloud dataset using the rigid transformation found
@@ -133,6 +192,34 @@ namespace pcl
       using Registration<PointSource, PointTarget>::correspondence_distances_;
       using Registration<PointSource, PointTarget>::euclidean_fitness_epsilon_;
       using Registration<PointSource, PointTarget>::transformation_estimation_;
+
+      /** \brief The chain of correspondence rejectors applied in every iteration. */
+      std::vector<CorrespondenceRejectorPtr> correspondence_rejectors_;
+
+      /** \brief The timings of every iteration of the last alignment. */
+      std::vector<IterationTiming> iteration_timings_;
+
+    private:
+      /** \brief Apply the rejection chain on \a correspondences_, leaving the result in \a correspondences_. */
+      void
+      rejectCorrespondences ();
+
+      /** \brief The source cloud transformed with the current estimate. Shared with the rejectors, and kept 
+        * between iterations so that no cloud has to be copied or allocated while iterating. 
+        */
+      PointCloudSourcePtr input_transformed_;
+
+      /** \brief The correspondences of the current iteration. */
+      pcl::CorrespondencesPtr correspondences_;
+
+      /** \brief Scratch buffer for the output of each rejector in the chain. */
+      pcl::CorrespondencesPtr remaining_correspondences_;
+
+      /** \brief Scratch buffers for the source and target indices of the correspondences. */
+      std::vector<int> source_indices_, target_indices_;
+
+      /** \brief The RANSAC rejector used when no rejection chain is given. */
+      boost::shared_ptr<pcl::registration::CorrespondenceRejectorSampleConsensus<PointSource> > rejector_ransac_;
   };
 }
 
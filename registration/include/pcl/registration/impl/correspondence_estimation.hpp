@@ -74,6 +74,32 @@ pcl::registration::CorrespondenceEstimation<PointSource, PointTarget>::determine
   float max_dist_sqr = max_distance * max_distance;
 
   correspondences.resize (indices_->size ());
+
+  if (threads_ > 1)
+  {
+    int nr_queries = static_cast<int> (indices_->size ());
+#pragma omp parallel num_threads (threads_)
+    {
+      // Per-thread search buffers, reused for all the queries handled by this thread
+      std::vector<int> nn_index (1);
+      std::vector<float> nn_distance (1);
+#pragma omp for schedule (static)
+      for (int i = 0; i < nr_queries; ++i)
+      {
+        PointTarget pt;
+        pcl::for_each_type <FieldListTarget> (pcl::NdConcatenateFunctor <PointSource, PointTarget> (
+              input_->points[(*indices_)[i]], 
+              pt));
+
+        // Each query writes only its own slot, so the result does not depend on the schedule
+        if (tree_->nearestKSearch (pt, 1, nn_index, nn_distance) && nn_distance[0] <= max_dist_sqr)
+          correspondences[i] = pcl::Correspondence (i, nn_index[0], nn_distance[0]);
+      }
+    }
+    deinitCompute ();
+    return;
+  }
+
   std::vector<int> index (1);
   std::vector<float> distance (1);
   pcl::Correspondence corr;
@@ -125,6 +151,52 @@ pcl::registration::CorrespondenceEstimation<PointSource, PointTarget>::determine
   tree_reciprocal.setInputCloud (input_, indices_);
 
   correspondences.resize (indices_->size());
+
+  if (threads_ > 1)
+  {
+    int nr_queries = static_cast<int> (indices_->size ());
+    // Mark the reciprocal matches in parallel, then compact them in query order
+    std::vector<char> is_reciprocal (indices_->size (), 0);
+#pragma omp parallel num_threads (threads_)
+    {
+      // Per-thread search buffers, reused for all the queries handled by this thread
+      std::vector<int> nn_index (1);
+      std::vector<float> nn_distance (1);
+      std::vector<int> nn_index_reciprocal (1);
+      std::vector<float> nn_distance_reciprocal (1);
+#pragma omp for schedule (static)
+      for (int i = 0; i < nr_queries; ++i)
+      {
+        PointTarget pt_src;
+        pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointSource, PointTarget> (
+              input_->points[(*indices_)[i]], 
+              pt_src));
+        tree_->nearestKSearch (pt_src, 1, nn_index, nn_distance);
+
+        PointSource pt_tgt;
+        pcl::for_each_type <FieldList> (pcl::NdConcatenateFunctor <PointTarget, PointSource> (
+              target_->points[nn_index[0]],
+              pt_tgt));
+        tree_reciprocal.nearestKSearch (pt_tgt, 1, nn_index_reciprocal, nn_distance_reciprocal);
+
+        if ((*indices_)[i] == nn_index_reciprocal[0])
+        {
+          correspondences[i] = pcl::Correspondence ((*indices_)[i], nn_index[0], nn_distance[0]);
+          is_reciprocal[i] = 1;
+        }
+      }
+    }
+
+    size_t nr_valid = 0;
+    for (size_t i = 0; i < is_reciprocal.size (); ++i)
+      if (is_reciprocal[i])
+        correspondences[nr_valid++] = correspondences[i];
+    correspondences.resize (nr_valid);
+
+    deinitCompute ();
+    return;
+  }
+
   std::vector<int> index (1);
   std::vector<float> distance (1);
   std::vector<int> index_reciprocal (1);
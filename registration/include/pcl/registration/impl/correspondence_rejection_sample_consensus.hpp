@@ -47,27 +47,27 @@ pcl::registration::CorrespondenceRejectorSampleConsensus<PointT>::getRemainingCo
     pcl::Correspondences& remaining_correspondences)
 {
   int nr_correspondences = static_cast<int> (original_correspondences.size ());
-  std::vector<int> source_indices (nr_correspondences);
-  std::vector<int> target_indices (nr_correspondences);
+  // The index buffers are members, so that their memory is reused when the rejector is called in every ICP
+  // iteration. The model and the RANSAC estimator below are still created anew.
+  source_indices_.resize (nr_correspondences);
+  target_indices_.resize (nr_correspondences);
 
   // Copy the query-match indices
   for (size_t i = 0; i < original_correspondences.size (); ++i)
   {
-    source_indices[i] = original_correspondences[i].index_query;
-    target_indices[i] = original_correspondences[i].index_match;
+    source_indices_[i] = original_correspondences[i].index_query;
+    target_indices_[i] = original_correspondences[i].index_match;
   }
 
    // from pcl/registration/icp.hpp:
-   std::vector<int> source_indices_good;
-   std::vector<int> target_indices_good;
    {
      // From the set of correspondences found, attempt to remove outliers
      // Create the registration model
      typedef typename pcl::SampleConsensusModelRegistration<PointT>::Ptr SampleConsensusModelRegistrationPtr;
      SampleConsensusModelRegistrationPtr model;
-     model.reset (new pcl::SampleConsensusModelRegistration<PointT> (input_, source_indices));
+     model.reset (new pcl::SampleConsensusModelRegistration<PointT> (input_, source_indices_));
      // Pass the target_indices
-     model->setInputTarget (target_, target_indices);
+     model->setInputTarget (target_, target_indices_);
      // Create a RANSAC model
      pcl::RandomSampleConsensus<PointT> sac (model, inlier_threshold_);
      sac.setMaxIterations (max_iterations_);
@@ -81,22 +81,21 @@ pcl::registration::CorrespondenceRejectorSampleConsensus<PointT>::getRemainingCo
      }
      else
      {
-       std::vector<int> inliers;
-       sac.getInliers (inliers);
+       sac.getInliers (inliers_);
 
-       if (inliers.size () < 3)
+       if (inliers_.size () < 3 && keep_all_on_few_inliers_)
        {
          remaining_correspondences = original_correspondences;
          best_transformation_.setIdentity ();
          return;
        }
-       boost::unordered_map<int, int> index_to_correspondence;
+       index_to_correspondence_.clear ();
        for (int i = 0; i < nr_correspondences; ++i)
-         index_to_correspondence[original_correspondences[i].index_query] = i;
+         index_to_correspondence_[original_correspondences[i].index_query] = i;
 
-       remaining_correspondences.resize (inliers.size ());
-       for (size_t i = 0; i < inliers.size (); ++i)
-         remaining_correspondences[i] = original_correspondences[index_to_correspondence[inliers[i]]];
+       remaining_correspondences.resize (inliers_.size ());
+       for (size_t i = 0; i < inliers_.size (); ++i)
+         remaining_correspondences[i] = original_correspondences[index_to_correspondence_[inliers_[i]]];
 
        // get best transformation
        Eigen::VectorXf model_coefficients;
@@ -37,7 +37,45 @@
  *
  */
 
-#include <boost/unordered_map.hpp>
+#include <pcl/common/time.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget> void
+pcl::IterativeClosestPoint<PointSource, PointTarget>::rejectCorrespondences ()
+{
+  typedef pcl::registration::CorrespondenceRejectorSampleConsensus<PointSource> RejectorSampleConsensus;
+
+  // Without a user given chain, fall back to the RANSAC rejection configured through Registration
+  if (correspondence_rejectors_.empty ())
+  {
+    if (ransac_iterations_ <= 0)
+      return;
+    rejector_ransac_->setInputCloud (input_transformed_);
+    rejector_ransac_->setTargetCloud (target_);
+    rejector_ransac_->setInlierThreshold (inlier_threshold_);
+    rejector_ransac_->setMaxIterations (ransac_iterations_);
+    rejector_ransac_->getRemainingCorrespondences (*correspondences_, *remaining_correspondences_);
+    correspondences_.swap (remaining_correspondences_);
+    return;
+  }
+
+  for (size_t i = 0; i < correspondence_rejectors_.size (); ++i)
+  {
+    // The sample consensus rejector needs the clouds the correspondences refer to
+    RejectorSampleConsensus *rejector_sac = dynamic_cast<RejectorSampleConsensus*> (correspondence_rejectors_[i].get ());
+    if (rejector_sac)
+    {
+      rejector_sac->setInputCloud (input_transformed_);
+      rejector_sac->setTargetCloud (target_);
+    }
+
+    if (correspondences_->empty ())
+      return;
+    correspondence_rejectors_[i]->setInputCorrespondences (correspondences_);
+    correspondence_rejectors_[i]->getCorrespondences (*remaining_correspondences_);
+    correspondences_.swap (remaining_correspondences_);
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget> void
@@ -47,13 +85,19 @@ pcl::IterativeClosestPoint<PointSource, PointTarget>::computeTransformation (Poi
   std::vector<int> nn_indices (1);
   std::vector<float> nn_dists (1);
 
-  // Point cloud containing the correspondences of each point in <input, indices>
-  PointCloudTarget input_corresp;
-  input_corresp.points.resize (indices_->size ());
-
   nr_iterations_ = 0;
   converged_ = false;
   double dist_threshold = corr_dist_threshold_ * corr_dist_threshold_;
+  iteration_timings_.clear ();
+
+  // Work on the internal source cloud, which the rejectors can share without copying. The point data is 
+  // swapped in (and back out at the end), so no source cloud is copied or allocated while iterating.
+  input_transformed_->points.swap (output.points);
+  input_transformed_->header = output.header;
+  input_transformed_->width = output.width;
+  input_transformed_->height = output.height;
+  input_transformed_->is_dense = output.is_dense;
+  PointCloudSource &cloud = *input_transformed_;
 
   // If the guessed transformation is non identity
   if (guess != Eigen::Matrix4f::Identity ())
@@ -61,125 +105,103 @@ pcl::IterativeClosestPoint<PointSource, PointTarget>::computeTransformation (Poi
     // Initialise final transformation to the guessed one
     final_transformation_ = guess;
     // Apply guessed transformation prior to search for neighbours
-    transformPointCloud (output, output, guess);
+    transformPointCloud (cloud, cloud, guess);
   }
 
   // Resize the vector of distances between correspondences 
   std::vector<float> previous_correspondence_distances (indices_->size ());
   correspondence_distances_.resize (indices_->size ());
+  correspondences_->reserve (indices_->size ());
+  remaining_correspondences_->reserve (indices_->size ());
 
   while (!converged_)           // repeat until convergence
   {
+    pcl::StopWatch iteration_watch;
+    IterationTiming timing;
+
     // Save the previously estimated transformation
     previous_transformation_ = transformation_;
     // And the previous set of distances
     previous_correspondence_distances = correspondence_distances_;
 
-    int cnt = 0;
-    std::vector<int> source_indices (indices_->size ());
-    std::vector<int> target_indices (indices_->size ());
-
     // Iterating over the entire index vector and  find all correspondences
+    bool neighbors_found = true;
+    correspondences_->clear ();
     for (size_t idx = 0; idx < indices_->size (); ++idx)
     {
-      if (!this->searchForNeighbors (output, (*indices_)[idx], nn_indices, nn_dists))
+      if (!this->searchForNeighbors (cloud, (*indices_)[idx], nn_indices, nn_dists))
       {
         PCL_ERROR ("[pcl::%s::computeTransformation] Unable to find a nearest neighbor in the target dataset for point %d in the source!\n", getClassName ().c_str (), (*indices_)[idx]);
-        return;
+        neighbors_found = false;
+        break;
       }
 
       // Check if the distance to the nearest neighbor is smaller than the user imposed threshold
       if (nn_dists[0] < dist_threshold)
-      {
-        source_indices[cnt] = (*indices_)[idx];
-        target_indices[cnt] = nn_indices[0];
-        cnt++;
-      }
+        correspondences_->push_back (pcl::Correspondence ((*indices_)[idx], nn_indices[0], nn_dists[0]));
 
       // Save the nn_dists[0] to a global vector of distances
       correspondence_distances_[(*indices_)[idx]] = std::min (nn_dists[0], static_cast<float> (dist_threshold));
     }
-    if (cnt < min_number_correspondences_)
+    if (!neighbors_found)
+      break;
+
+    size_t nr_correspondences = correspondences_->size ();
+    if (static_cast<int> (nr_correspondences) < min_number_correspondences_)
     {
       PCL_ERROR ("[pcl::%s::computeTransformation] Not enough correspondences found. Relax your threshold parameters.\n", getClassName ().c_str ());
       converged_ = false;
-      return;
+      break;
     }
+    timing.correspondence_search = iteration_watch.getTime ();
 
-    // Resize to the actual number of valid correspondences
-    source_indices.resize (cnt); target_indices.resize (cnt);
-
-    std::vector<int> source_indices_good;
-    std::vector<int> target_indices_good;
-    {
-      // From the set of correspondences found, attempt to remove outliers
-      // Create the registration model
-      typedef typename SampleConsensusModelRegistration<PointSource>::Ptr SampleConsensusModelRegistrationPtr;
-      SampleConsensusModelRegistrationPtr model;
-      model.reset (new SampleConsensusModelRegistration<PointSource> (output.makeShared (), source_indices));
-      // Pass the target_indices
-      model->setInputTarget (target_, target_indices);
-      // Create a RANSAC model
-      RandomSampleConsensus<PointSource> sac (model, inlier_threshold_);
-      sac.setMaxIterations (ransac_iterations_);
-
-      // Compute the set of inliers
-      if (!sac.computeModel ())
-      {
-        source_indices_good = source_indices;
-        target_indices_good = target_indices;
-      }
-      else
-      {
-        std::vector<int> inliers;
-        // Get the inliers
-        sac.getInliers (inliers);
-        source_indices_good.resize (inliers.size ());
-        target_indices_good.resize (inliers.size ());
-
-        boost::unordered_map<int, int> source_to_target;
-        for (unsigned int i = 0; i < source_indices.size(); ++i)
-          source_to_target[source_indices[i]] = target_indices[i];
-
-        // Copy just the inliers
-        std::copy(inliers.begin(), inliers.end(), source_indices_good.begin());
-        for (size_t i = 0; i < inliers.size (); ++i)
-          target_indices_good[i] = source_to_target[inliers[i]];
-      }
-    }
+    // From the set of correspondences found, attempt to remove outliers
+    rejectCorrespondences ();
+    timing.rejection = iteration_watch.getTime () - timing.correspondence_search;
 
     // Check whether we have enough correspondences
-    cnt = static_cast<int> (source_indices_good.size ());
+    int cnt = static_cast<int> (correspondences_->size ());
     if (cnt < min_number_correspondences_)
     {
       PCL_ERROR ("[pcl::%s::computeTransformation] Not enough correspondences found. Relax your threshold parameters.\n", getClassName ().c_str ());
       converged_ = false;
-      return;
+      break;
     }
 
-    PCL_DEBUG ("[pcl::%s::computeTransformation] Number of correspondences %d [%f%%] out of %zu points [100.0%%], RANSAC rejected: %zu [%f%%].\n", 
+    PCL_DEBUG ("[pcl::%s::computeTransformation] Number of correspondences %d [%f%%] out of %zu points [100.0%%], rejected: %zu [%f%%].\n", 
         getClassName ().c_str (), 
         cnt, 
         (static_cast<float> (cnt) * 100.0f) / static_cast<float> (indices_->size ()), 
         indices_->size (), 
-        source_indices.size () - cnt, 
-        static_cast<float> (source_indices.size () - cnt) * 100.0f / static_cast<float> (source_indices.size ()));
+        nr_correspondences - cnt, 
+        static_cast<float> (nr_correspondences - cnt) * 100.0f / static_cast<float> (nr_correspondences));
+
+    source_indices_.resize (cnt);
+    target_indices_.resize (cnt);
+    for (int i = 0; i < cnt; ++i)
+    {
+      source_indices_[i] = (*correspondences_)[i].index_query;
+      target_indices_[i] = (*correspondences_)[i].index_match;
+    }
   
     // Estimate the transform
-    //rigid_transformation_estimation_(output, source_indices_good, *target_, target_indices_good, transformation_);
-    transformation_estimation_->estimateRigidTransformation (output, source_indices_good, *target_, target_indices_good, transformation_);
+    transformation_estimation_->estimateRigidTransformation (cloud, source_indices_, *target_, target_indices_, transformation_);
 
     // Tranform the data
-    transformPointCloud (output, output, transformation_);
+    transformPointCloud (cloud, cloud, transformation_);
 
     // Obtain the final transformation    
     final_transformation_ = transformation_ * final_transformation_;
 
     nr_iterations_++;
 
+    timing.total = iteration_watch.getTime ();
+    timing.estimation = timing.total - timing.correspondence_search - timing.rejection;
+    iteration_timings_.push_back (timing);
+
     // Update the vizualization of icp convergence
     if (update_visualizer_ != 0)
-      update_visualizer_(output, source_indices_good, *target_, target_indices_good );
+      update_visualizer_(cloud, source_indices_, *target_, target_indices_);
 
     // Various/Different convergence termination criteria
     // 1. Number of iterations has reached the maximum user imposed number of iterations (via 
@@ -207,5 +229,8 @@ pcl::IterativeClosestPoint<PointSource, PointTarget>::computeTransformation (Poi
 
     }
   }
+
+  // Hand the (transformed) point data back to the caller
+  output.points.swap (input_transformed_->points);
 }
 
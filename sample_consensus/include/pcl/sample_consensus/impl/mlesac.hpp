@@ -55,9 +55,6 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
-  std::vector<int> best_model;
-  std::vector<int> selection;
-  Eigen::VectorXf model_coefficients;
   std::vector<double> distances;
 
   // Compute sigma - remember to set threshold_ correctly !
@@ -71,91 +68,74 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   max_pt -= min_pt;
   double v = sqrt (max_pt.dot (max_pt));
 
+  // The models are drawn in batches of one per thread, and scored in parallel
+  const int nr_models = static_cast<int> (threads_);
+  std::vector<std::vector<int> > selections;
+  std::vector<Eigen::VectorXf> models_coefficients;
+  std::vector<bool> pretest_passed;
+  std::vector<double> penalties (nr_models);
+  std::vector<int> inliers_counts (nr_models);
+
   int n_inliers_count = 0;
-  size_t indices_size;
   unsigned skipped_count = 0;
   // supress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
   
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  bool done = false;
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
+    // Get the next valid models. MLESAC scores every model, so the pre-test is not run
+    int nr_drawn = this->drawModels (nr_models, selections, models_coefficients, pretest_passed, skipped_count, max_skip, false);
+    if (nr_drawn < nr_models)
+      done = true;
 
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    // Compute the penalty and the number of inliers of each model
+#pragma omp parallel num_threads (threads_)
     {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
+      std::vector<double> model_distances;
+#pragma omp for schedule (dynamic, 1)
+      for (int m = 0; m < nr_drawn; ++m)
+      {
+        // Iterate through the 3d points and calculate the distances from them to the model
+        sac_model_->getDistancesToModel (models_coefficients[m], model_distances);
+        scoreModel (model_distances, v, penalties[m], inliers_counts[m]);
+      }
     }
 
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-
-    // Use Expectiation-Maximization to find out the right value for d_cur_penalty
-    // ---[ Initial estimate for the gamma mixing parameter = 1/2
-    double gamma = 0.5;
-    double p_outlier_prob = 0;
-
-    indices_size = sac_model_->getIndices ()->size ();
-    std::vector<double> p_inlier_prob (indices_size);
-    for (int j = 0; j < iterations_EM_; ++j)
+    // Go through the models in the order they were drawn in, exactly as the serial loop would
+    for (int m = 0; m < nr_drawn && iterations_ < k; ++m)
     {
-      // Likelihood of a datum given that it is an inlier
-      for (size_t i = 0; i < indices_size; ++i)
-        p_inlier_prob[i] = gamma * exp (- (distances[i] * distances[i] ) / 2 * (sigma_ * sigma_) ) /
-                           (sqrt (2 * M_PI) * sigma_);
-
-      // Likelihood of a datum given that it is an outlier
-      p_outlier_prob = (1 - gamma) / v;
-
-      gamma = 0;
-      for (size_t i = 0; i < indices_size; ++i)
-        gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
-      gamma /= static_cast<double>(sac_model_->getIndices ()->size ());
-    }
-
-    // Find the log likelihood of the model -L = -sum [log (pInlierProb + pOutlierProb)]
-    double d_cur_penalty = 0;
-    for (size_t i = 0; i < indices_size; ++i)
-      d_cur_penalty += log (p_inlier_prob[i] + p_outlier_prob);
-    d_cur_penalty = - d_cur_penalty;
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      n_inliers_count = 0;
-      // Need to compute the number of inliers for this model to adapt k
-      for (size_t i = 0; i < distances.size (); ++i)
-        if (distances[i] <= 2 * sigma_)
-          n_inliers_count++;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log (1 - probability_) / log (p_no_outliers);
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
-      break;
+      // Better match ?
+      if (penalties[m] < d_best_penalty)
+      {
+        d_best_penalty = penalties[m];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = selections[m];
+        model_coefficients_ = models_coefficients[m];
+
+        // Need the number of inliers for this model to adapt k
+        n_inliers_count = inliers_counts[m];
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1 - pow (w, static_cast<double> (selections[m].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
     }
   }
 
@@ -191,6 +171,46 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MaximumLikelihoodSampleConsensus<PointT>::scoreModel (const std::vector<double> &distances, double v,
+                                                            double &penalty, int &inliers_count) const
+{
+  // Use Expectiation-Maximization to find out the right value for the penalty
+  // ---[ Initial estimate for the gamma mixing parameter = 1/2
+  double gamma = 0.5;
+  double p_outlier_prob = 0;
+
+  size_t indices_size = distances.size ();
+  std::vector<double> p_inlier_prob (indices_size);
+  for (int j = 0; j < iterations_EM_; ++j)
+  {
+    // Likelihood of a datum given that it is an inlier
+    for (size_t i = 0; i < indices_size; ++i)
+      p_inlier_prob[i] = gamma * exp (- (distances[i] * distances[i] ) / 2 * (sigma_ * sigma_) ) /
+                         (sqrt (2 * M_PI) * sigma_);
+
+    // Likelihood of a datum given that it is an outlier
+    p_outlier_prob = (1 - gamma) / v;
+
+    gamma = 0;
+    for (size_t i = 0; i < indices_size; ++i)
+      gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
+    gamma /= static_cast<double>(sac_model_->getIndices ()->size ());
+  }
+
+  // Find the log likelihood of the model -L = -sum [log (pInlierProb + pOutlierProb)]
+  penalty = 0;
+  for (size_t i = 0; i < indices_size; ++i)
+    penalty += log (p_inlier_prob[i] + p_outlier_prob);
+  penalty = - penalty;
+
+  inliers_count = 0;
+  for (size_t i = 0; i < indices_size; ++i)
+    if (distances[i] <= 2 * sigma_)
+      inliers_count++;
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> double
 pcl::MaximumLikelihoodSampleConsensus<PointT>::computeMedianAbsoluteDeviation (
@@ -55,9 +55,13 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
-  std::vector<int> best_model;
-  std::vector<int> selection;
-  Eigen::VectorXf model_coefficients;
+  // The models are drawn in batches of one per thread, and scored in parallel
+  const int nr_models = static_cast<int> (threads_);
+  std::vector<std::vector<int> > selections;
+  std::vector<Eigen::VectorXf> models_coefficients;
+  std::vector<bool> pretest_passed;
+  std::vector<double> penalties (nr_models);
+  std::vector<int> inliers_counts (nr_models);
   std::vector<double> distances;
 
   int n_inliers_count = 0;
@@ -66,62 +70,74 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   const unsigned max_skip = max_iterations_ * 10;
   
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  bool done = false;
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    // Get the next valid models
+    int nr_drawn = this->drawModels (nr_models, selections, models_coefficients, pretest_passed, skipped_count, max_skip);
+    if (nr_drawn < nr_models)
+      done = true;
+
+    // Compute the penalty and the number of inliers of each model. A model without distances has no inliers and
+    // is marked with a negative penalty
+#pragma omp parallel num_threads (threads_)
     {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-     }
-
-    double d_cur_penalty = 0;
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-    
-    if (distances.empty () && k > 1.0)
-      continue;
-
-    for (size_t i = 0; i < distances.size (); ++i)
-      d_cur_penalty += (std::min) (distances[i], threshold_);
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      n_inliers_count = 0;
-      // Need to compute the number of inliers for this model to adapt k
-      for (size_t i = 0; i < distances.size (); ++i)
-        if (distances[i] <= threshold_)
-          ++n_inliers_count;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1.0 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log (1.0 - probability_) / log (p_no_outliers);
+      std::vector<double> model_distances;
+#pragma omp for schedule (dynamic, 1)
+      for (int m = 0; m < nr_drawn; ++m)
+      {
+        if (!pretest_passed[m])
+          continue;
+        sac_model_->getDistancesToModel (models_coefficients[m], model_distances);
+        scoreModel (model_distances, penalties[m], inliers_counts[m]);
+      }
     }
 
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
+    // Go through the models in the order they were drawn in, exactly as the serial loop would
+    for (int m = 0; m < nr_drawn && iterations_ < k; ++m)
     {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
-      break;
+      // Unfortunately we cannot drop a model before the first one is scored, because k is not set yet
+      bool dropped = !pretest_passed[m] && k > 1.0;
+      if (!pretest_passed[m] && !dropped)
+      {
+        sac_model_->getDistancesToModel (models_coefficients[m], distances);
+        scoreModel (distances, penalties[m], inliers_counts[m]);
+      }
+
+      if (!dropped && penalties[m] < 0 && k > 1.0)
+        continue;
+
+      double d_cur_penalty = (std::max) (penalties[m], 0.0);
+      // Better match ? Models dropped by the pre-test still count as a trial
+      if (!dropped && d_cur_penalty < d_best_penalty)
+      {
+        d_best_penalty = d_cur_penalty;
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = selections[m];
+        model_coefficients_ = models_coefficients[m];
+
+        // Need the number of inliers for this model to adapt k
+        n_inliers_count = inliers_counts[m];
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1.0 - pow (w, static_cast<double> (selections[m].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1.0 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
     }
   }
 
@@ -158,6 +174,27 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MEstimatorSampleConsensus<PointT>::scoreModel (const std::vector<double> &distances, 
+                                                     double &penalty, int &inliers_count) const
+{
+  inliers_count = 0;
+  if (distances.empty ())
+  {
+    penalty = -1.0;
+    return;
+  }
+
+  penalty = 0;
+  for (size_t i = 0; i < distances.size (); ++i)
+  {
+    penalty += (std::min) (distances[i], threshold_);
+    if (distances[i] <= threshold_)
+      ++inliers_count;
+  }
+}
+
 #define PCL_INSTANTIATE_MEstimatorSampleConsensus(T) template class PCL_EXPORTS pcl::MEstimatorSampleConsensus<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_MSAC_H_
@@ -55,8 +55,12 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   int n_best_inliers_count = -INT_MAX;
   double k = 1.0;
 
-  std::vector<int> selection;
-  Eigen::VectorXf model_coefficients;
+  // The models are drawn in batches of one per thread, and scored in parallel
+  const int nr_models = static_cast<int> (threads_);
+  std::vector<std::vector<int> > selections;
+  std::vector<Eigen::VectorXf> models_coefficients;
+  std::vector<bool> pretest_passed;
+  std::vector<int> inliers_counts (nr_models);
 
   int n_inliers_count = 0;
   unsigned skipped_count = 0;
@@ -64,57 +68,63 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   const unsigned max_skip = max_iterations_ * 10;
   
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  bool done = false;
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) 
+    // Get the next valid models
+    int nr_drawn = this->drawModels (nr_models, selections, models_coefficients, pretest_passed, skipped_count, max_skip);
+    if (nr_drawn < nr_models)
+      done = true;
+    if (nr_drawn == 0 && skipped_count < max_skip)
     {
       PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
       break;
     }
 
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //++iterations_;
-      ++ skipped_count;
-      continue;
-    }
-
-    // Select the inliers that are within threshold_ from the model
-    //sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
-    //if (inliers.empty () && k > 1.0)
-    //  continue;
-
-    n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_);
+    // Count the inliers that are within threshold_ from each model
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads_)
+    for (int m = 0; m < nr_drawn; ++m)
+      if (pretest_passed[m])
+        inliers_counts[m] = sac_model_->countWithinDistance (models_coefficients[m], threshold_);
 
-    // Better match ?
-    if (n_inliers_count > n_best_inliers_count)
+    // Go through the models in the order they were drawn in, exactly as the serial loop would
+    for (int m = 0; m < nr_drawn && iterations_ < k; ++m)
     {
-      n_best_inliers_count = n_inliers_count;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_best_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1.0 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log (1.0 - probability_) / log (p_no_outliers);
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %d inliers (best is: %d so far).\n", iterations_, k, n_inliers_count, n_best_inliers_count);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
-      break;
+      if (pretest_passed[m])
+        n_inliers_count = inliers_counts[m];
+      // Unfortunately we cannot drop a model before the first one is scored, because k is not set yet
+      else if (k > 1.0)
+        n_inliers_count = -INT_MAX;
+      else
+        n_inliers_count = sac_model_->countWithinDistance (models_coefficients[m], threshold_);
+
+      // Better match ?
+      if (n_inliers_count > n_best_inliers_count)
+      {
+        n_best_inliers_count = n_inliers_count;
+
+        // Save the current model/inlier/coefficients selection as being the best so far
+        model_              = selections[m];
+        model_coefficients_ = models_coefficients[m];
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_best_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1.0 - pow (w, static_cast<double> (selections[m].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1.0 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %d inliers (best is: %d so far).\n", iterations_, k, n_inliers_count, n_best_inliers_count);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
     }
   }
 
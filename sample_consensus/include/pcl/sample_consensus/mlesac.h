@@ -62,6 +62,7 @@ namespace pcl
     using SampleConsensus<PointT>::model_coefficients_;
     using SampleConsensus<PointT>::inliers_;
     using SampleConsensus<PointT>::probability_;
+    using SampleConsensus<PointT>::threads_;
 
     typedef typename SampleConsensusModel<PointT>::Ptr SampleConsensusModelPtr;
     typedef typename SampleConsensusModel<PointT>::PointCloudConstPtr PointCloudConstPtr; 
@@ -108,6 +109,16 @@ namespace pcl
 
 
     protected:
+      /** \brief Compute the negative log likelihood and the number of inliers of a model from its distances, using a
+        * few Expectation-Maximization iterations to estimate the mixing parameter.
+        * \param[in] distances the distances from the points to the model
+        * \param[in] v the length of the diagonal of the bounding box of the points
+        * \param[out] penalty the negative log likelihood of the model
+        * \param[out] inliers_count the number of points within 2 sigma of the model
+        */
+      void
+      scoreModel (const std::vector<double> &distances, double v, double &penalty, int &inliers_count) const;
+
       /** \brief Compute the median absolute deviation:
         * \f[
         * MAD = \sigma * median_i (| Xi - median_j(Xj) |)
@@ -62,6 +62,7 @@ namespace pcl
     using SampleConsensus<PointT>::model_coefficients_;
     using SampleConsensus<PointT>::inliers_;
     using SampleConsensus<PointT>::probability_;
+    using SampleConsensus<PointT>::threads_;
 
     typedef typename SampleConsensusModel<PointT>::Ptr SampleConsensusModelPtr;
 
@@ -89,6 +90,15 @@ namespace pcl
         * \param debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
         */
       bool computeModel (int debug_verbosity_level = 0);
+
+    protected:
+      /** \brief Compute the truncated penalty and the number of inliers of a model from its distances.
+        * \param[in] distances the distances from the points to the model
+        * \param[out] penalty the sum of the distances, truncated to the threshold (-1 if \a distances is empty)
+        * \param[out] inliers_count the number of points within the threshold
+        */
+      void
+      scoreModel (const std::vector<double> &distances, double &penalty, int &inliers_count) const;
   };
 }
 
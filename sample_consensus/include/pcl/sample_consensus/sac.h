@@ -77,6 +77,8 @@ namespace pcl
         iterations_ (0), 
         threshold_ (std::numeric_limits<double>::max()),
         max_iterations_ (1000), 
+        threads_ (1),
+        pretest_size_ (0),
         rng_alg_ (), 
         rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
       {
@@ -101,6 +103,8 @@ namespace pcl
         iterations_ (0), 
         threshold_ (threshold), 
         max_iterations_ (1000), 
+        threads_ (1),
+        pretest_size_ (0),
         rng_alg_ (), 
         rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
       {
@@ -145,6 +149,30 @@ namespace pcl
       inline double 
       getProbability () { return (probability_); }
 
+      /** \brief Set the number of threads used to score the models.
+        * The models are still drawn one after the other from the same random number generator, so the results do
+        * not depend on the number of threads. Used by RANSAC, MSAC and MLESAC.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void 
+      setNumberOfThreads (unsigned int nr_threads) { threads_ = (nr_threads == 0) ? 1 : nr_threads; }
+
+      /** \brief Get the number of threads used to score the models, as set by the user. */
+      inline unsigned int 
+      getNumberOfThreads () const { return (threads_); }
+
+      /** \brief Set the number of random points each model is checked against before being scored (the T(d,d)
+        * test of Matas and Chum). Models for which any of these points is an outlier are dropped without looking at
+        * the rest of the data. Used by RANSAC and MSAC.
+        * \param[in] nr_points the number of points in the pre-test (0 disables the test, default)
+        */
+      inline void 
+      setPreTestSize (unsigned int nr_points) { pretest_size_ = nr_points; }
+
+      /** \brief Get the number of random points each model is checked against before being scored. */
+      inline unsigned int 
+      getPreTestSize () const { return (pretest_size_); }
+
       /** \brief Compute the actual model. Pure virtual. */
       virtual bool 
       computeModel (int debug_verbosity_level = 0) = 0;
@@ -184,6 +212,58 @@ namespace pcl
       getModelCoefficients (Eigen::VectorXf &model_coefficients) { model_coefficients = model_coefficients_; }
 
     protected:
+      /** \brief Draw the next valid models, in the same order as a serial estimator would, so that they can be
+        * scored in parallel. Samples that do not give a valid model are skipped.
+        * \param[in] nr_models the maximum number of models to draw
+        * \param[out] samples the samples each model was computed from
+        * \param[out] coefficients the coefficients of each model
+        * \param[out] pretest_passed for each model, whether it passed the T(d,d) pre-test (see setPreTestSize ())
+        * \param[in,out] skipped_count the number of samples that did not give a valid model so far
+        * \param[in] max_skip the maximum number of samples that may not give a valid model
+        * \param[in] pretest whether to run the pre-test at all, for estimators that do not use its result
+        * \return the number of models drawn, less than \a nr_models if no more samples can be drawn
+        */
+      int
+      drawModels (int nr_models, 
+                  std::vector<std::vector<int> > &samples, 
+                  std::vector<Eigen::VectorXf> &coefficients, 
+                  std::vector<bool> &pretest_passed,
+                  unsigned int &skipped_count, 
+                  unsigned int max_skip,
+                  bool pretest = true)
+      {
+        samples.resize (nr_models);
+        coefficients.resize (nr_models);
+        pretest_passed.resize (nr_models);
+
+        size_t pretest_size = pretest ? (std::min) (static_cast<size_t> (pretest_size_), sac_model_->getIndices ()->size ()) : 0;
+        std::set<int> pretest_indices;
+        int nr_drawn = 0;
+        while (nr_drawn < nr_models && skipped_count < max_skip)
+        {
+          // Get X samples which satisfy the model criteria
+          sac_model_->getSamples (iterations_, samples[nr_drawn]);
+          if (samples[nr_drawn].empty ())
+            break;
+
+          if (!sac_model_->computeModelCoefficients (samples[nr_drawn], coefficients[nr_drawn]))
+          {
+            ++skipped_count;
+            continue;
+          }
+
+          // Verify the model on a few random points first
+          pretest_passed[nr_drawn] = true;
+          if (pretest_size > 0)
+          {
+            getRandomSamples (sac_model_->getIndices (), pretest_size, pretest_indices);
+            pretest_passed[nr_drawn] = sac_model_->doSamplesVerifyModel (pretest_indices, coefficients[nr_drawn], threshold_);
+          }
+          ++nr_drawn;
+        }
+        return (nr_drawn);
+      }
+
       /** \brief The underlying data model used (i.e. what is it that we attempt to search for). */
       SampleConsensusModelPtr sac_model_;
 
@@ -208,6 +288,12 @@ namespace pcl
       /** \brief Maximum number of iterations before giving up. */
       int max_iterations_;
 
+      /** \brief The number of threads used to score the models (default = 1). */
+      unsigned int threads_;
+
+      /** \brief The number of random points each model is checked against before being scored (default = 0). */
+      unsigned int pretest_size_;
+
       /** \brief Boost-based random number generator algorithm. */
       boost::mt19937 rng_alg_;
 
@@ -205,6 +205,37 @@ namespace pcl
         radiusSearch (const PointCloud& cloud, const std::vector<int>& indices, double radius, std::vector< std::vector<int> >& k_indices,
                 std::vector< std::vector<float> >& k_sqr_distances, unsigned int max_nn=0) const;
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, using several threads.
+          * Each thread searches contiguous blocks of queries with one FLANN call per block, writing directly into
+          * the flat output arrays. The neighbors of the i-th query point are stored at [i * k, (i + 1) * k).
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points (size: number of queries * \a k)
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points (size: number of queries * \a k)
+          * \param[in] nr_threads the number of threads used to process the queries
+          */
+        virtual void
+        batchNearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                             std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                             unsigned int nr_threads = 1) const;
+
+        /** \brief Search for all the neighbors of a batch of query points in a given radius, using several threads.
+          * The neighbors of the i-th query point are stored at [offsets[i], offsets[i + 1]).
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+          * \param[in] radius the radius of the sphere bounding the neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points, for all queries
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, for all queries
+          * \param[out] offsets the start of the neighbors of each query in \a k_indices (size: number of queries + 1)
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          * \param[in] nr_threads the number of threads used to process the queries
+          */
+        virtual void
+        batchRadiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                           std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                           std::vector<int> &offsets, unsigned int max_nn = 0, unsigned int nr_threads = 1) const;
+
         /** \brief Provide a pointer to the point representation to use to convert points into k-D vectors.
           * \param[in] point_representation the const boost shared pointer to a PointRepresentation
           */
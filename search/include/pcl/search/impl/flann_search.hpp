@@ -337,6 +337,140 @@ pcl::search::FlannSearch<PointT, FlannDistance>::radiusSearch (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename FlannDistance> void
+pcl::search::FlannSearch<PointT, FlannDistance>::batchNearestKSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, int k,
+    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances, unsigned int nr_threads) const
+{
+  int nr_queries = static_cast<int> (indices.empty () ? cloud.size () : indices.size ());
+  k = std::max (k, 0);
+  k_indices.resize (nr_queries * k);
+  k_sqr_distances.resize (nr_queries * k);
+
+  // At most index_->size () neighbors can be found, the remaining entries of each query are padded
+  int nr_found = std::min (k, static_cast<int> (index_->size ()));
+  if (nr_found <= 0)
+  {
+    std::fill (k_indices.begin (), k_indices.end (), -1);
+    std::fill (k_sqr_distances.begin (), k_sqr_distances.end (), std::numeric_limits<float>::max ());
+    return;
+  }
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  flann::SearchParams p (-1);
+  p.eps = eps_;
+  p.sorted = sorted_results_;
+
+  // Queries are converted and searched in blocks: one FLANN call per block, writing straight into the output
+  const int block_size = 256;
+  int nr_blocks = (nr_queries + block_size - 1) / block_size;
+
+#pragma omp parallel num_threads (nr_threads)
+  {
+    std::vector<float> queries (block_size * dim_);
+#pragma omp for schedule (dynamic, 1)
+    for (int b = 0; b < nr_blocks; ++b)
+    {
+      int begin = b * block_size;
+      int end = std::min (begin + block_size, nr_queries);
+
+      float* query_ptr = &queries[0];
+      for (int i = begin; i < end; ++i, query_ptr += dim_)
+      {
+        const PointT &point = cloud[indices.empty () ? i : indices[i]];
+        assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to batchNearestKSearch!"); // remove this check as soon as FLANN does NaN checks internally
+        point_representation_->vectorize (point, query_ptr);
+      }
+
+      // The row stride is k, so that the padding entries are skipped by FLANN
+      flann::Matrix<int> i_mat (&k_indices[begin * k], end - begin, nr_found, k * sizeof (int));
+      flann::Matrix<float> d_mat (&k_sqr_distances[begin * k], end - begin, nr_found, k * sizeof (float));
+      index_->knnSearch (flann::Matrix<float> (&queries[0], end - begin, dim_), i_mat, d_mat, nr_found, p);
+
+      for (int i = begin; i < end; ++i)
+      {
+        if (!identity_mapping_)
+          for (int j = i * k; j < i * k + nr_found; ++j)
+            k_indices[j] = index_mapping_[k_indices[j]];
+        std::fill (k_indices.begin () + i * k + nr_found, k_indices.begin () + (i + 1) * k, -1);
+        std::fill (k_sqr_distances.begin () + i * k + nr_found, k_sqr_distances.begin () + (i + 1) * k,
+                   std::numeric_limits<float>::max ());
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename FlannDistance> void
+pcl::search::FlannSearch<PointT, FlannDistance>::batchRadiusSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, double radius,
+    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+    std::vector<int> &offsets, unsigned int max_nn, unsigned int nr_threads) const
+{
+  int nr_queries = static_cast<int> (indices.empty () ? cloud.size () : indices.size ());
+  offsets.resize (nr_queries + 1);
+  offsets[0] = 0;
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  flann::SearchParams p;
+  p.sorted = sorted_results_;
+  p.eps = eps_;
+  // here: max_nn==0: take all neighbors. flann: max_nn==0: return no neighbors, only count them. max_nn==-1: return all neighbors
+  p.max_neighbors = max_nn > 0 ? max_nn : -1;
+  float sqr_radius = static_cast<float> (radius * radius);
+
+  // Contiguous chunks of queries fill their own buffers, which are concatenated in chunk (i.e., query) order
+  int nr_chunks = std::max (std::min (static_cast<int> (nr_threads) * 4, nr_queries), 1);
+  std::vector<std::vector<int> > chunk_indices (nr_chunks);
+  std::vector<std::vector<float> > chunk_dists (nr_chunks);
+
+#pragma omp parallel num_threads (nr_threads)
+  {
+    std::vector<float> query (dim_);
+    std::vector<std::vector<int> > nn_indices (1);
+    std::vector<std::vector<float> > nn_dists (1);
+#pragma omp for schedule (dynamic, 1)
+    for (int c = 0; c < nr_chunks; ++c)
+    {
+      int begin = static_cast<int> (static_cast<long> (nr_queries) * c / nr_chunks);
+      int end = static_cast<int> (static_cast<long> (nr_queries) * (c + 1) / nr_chunks);
+      for (int i = begin; i < end; ++i)
+      {
+        const PointT &point = cloud[indices.empty () ? i : indices[i]];
+        assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to batchRadiusSearch!"); // remove this check as soon as FLANN does NaN checks internally
+        point_representation_->vectorize (point, query);
+
+        index_->radiusSearch (flann::Matrix<float> (&query[0], 1, dim_), nn_indices, nn_dists, sqr_radius, p);
+
+        if (!identity_mapping_)
+          for (size_t j = 0; j < nn_indices[0].size (); ++j)
+            nn_indices[0][j] = index_mapping_[nn_indices[0][j]];
+
+        chunk_indices[c].insert (chunk_indices[c].end (), nn_indices[0].begin (), nn_indices[0].end ());
+        chunk_dists[c].insert (chunk_dists[c].end (), nn_dists[0].begin (), nn_dists[0].end ());
+        // Number of neighbors for now, turned into offsets below
+        offsets[i + 1] = static_cast<int> (nn_indices[0].size ());
+      }
+    }
+  }
+
+  for (int i = 0; i < nr_queries; ++i)
+    offsets[i + 1] += offsets[i];
+  k_indices.resize (offsets[nr_queries]);
+  k_sqr_distances.resize (offsets[nr_queries]);
+
+  int begin = 0;
+  for (int c = 0; c < nr_chunks; ++c)
+  {
+    std::copy (chunk_indices[c].begin (), chunk_indices[c].end (), k_indices.begin () + begin);
+    std::copy (chunk_dists[c].begin (), chunk_dists[c].end (), k_sqr_distances.begin () + begin);
+    begin += static_cast<int> (chunk_indices[c].size ());
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename FlannDistance> void
 pcl::search::FlannSearch<PointT, FlannDistance>::convertInputToFlannMatrix ()
@@ -0,0 +1,281 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_IMPL_NEIGHBORHOOD_CACHE_H_
+#define PCL_SEARCH_IMPL_NEIGHBORHOOD_CACHE_H_
+
+#include <pcl/search/neighborhood_cache.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::NeighborhoodCache<PointT>::clear ()
+{
+  queries_.reset ();
+  rows_.clear ();
+  nn_indices_.clear ();
+  nn_dists_.clear ();
+  nn_offsets_.assign (1, 0);
+  radius_ = 0;
+  k_ = 0;
+  sorted_rows_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::NeighborhoodCache<PointT>::initRows (
+    const PointCloudConstPtr &queries, const IndicesConstPtr &indices, std::vector<int> &query_indices)
+{
+  clear ();
+  rows_.assign (queries->points.size (), -1);
+  int nr_queries = indices ? static_cast<int> (indices->size ()) : static_cast<int> (queries->points.size ());
+  query_indices.clear ();
+  query_indices.reserve (nr_queries);
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    int index = indices ? (*indices)[i] : i;
+    if (rows_[index] != -1 || !isFinite (queries->points[index]))
+      continue;
+    rows_[index] = static_cast<int> (query_indices.size ());
+    query_indices.push_back (index);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::NeighborhoodCache<PointT>::computeRadiusNeighborhoods (
+    const PointCloudConstPtr &queries, double radius, const IndicesConstPtr &indices)
+{
+  std::vector<int> query_indices;
+  initRows (queries, indices, query_indices);
+  // An empty list of queries would stand for the whole cloud
+  if (!query_indices.empty ())
+    search_->batchRadiusSearch (*queries, query_indices, radius, nn_indices_, nn_dists_, nn_offsets_, 0, threads_);
+  queries_ = queries;
+  radius_ = radius;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::NeighborhoodCache<PointT>::computeNearestKNeighborhoods (
+    const PointCloudConstPtr &queries, int k, const IndicesConstPtr &indices)
+{
+  std::vector<int> query_indices;
+  initRows (queries, indices, query_indices);
+  if (query_indices.empty () || k <= 0)
+  {
+    queries_ = queries;
+    k_ = std::max (k, 0);
+    return;
+  }
+
+  // The k-nearest neighbor search pads the results of each query with -1; compact them into rows
+  search_->batchNearestKSearch (*queries, query_indices, k, nn_indices_, nn_dists_, threads_);
+  nn_offsets_.resize (query_indices.size () + 1);
+  nn_offsets_[0] = 0;
+  int nr_neighbors = 0;
+  for (size_t i = 0; i < query_indices.size (); ++i)
+  {
+    for (int j = static_cast<int> (i) * k; j < static_cast<int> (i + 1) * k && nn_indices_[j] != -1; ++j)
+    {
+      nn_indices_[nr_neighbors] = nn_indices_[j];
+      nn_dists_[nr_neighbors] = nn_dists_[j];
+      ++nr_neighbors;
+    }
+    nn_offsets_[i + 1] = nr_neighbors;
+  }
+  nn_indices_.resize (nr_neighbors);
+  nn_dists_.resize (nr_neighbors);
+  queries_ = queries;
+  k_ = k;
+  // The k-nearest neighbors come sorted by distance
+  sorted_rows_ = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::NeighborhoodCache<PointT>::sortNeighborhoods ()
+{
+  if (sorted_rows_)
+    return;
+
+  int nr_rows = static_cast<int> (nn_offsets_.size ()) - 1;
+#pragma omp parallel for schedule (dynamic, 256) num_threads (threads_)
+  for (int row = 0; row < nr_rows; ++row)
+  {
+    int begin = nn_offsets_[row], end = nn_offsets_[row + 1];
+    std::vector<std::pair<float, int> > neighbors (end - begin);
+    for (int j = begin; j < end; ++j)
+      neighbors[j - begin] = std::make_pair (nn_dists_[j], nn_indices_[j]);
+    std::sort (neighbors.begin (), neighbors.end ());
+    for (int j = begin; j < end; ++j)
+    {
+      nn_dists_[j] = neighbors[j - begin].first;
+      nn_indices_[j] = neighbors[j - begin].second;
+    }
+  }
+  sorted_rows_ = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::NeighborhoodCache<PointT>::copyRadiusNeighbors (
+    int row, double radius, unsigned int max_nn,
+    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  const float sqr_radius = static_cast<float> (radius * radius);
+  if (sorted_rows_)
+  {
+    // The neighbors within radius are a prefix of the row
+    int end = nn_offsets_[row + 1];
+    if (radius < radius_)
+      end = static_cast<int> (std::upper_bound (nn_dists_.begin () + nn_offsets_[row], nn_dists_.begin () + end,
+                                                sqr_radius) - nn_dists_.begin ());
+    if (max_nn > 0)
+      end = std::min (end, nn_offsets_[row] + static_cast<int> (max_nn));
+    k_indices.assign (nn_indices_.begin () + nn_offsets_[row], nn_indices_.begin () + end);
+    k_sqr_distances.assign (nn_dists_.begin () + nn_offsets_[row], nn_dists_.begin () + end);
+    return (end - nn_offsets_[row]);
+  }
+  for (int j = nn_offsets_[row]; j < nn_offsets_[row + 1]; ++j)
+  {
+    if (max_nn > 0 && k_indices.size () == max_nn)
+      break;
+    // Neighborhoods stored for the same radius are copied as they are
+    if (radius < radius_ && nn_dists_[j] > sqr_radius)
+      continue;
+    k_indices.push_back (nn_indices_[j]);
+    k_sqr_distances.push_back (nn_dists_[j]);
+  }
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::NeighborhoodCache<PointT>::nearestKSearch (
+    const PointCloud &cloud, int index, int k,
+    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  int row = getRow (cloud, index);
+  if (row < 0 || k_ == 0 || k > k_)
+    return (search_->nearestKSearch (cloud, index, k, k_indices, k_sqr_distances));
+
+  int nr_neighbors = std::min (k, nn_offsets_[row + 1] - nn_offsets_[row]);
+  k_indices.assign (nn_indices_.begin () + nn_offsets_[row], nn_indices_.begin () + nn_offsets_[row] + nr_neighbors);
+  k_sqr_distances.assign (nn_dists_.begin () + nn_offsets_[row], nn_dists_.begin () + nn_offsets_[row] + nr_neighbors);
+  return (nr_neighbors);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::NeighborhoodCache<PointT>::radiusSearch (
+    const PointCloud &cloud, int index, double radius,
+    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances, unsigned int max_nn) const
+{
+  int row = getRow (cloud, index);
+  if (row < 0 || k_ != 0 || radius > radius_)
+    return (search_->radiusSearch (cloud, index, radius, k_indices, k_sqr_distances, max_nn));
+  return (copyRadiusNeighbors (row, radius, max_nn, k_indices, k_sqr_distances));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::NeighborhoodCache<PointT>::batchNearestKSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, int k,
+    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances, unsigned int nr_threads) const
+{
+  int nr_queries = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+  bool stored = (k_ != 0 && k <= k_);
+  for (int i = 0; i < nr_queries && stored; ++i)
+    stored = getRow (cloud, indices.empty () ? i : indices[i]) >= 0;
+  if (!stored)
+  {
+    search_->batchNearestKSearch (cloud, indices, k, k_indices, k_sqr_distances, nr_threads);
+    return;
+  }
+
+  k = std::max (k, 0);
+  k_indices.resize (nr_queries * k);
+  k_sqr_distances.resize (nr_queries * k);
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    int row = getRow (cloud, indices.empty () ? i : indices[i]);
+    int nr_neighbors = std::min (k, nn_offsets_[row + 1] - nn_offsets_[row]);
+    for (int j = 0; j < k; ++j)
+    {
+      k_indices[i * k + j] = (j < nr_neighbors) ? nn_indices_[nn_offsets_[row] + j] : -1;
+      k_sqr_distances[i * k + j] = (j < nr_neighbors) ? nn_dists_[nn_offsets_[row] + j] : std::numeric_limits<float>::max ();
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::NeighborhoodCache<PointT>::batchRadiusSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, double radius,
+    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+    std::vector<int> &offsets, unsigned int max_nn, unsigned int nr_threads) const
+{
+  int nr_queries = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+  bool stored = (k_ == 0 && radius <= radius_);
+  for (int i = 0; i < nr_queries && stored; ++i)
+    stored = getRow (cloud, indices.empty () ? i : indices[i]) >= 0;
+  if (!stored)
+  {
+    search_->batchRadiusSearch (cloud, indices, radius, k_indices, k_sqr_distances, offsets, max_nn, nr_threads);
+    return;
+  }
+
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  offsets.resize (nr_queries + 1);
+  offsets[0] = 0;
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    copyRadiusNeighbors (getRow (cloud, indices.empty () ? i : indices[i]), radius, max_nn, nn_indices, nn_dists);
+    k_indices.insert (k_indices.end (), nn_indices.begin (), nn_indices.end ());
+    k_sqr_distances.insert (k_sqr_distances.end (), nn_dists.begin (), nn_dists.end ());
+    offsets[i + 1] = static_cast<int> (k_indices.size ());
+  }
+}
+
+#define PCL_INSTANTIATE_NeighborhoodCache(T) template class PCL_EXPORTS pcl::search::NeighborhoodCache<T>;
+
+#endif    // PCL_SEARCH_IMPL_NEIGHBORHOOD_CACHE_H_
@@ -56,26 +56,35 @@ pcl::search::OrganizedNeighbor<PointT>::radiusSearch (const               PointT
   // NAN test
   assert (isFinite (query) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
 
-  // search window
-  unsigned left, right, top, bottom;
-  //unsigned x, y, idx;
-  float squared_distance;
-  double squared_radius;
-
   k_indices.clear ();
   k_sqr_distances.clear ();
 
-  squared_radius = radius * radius;
-
-  this->getProjectedRadiusSearchBox (query, static_cast<float> (squared_radius), left, right, top, bottom);
-
   // iterate over search box
   if (max_nn == 0 || max_nn >= static_cast<unsigned int> (input_->points.size ()))
     max_nn = static_cast<unsigned int> (input_->points.size ());
 
-  k_indices.reserve (max_nn);
-  k_sqr_distances.reserve (max_nn);
+  searchRadiusBox (query, static_cast<float> (radius * radius), max_nn, k_indices, k_sqr_distances);
+
+  if (sorted_results_)
+    this->sortResults (k_indices, k_sqr_distances);  
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> unsigned
+pcl::search::OrganizedNeighbor<PointT>::searchRadiusBox (const PointT &query,
+                                                         float squared_radius,
+                                                         unsigned max_nn,
+                                                         std::vector<int> &k_indices,
+                                                         std::vector<float> &k_sqr_distances) const
+{
+  // search window
+  unsigned left, right, top, bottom;
+  float squared_distance;
+
+  this->getProjectedRadiusSearchBox (query, squared_radius, left, right, top, bottom);
 
+  unsigned nr_found = 0;
   unsigned yEnd  = (bottom + 1) * input_->width + right + 1;
   register unsigned idx  = top * input_->width + left;
   unsigned skip = input_->width - right + left - 1;
@@ -94,18 +103,172 @@ pcl::search::OrganizedNeighbor<PointT>::radiusSearch (const               PointT
         k_indices.push_back (idx);
         k_sqr_distances.push_back (squared_distance);
         // already done ?
-        if (k_indices.size () == max_nn)
+        if (++nr_found == max_nn)
+          return (nr_found);
+      }
+    }
+  }
+  return (nr_found);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::search::OrganizedNeighbor<PointT>::computeQueryTiles (const PointCloud &cloud,
+                                                           const std::vector<int> &indices,
+                                                           std::vector<int> &order,
+                                                           std::vector<int> &tile_offsets) const
+{
+  // Edge length of the tiles in pixels: the search windows of the queries of one tile share most of their rows
+  const int tile_size = 32;
+  const int tiles_x = (static_cast<int> (input_->width) + tile_size - 1) / tile_size;
+  const int tiles_y = (static_cast<int> (input_->height) + tile_size - 1) / tile_size;
+  // The last tile holds the query points that can not be projected
+  const int nr_tiles = tiles_x * tiles_y + 1;
+  const int nr_queries = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+
+  std::vector<int> tile_ids (nr_queries);
+  tile_offsets.assign (nr_tiles + 1, 0);
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    const PointT &point = cloud.points[indices.empty () ? i : indices[i]];
+    pcl::PointXY q;
+    int tile = nr_tiles - 1;
+    if (isFinite (point) && projectPoint (point, q) && pcl_isfinite (q.x) && pcl_isfinite (q.y))
+    {
+      int x = std::max (std::min (static_cast<int> (q.x), static_cast<int> (input_->width) - 1), 0);
+      int y = std::max (std::min (static_cast<int> (q.y), static_cast<int> (input_->height) - 1), 0);
+      tile = (y / tile_size) * tiles_x + x / tile_size;
+    }
+    tile_ids[i] = tile;
+    ++tile_offsets[tile + 1];
+  }
+
+  // Counting sort of the queries by tile, keeping the query order within a tile
+  for (int t = 0; t < nr_tiles; ++t)
+    tile_offsets[t + 1] += tile_offsets[t];
+  std::vector<int> fill (tile_offsets.begin (), tile_offsets.end () - 1);
+  order.resize (nr_queries);
+  for (int i = 0; i < nr_queries; ++i)
+    order[fill[tile_ids[i]]++] = i;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::search::OrganizedNeighbor<PointT>::batchNearestKSearch (const PointCloud &cloud,
+                                                             const std::vector<int> &indices,
+                                                             int k,
+                                                             std::vector<int> &k_indices,
+                                                             std::vector<float> &k_sqr_distances,
+                                                             unsigned int nr_threads) const
+{
+  int nr_queries = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+  k = std::max (k, 0);
+  k_indices.assign (nr_queries * k, -1);
+  k_sqr_distances.assign (nr_queries * k, std::numeric_limits<float>::max ());
+  if (k == 0 || nr_queries == 0)
+    return;
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  std::vector<int> order, tile_offsets;
+  computeQueryTiles (cloud, indices, order, tile_offsets);
+  // The queries of the last tile have invalid coordinates and keep the default results
+  int nr_tiles = static_cast<int> (tile_offsets.size ()) - 2;
+
+#pragma omp parallel num_threads (nr_threads)
+  {
+    // Per-thread scratch buffers, reused for all the queries of this thread
+    std::vector<int> nn_indices (k);
+    std::vector<float> nn_dists (k);
+#pragma omp for schedule (dynamic, 1)
+    for (int t = 0; t < nr_tiles; ++t)
+    {
+      for (int j = tile_offsets[t]; j < tile_offsets[t + 1]; ++j)
+      {
+        int i = order[j];
+        const PointT &query = cloud.points[indices.empty () ? i : indices[i]];
+        int nr_found = std::min (nearestKSearch (query, k, nn_indices, nn_dists), k);
+        std::copy (nn_indices.begin (), nn_indices.begin () + nr_found, k_indices.begin () + i * k);
+        std::copy (nn_dists.begin (), nn_dists.begin () + nr_found, k_sqr_distances.begin () + i * k);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::search::OrganizedNeighbor<PointT>::batchRadiusSearch (const PointCloud &cloud,
+                                                           const std::vector<int> &indices,
+                                                           double radius,
+                                                           std::vector<int> &k_indices,
+                                                           std::vector<float> &k_sqr_distances,
+                                                           std::vector<int> &offsets,
+                                                           unsigned int max_nn,
+                                                           unsigned int nr_threads) const
+{
+  int nr_queries = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+  if (max_nn == 0 || max_nn >= static_cast<unsigned int> (input_->points.size ()))
+    max_nn = static_cast<unsigned int> (input_->points.size ());
+  if (nr_threads == 0)
+    nr_threads = 1;
+  const float squared_radius = static_cast<float> (radius * radius);
+
+  std::vector<int> order, tile_offsets;
+  computeQueryTiles (cloud, indices, order, tile_offsets);
+  int nr_tiles = static_cast<int> (tile_offsets.size ()) - 2;
+
+  // Each tile fills its own buffers; the position of every query in the buffer of its tile is remembered in
+  // tile_starts, so that the results can be scattered back into query order afterwards
+  std::vector<std::vector<int> > tile_indices (nr_tiles);
+  std::vector<std::vector<float> > tile_dists (nr_tiles);
+  std::vector<int> tile_starts (nr_queries, 0);
+  offsets.assign (nr_queries + 1, 0);
+
+#pragma omp parallel num_threads (nr_threads)
+  {
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
+#pragma omp for schedule (dynamic, 1)
+    for (int t = 0; t < nr_tiles; ++t)
+    {
+      for (int j = tile_offsets[t]; j < tile_offsets[t + 1]; ++j)
+      {
+        int i = order[j];
+        const PointT &query = cloud.points[indices.empty () ? i : indices[i]];
+        tile_starts[i] = static_cast<int> (tile_indices[t].size ());
+        unsigned nr_found = searchRadiusBox (query, squared_radius, max_nn, tile_indices[t], tile_dists[t]);
+        if (sorted_results_ && nr_found > 1)
         {
-          if (sorted_results_)
-            this->sortResults (k_indices, k_sqr_distances);
-          return (max_nn);
+          nn_indices.assign (tile_indices[t].end () - nr_found, tile_indices[t].end ());
+          nn_dists.assign (tile_dists[t].end () - nr_found, tile_dists[t].end ());
+          this->sortResults (nn_indices, nn_dists);
+          std::copy (nn_indices.begin (), nn_indices.end (), tile_indices[t].end () - nr_found);
+          std::copy (nn_dists.begin (), nn_dists.end (), tile_dists[t].end () - nr_found);
         }
+        // Number of neighbors for now, turned into offsets below
+        offsets[i + 1] = static_cast<int> (nr_found);
       }
     }
   }
-  if (sorted_results_)
-    this->sortResults (k_indices, k_sqr_distances);  
-  return (static_cast<int> (k_indices.size ()));
+
+  for (int i = 0; i < nr_queries; ++i)
+    offsets[i + 1] += offsets[i];
+  k_indices.resize (offsets[nr_queries]);
+  k_sqr_distances.resize (offsets[nr_queries]);
+
+#pragma omp parallel for schedule (dynamic, 1) num_threads (nr_threads)
+  for (int t = 0; t < nr_tiles; ++t)
+  {
+    for (int j = tile_offsets[t]; j < tile_offsets[t + 1]; ++j)
+    {
+      int i = order[j];
+      int nr_found = offsets[i + 1] - offsets[i];
+      std::copy (tile_indices[t].begin () + tile_starts[i], tile_indices[t].begin () + tile_starts[i] + nr_found,
+                 k_indices.begin () + offsets[i]);
+      std::copy (tile_dists[t].begin () + tile_starts[i], tile_dists[t].begin () + tile_starts[i] + nr_found,
+                 k_sqr_distances.begin () + offsets[i]);
+    }
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -139,12 +302,14 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
   std::priority_queue <Entry> results;
   //std::vector<Entry> k_results;
   //k_results.reserve (k);
+  // stop used as isChanged as well as stop.
+  bool stop = false;
   // add point laying on the projection of the query point.
   if (xBegin >= 0 && 
       xBegin < static_cast<int> (input_->width) && 
       yBegin >= 0 && 
       yBegin < static_cast<int> (input_->height))
-    testPoint (query, k, results, yBegin * input_->width + xBegin);
+    stop = testPoint (query, k, results, yBegin * input_->width + xBegin);
   else // point lys
   {
     // find the box that touches the image border -> dont waste time evaluating boxes that are completely outside the image!
@@ -168,8 +333,6 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
   }
 
   
-  // stop used as isChanged as well as stop.
-  bool stop = false;
   do
   {
     // increment box size
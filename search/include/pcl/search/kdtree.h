@@ -168,6 +168,41 @@ namespace pcl
           return (tree_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
         }
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, using several threads.
+          * The queries are forwarded in blocks to FLANN, see pcl::KdTreeFLANN::batchNearestKSearch.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points (size: number of queries * \a k)
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points (size: number of queries * \a k)
+          * \param[in] nr_threads the number of threads used to process the queries
+          */
+        inline void
+        batchNearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                             std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                             unsigned int nr_threads = 1) const
+        {
+          tree_->batchNearestKSearch (cloud, indices, k, k_indices, k_sqr_distances, nr_threads);
+        }
+
+        /** \brief Search for all the neighbors of a batch of query points in a given radius, using several threads.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+          * \param[in] radius the radius of the sphere bounding the neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points, for all queries
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, for all queries
+          * \param[out] offsets the start of the neighbors of each query in \a k_indices (size: number of queries + 1)
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          * \param[in] nr_threads the number of threads used to process the queries
+          */
+        inline void
+        batchRadiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                           std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                           std::vector<int> &offsets, unsigned int max_nn = 0, unsigned int nr_threads = 1) const
+        {
+          tree_->batchRadiusSearch (cloud, indices, radius, k_indices, k_sqr_distances, offsets, max_nn, nr_threads);
+        }
+
       protected:
         /** \brief A pointer to the internal KdTreeFLANN object. */
         KdTreeFLANNPtr tree_;
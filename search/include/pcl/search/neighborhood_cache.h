@@ -0,0 +1,365 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_NEIGHBORHOOD_CACHE_H_
+#define PCL_SEARCH_NEIGHBORHOOD_CACHE_H_
+
+#include <pcl/search/search.h>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief Search wrapper which stores the neighborhoods of a set of query points, so that several
+      * algorithms working on the same points and search parameter share a single search pass.
+      *
+      * The neighborhoods are computed once with \ref computeRadiusNeighborhoods or
+      * \ref computeNearestKNeighborhoods, using the batch search of the wrapped search object, and kept in
+      * a compressed row table. Queries given as a (cloud, index) pair for that same query cloud are then
+      * answered from the table, as long as the table holds them: a radius search may use any radius up to
+      * the stored one, and a k-nearest neighbor search any k up to the stored one. Every other query is
+      * forwarded to the wrapped search object.
+      *
+      * A typical use is to give the same cache to several features with setSearchMethod ():
+      * \code
+      * pcl::search::NeighborhoodCache<pcl::PointXYZ>::Ptr cache (new pcl::search::NeighborhoodCache<pcl::PointXYZ> (tree));
+      * cache->setInputCloud (cloud);
+      * cache->computeRadiusNeighborhoods (cloud, 0.03);
+      * normal_estimation.setSearchMethod (cache);
+      * fpfh_estimation.setSearchMethod (cache);
+      * \endcode
+      *
+      * \note The k-nearest neighbors are assumed to be sorted by distance, which is the case for all the
+      * search methods in PCL.
+      * \ingroup search
+      */
+    template<typename PointT>
+    class NeighborhoodCache : public pcl::search::Search<PointT>
+    {
+      public:
+        typedef typename Search<PointT>::PointCloud PointCloud;
+        typedef typename Search<PointT>::PointCloudConstPtr PointCloudConstPtr;
+        typedef typename Search<PointT>::IndicesConstPtr IndicesConstPtr;
+
+        typedef boost::shared_ptr<NeighborhoodCache<PointT> > Ptr;
+        typedef boost::shared_ptr<const NeighborhoodCache<PointT> > ConstPtr;
+
+        typedef typename Search<PointT>::Ptr SearchPtr;
+
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::sorted_results_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+
+        /** \brief Constructor.
+          * \param[in] search the search object used to compute the neighborhoods and to answer the queries
+          * which are not stored
+          */
+        NeighborhoodCache (const SearchPtr &search)
+          : Search<PointT> ("NeighborhoodCache")
+          , search_ (search)
+          , queries_ ()
+          , rows_ ()
+          , nn_indices_ ()
+          , nn_dists_ ()
+          , nn_offsets_ ()
+          , radius_ (0)
+          , k_ (0)
+          , sorted_rows_ (false)
+          , threads_ (1)
+        {
+          input_ = search_->getInputCloud ();
+          indices_ = search_->getIndices ();
+        }
+
+        /** \brief Destructor. */
+        virtual
+        ~NeighborhoodCache ()
+        {
+        }
+
+        /** \brief Get the wrapped search object. */
+        inline SearchPtr
+        getSearchMethod () const
+        {
+          return (search_);
+        }
+
+        /** \brief Set the number of threads to use for computing the neighborhoods.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads)
+        {
+          threads_ = (nr_threads == 0) ? 1 : nr_threads;
+        }
+
+        /** \brief Get the number of threads used for computing the neighborhoods. */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
+        /** \brief Set whether the results should be sorted by distance, in the wrapped search object. */
+        virtual void
+        setSortedResults (bool sorted)
+        {
+          sorted_results_ = sorted;
+          search_->setSortedResults (sorted);
+        }
+
+        /** \brief Pass the input dataset that the search will be performed on, to the wrapped search object.
+          * Changing the input cloud clears the stored neighborhoods, since they refer to its points.
+          * \param[in] cloud a const pointer to the PointCloud data
+          * \param[in] indices the point indices subset that is to be used from the cloud
+          */
+        virtual void
+        setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr &indices = IndicesConstPtr ())
+        {
+          if (cloud != input_ || indices != indices_)
+            clear ();
+          input_ = cloud;
+          indices_ = indices;
+          search_->setInputCloud (cloud, indices);
+        }
+
+        /** \brief Compute and store the neighbors within a given radius of a set of query points.
+          * \param[in] queries the cloud holding the query points
+          * \param[in] radius the radius of the sphere bounding the neighbors
+          * \param[in] indices the indices of the query points in \a queries. If not given, all the points are used.
+          * Points with non finite coordinates are skipped.
+          */
+        void
+        computeRadiusNeighborhoods (const PointCloudConstPtr &queries, double radius,
+                                    const IndicesConstPtr &indices = IndicesConstPtr ());
+
+        /** \brief Compute and store the k nearest neighbors of a set of query points.
+          * \param[in] queries the cloud holding the query points
+          * \param[in] k the number of neighbors to search for
+          * \param[in] indices the indices of the query points in \a queries. If not given, all the points are used.
+          * Points with non finite coordinates are skipped.
+          */
+        void
+        computeNearestKNeighborhoods (const PointCloudConstPtr &queries, int k,
+                                      const IndicesConstPtr &indices = IndicesConstPtr ());
+
+        /** \brief Sort each stored neighborhood by increasing distance to its query point. A radius search
+          * for a smaller radius than the stored one is then answered by the prefix of the stored neighborhood,
+          * instead of filtering all its neighbors. This is what multi-scale algorithms do, which compute the
+          * neighborhoods once at their largest scale.
+          */
+        void
+        sortNeighborhoods ();
+
+        /** \brief Get whether the stored neighborhoods are sorted by distance, see \ref sortNeighborhoods. */
+        inline bool
+        getSortedNeighborhoods () const
+        {
+          return (sorted_rows_);
+        }
+
+        /** \brief Remove all the stored neighborhoods. */
+        void
+        clear ();
+
+        /** \brief Get the stored neighbors of a query point.
+          * \param[in] index the index of the query point in the query cloud
+          * \param[out] nn_indices a pointer to the indices of its neighbors
+          * \param[out] nn_sqr_dists a pointer to the squared distances to its neighbors
+          * \return the number of neighbors, or -1 if the neighborhood of \a index is not stored
+          */
+        inline int
+        getNeighborhood (int index, const int* &nn_indices, const float* &nn_sqr_dists) const
+        {
+          if (index < 0 || index >= static_cast<int> (rows_.size ()) || rows_[index] < 0)
+            return (-1);
+          int row = rows_[index];
+          nn_indices = nn_indices_.empty () ? NULL : &nn_indices_[nn_offsets_[row]];
+          nn_sqr_dists = nn_dists_.empty () ? NULL : &nn_dists_[nn_offsets_[row]];
+          return (nn_offsets_[row + 1] - nn_offsets_[row]);
+        }
+
+        /** \brief Get the cloud holding the query points whose neighborhoods are stored. */
+        inline PointCloudConstPtr
+        getQueryCloud () const
+        {
+          return (queries_);
+        }
+
+        /** \brief Get the radius of the stored neighborhoods (0 if they were computed by k-nearest neighbor search). */
+        inline double
+        getRadius () const
+        {
+          return (radius_);
+        }
+
+        /** \brief Get the number of neighbors of the stored neighborhoods (0 if they were computed by radius search). */
+        inline int
+        getK () const
+        {
+          return (k_);
+        }
+
+        /** \brief Search for the k-nearest neighbors of a given query point, using the wrapped search object.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const
+        {
+          return (search_->nearestKSearch (point, k, k_indices, k_sqr_distances));
+        }
+
+        /** \brief Search for the k-nearest neighbors of a point of a cloud. The stored neighborhood is used if
+          * \a cloud is the query cloud and at least \a k neighbors were stored.
+          * \param[in] cloud the point cloud data
+          * \param[in] index a \a valid index in \a cloud representing a \a valid (i.e., finite) query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointCloud &cloud, int index, int k,
+                        std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for all the neighbors of a given query point within a radius, using the wrapped search
+          * object.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
+        {
+          return (search_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
+        }
+
+        /** \brief Search for all the neighbors of a point of a cloud within a radius. The stored neighborhood is
+          * used if \a cloud is the query cloud and the stored radius is at least \a radius.
+          * \param[in] cloud the point cloud data
+          * \param[in] index a \a valid index in \a cloud representing a \a valid (i.e., finite) query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointCloud &cloud, int index, double radius,
+                      std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const;
+
+        /** \brief Search for the k-nearest neighbors of a batch of query points. The stored neighborhoods are
+          * used if they hold all the queries, see \ref pcl::search::Search::batchNearestKSearch.
+          */
+        void
+        batchNearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                             std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                             unsigned int nr_threads = 1) const;
+
+        /** \brief Search for all the neighbors of a batch of query points within a radius. The stored
+          * neighborhoods are used if they hold all the queries, see \ref pcl::search::Search::batchRadiusSearch.
+          */
+        void
+        batchRadiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                           std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                           std::vector<int> &offsets, unsigned int max_nn = 0, unsigned int nr_threads = 1) const;
+
+      protected:
+        /** \brief Fill \a rows_ and list the finite query points, in the order of the rows. */
+        void
+        initRows (const PointCloudConstPtr &queries, const IndicesConstPtr &indices, std::vector<int> &query_indices);
+
+        /** \brief Get the row of a query point in the table, or -1 if its neighborhood is not stored. */
+        inline int
+        getRow (const PointCloud &cloud, int index) const
+        {
+          if (&cloud != queries_.get () || index < 0 || index >= static_cast<int> (rows_.size ()))
+            return (-1);
+          return (rows_[index]);
+        }
+
+        /** \brief Copy the stored neighbors of a row which are within \a radius, at most \a max_nn of them if not 0. */
+        int
+        copyRadiusNeighbors (int row, double radius, unsigned int max_nn,
+                             std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief The search object the neighborhoods are computed with. */
+        SearchPtr search_;
+
+        /** \brief The cloud holding the query points of the stored neighborhoods. */
+        PointCloudConstPtr queries_;
+
+        /** \brief The row of each point of the query cloud in the table, -1 if it is not stored. */
+        std::vector<int> rows_;
+
+        /** \brief The neighbor indices of all the stored neighborhoods. */
+        std::vector<int> nn_indices_;
+
+        /** \brief The squared distances to the neighbors of all the stored neighborhoods. */
+        std::vector<float> nn_dists_;
+
+        /** \brief The neighbors of row i are at [nn_offsets_[i], nn_offsets_[i + 1]) in the table. */
+        std::vector<int> nn_offsets_;
+
+        /** \brief The radius of the stored neighborhoods, if computed by radius search. */
+        double radius_;
+
+        /** \brief The number of neighbors of the stored neighborhoods, if computed by k-nearest neighbor search. */
+        int k_;
+
+        /** \brief Whether the stored neighborhoods are sorted by distance. */
+        bool sorted_rows_;
+
+        /** \brief The number of threads the neighborhoods are computed with. */
+        unsigned int threads_;
+    };
+  }
+}
+
+#endif    // PCL_SEARCH_NEIGHBORHOOD_CACHE_H_
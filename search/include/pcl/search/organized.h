@@ -181,6 +181,41 @@ namespace pcl
                         std::vector<int> &k_indices,
                         std::vector<float> &k_sqr_distances) const;
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, using several threads.
+          * The query points are grouped into square tiles of the image plane and each thread processes whole tiles,
+          * so that the search windows of consecutive queries overlap and stay in cache. The results are laid out as
+          * in \ref pcl::search::Search::batchNearestKSearch. Query points with invalid (NaN, Inf) coordinates get
+          * no neighbors.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points, for all queries
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, for all queries
+          * \param[in] nr_threads the number of threads used to process the queries
+          */
+        virtual void
+        batchNearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                             std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                             unsigned int nr_threads = 1) const;
+
+        /** \brief Search for all the neighbors of a batch of query points in a given radius, using several threads.
+          * The query points are grouped into square tiles of the image plane and each thread processes whole tiles.
+          * The results are laid out as in \ref pcl::search::Search::batchRadiusSearch. Query points with invalid
+          * (NaN, Inf) coordinates get no neighbors.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+          * \param[in] radius the radius of the sphere bounding the neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points, for all queries
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, for all queries
+          * \param[out] offsets the start of the neighbors of each query in \a k_indices (size: number of queries + 1)
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          * \param[in] nr_threads the number of threads used to process the queries
+          */
+        virtual void
+        batchRadiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                           std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                           std::vector<int> &offsets, unsigned int max_nn = 0, unsigned int nr_threads = 1) const;
+
         /** \brief projects a point into the image
           * \param[in] p point in 3D World Coordinate Frame to be projected onto the image plane
           * \param[out] q the 2D projected point in pixel coordinates (u,v)
@@ -209,7 +244,8 @@ namespace pcl
           * \param[in] k number of maximum nn interested in
           * \param[in] queue priority queue with k NN
           * \param[in] index index on point to be tested
-          * \return wheter the top element changed or not.
+          * \return wheter the top element changed or not. Filling the queue up to \a k elements counts as a change,
+          * so that the search window gets bounded as soon as k candidates are known.
           */
         inline bool 
         testPoint (const PointT& query, unsigned k, std::priority_queue<Entry>& queue, unsigned index) const
@@ -219,7 +255,10 @@ namespace pcl
           {
             float squared_distance = (point.getVector3fMap () - query.getVector3fMap ()).squaredNorm ();
             if (queue.size () < k)
+            {
               queue.push (Entry (index, squared_distance));
+              return (queue.size () == k);
+            }
             else if (queue.top ().distance > squared_distance)
             {
               queue.pop ();
@@ -250,6 +289,30 @@ namespace pcl
                                      unsigned& maxX, unsigned& maxY) const;
 
 
+        /** \brief Collect the points of the search box around a query point that are within a given radius.
+          * The results are appended to \a k_indices and \a k_sqr_distances.
+          * \param[in] query the query point
+          * \param[in] squared_radius the squared radius of the sphere bounding the neighbors
+          * \param[in] max_nn the maximum number of neighbors to append
+          * \param[out] k_indices the indices of the neighboring points
+          * \param[out] k_sqr_distances the squared distances to the neighboring points
+          * \return the number of neighbors appended
+          */
+        unsigned
+        searchRadiusBox (const PointT &query, float squared_radius, unsigned max_nn,
+                         std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Sort a batch of query points by the square tile of the image plane they project into.
+          * Query points with invalid coordinates are put into an extra tile at the end.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are used
+          * \param[out] order the positions of the query points in the batch, sorted by tile
+          * \param[out] tile_offsets the start of each tile in \a order (size: number of tiles + 1)
+          */
+        void
+        computeQueryTiles (const PointCloud &cloud, const std::vector<int> &indices,
+                           std::vector<int> &order, std::vector<int> &tile_offsets) const;
+
         /** \brief copys upper or lower triangular part of the matrix to the other one */
         template <typename MatrixType> void
         makeSymmetric (MatrixType& matrix, bool use_upper_triangular = true) const;
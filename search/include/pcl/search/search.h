@@ -42,6 +42,8 @@
 
 #include <pcl/point_cloud.h>
 #include <pcl/common/io.h>
+#include <algorithm>
+#include <limits>
 
 namespace pcl
 {
@@ -475,6 +477,41 @@ namespace pcl
           }
         }
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, using several threads.
+          * The results are written into flat arrays: the neighbors of the i-th query point are stored at
+          * [i * k, (i + 1) * k) in \a k_indices and \a k_sqr_distances. If less than \a k neighbors are found,
+          * the remaining entries are set to -1 and std::numeric_limits<float>::max (). The output arrays are only
+          * resized, so reusing them from one call to the next does not allocate memory.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points (size: number of queries * \a k)
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points (size: number of queries * \a k)
+          * \param[in] nr_threads the number of threads used to process the queries
+          */
+        virtual void
+        batchNearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                             std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                             unsigned int nr_threads = 1) const;
+
+        /** \brief Search for all the neighbors of a batch of query points in a given radius, using several threads.
+          * The results are written into flat arrays (compressed row storage): the neighbors of the i-th query point
+          * are stored at [offsets[i], offsets[i + 1]) in \a k_indices and \a k_sqr_distances. The output arrays are
+          * only resized, so reusing them from one call to the next avoids most allocations.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points in \a cloud are queried
+          * \param[in] radius the radius of the sphere bounding the neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points, for all queries
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points, for all queries
+          * \param[out] offsets the start of the neighbors of each query in \a k_indices (size: number of queries + 1)
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          * \param[in] nr_threads the number of threads used to process the queries
+          */
+        virtual void
+        batchRadiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                           std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                           std::vector<int> &offsets, unsigned int max_nn = 0, unsigned int nr_threads = 1) const;
+
       protected:
         void sortResults (std::vector<int>& indices, std::vector<float>& distances) const;
         PointCloudConstPtr input_;
@@ -519,6 +556,91 @@ namespace pcl
       // sort  the according distances.
       sort (distances.begin (), distances.end ());
     }
+
+    template<typename PointT> void
+    Search<PointT>::batchNearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                                         std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                                         unsigned int nr_threads) const
+    {
+      int nr_queries = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+      k = std::max (k, 0);
+      k_indices.resize (nr_queries * k);
+      k_sqr_distances.resize (nr_queries * k);
+      if (nr_threads == 0)
+        nr_threads = 1;
+
+#pragma omp parallel num_threads (nr_threads)
+      {
+        // Per-thread scratch buffers, reused for all the queries of this thread
+        std::vector<int> nn_indices (k);
+        std::vector<float> nn_dists (k);
+#pragma omp for schedule (dynamic, 64)
+        for (int i = 0; i < nr_queries; ++i)
+        {
+          int index = indices.empty () ? i : indices[i];
+          int nr_found = std::min (nearestKSearch (cloud, index, k, nn_indices, nn_dists), k);
+          nr_found = std::max (std::min (nr_found, static_cast<int> (nn_indices.size ())), 0);
+          std::copy (nn_indices.begin (), nn_indices.begin () + nr_found, k_indices.begin () + i * k);
+          std::copy (nn_dists.begin (), nn_dists.begin () + nr_found, k_sqr_distances.begin () + i * k);
+          std::fill (k_indices.begin () + i * k + nr_found, k_indices.begin () + (i + 1) * k, -1);
+          std::fill (k_sqr_distances.begin () + i * k + nr_found, k_sqr_distances.begin () + (i + 1) * k, 
+                     std::numeric_limits<float>::max ());
+        }
+      }
+    }
+
+    template<typename PointT> void
+    Search<PointT>::batchRadiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                                       std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                                       std::vector<int> &offsets, unsigned int max_nn, unsigned int nr_threads) const
+    {
+      int nr_queries = static_cast<int> (indices.empty () ? cloud.points.size () : indices.size ());
+      if (nr_threads == 0)
+        nr_threads = 1;
+
+      // The queries are split into contiguous chunks, each filling its own buffers. Concatenating the chunk
+      // buffers in chunk order then gives the neighbors in query order, independently of the scheduling.
+      int nr_chunks = std::max (std::min (static_cast<int> (nr_threads) * 4, nr_queries), 1);
+      std::vector<std::vector<int> > chunk_indices (nr_chunks);
+      std::vector<std::vector<float> > chunk_dists (nr_chunks);
+      offsets.resize (nr_queries + 1);
+      offsets[0] = 0;
+
+#pragma omp parallel num_threads (nr_threads)
+      {
+        std::vector<int> nn_indices;
+        std::vector<float> nn_dists;
+#pragma omp for schedule (dynamic, 1)
+        for (int c = 0; c < nr_chunks; ++c)
+        {
+          int begin = static_cast<int> (static_cast<long> (nr_queries) * c / nr_chunks);
+          int end = static_cast<int> (static_cast<long> (nr_queries) * (c + 1) / nr_chunks);
+          for (int i = begin; i < end; ++i)
+          {
+            int index = indices.empty () ? i : indices[i];
+            int nr_found = std::max (radiusSearch (cloud, index, radius, nn_indices, nn_dists, max_nn), 0);
+            nr_found = std::min (nr_found, static_cast<int> (nn_indices.size ()));
+            chunk_indices[c].insert (chunk_indices[c].end (), nn_indices.begin (), nn_indices.begin () + nr_found);
+            chunk_dists[c].insert (chunk_dists[c].end (), nn_dists.begin (), nn_dists.begin () + nr_found);
+            // Number of neighbors for now, turned into offsets below
+            offsets[i + 1] = nr_found;
+          }
+        }
+      }
+
+      for (int i = 0; i < nr_queries; ++i)
+        offsets[i + 1] += offsets[i];
+      k_indices.resize (offsets[nr_queries]);
+      k_sqr_distances.resize (offsets[nr_queries]);
+
+      int begin = 0;
+      for (int c = 0; c < nr_chunks; ++c)
+      {
+        std::copy (chunk_indices[c].begin (), chunk_indices[c].end (), k_indices.begin () + begin);
+        std::copy (chunk_dists[c].begin (), chunk_dists[c].end (), k_sqr_distances.begin () + begin);
+        begin += static_cast<int> (chunk_indices[c].size ());
+      }
+    }
   } // namespace search
 } // namespace pcl
 
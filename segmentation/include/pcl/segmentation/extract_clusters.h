@@ -55,13 +55,17 @@ namespace pcl
     * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
     * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
     * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \param nr_threads the number of threads to use (default: 1). With more than one thread, the neighbors are
+    * searched for in parallel and the clusters are merged with a concurrent union-find; the clusters are the same
+    * as the ones given by the single threaded version, and are returned in the same order.
     * \ingroup segmentation
     */
   template <typename PointT> void 
   extractEuclideanClusters (
       const PointCloud<PointT> &cloud, const boost::shared_ptr<search::Search<PointT> > &tree, 
       float tolerance, std::vector<PointIndices> &clusters, 
-      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) (),
+      unsigned int nr_threads = 1);
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief Decompose a region of space into clusters based on the Euclidean distance between points
@@ -73,13 +77,16 @@ namespace pcl
     * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
     * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
     * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \param nr_threads the number of threads to use (default: 1). As for the version without indices, the
+    * clusters do not depend on the number of threads, and are returned in the same order.
     * \ingroup segmentation
     */
   template <typename PointT> void 
   extractEuclideanClusters (
       const PointCloud<PointT> &cloud, const std::vector<int> &indices, 
       const boost::shared_ptr<search::Search<PointT> > &tree, float tolerance, std::vector<PointIndices> &clusters, 
-      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) (),
+      unsigned int nr_threads = 1);
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief Decompose a region of space into clusters based on the euclidean distance between points, and the normal
@@ -310,7 +317,8 @@ namespace pcl
       EuclideanClusterExtraction () : tree_ (), 
                                       cluster_tolerance_ (0),
                                       min_pts_per_cluster_ (1), 
-                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ())
+                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ()),
+                                      threads_ (1)
       {};
 
       /** \brief Provide a pointer to the search object.
@@ -379,6 +387,22 @@ namespace pcl
         return (max_pts_per_cluster_); 
       }
 
+      /** \brief Set the number of threads used to search for neighbors and merge the clusters.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to 1)
+        */
+      inline void 
+      setNumberOfThreads (unsigned int nr_threads) 
+      { 
+        threads_ = (nr_threads == 0) ? 1 : nr_threads; 
+      }
+
+      /** \brief Get the number of threads used to search for neighbors and merge the clusters. */
+      inline unsigned int 
+      getNumberOfThreads () const 
+      { 
+        return (threads_); 
+      }
+
       /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
         * \param[out] clusters the resultant point clusters
         */
@@ -404,6 +428,9 @@ namespace pcl
       /** \brief The maximum number of points that a cluster needs to contain in order to be considered valid (default = MAXINT). */
       int max_pts_per_cluster_;
 
+      /** \brief The number of threads the scheduler should use (default = 1). */
+      unsigned int threads_;
+
       /** \brief Class getName method. */
       virtual std::string getClassName () const { return ("EuclideanClusterExtraction"); }
 
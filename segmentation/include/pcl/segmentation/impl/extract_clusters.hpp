@@ -40,19 +40,201 @@
 
 #include <pcl/segmentation/extract_clusters.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Atomically replace the value pointed to by \a value with \a desired, if it is equal to \a expected.
+      * \return true if the value was replaced
+      */
+    inline bool
+    compareAndSwap (volatile int *value, int expected, int desired)
+    {
+#if defined __GNUC__
+      return (__sync_bool_compare_and_swap (value, expected, desired));
+#elif defined _MSC_VER
+      return (_InterlockedCompareExchange (reinterpret_cast<volatile long*> (value), desired, expected) == expected);
+#else
+      bool swapped = false;
+#pragma omp critical (pcl_detail_compare_and_swap)
+      {
+        if (*value == expected)
+        {
+          *value = desired;
+          swapped = true;
+        }
+      }
+      return (swapped);
+#endif
+    }
+
+    /** \brief Find the root of the set holding \a element in a union-find forest, halving the path on the way.
+      * Can be called concurrently with other calls to findRoot and unionSets on the same forest.
+      * \param[in,out] parents the parent of each element, with parents[i] <= i
+      * \param[in] element the element to find the root of
+      */
+    inline int
+    findRoot (std::vector<int> &parents, int element)
+    {
+      volatile int *p = &parents[0];
+      int parent = p[element];
+      while (parent != element)
+      {
+        int grand_parent = p[parent];
+        if (grand_parent != parent)
+          compareAndSwap (p + element, parent, grand_parent);
+        element = grand_parent;
+        parent = p[element];
+      }
+      return (element);
+    }
+
+    /** \brief Merge the sets holding \a a and \a b in a union-find forest, without locking.
+      * The larger root is always linked under the smaller one, so the root of a set is its smallest element.
+      * \param[in,out] parents the parent of each element, with parents[i] <= i
+      * \param[in] a an element of the first set
+      * \param[in] b an element of the second set
+      */
+    inline void
+    unionSets (std::vector<int> &parents, int a, int b)
+    {
+      volatile int *p = &parents[0];
+      while (true)
+      {
+        a = findRoot (parents, a);
+        b = findRoot (parents, b);
+        if (a == b)
+          return;
+        if (a < b)
+          std::swap (a, b);
+        // Fails if another thread linked a in the meantime, in which case we start over from the new roots
+        if (compareAndSwap (p + a, a, b))
+          return;
+      }
+    }
+
+    /** \brief Decompose a region of space into clusters based on the Euclidean distance between points, searching
+      * for the neighbors of all the points in parallel and merging them with a lock-free union-find.
+      * \param[in] cloud the point cloud message
+      * \param[in] indices a list of point indices to use from \a cloud, or NULL to use all the points
+      * \param[in] tree the spatial locator, created on \a cloud (and \a indices)
+      * \param[in] tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+      * \param[out] clusters the resultant clusters, appended in the order of their first point
+      * \param[in] min_pts_per_cluster minimum number of points that a cluster may contain
+      * \param[in] max_pts_per_cluster maximum number of points that a cluster may contain
+      * \param[in] nr_threads the number of threads to use
+      */
+    template <typename PointT> void
+    extractEuclideanClustersParallel (const PointCloud<PointT> &cloud, const std::vector<int> *indices,
+                                      const boost::shared_ptr<search::Search<PointT> > &tree,
+                                      float tolerance, std::vector<PointIndices> &clusters,
+                                      unsigned int min_pts_per_cluster, unsigned int max_pts_per_cluster,
+                                      unsigned int nr_threads)
+    {
+      const int nr_points = static_cast<int> (indices ? indices->size () : cloud.points.size ());
+
+      // The search returns indices in cloud, which have to be mapped back to positions in indices
+      std::vector<int> positions;
+      if (indices)
+      {
+        positions.assign (cloud.points.size (), -1);
+        for (int i = 0; i < nr_points; ++i)
+          positions[(*indices)[i]] = i;
+      }
+
+      std::vector<int> parents (nr_points);
+      for (int i = 0; i < nr_points; ++i)
+        parents[i] = i;
+
+      // Search for the neighbors of a block of points at a time, to bound the memory used by the results
+      const int block_size = 16384;
+      std::vector<int> queries, nn_indices, nn_offsets;
+      std::vector<float> nn_distances;
+      for (int begin = 0; begin < nr_points; begin += block_size)
+      {
+        int end = std::min (begin + block_size, nr_points);
+        queries.resize (end - begin);
+        for (int i = begin; i < end; ++i)
+          queries[i - begin] = indices ? (*indices)[i] : i;
+        tree->batchRadiusSearch (cloud, queries, tolerance, nn_indices, nn_distances, nn_offsets, 0, nr_threads);
+
+#pragma omp parallel for schedule (dynamic, 256) num_threads (nr_threads)
+        for (int i = begin; i < end; ++i)
+        {
+          for (int j = nn_offsets[i - begin]; j < nn_offsets[i - begin + 1]; ++j)
+          {
+            int neighbor = nn_indices[j];
+            if (indices && neighbor != -1)
+              neighbor = positions[neighbor];
+            if (neighbor == -1 || neighbor == i)
+              continue;
+            unionSets (parents, i, neighbor);
+          }
+        }
+      }
+
+      // Parents are smaller than their children, so a single pass in increasing order points every element
+      // directly to its root
+      std::vector<unsigned int> sizes (nr_points, 0);
+      for (int i = 0; i < nr_points; ++i)
+      {
+        parents[i] = parents[parents[i]];
+        ++sizes[parents[i]];
+      }
+
+      // The root of each cluster is its first point, which is also the seed the region growing starts from:
+      // going through the roots in increasing order gives the clusters in the same order as the serial version
+      std::vector<int> cluster_ids (nr_points, -1);
+      size_t first_cluster = clusters.size ();
+      for (int i = 0; i < nr_points; ++i)
+      {
+        if (parents[i] != i || sizes[i] < min_pts_per_cluster || sizes[i] > max_pts_per_cluster)
+          continue;
+        cluster_ids[i] = static_cast<int> (clusters.size ());
+        clusters.push_back (PointIndices ());
+        clusters.back ().indices.reserve (sizes[i]);
+        clusters.back ().header = cloud.header;
+      }
+      for (int i = 0; i < nr_points; ++i)
+      {
+        int id = cluster_ids[parents[i]];
+        if (id != -1)
+          clusters[id].indices.push_back (indices ? (*indices)[i] : i);
+      }
+      for (size_t c = first_cluster; c < clusters.size (); ++c)
+      {
+        std::vector<int> &r = clusters[c].indices;
+        std::sort (r.begin (), r.end ());
+        r.erase (std::unique (r.begin (), r.end ()), r.end ());
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud, 
                                const boost::shared_ptr<search::Search<PointT> > &tree,
                                float tolerance, std::vector<PointIndices> &clusters,
                                unsigned int min_pts_per_cluster, 
-                               unsigned int max_pts_per_cluster)
+                               unsigned int max_pts_per_cluster,
+                               unsigned int nr_threads)
 {
   if (tree->getInputCloud ()->points.size () != cloud.points.size ())
   {
     PCL_ERROR ("[pcl::extractEuclideanClusters] Tree built for a different point cloud dataset (%zu) than the input cloud (%zu)!\n", tree->getInputCloud ()->points.size (), cloud.points.size ());
     return;
   }
+  if (nr_threads > 1)
+  {
+    detail::extractEuclideanClustersParallel<PointT> (cloud, NULL, tree, tolerance, clusters,
+                                                      min_pts_per_cluster, max_pts_per_cluster, nr_threads);
+    return;
+  }
   // Create a bool vector of processed point indices, and initialize it to false
   std::vector<bool> processed (cloud.points.size (), false);
 
@@ -79,7 +261,9 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
         continue;
       }
 
-      for (size_t j = 1; j < nn_indices.size (); ++j)             // nn_indices[0] should be sq_idx
+      // The results are not necessarily sorted, so nn_indices[0] is not always sq_idx: the processed check
+      // skips it instead
+      for (size_t j = 0; j < nn_indices.size (); ++j)
       {
         if (nn_indices[j] == -1 || processed[nn_indices[j]])        // Has this point been processed before ?
           continue;
@@ -117,7 +301,8 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
                                const boost::shared_ptr<search::Search<PointT> > &tree,
                                float tolerance, std::vector<PointIndices> &clusters,
                                unsigned int min_pts_per_cluster, 
-                               unsigned int max_pts_per_cluster)
+                               unsigned int max_pts_per_cluster,
+                               unsigned int nr_threads)
 {
   // \note If the tree was created over <cloud, indices>, we guarantee a 1-1 mapping between what the tree returns
   //and indices[i]
@@ -131,6 +316,17 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
     PCL_ERROR ("[pcl::extractEuclideanClusters] Tree built for a different set of indices (%zu) than the input set (%zu)!\n", tree->getIndices ()->size (), indices.size ());
     return;
   }
+  if (nr_threads > 1)
+  {
+    detail::extractEuclideanClustersParallel<PointT> (cloud, &indices, tree, tolerance, clusters,
+                                                      min_pts_per_cluster, max_pts_per_cluster, nr_threads);
+    return;
+  }
+
+  // The search returns indices in cloud, which have to be mapped back to positions in indices
+  std::vector<int> positions (cloud.points.size (), -1);
+  for (int i = 0; i < static_cast<int> (indices.size ()); ++i)
+    positions[indices[i]] = i;
 
   // Create a bool vector of processed point indices, and initialize it to false
   std::vector<bool> processed (indices.size (), false);
@@ -164,14 +360,17 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
         continue;
       }
 
-      for (size_t j = 1; j < nn_indices.size (); ++j)             // nn_indices[0] should be sq_idx
+      // The results are not necessarily sorted, so nn_indices[0] is not always sq_idx: the processed check
+      // skips it instead
+      for (size_t j = 0; j < nn_indices.size (); ++j)
       {
-        if (nn_indices[j] == -1 || processed[nn_indices[j]])        // Has this point been processed before ?
+        int neighbor = (nn_indices[j] == -1) ? -1 : positions[nn_indices[j]];
+        if (neighbor == -1 || processed[neighbor])        // Has this point been processed before ?
           continue;
 
         // Perform a simple Euclidean clustering
-        seed_queue.push_back (nn_indices[j]);
-        processed[nn_indices[j]] = true;
+        seed_queue.push_back (neighbor);
+        processed[neighbor] = true;
       }
 
       sq_idx++;
@@ -183,7 +382,7 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
       pcl::PointIndices r;
       r.indices.resize (seed_queue.size ());
       for (size_t j = 0; j < seed_queue.size (); ++j)
-        // This is the only place where indices come into play
+        // The seed queue holds positions in indices
         r.indices[j] = indices[seed_queue[j]];
 
       //r.indices.assign(seed_queue.begin(), seed_queue.end());
@@ -222,7 +421,7 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_, indices_);
-  extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+  extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
 
   //tree_->setInputCloud (input_);
   //extractEuclideanClusters (*input_, tree_, cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
@@ -234,7 +433,7 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 }
 
 #define PCL_INSTANTIATE_EuclideanClusterExtraction(T) template class PCL_EXPORTS pcl::EuclideanClusterExtraction<T>;
-#define PCL_INSTANTIATE_extractEuclideanClusters(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
-#define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClusters(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const std::vector<int> &, const boost::shared_ptr<pcl::search::Search<T> > &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
 
 #endif        // PCL_EXTRACT_CLUSTERS_IMPL_H_
@@ -41,6 +41,7 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/principal_curvatures.h>
+#include <pcl/features/principal_curvatures_omp.h>
 #include <pcl/io/pcd_io.h>
 
 using namespace pcl;
@@ -143,6 +144,51 @@ TEST (PCL, PrincipalCurvaturesEstimation)
   EXPECT_NEAR (pcs->points[indices.size () - 1].pc2, 0.17906941473484039, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PrincipalCurvaturesEstimationOpenMP)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  // set parameters
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10); // Use 10 nearest neighbors to estimate the normals
+  // estimate
+  n.compute (*normals);
+
+  PrincipalCurvaturesEstimation<PointXYZ, Normal, PrincipalCurvatures> pc;
+  pc.setInputNormals (normals);
+  pc.setInputCloud (cloud.makeShared ());
+  pc.setIndices (indicesptr);
+  pc.setSearchMethod (tree);
+  pc.setKSearch (20);
+  PointCloud<PrincipalCurvatures> pcs;
+  pc.compute (pcs);
+
+  PrincipalCurvaturesEstimationOMP<PointXYZ, Normal, PrincipalCurvatures> pc_omp (4); // instantiate 4 threads
+  pc_omp.setInputNormals (normals);
+  pc_omp.setInputCloud (cloud.makeShared ());
+  pc_omp.setIndices (indicesptr);
+  pc_omp.setSearchMethod (tree);
+  pc_omp.setKSearch (20);
+  PointCloud<PrincipalCurvatures> pcs_omp;
+  pc_omp.compute (pcs_omp);
+
+  // The parallel implementation must give exactly the same results
+  ASSERT_EQ (pcs_omp.points.size (), pcs.points.size ());
+  EXPECT_EQ (pcs_omp.is_dense, pcs.is_dense);
+  for (size_t i = 0; i < pcs.points.size (); ++i)
+  {
+    for (int d = 0; d < 3; ++d)
+      EXPECT_EQ (pcs_omp.points[i].principal_curvature[d], pcs.points[i].principal_curvature[d]);
+    EXPECT_EQ (pcs_omp.points[i].pc1, pcs.points[i].pc1);
+    EXPECT_EQ (pcs_omp.points[i].pc2, pcs.points[i].pc2);
+  }
+}
+
 #ifndef PCL_ONLY_CORE_POINT_TYPES
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   TEST (PCL, PrincipalCurvaturesEstimationEigen)
@@ -41,8 +41,14 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/cvfh.h>
+#include <pcl/features/vfh.h>
+#include <pcl/features/esf.h>
+#include <pcl/features/crh.h>
+#include <pcl/features/segment_features.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/filters/voxel_grid.h>
+#include <pcl/common/common.h>
+#include <boost/make_shared.hpp>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -119,6 +125,112 @@ TEST (PCL, CVFHEstimationMilk)
   EXPECT_EQ (static_cast<int>(vfhs->points.size ()), 2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SegmentFeatures)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  // Cut the cloud into slices along x
+  vector<PointIndices> segments (5);
+  Eigen::Vector4f min_pt, max_pt;
+  getMinMax3D (cloud, min_pt, max_pt);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    int segment = static_cast<int> ((cloud.points[i].x - min_pt[0]) / (max_pt[0] - min_pt[0]) * 4.0f);
+    segments[std::min (segment, 3)].indices.push_back (static_cast<int> (i));
+  }
+  // A segment may also hold the whole cloud
+  segments[4].indices = indices;
+
+  // VFH: the signature of each segment is the one of the segment alone
+  VFHEstimation<PointXYZ, Normal, VFHSignature308> vfh;
+  vfh.setInputCloud (cloud.makeShared ());
+  vfh.setInputNormals (normals);
+  PointCloud<VFHSignature308> vfhs;
+  computeSegmentFeatures (vfh, segments, vfhs, 4);
+  ASSERT_EQ (vfhs.points.size (), segments.size ());
+  for (size_t s = 0; s < segments.size (); ++s)
+  {
+    PointCloud<VFHSignature308> vfh_segment;
+    vfh.setIndices (boost::make_shared<vector<int> > (segments[s].indices));
+    vfh.compute (vfh_segment);
+    ASSERT_EQ (vfh_segment.points.size (), 1);
+    for (int d = 0; d < 308; ++d)
+      EXPECT_NEAR (vfhs.points[s].histogram[d], vfh_segment.points[0].histogram[d], 1e-4);
+  }
+
+  // CVFH may give several signatures per segment
+  CVFHEstimation<PointXYZ, Normal, VFHSignature308> cvfh;
+  cvfh.setInputCloud (cloud.makeShared ());
+  cvfh.setInputNormals (normals);
+  cvfh.setSearchMethod (tree);
+  vector<PointCloud<VFHSignature308> > cvfhs;
+  computeSegmentFeatures (cvfh, segments, cvfhs, 4);
+  ASSERT_EQ (cvfhs.size (), segments.size ());
+  for (size_t s = 0; s < segments.size (); ++s)
+  {
+    PointCloud<VFHSignature308> cvfh_segment;
+    cvfh.setIndices (boost::make_shared<vector<int> > (segments[s].indices));
+    cvfh.compute (cvfh_segment);
+    ASSERT_EQ (cvfhs[s].points.size (), cvfh_segment.points.size ());
+    for (size_t i = 0; i < cvfh_segment.points.size (); ++i)
+      for (int d = 0; d < 308; ++d)
+        EXPECT_NEAR (cvfhs[s].points[i].histogram[d], cvfh_segment.points[i].histogram[d], 1e-4);
+  }
+
+  // ESF only depends on its seed, not on the number of threads
+  ESFEstimation<PointXYZ, ESFSignature640> esf;
+  esf.setInputCloud (cloud.makeShared ());
+  esf.setSeed (42);
+  PointCloud<ESFSignature640> esfs;
+  computeSegmentFeatures (esf, segments, esfs, 4);
+  ASSERT_EQ (esfs.points.size (), segments.size ());
+  for (size_t s = 0; s < segments.size (); ++s)
+  {
+    PointCloud<ESFSignature640> esf_segment;
+    esf.setIndices (boost::make_shared<vector<int> > (segments[s].indices));
+    esf.setNumberOfThreads (3);
+    esf.compute (esf_segment);
+    ASSERT_EQ (esf_segment.points.size (), 1);
+    float sum = 0.0f;
+    for (int d = 0; d < 640; ++d)
+    {
+      EXPECT_EQ (esfs.points[s].histogram[d], esf_segment.points[0].histogram[d]);
+      sum += esf_segment.points[0].histogram[d];
+    }
+    EXPECT_NEAR (sum, 1.0f, 1e-3);
+  }
+
+  // CRH uses the centroid of each segment when none is given
+  CRHEstimation<PointXYZ, Normal, Histogram<90> > crh;
+  crh.setInputCloud (cloud.makeShared ());
+  crh.setInputNormals (normals);
+  PointCloud<Histogram<90> > crhs;
+  computeSegmentFeatures (crh, segments, crhs, 4);
+  ASSERT_EQ (crhs.points.size (), segments.size ());
+  for (size_t s = 0; s < segments.size (); ++s)
+  {
+    Eigen::Vector4f centroid;
+    compute3DCentroid (cloud, segments[s].indices, centroid);
+    CRHEstimation<PointXYZ, Normal, Histogram<90> > crh_segment;
+    crh_segment.setInputCloud (cloud.makeShared ());
+    crh_segment.setInputNormals (normals);
+    crh_segment.setIndices (boost::make_shared<vector<int> > (segments[s].indices));
+    crh_segment.setCentroid (centroid);
+    PointCloud<Histogram<90> > crh_output;
+    crh_segment.compute (crh_output);
+    ASSERT_EQ (crh_output.points.size (), 1);
+    for (int d = 0; d < 90; ++d)
+      EXPECT_NEAR (crhs.points[s].histogram[d], crh_output.points[0].histogram[d], 1e-4);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
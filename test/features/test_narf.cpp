@@ -0,0 +1,210 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/range_image/range_image.h>
+#include <pcl/features/range_image_border_extractor.h>
+#include <pcl/features/narf_descriptor.h>
+#include <pcl/keypoints/narf_keypoint.h>
+
+using namespace pcl;
+using namespace std;
+
+// Created in main (), a global RangeImage would depend on the initialization order of the static lookup tables
+RangeImage::Ptr range_image_ptr;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, RangeImageBorderExtractorMultiThreaded)
+{
+  const RangeImage& range_image = *range_image_ptr;
+  RangeImageBorderExtractor border_extractor (&range_image);
+  RangeImageBorderExtractor border_extractor_mt (&range_image);
+  border_extractor_mt.getParameters ().max_no_of_threads = 4;
+
+  const PointCloud<BorderDescription>& border_descriptions = border_extractor.getBorderDescriptions ();
+  const PointCloud<BorderDescription>& border_descriptions_mt = border_extractor_mt.getBorderDescriptions ();
+  ASSERT_EQ (border_descriptions.points.size (), range_image.points.size ());
+  ASSERT_EQ (border_descriptions_mt.points.size (), border_descriptions.points.size ());
+
+  int no_of_obstacle_borders = 0;
+  for (size_t i = 0; i < border_descriptions.points.size (); ++i)
+  {
+    EXPECT_EQ (border_descriptions_mt.points[i].x, border_descriptions.points[i].x);
+    EXPECT_EQ (border_descriptions_mt.points[i].y, border_descriptions.points[i].y);
+    EXPECT_EQ (border_descriptions_mt.points[i].traits, border_descriptions.points[i].traits);
+    if (border_descriptions.points[i].traits[BORDER_TRAIT__OBSTACLE_BORDER])
+      ++no_of_obstacle_borders;
+  }
+  // The boxes in front of the wall have to produce borders, otherwise the comparison above is meaningless
+  EXPECT_GT (no_of_obstacle_borders, 0);
+
+  Eigen::Vector3f** border_directions = border_extractor.getBorderDirections ();
+  Eigen::Vector3f** border_directions_mt = border_extractor_mt.getBorderDirections ();
+  float* surface_change_scores = border_extractor.getSurfaceChangeScores ();
+  float* surface_change_scores_mt = border_extractor_mt.getSurfaceChangeScores ();
+  for (size_t i = 0; i < range_image.points.size (); ++i)
+  {
+    ASSERT_EQ (border_directions_mt[i] == NULL, border_directions[i] == NULL);
+    if (border_directions[i] != NULL)
+    {
+      EXPECT_EQ ((*border_directions_mt[i])[0], (*border_directions[i])[0]);
+      EXPECT_EQ ((*border_directions_mt[i])[1], (*border_directions[i])[1]);
+      EXPECT_EQ ((*border_directions_mt[i])[2], (*border_directions[i])[2]);
+    }
+    EXPECT_EQ (surface_change_scores_mt[i], surface_change_scores[i]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NarfDescriptorMultiThreaded)
+{
+  const RangeImage& range_image = *range_image_ptr;
+  vector<int> indices;
+  for (int i = 0; i < static_cast<int> (range_image.points.size ()); i += 7)
+    indices.push_back (i);
+
+  NarfDescriptor narf_descriptor (&range_image, &indices);
+  narf_descriptor.getParameters ().support_size = 1.0f;
+  PointCloud<Narf36> narfs;
+  narf_descriptor.compute (narfs);
+  EXPECT_GT (narfs.points.size (), 0u);
+
+  NarfDescriptor narf_descriptor_mt (&range_image, &indices);
+  narf_descriptor_mt.getParameters ().support_size = 1.0f;
+  narf_descriptor_mt.getParameters ().max_no_of_threads = 4;
+  PointCloud<Narf36> narfs_mt;
+  narf_descriptor_mt.compute (narfs_mt);
+
+  // The features have to come out in the same order as in the single threaded case
+  ASSERT_EQ (narfs_mt.points.size (), narfs.points.size ());
+  for (size_t i = 0; i < narfs.points.size (); ++i)
+  {
+    EXPECT_EQ (narfs_mt.points[i].x, narfs.points[i].x);
+    EXPECT_EQ (narfs_mt.points[i].y, narfs.points[i].y);
+    EXPECT_EQ (narfs_mt.points[i].z, narfs.points[i].z);
+    EXPECT_EQ (narfs_mt.points[i].roll, narfs.points[i].roll);
+    EXPECT_EQ (narfs_mt.points[i].pitch, narfs.points[i].pitch);
+    EXPECT_EQ (narfs_mt.points[i].yaw, narfs.points[i].yaw);
+    for (int j = 0; j < 36; ++j)
+      EXPECT_EQ (narfs_mt.points[i].descriptor[j], narfs.points[i].descriptor[j]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NarfKeypointMultiThreaded)
+{
+  const RangeImage& range_image = *range_image_ptr;
+  RangeImageBorderExtractor border_extractor (&range_image);
+  NarfKeypoint narf_keypoint (&border_extractor, 0.4f);
+  // The sparse interest image skips points depending on the order they are processed in
+  narf_keypoint.getParameters ().calculate_sparse_interest_image = false;
+  narf_keypoint.getParameters ().min_interest_value = 0.3f;
+  PointCloud<int> keypoints;
+  narf_keypoint.compute (keypoints);
+  EXPECT_GT (keypoints.points.size (), 0u);
+
+  RangeImageBorderExtractor border_extractor_mt (&range_image);
+  NarfKeypoint narf_keypoint_mt (&border_extractor_mt, 0.4f);
+  narf_keypoint_mt.getParameters ().calculate_sparse_interest_image = false;
+  narf_keypoint_mt.getParameters ().min_interest_value = 0.3f;
+  narf_keypoint_mt.getParameters ().max_no_of_threads = 4;
+  PointCloud<int> keypoints_mt;
+  narf_keypoint_mt.compute (keypoints_mt);
+
+  const float* interest_image = narf_keypoint.getInterestImage ();
+  const float* interest_image_mt = narf_keypoint_mt.getInterestImage ();
+  for (size_t i = 0; i < range_image.points.size (); ++i)
+    EXPECT_EQ (interest_image_mt[i], interest_image[i]);
+
+  ASSERT_EQ (keypoints_mt.points.size (), keypoints.points.size ());
+  for (size_t i = 0; i < keypoints.points.size (); ++i)
+    EXPECT_EQ (keypoints_mt.points[i], keypoints.points[i]);
+
+  const PointCloud<InterestPoint>& interest_points = narf_keypoint.getInterestPoints ();
+  const PointCloud<InterestPoint>& interest_points_mt = narf_keypoint_mt.getInterestPoints ();
+  ASSERT_EQ (interest_points_mt.points.size (), interest_points.points.size ());
+  for (size_t i = 0; i < interest_points.points.size (); ++i)
+  {
+    EXPECT_EQ (interest_points_mt.points[i].x, interest_points.points[i].x);
+    EXPECT_EQ (interest_points_mt.points[i].y, interest_points.points[i].y);
+    EXPECT_EQ (interest_points_mt.points[i].z, interest_points.points[i].z);
+    EXPECT_EQ (interest_points_mt.points[i].strength, interest_points.points[i].strength);
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  // Simulate a 360 degree laser scan of a cylindrical room with a few boxes standing in it
+  PointCloud<PointXYZ> scene;
+  for (float angle = 0.0f; angle < 360.0f; angle += 0.25f)
+  {
+    float angle_rad = deg2rad (angle);
+    for (float z = -2.0f; z <= 2.0f; z += 0.02f)
+      scene.points.push_back (PointXYZ (10.0f * cosf (angle_rad), 10.0f * sinf (angle_rad), z));
+  }
+  for (int box_idx = 0; box_idx < 6; ++box_idx)
+  {
+    float box_angle = deg2rad (60.0f * static_cast<float> (box_idx) + 10.0f);
+    Eigen::Vector3f box_center (4.0f * cosf (box_angle), 4.0f * sinf (box_angle), -1.0f);
+    // Only the side facing the sensor is visible
+    Eigen::Vector3f normal = -box_center.normalized (), tangent (-normal[1], normal[0], 0.0f);
+    for (float u = -0.5f; u <= 0.5f; u += 0.01f)
+      for (float v = -0.5f; v <= 1.0f; v += 0.01f)
+      {
+        Eigen::Vector3f point = box_center + 0.5f * normal + u * tangent + Eigen::Vector3f (0.0f, 0.0f, v);
+        scene.points.push_back (PointXYZ (point[0], point[1], point[2]));
+      }
+  }
+  scene.width = static_cast<uint32_t> (scene.points.size ());
+  scene.height = 1;
+
+  range_image_ptr.reset (new RangeImage);
+  RangeImage& range_image = *range_image_ptr;
+  range_image.createFromPointCloud (scene, deg2rad (0.5f), deg2rad (360.0f), deg2rad (180.0f),
+                                    Eigen::Affine3f::Identity (), RangeImage::LASER_FRAME, 0.0f, 0.0f, 1);
+  range_image.setUnseenToMaxRange ();
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -41,6 +41,7 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/normal_3d_omp.h>
+#include <pcl/search/neighborhood_cache.h>
 #include <pcl/io/pcd_io.h>
 
 using namespace pcl;
@@ -144,6 +145,101 @@ TEST (PCL, NormalEstimation)
   EXPECT_EQ (normals->points.size (), indices.size ());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ComputePointNormals)
+{
+  // Gather the 10 nearest neighbors of every point, plus an empty neighborhood and one made of a NaN point
+  PointCloud<PointXYZ> surface = cloud;
+  PointXYZ nan_point;
+  nan_point.x = nan_point.y = nan_point.z = std::numeric_limits<float>::quiet_NaN ();
+  surface.points.push_back (nan_point);
+  surface.width = static_cast<uint32_t> (surface.points.size ());
+  surface.is_dense = false;
+
+  search::KdTree<PointXYZ> kdtree;
+  kdtree.setInputCloud (cloud.makeShared ());
+  vector<int> nn_indices, nn_offsets (1, 0), k_indices;
+  vector<float> k_sqr_distances;
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    kdtree.nearestKSearch (cloud.points[i], 10, k_indices, k_sqr_distances);
+    nn_indices.insert (nn_indices.end (), k_indices.begin (), k_indices.end ());
+    // Mix some invalid points in the neighborhoods
+    if (i % 3 == 0)
+      nn_indices.push_back (static_cast<int> (cloud.points.size ()));
+    nn_offsets.push_back (static_cast<int> (nn_indices.size ()));
+  }
+  nn_offsets.push_back (static_cast<int> (nn_indices.size ()));
+  nn_indices.push_back (static_cast<int> (cloud.points.size ()));
+  nn_offsets.push_back (static_cast<int> (nn_indices.size ()));
+
+  vector<float> normals_curvatures;
+  computePointNormals (surface, nn_indices, nn_offsets, normals_curvatures);
+  ASSERT_EQ (normals_curvatures.size (), 4 * (cloud.points.size () + 2));
+
+  Eigen::Vector4f plane_parameters;
+  float curvature;
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    vector<int> neighborhood (nn_indices.begin () + nn_offsets[i], nn_indices.begin () + nn_offsets[i + 1]);
+    computePointNormal (surface, neighborhood, plane_parameters, curvature);
+    Eigen::Vector3f normal (normals_curvatures[4 * i], normals_curvatures[4 * i + 1], normals_curvatures[4 * i + 2]);
+    EXPECT_NEAR (fabs (normal.dot (plane_parameters.head<3> ())), 1.0, 1e-4);
+    EXPECT_NEAR (normals_curvatures[4 * i + 3], curvature, 1e-4);
+  }
+  for (size_t i = cloud.points.size (); i < cloud.points.size () + 2; ++i)
+    for (int d = 0; d < 4; ++d)
+      EXPECT_TRUE (pcl_isnan (normals_curvatures[4 * i + d]));
+
+  // The multi-threaded computation gives the same results
+  vector<float> normals_curvatures_mt;
+  computePointNormals (surface, nn_indices, nn_offsets, normals_curvatures_mt, 4);
+  ASSERT_EQ (normals_curvatures_mt.size (), normals_curvatures.size ());
+  for (size_t i = 0; i < cloud.points.size () * 4; ++i)
+    EXPECT_EQ (normals_curvatures_mt[i], normals_curvatures[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalEstimationNeighborhoodCache)
+{
+  PointCloud<PointXYZ>::Ptr cloudptr = cloud.makeShared ();
+  KdTreePtr kdtree (new search::KdTree<PointXYZ> (false));
+  const double radius = 0.02;
+
+  PointCloud<Normal> normals, cached_normals, cached_normals_omp;
+  NormalEstimation<PointXYZ, Normal> n;
+  n.setInputCloud (cloudptr);
+  n.setSearchMethod (kdtree);
+  n.setRadiusSearch (radius);
+  n.compute (normals);
+
+  // Both estimators take their neighborhoods from the same cache
+  search::NeighborhoodCache<PointXYZ>::Ptr cache (new search::NeighborhoodCache<PointXYZ> (kdtree));
+  cache->setInputCloud (cloudptr);
+  cache->computeRadiusNeighborhoods (cloudptr, radius);
+  n.setSearchMethod (cache);
+  n.compute (cached_normals);
+
+  NormalEstimationOMP<PointXYZ, Normal> n_omp (2);
+  n_omp.setInputCloud (cloudptr);
+  n_omp.setSearchMethod (cache);
+  n_omp.setRadiusSearch (radius);
+  n_omp.compute (cached_normals_omp);
+
+  ASSERT_EQ (cached_normals.points.size (), normals.points.size ());
+  ASSERT_EQ (cached_normals_omp.points.size (), normals.points.size ());
+  for (size_t i = 0; i < normals.points.size (); ++i)
+  {
+    for (int d = 0; d < 3; ++d)
+    {
+      EXPECT_EQ (cached_normals.points[i].normal[d], normals.points[i].normal[d]);
+      EXPECT_EQ (cached_normals_omp.points[i].normal[d], normals.points[i].normal[d]);
+    }
+    EXPECT_EQ (cached_normals.points[i].curvature, normals.points[i].curvature);
+    EXPECT_EQ (cached_normals_omp.points[i].curvature, normals.points[i].curvature);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, NormalEstimationOpenMP)
 {
@@ -176,6 +272,63 @@ TEST (PCL, NormalEstimationOpenMP)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalEstimationOpenMPOrganized)
+{
+  // 640x480 frame of the plane z = 1.5 + 0.5 x seen by a Kinect like camera, with a hole in the middle
+  PointCloud<PointXYZ>::Ptr frame (new PointCloud<PointXYZ> (640, 480));
+  frame->is_dense = false;
+  const float focal_length = 525.0f;
+  for (unsigned v = 0; v < frame->height; ++v)
+  {
+    for (unsigned u = 0; u < frame->width; ++u)
+    {
+      float ray_x = (static_cast<float> (u) - 319.5f) / focal_length;
+      float ray_y = (static_cast<float> (v) - 239.5f) / focal_length;
+      float z = 1.5f / (1.0f - 0.5f * ray_x);
+      if (u > 300 && u < 340 && v > 220 && v < 260)
+        (*frame) (u, v).x = (*frame) (u, v).y = (*frame) (u, v).z = std::numeric_limits<float>::quiet_NaN ();
+      else
+        (*frame) (u, v) = PointXYZ (ray_x * z, ray_y * z, z);
+    }
+  }
+  const Eigen::Vector3f plane_normal = Eigen::Vector3f (0.5f, 0.0f, -1.0f).normalized ();
+
+  // Both use an OrganizedNeighbor search, created for the organized input
+  NormalEstimation<PointXYZ, Normal> n;
+  n.setInputCloud (frame);
+  n.setRadiusSearch (0.01);
+  NormalEstimationOMP<PointXYZ, Normal> n_omp (4);
+  n_omp.setInputCloud (frame);
+  n_omp.setRadiusSearch (0.01);
+
+  PointCloud<Normal> normals, normals_omp;
+  n.compute (normals);
+  n_omp.compute (normals_omp);
+
+  ASSERT_EQ (normals.points.size (), normals_omp.points.size ());
+  EXPECT_EQ (normals.is_dense, normals_omp.is_dense);
+  for (size_t i = 0; i < normals.points.size (); ++i)
+  {
+    EXPECT_EQ (pcl_isfinite (normals.points[i].normal[0]), pcl_isfinite (normals_omp.points[i].normal[0]));
+    if (!pcl_isfinite (normals_omp.points[i].normal[0]))
+      continue;
+    EXPECT_NEAR (fabs (normals_omp.points[i].getNormalVector3fMap ().dot (plane_normal)), 1.0, 1e-4);
+  }
+
+  // The same with the k-nearest neighbor search
+  n_omp.setRadiusSearch (0);
+  n_omp.setKSearch (9);
+  n_omp.compute (normals_omp);
+  ASSERT_EQ (normals.points.size (), normals_omp.points.size ());
+  for (size_t i = 0; i < normals_omp.points.size (); ++i)
+  {
+    if (!pcl_isfinite (normals_omp.points[i].normal[0]))
+      continue;
+    EXPECT_NEAR (fabs (normals_omp.points[i].getNormalVector3fMap ().dot (plane_normal)), 1.0, 1e-4);
+  }
+}
+
 #ifndef PCL_ONLY_CORE_POINT_TYPES
   /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   TEST (PCL, NormalEstimationEigen)
@@ -41,10 +41,12 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/pfh.h>
+#include <pcl/features/pfh_omp.h>
 #include <pcl/features/fpfh.h>
 #include <pcl/features/fpfh_omp.h>
 #include <pcl/features/vfh.h>
 #include <pcl/features/gfpfh.h>
+#include <pcl/features/multiscale_feature_persistence.h>
 #include <pcl/io/pcd_io.h>
 
 using namespace pcl;
@@ -262,6 +264,136 @@ TEST (PCL, PFHEstimation)
   (cloud.makeShared (), normals, test_indices, 125);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PFHEstimationOpenMP)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  // set parameters
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10); // Use 10 nearest neighbors to estimate the normals
+  // estimate
+  n.compute (*normals);
+
+  PFHEstimation<PointXYZ, Normal, PFHSignature125> pfh;
+  pfh.setInputNormals (normals);
+  pfh.setInputCloud (cloud.makeShared ());
+  pfh.setIndices (indicesptr);
+  pfh.setSearchMethod (tree);
+  pfh.setKSearch (30);
+  PointCloud<PFHSignature125> pfhs;
+  pfh.compute (pfhs);
+
+  PFHEstimationOMP<PointXYZ, Normal, PFHSignature125> pfh_omp (4); // instantiate 4 threads
+  EXPECT_EQ (pfh_omp.getNumberOfThreads (), 4);
+  pfh_omp.setInputNormals (normals);
+  pfh_omp.setInputCloud (cloud.makeShared ());
+  pfh_omp.setIndices (indicesptr);
+  pfh_omp.setSearchMethod (tree);
+  pfh_omp.setKSearch (30);
+  PointCloud<PFHSignature125> pfhs_omp;
+  pfh_omp.compute (pfhs_omp);
+
+  // The parallel implementation must give exactly the same results
+  ASSERT_EQ (pfhs_omp.points.size (), pfhs.points.size ());
+  for (size_t i = 0; i < pfhs.points.size (); ++i)
+    for (int d = 0; d < 125; ++d)
+      EXPECT_EQ (pfhs_omp.points[i].histogram[d], pfhs.points[i].histogram[d]);
+
+  // Test results when setIndices and/or setSearchSurface are used
+  boost::shared_ptr<vector<int> > test_indices (new vector<int> (0));
+  for (size_t i = 0; i < cloud.size (); i+=3)
+    test_indices->push_back (static_cast<int> (i));
+
+  testIndicesAndSearchSurface<PFHEstimationOMP<PointXYZ, Normal, PFHSignature125>, PointXYZ, Normal, PFHSignature125>
+  (cloud.makeShared (), normals, test_indices, 125);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PairFeatureCache)
+{
+  PairFeatureCache<4> cache (1024 * PairFeatureCache<4>::getEntrySize (), 4);
+  EXPECT_EQ (cache.getCapacity (), 1024);
+  EXPECT_EQ (cache.getMemoryUsage (), 0);
+
+  float features[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+  float result[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  EXPECT_FALSE (cache.find (3, 7, result));
+  cache.insert (3, 7, features);
+  EXPECT_TRUE (cache.find (3, 7, result));
+  for (int d = 0; d < 4; ++d)
+    EXPECT_EQ (result[d], features[d]);
+  // Pairs are ordered
+  EXPECT_FALSE (cache.find (7, 3, result));
+  EXPECT_EQ (cache.size (), 1);
+  EXPECT_EQ (cache.getHits (), 1);
+  EXPECT_EQ (cache.getMisses (), 2);
+
+  // Filling the cache past its capacity replaces entries instead of going over the memory budget
+  for (int p = 0; p < 100; ++p)
+    for (int q = 0; q < 100; ++q)
+      cache.insert (p, q, features);
+  EXPECT_LE (cache.size (), cache.getCapacity ());
+  EXPECT_LE (cache.getMemoryUsage (), cache.getMemoryBudget ());
+  EXPECT_GT (cache.getEvictions (), 0);
+
+  cache.clear ();
+  EXPECT_EQ (cache.size (), 0);
+  EXPECT_EQ (cache.getHits (), 0);
+  EXPECT_FALSE (cache.find (3, 7, result));
+
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  PFHEstimation<PointXYZ, Normal, PFHSignature125> pfh;
+  pfh.setInputNormals (normals);
+  pfh.setInputCloud (cloud.makeShared ());
+  pfh.setIndices (indicesptr);
+  pfh.setSearchMethod (tree);
+  pfh.setKSearch (30);
+  PointCloud<PFHSignature125> pfhs;
+  pfh.compute (pfhs);
+
+  // The cached pair features must give exactly the same results, both serially and in parallel
+  pfh.setUseInternalCache (true);
+  PointCloud<PFHSignature125> pfhs_cached;
+  pfh.compute (pfhs_cached);
+  EXPECT_GT (pfh.getInternalCache ()->getHits (), 0);
+
+  PFHEstimationOMP<PointXYZ, Normal, PFHSignature125> pfh_omp (4);
+  pfh_omp.setUseInternalCache (true);
+  pfh_omp.setMaximumCacheSize (10000);
+  pfh_omp.setInputNormals (normals);
+  pfh_omp.setInputCloud (cloud.makeShared ());
+  pfh_omp.setIndices (indicesptr);
+  pfh_omp.setSearchMethod (tree);
+  pfh_omp.setKSearch (30);
+  PointCloud<PFHSignature125> pfhs_omp;
+  pfh_omp.compute (pfhs_omp);
+  EXPECT_GT (pfh_omp.getInternalCache ()->getHits (), 0);
+  EXPECT_LE (pfh_omp.getInternalCache ()->size (), 10000);
+
+  ASSERT_EQ (pfhs_cached.points.size (), pfhs.points.size ());
+  ASSERT_EQ (pfhs_omp.points.size (), pfhs.points.size ());
+  for (size_t i = 0; i < pfhs.points.size (); ++i)
+    for (int d = 0; d < 125; ++d)
+    {
+      EXPECT_EQ (pfhs_cached.points[i].histogram[d], pfhs.points[i].histogram[d]);
+      EXPECT_EQ (pfhs_omp.points[i].histogram[d], pfhs.points[i].histogram[d]);
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, FPFHEstimation)
 {
@@ -499,6 +631,199 @@ TEST (PCL, FPFHEstimationOpenMP)
   (cloud.makeShared (), normals, test_indices, 33);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+expectFullFPFHComputation (const PointCloud<PointXYZ>::Ptr &points, const PointCloud<Normal>::Ptr &normals,
+                           int k, double radius, const PointCloud<FPFHSignature33> &output)
+{
+  FPFHEstimationOMP<PointXYZ, Normal, FPFHSignature33> fpfh (4);
+  fpfh.setSearchMethod (KdTreePtr (new search::KdTree<PointXYZ> (false)));
+  fpfh.setKSearch (k);
+  fpfh.setRadiusSearch (radius);
+  fpfh.setInputCloud (points);
+  fpfh.setInputNormals (normals);
+  PointCloud<FPFHSignature33> full_output;
+  fpfh.compute (full_output);
+
+  ASSERT_EQ (output.points.size (), full_output.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    for (int d = 0; d < 33; ++d)
+    {
+      EXPECT_EQ (pcl_isfinite (full_output.points[i].histogram[d]), pcl_isfinite (output.points[i].histogram[d]));
+      if (pcl_isfinite (full_output.points[i].histogram[d]))
+        EXPECT_NEAR (full_output.points[i].histogram[d], output.points[i].histogram[d], 1e-4);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FPFHEstimationOpenMPIncremental)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  // The first frame holds a part of the cloud
+  const size_t nr_first_points = cloud.points.size () * 3 / 4;
+  PointCloud<PointXYZ>::Ptr first (new PointCloud<PointXYZ> ());
+  PointCloud<Normal>::Ptr first_normals (new PointCloud<Normal> ());
+  first->points.assign (cloud.points.begin (), cloud.points.begin () + nr_first_points);
+  first->width = static_cast<uint32_t> (first->points.size ());
+  first->height = 1;
+  first_normals->points.assign (normals->points.begin (), normals->points.begin () + nr_first_points);
+  first_normals->width = static_cast<uint32_t> (first_normals->points.size ());
+  first_normals->height = 1;
+
+  for (int k = 0; k < 2; ++k)
+  {
+    const int nr_neighbors = (k == 0) ? 10 : 0;
+    const double radius = (k == 0) ? 0.0 : 0.01;
+
+    FPFHEstimationOMP<PointXYZ, Normal, FPFHSignature33> fpfh (4);
+    fpfh.setSearchMethod (KdTreePtr (new search::KdTree<PointXYZ> (false)));
+    fpfh.setKSearch (nr_neighbors);
+    fpfh.setRadiusSearch (radius);
+    fpfh.setInputCloud (first);
+    fpfh.setInputNormals (first_normals);
+    PointCloud<FPFHSignature33> output;
+    fpfh.compute (output);
+
+    // The second frame appends the remaining points, moves one point and removes another one
+    PointCloud<PointXYZ>::Ptr second (new PointCloud<PointXYZ> (cloud));
+    second->points[10].x += 0.002f;
+    second->points[20].x = second->points[20].y = second->points[20].z = std::numeric_limits<float>::quiet_NaN ();
+    second->is_dense = false;
+
+    fpfh.setInputCloud (second);
+    fpfh.setInputNormals (normals);
+    fpfh.computeIncremental (vector<int> (), vector<int> (1, 20), vector<int> (1, 10), output);
+    expectFullFPFHComputation (second, normals, nr_neighbors, radius, output);
+
+    // Move another point, this time in place
+    second->points[50].y -= 0.003f;
+    fpfh.computeIncremental (vector<int> (), vector<int> (), vector<int> (1, 50), output);
+    expectFullFPFHComputation (second, normals, nr_neighbors, radius, output);
+  }
+
+  // A cloud with less than k points has unbounded neighborhoods, which every new point joins
+  PointCloud<PointXYZ>::Ptr few (new PointCloud<PointXYZ> ());
+  PointCloud<Normal>::Ptr few_normals (new PointCloud<Normal> ());
+  few->points.assign (first->points.begin (), first->points.begin () + 5);
+  few->width = static_cast<uint32_t> (few->points.size ());
+  few->height = 1;
+  few_normals->points.assign (first_normals->points.begin (), first_normals->points.begin () + 5);
+  few_normals->width = static_cast<uint32_t> (few_normals->points.size ());
+  few_normals->height = 1;
+
+  FPFHEstimationOMP<PointXYZ, Normal, FPFHSignature33> fpfh (4);
+  fpfh.setSearchMethod (KdTreePtr (new search::KdTree<PointXYZ> (false)));
+  fpfh.setKSearch (10);
+  fpfh.setInputCloud (few);
+  fpfh.setInputNormals (few_normals);
+  PointCloud<FPFHSignature33> output;
+  fpfh.compute (output);
+
+  fpfh.setInputCloud (first);
+  fpfh.setInputNormals (first_normals);
+  fpfh.computeIncremental (vector<int> (), vector<int> (), vector<int> (), output);
+  expectFullFPFHComputation (first, first_normals, 10, 0.0, output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MultiscaleFeaturePersistence)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  std::vector<float> scales;
+  scales.push_back (0.015f);
+  scales.push_back (0.01f);
+  scales.push_back (0.02f);
+  const float alpha = 1.0f;
+
+  // Compute the features at each scale with independent searches
+  std::vector<std::vector<std::vector<float> > > features (scales.size ());
+  std::vector<float> mean (33, 0.0f);
+  DefaultPointRepresentation<FPFHSignature33> representation;
+  for (size_t scale_i = 0; scale_i < scales.size (); ++scale_i)
+  {
+    FPFHEstimation<PointXYZ, Normal, FPFHSignature33> fpfh;
+    fpfh.setInputCloud (cloud.makeShared ());
+    fpfh.setInputNormals (normals);
+    fpfh.setSearchMethod (KdTreePtr (new search::KdTree<PointXYZ> (false)));
+    fpfh.setRadiusSearch (scales[scale_i]);
+    PointCloud<FPFHSignature33> output;
+    fpfh.compute (output);
+    features[scale_i].resize (output.points.size (), std::vector<float> (33));
+    for (size_t i = 0; i < output.points.size (); ++i)
+    {
+      representation.vectorize (output.points[i], features[scale_i][i]);
+      for (int d = 0; d < 33; ++d)
+        mean[d] += features[scale_i][i][d] / static_cast<float> (scales.size () * output.points.size ());
+    }
+  }
+
+  // A feature is persistent if it is far from the mean feature at all the scales
+  std::vector<bool> persistent (cloud.points.size (), true);
+  for (size_t scale_i = 0; scale_i < scales.size (); ++scale_i)
+  {
+    std::vector<float> diff (features[scale_i].size ());
+    float standard_dev = 0.0f;
+    for (size_t i = 0; i < diff.size (); ++i)
+    {
+      diff[i] = selectNorm<std::vector<float> > (features[scale_i][i], mean, 33, L1);
+      standard_dev += diff[i] * diff[i];
+    }
+    standard_dev = sqrtf (standard_dev / static_cast<float> (diff.size ()));
+    for (size_t i = 0; i < diff.size (); ++i)
+      persistent[i] = persistent[i] && (diff[i] > alpha * standard_dev);
+  }
+
+  for (unsigned int nr_threads = 1; nr_threads <= 4; nr_threads += 3)
+  {
+    FPFHEstimation<PointXYZ, Normal, FPFHSignature33>::Ptr fpfh (new FPFHEstimation<PointXYZ, Normal, FPFHSignature33> ());
+    fpfh->setInputCloud (cloud.makeShared ());
+    fpfh->setInputNormals (normals);
+    fpfh->setSearchMethod (tree);
+
+    MultiscaleFeaturePersistence<PointXYZ, FPFHSignature33> persistence;
+    persistence.setScalesVector (scales);
+    persistence.setAlpha (alpha);
+    persistence.setFeatureEstimator (fpfh);
+    persistence.setDistanceMetric (L1);
+    persistence.setNumberOfThreads (nr_threads);
+    PointCloud<FPFHSignature33> output;
+    boost::shared_ptr<std::vector<int> > output_indices (new std::vector<int> ());
+    persistence.determinePersistentFeatures (output, output_indices);
+
+    // The estimator gets its search object back
+    EXPECT_EQ (fpfh->getSearchMethod (), tree);
+
+    std::vector<int> expected_indices;
+    for (size_t i = 0; i < persistent.size (); ++i)
+      if (persistent[i])
+        expected_indices.push_back (static_cast<int> (i));
+    ASSERT_EQ (output_indices->size (), expected_indices.size ());
+    EXPECT_FALSE (expected_indices.empty ());
+    for (size_t i = 0; i < expected_indices.size (); ++i)
+    {
+      EXPECT_EQ ((*output_indices)[i], expected_indices[i]);
+      for (int d = 0; d < 33; ++d)
+        EXPECT_NEAR (output.points[i].histogram[d], features[0][expected_indices[i]][d], 1e-4);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, VFHEstimation)
 {
@@ -0,0 +1,169 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/features/rsd.h>
+#include <pcl/features/rsd_omp.h>
+#include <pcl/io/pcd_io.h>
+
+using namespace pcl;
+using namespace pcl::io;
+using namespace std;
+
+typedef search::KdTree<PointXYZ>::Ptr KdTreePtr;
+
+PointCloud<PointXYZ> cloud;
+vector<int> indices;
+KdTreePtr tree;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, RSDEstimation)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  // set parameters
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10); // Use 10 nearest neighbors to estimate the normals
+  // estimate
+  n.compute (*normals);
+
+  RSDEstimation<PointXYZ, Normal, PrincipalRadiiRSD> rsd;
+  rsd.setInputNormals (normals);
+  rsd.setInputCloud (cloud.makeShared ());
+  rsd.setIndices (indicesptr);
+  rsd.setSearchMethod (tree);
+  rsd.setRadiusSearch (0.03);
+  rsd.setSaveHistograms (true);
+  PointCloud<PrincipalRadiiRSD> radii;
+  rsd.compute (radii);
+
+  ASSERT_EQ (radii.points.size (), indices.size ());
+  ASSERT_EQ (rsd.getHistograms ()->size (), indices.size ());
+  EXPECT_EQ ((*rsd.getHistograms ())[0].rows (), rsd.getNrSubdivisions ());
+  for (size_t i = 0; i < radii.points.size (); ++i)
+  {
+    EXPECT_GE (radii.points[i].r_min, 0.0f);
+    EXPECT_LE (radii.points[i].r_min, radii.points[i].r_max);
+  }
+
+  EXPECT_NEAR (radii.points[0].r_min, 0.030376, 1e-4);
+  EXPECT_NEAR (radii.points[0].r_max, 0.148651, 1e-4);
+  EXPECT_NEAR (radii.points[indices.size () - 1].r_min, 0.043876, 1e-4);
+  EXPECT_NEAR (radii.points[indices.size () - 1].r_max, 0.085833, 1e-4);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, RSDEstimationOpenMP)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  // set parameters
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setKSearch (10); // Use 10 nearest neighbors to estimate the normals
+  // estimate
+  n.compute (*normals);
+
+  RSDEstimation<PointXYZ, Normal, PrincipalRadiiRSD> rsd;
+  rsd.setInputNormals (normals);
+  rsd.setInputCloud (cloud.makeShared ());
+  rsd.setIndices (indicesptr);
+  rsd.setSearchMethod (tree);
+  rsd.setRadiusSearch (0.03);
+  rsd.setSaveHistograms (true);
+  PointCloud<PrincipalRadiiRSD> radii;
+  rsd.compute (radii);
+
+  RSDEstimationOMP<PointXYZ, Normal, PrincipalRadiiRSD> rsd_omp (4); // instantiate 4 threads
+  rsd_omp.setInputNormals (normals);
+  rsd_omp.setInputCloud (cloud.makeShared ());
+  rsd_omp.setIndices (indicesptr);
+  rsd_omp.setSearchMethod (tree);
+  rsd_omp.setRadiusSearch (0.03);
+  rsd_omp.setSaveHistograms (true);
+  PointCloud<PrincipalRadiiRSD> radii_omp;
+  rsd_omp.compute (radii_omp);
+
+  // The parallel implementation must give exactly the same results, including the histograms
+  ASSERT_EQ (radii_omp.points.size (), radii.points.size ());
+  ASSERT_EQ (rsd_omp.getHistograms ()->size (), rsd.getHistograms ()->size ());
+  for (size_t i = 0; i < radii.points.size (); ++i)
+  {
+    EXPECT_EQ (radii_omp.points[i].r_min, radii.points[i].r_min);
+    EXPECT_EQ (radii_omp.points[i].r_max, radii.points[i].r_max);
+    EXPECT_TRUE ((*rsd_omp.getHistograms ())[i] == (*rsd.getHistograms ())[i]);
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "No test file given. Please download `bun0.pcd` and pass its path to the test." << std::endl;
+    return (-1);
+  }
+
+  if (loadPCDFile<PointXYZ> (argv[1], cloud) < 0)
+  {
+    std::cerr << "Failed to read test file. Please download `bun0.pcd` and pass its path to the test." << std::endl;
+    return (-1);
+  }
+
+  indices.resize (cloud.points.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+    indices[i] = static_cast<int> (i);
+
+  // RSD uses the first neighbor as the reference point, so the neighbors have to be sorted by distance
+  tree.reset (new search::KdTree<PointXYZ> (true));
+  tree->setInputCloud (cloud.makeShared ());
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -45,7 +45,9 @@
 #include <pcl/features/shot_omp.h>
 #include "pcl/features/shot_lrf.h"
 #include <pcl/features/3dsc.h>
+#include <pcl/features/3dsc_omp.h>
 #include <pcl/features/usc.h>
+#include <pcl/features/usc_omp.h>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -554,6 +556,68 @@ TEST (PCL, SHOTShapeEstimationOpenMP)
   testSHOTLocalReferenceFrame<SHOTEstimationOMP<PointXYZ, Normal, SHOT>, PointXYZ, Normal, SHOT> (cloud.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SHOTQuantizedEstimation)
+{
+  double mr = 0.002;
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (20 * mr);
+  n.compute (*normals);
+
+  SHOTEstimation<PointXYZ, Normal, SHOT> shot;
+  shot.setInputNormals (normals);
+  shot.setRadiusSearch (20 * mr);
+  shot.setInputCloud (cloud.makeShared ());
+  shot.setIndices (indicesptr);
+  shot.setSearchMethod (tree);
+  PointCloud<SHOT> shots;
+  shot.compute (shots);
+
+  SHOTEstimationOMP<PointXYZ, Normal, SHOTQuantized> shot_quantized (4);
+  shot_quantized.setInputNormals (normals);
+  shot_quantized.setRadiusSearch (20 * mr);
+  shot_quantized.setInputCloud (cloud.makeShared ());
+  shot_quantized.setIndices (indicesptr);
+  shot_quantized.setSearchMethod (tree);
+  PointCloud<SHOTQuantized> shots_quantized;
+  shot_quantized.compute (shots_quantized);
+
+  // Every bin is within half a quantization step of the floating point one
+  ASSERT_EQ (shots_quantized.points.size (), shots.points.size ());
+  for (size_t i = 0; i < shots.points.size (); ++i)
+  {
+    ASSERT_EQ (shots_quantized.points[i].descriptor.size (), shots.points[i].descriptor.size ());
+    if (!pcl_isfinite (shots.points[i].descriptor[0]))
+    {
+      EXPECT_FALSE (pcl_isfinite (shots_quantized.points[i].scale));
+      continue;
+    }
+
+    SHOT dequantized;
+    dequantizeSHOT (shots_quantized.points[i], dequantized);
+    const float step = shots_quantized.points[i].scale / 255.0f;
+    for (size_t j = 0; j < shots.points[i].descriptor.size (); ++j)
+      EXPECT_NEAR (dequantized.descriptor[j], shots.points[i].descriptor[j], step / 2 + 1e-6);
+    for (int j = 0; j < 9; ++j)
+      EXPECT_EQ (dequantized.rf[j], shots.points[i].rf[j]);
+
+    // Quantizing the floating point signature gives the same descriptor
+    SHOTQuantized quantized;
+    quantizeSHOT (shots.points[i], quantized);
+    EXPECT_EQ (quantized.scale, shots_quantized.points[i].scale);
+    for (size_t j = 0; j < quantized.descriptor.size (); ++j)
+      EXPECT_EQ (quantized.descriptor[j], shots_quantized.points[i].descriptor[j]);
+  }
+
+  // The largest bin maps to 255
+  EXPECT_EQ (*std::max_element (shots_quantized.points[103].descriptor.begin (), shots_quantized.points[103].descriptor.end ()), 255);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL,SHOTShapeAndColorEstimationOpenMP)
 {
@@ -787,6 +851,93 @@ TEST (PCL, USCEstimation)
   testSHOTLocalReferenceFrame<UniqueShapeContext<PointXYZ, SHOT>, PointXYZ, Normal, SHOT> (cloud.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, 3DSCEstimationOpenMP)
+{
+  float meshRes = 0.002f;
+  float radius = 20.0f * meshRes;
+
+  PointCloud<PointXYZ>::Ptr cloudptr = cloud.makeShared ();
+
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> ne;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  ne.setInputCloud (cloudptr);
+  ne.setSearchMethod (tree);
+  ne.setRadiusSearch (radius);
+  ne.compute (*normals);
+
+  ShapeContext3DEstimation<PointXYZ, Normal, ShapeContext> sc3d;
+  ShapeContext3DEstimationOMP<PointXYZ, Normal, ShapeContext> sc3d_omp (4, false); // instantiate 4 threads
+  ShapeContext3DEstimation<PointXYZ, Normal, ShapeContext> *estimators[2] = { &sc3d, &sc3d_omp };
+  for (int e = 0; e < 2; ++e)
+  {
+    estimators[e]->setInputCloud (cloudptr);
+    estimators[e]->setInputNormals (normals);
+    estimators[e]->setSearchMethod (tree);
+    estimators[e]->setRadiusSearch (radius);
+    estimators[e]->setAzimuthBins (4);
+    estimators[e]->setElevationBins (4);
+    estimators[e]->setRadiusBins (4);
+    estimators[e]->setMinimalRadius (radius / 10.0f);
+    estimators[e]->setPointDensityRadius (radius / 5.0f);
+  }
+
+  // Both estimators are seeded the same way, so the random X axes must be drawn in the same order
+  PointCloud<ShapeContext> sc3ds, sc3ds_omp;
+  sc3d.compute (sc3ds);
+  sc3d_omp.compute (sc3ds_omp);
+
+  ASSERT_EQ (sc3ds_omp.size (), sc3ds.size ());
+  EXPECT_EQ (sc3ds_omp.is_dense, sc3ds.is_dense);
+  for (size_t i = 0; i < sc3ds.size (); ++i)
+  {
+    ASSERT_EQ (sc3ds_omp[i].descriptor.size (), sc3ds[i].descriptor.size ());
+    for (size_t d = 0; d < sc3ds[i].descriptor.size (); ++d)
+      EXPECT_EQ (sc3ds_omp[i].descriptor[d], sc3ds[i].descriptor[d]);
+    for (int d = 0; d < 9; ++d)
+      EXPECT_EQ (sc3ds_omp[i].rf[d], sc3ds[i].rf[d]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, USCEstimationOpenMP)
+{
+  float meshRes = 0.002f;
+  float radius = 20.0f * meshRes;
+
+  UniqueShapeContext<PointXYZ, SHOT> uscd;
+  UniqueShapeContextOMP<PointXYZ, SHOT> uscd_omp (4); // instantiate 4 threads
+  UniqueShapeContext<PointXYZ, SHOT> *estimators[2] = { &uscd, &uscd_omp };
+  for (int e = 0; e < 2; ++e)
+  {
+    estimators[e]->setInputCloud (cloud.makeShared ());
+    estimators[e]->setSearchMethod (tree);
+    estimators[e]->setRadiusSearch (radius);
+    estimators[e]->setAzimuthBins (4);
+    estimators[e]->setElevationBins (4);
+    estimators[e]->setRadiusBins (4);
+    estimators[e]->setMinimalRadius (radius / 10.0f);
+    estimators[e]->setPointDensityRadius (radius / 5.0f);
+    estimators[e]->setLocalRadius (radius);
+  }
+
+  PointCloud<SHOT> uscds, uscds_omp;
+  uscd.compute (uscds);
+  uscd_omp.compute (uscds_omp);
+
+  // The parallel implementation must give exactly the same results
+  ASSERT_EQ (uscds_omp.size (), uscds.size ());
+  for (size_t i = 0; i < uscds.size (); ++i)
+  {
+    ASSERT_EQ (uscds_omp[i].descriptor.size (), uscds[i].descriptor.size ());
+    for (size_t d = 0; d < uscds[i].descriptor.size (); ++d)
+      EXPECT_EQ (uscds_omp[i].descriptor[d], uscds[i].descriptor[d]);
+    for (int d = 0; d < 9; ++d)
+      EXPECT_EQ (uscds_omp[i].rf[d], uscds[i].rf[d]);
+  }
+}
+
 #ifndef PCL_ONLY_CORE_POINT_TYPES
   ///////////////////////////////////////////////////////////////////////////////////
   template <> UniqueShapeContext<PointXYZ, Eigen::MatrixXf>
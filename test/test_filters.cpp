@@ -51,6 +51,9 @@
 #include <pcl/filters/conditional_removal.h>
 #include <pcl/filters/random_sample.h>
 #include <pcl/filters/crop_box.h>
+#include <pcl/filters/crop_hull.h>
+#include <pcl/filters/filter_chain.h>
+#include <pcl/filters/bilateral.h>
 
 #include <pcl/common/transforms.h>
 #include <pcl/common/eigen.h>
@@ -771,6 +774,86 @@ TEST (VoxelGrid_RGB, Filters)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGrid_Threads, Filters)
+{
+  // The multi-threaded binning must give exactly the same cloud as the serial one
+  PointCloud<PointXYZ> output, output_mt;
+  VoxelGrid<PointXYZ> grid;
+  grid.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid.setInputCloud (cloud);
+  grid.filter (output);
+  grid.setNumberOfThreads (4);
+  grid.filter (output_mt);
+
+  ASSERT_EQ (output.points.size (), output_mt.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (output.points[i].x, output_mt.points[i].x);
+    EXPECT_EQ (output.points[i].y, output_mt.points[i].y);
+    EXPECT_EQ (output.points[i].z, output_mt.points[i].z);
+  }
+
+  PointCloud2 output_blob, output_blob_mt;
+  VoxelGrid<PointCloud2> grid2;
+  grid2.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid2.setInputCloud (cloud_blob);
+  grid2.filter (output_blob);
+  grid2.setNumberOfThreads (4);
+  grid2.filter (output_blob_mt);
+
+  EXPECT_EQ (output_blob.width, output_blob_mt.width);
+  EXPECT_TRUE (output_blob.data == output_blob_mt.data);
+
+  // Both specializations downsample only the indexed points
+  IndicesPtr sparse_indices (new std::vector<int>);
+  for (int i = 0; i < static_cast<int> (cloud->points.size ()); i += 3)
+    sparse_indices->push_back (i);
+  grid.setIndices (sparse_indices);
+  grid.filter (output);
+  grid.setIndices (IndicesPtr ());
+  grid2.setIndices (sparse_indices);
+  grid2.filter (output_blob);
+  grid2.setIndices (IndicesPtr ());
+  fromROSMsg (output_blob, output_mt);
+
+  EXPECT_LT (output.points.size (), output_blob_mt.width * output_blob_mt.height);
+  ASSERT_EQ (output.points.size (), output_mt.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_NEAR (output.points[i].x, output_mt.points[i].x, 1e-6);
+    EXPECT_NEAR (output.points[i].y, output_mt.points[i].y, 1e-6);
+    EXPECT_NEAR (output.points[i].z, output_mt.points[i].z, 1e-6);
+  }
+
+  // A bounding box with more leaves than a 32 bit index can address
+  PointCloud<PointXYZ>::Ptr far_cloud (new PointCloud<PointXYZ>);
+  far_cloud->push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+  far_cloud->push_back (PointXYZ (0.0005f, 0.0005f, 0.0005f));
+  far_cloud->push_back (PointXYZ (1000.0f, 1000.0f, 1000.0f));
+  grid.setLeafSize (0.001f, 0.001f, 0.001f);
+  grid.setInputCloud (far_cloud);
+  grid.filter (output);
+
+  ASSERT_EQ (int (output.points.size ()), 2);
+  EXPECT_NEAR (output.points[0].x, 0.00025, 1e-6);
+  EXPECT_NEAR (output.points[1].x, 1000.0, 1e-3);
+
+  // The integer leaf layout can not index that many leaves, so it is not saved and the lookups fail
+  grid.setSaveLeafLayout (true);
+  grid.filter (output);
+  ASSERT_EQ (int (output.points.size ()), 2);
+  EXPECT_TRUE (grid.getLeafLayout ().empty ());
+  EXPECT_EQ (grid.getCentroidIndexAt (grid.getGridCoordinates (1000.0f, 1000.0f, 1000.0f)), -1);
+
+  // A smaller grid is indexed again
+  grid.setLeafSize (10.0f, 10.0f, 10.0f);
+  grid.filter (output);
+  ASSERT_EQ (int (output.points.size ()), 2);
+  EXPECT_EQ (grid.getCentroidIndexAt (grid.getGridCoordinates (0.0f, 0.0f, 0.0f)), 0);
+  EXPECT_EQ (grid.getCentroidIndexAt (grid.getGridCoordinates (1000.0f, 1000.0f, 1000.0f)), 1);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (VoxelGridCovariance, Filters)
 {
@@ -1186,6 +1269,121 @@ TEST (CropBox, Filters)
   EXPECT_EQ (int (cloud_out2.width * cloud_out2.height), 0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CropHull, Filters)
+{
+  // A closed triangle mesh approximating a sphere of radius 1 around (1, 2, 3), with all vertices on the sphere
+  const Eigen::Vector3f center (1.0f, 2.0f, 3.0f);
+  const int nr_rings = 16, nr_segments = 32;
+  PointCloud<PointXYZ>::Ptr hull_cloud (new PointCloud<PointXYZ>);
+  vector<Vertices> hull_polygons;
+  hull_cloud->push_back (PointXYZ (center[0], center[1], center[2] + 1.0f));
+  for (int ring = 1; ring < nr_rings; ++ring)
+  {
+    float theta = PI * static_cast<float> (ring) / static_cast<float> (nr_rings);
+    for (int segment = 0; segment < nr_segments; ++segment)
+    {
+      float phi = 2.0f * PI * static_cast<float> (segment) / static_cast<float> (nr_segments);
+      hull_cloud->push_back (PointXYZ (center[0] + sinf (theta) * cosf (phi), center[1] + sinf (theta) * sinf (phi),
+                                       center[2] + cosf (theta)));
+    }
+  }
+  hull_cloud->push_back (PointXYZ (center[0], center[1], center[2] - 1.0f));
+  const int bottom = static_cast<int> (hull_cloud->size ()) - 1;
+  for (int segment = 0; segment < nr_segments; ++segment)
+  {
+    int next = (segment + 1) % nr_segments;
+    Vertices triangle;
+    triangle.vertices.resize (3);
+    triangle.vertices[0] = 0; triangle.vertices[1] = 1 + segment; triangle.vertices[2] = 1 + next;
+    hull_polygons.push_back (triangle);
+    for (int ring = 1; ring < nr_rings - 1; ++ring)
+    {
+      int upper = 1 + (ring - 1) * nr_segments, lower = upper + nr_segments;
+      triangle.vertices[0] = upper + segment; triangle.vertices[1] = lower + segment; triangle.vertices[2] = lower + next;
+      hull_polygons.push_back (triangle);
+      triangle.vertices[0] = upper + segment; triangle.vertices[1] = lower + next; triangle.vertices[2] = upper + next;
+      hull_polygons.push_back (triangle);
+    }
+    int last = 1 + (nr_rings - 2) * nr_segments;
+    triangle.vertices[0] = last + segment; triangle.vertices[1] = bottom; triangle.vertices[2] = last + next;
+    hull_polygons.push_back (triangle);
+  }
+
+  // Random points in a box around the sphere, except for a shell around the mesh where the classification
+  // depends on the approximation of the sphere
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  srand (42);
+  while (input->size () < 5000)
+  {
+    Eigen::Vector3f point = center + Eigen::Vector3f::Random () * 1.5f;
+    float distance = (point - center).norm ();
+    if (distance > 0.95f && distance < 1.0f)
+      continue;
+    input->push_back (PointXYZ (point[0], point[1], point[2]));
+  }
+
+  CropHull<PointXYZ> crop_hull;
+  crop_hull.setHullCloud (hull_cloud);
+  crop_hull.setHullIndices (hull_polygons);
+  crop_hull.setDim (3);
+  crop_hull.setInputCloud (input);
+  vector<int> inside, outside;
+  crop_hull.filter (inside);
+  crop_hull.setCropOutside (false);
+  crop_hull.filter (outside);
+
+  EXPECT_EQ (inside.size () + outside.size (), input->size ());
+  for (size_t i = 0; i < inside.size (); ++i)
+    EXPECT_LT ((input->points[inside[i]].getVector3fMap () - center).norm (), 0.95f);
+  for (size_t i = 0; i < outside.size (); ++i)
+    EXPECT_GT ((input->points[outside[i]].getVector3fMap () - center).norm (), 1.0f);
+
+  // The output does not depend on the number of threads
+  PointCloud<PointXYZ> output, output_mt;
+  crop_hull.setCropOutside (true);
+  crop_hull.filter (output);
+  crop_hull.setNumberOfThreads (4);
+  crop_hull.filter (output_mt);
+  ASSERT_EQ (output.size (), inside.size ());
+  ASSERT_EQ (output_mt.size (), inside.size ());
+  for (size_t i = 0; i < inside.size (); ++i)
+  {
+    EXPECT_EQ (output.points[i].getVector3fMap (), input->points[inside[i]].getVector3fMap ());
+    EXPECT_EQ (output_mt.points[i].getVector3fMap (), input->points[inside[i]].getVector3fMap ());
+  }
+
+  // A 2D hull: the square [0, 1] x [0, 1] in the plane z = 0
+  PointCloud<PointXYZ>::Ptr square (new PointCloud<PointXYZ>);
+  square->push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+  square->push_back (PointXYZ (1.0f, 0.0f, 0.0f));
+  square->push_back (PointXYZ (1.0f, 1.0f, 0.0f));
+  square->push_back (PointXYZ (0.0f, 1.0f, 0.0f));
+  Vertices square_polygon;
+  for (uint32_t i = 0; i < 4; ++i)
+    square_polygon.vertices.push_back (i);
+  PointCloud<PointXYZ>::Ptr plane (new PointCloud<PointXYZ>);
+  plane->push_back (PointXYZ (0.5f, 0.5f, 0.0f));
+  plane->push_back (PointXYZ (1.5f, 0.5f, 0.0f));
+  plane->push_back (PointXYZ (0.25f, 0.75f, 0.0f));
+  plane->push_back (PointXYZ (-0.5f, -0.5f, 0.0f));
+
+  CropHull<PointXYZ> crop_hull_2d;
+  crop_hull_2d.setHullCloud (square);
+  crop_hull_2d.setHullIndices (vector<Vertices> (1, square_polygon));
+  crop_hull_2d.setDim (2);
+  crop_hull_2d.setInputCloud (plane);
+  crop_hull_2d.filter (inside);
+  ASSERT_EQ (int (inside.size ()), 2);
+  EXPECT_EQ (inside[0], 0);
+  EXPECT_EQ (inside[1], 2);
+  crop_hull_2d.setCropOutside (false);
+  crop_hull_2d.filter (outside);
+  ASSERT_EQ (int (outside.size ()), 2);
+  EXPECT_EQ (outside[0], 1);
+  EXPECT_EQ (outside[1], 3);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (StatisticalOutlierRemoval, Filters)
 {
@@ -1301,6 +1499,136 @@ TEST (StatisticalOutlierRemoval, Filters)
   EXPECT_NEAR (output.points[output.points.size () - 1].z, -0.0444, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (OutlierRemoval_Threads, Filters)
+{
+  // The multi-threaded filters must give exactly the same clouds and removed indices as the serial ones
+  PointCloud<PointXYZ> output, output_mt;
+  StatisticalOutlierRemoval<PointXYZ> sor (true);
+  sor.setInputCloud (cloud);
+  sor.setMeanK (50);
+  sor.setStddevMulThresh (1.0);
+  sor.filter (output);
+  vector<int> removed = *sor.getRemovedIndices ();
+  sor.setNumberOfThreads (4);
+  sor.filter (output_mt);
+
+  EXPECT_EQ (int (output.points.size ()), 352);
+  ASSERT_EQ (output.points.size (), output_mt.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (output.points[i].getVector3fMap (), output_mt.points[i].getVector3fMap ());
+  EXPECT_TRUE (removed == *sor.getRemovedIndices ());
+
+  RadiusOutlierRemoval<PointXYZ> ror (true);
+  ror.setInputCloud (cloud);
+  ror.setRadiusSearch (0.02);
+  ror.setMinNeighborsInRadius (15);
+  ror.filter (output);
+  removed = *ror.getRemovedIndices ();
+  ror.setNumberOfThreads (4);
+  ror.filter (output_mt);
+
+  EXPECT_EQ (int (output.points.size ()), 307);
+  ASSERT_EQ (output.points.size (), output_mt.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (output.points[i].getVector3fMap (), output_mt.points[i].getVector3fMap ());
+  EXPECT_TRUE (removed == *ror.getRemovedIndices ());
+
+  PointCloud2 output_blob, output_blob_mt;
+  StatisticalOutlierRemoval<PointCloud2> sor2;
+  sor2.setInputCloud (cloud_blob);
+  sor2.setMeanK (50);
+  sor2.setStddevMulThresh (1.0);
+  sor2.filter (output_blob);
+  sor2.setNumberOfThreads (4);
+  sor2.filter (output_blob_mt);
+  EXPECT_EQ (output_blob.width, output_blob_mt.width);
+  EXPECT_TRUE (output_blob.data == output_blob_mt.data);
+
+  RadiusOutlierRemoval<PointCloud2> ror2;
+  ror2.setInputCloud (cloud_blob);
+  ror2.setRadiusSearch (0.02);
+  ror2.setMinNeighborsInRadius (15);
+  ror2.filter (output_blob);
+  ror2.setNumberOfThreads (4);
+  ror2.filter (output_blob_mt);
+  EXPECT_EQ (output_blob.width, output_blob_mt.width);
+  EXPECT_TRUE (output_blob.data == output_blob_mt.data);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (OutlierRemoval_Organized, Filters)
+{
+  // A depth image of a tilted plane seen by a pinhole camera, with a few isolated points pushed away from it and
+  // a few invalid pixels. The organized search has to find the same neighbors as the kd-tree.
+  PointCloud<PointXYZ>::Ptr organized (new PointCloud<PointXYZ> (80, 60));
+  const float focal_length = 70.0f;
+  for (int y = 0; y < 60; ++y)
+  {
+    for (int x = 0; x < 80; ++x)
+    {
+      PointXYZ &point = organized->at (x, y);
+      float u = (static_cast<float> (x) - 40.0f) / focal_length, v = (static_cast<float> (y) - 30.0f) / focal_length;
+      float depth = 2.0f + 0.5f * u;
+      if ((x * 7 + y * 13) % 97 == 0)
+        depth += 0.5f;
+      point.x = u * depth;
+      point.y = v * depth;
+      point.z = depth;
+      if ((x * 11 + y * 3) % 211 == 0)
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  }
+  organized->is_dense = false;
+  PointCloud<PointXYZ>::Ptr unorganized (new PointCloud<PointXYZ> (*organized));
+  unorganized->width = static_cast<uint32_t> (unorganized->points.size ());
+  unorganized->height = 1;
+
+  PointCloud<PointXYZ> output, output_organized;
+  RadiusOutlierRemoval<PointXYZ> ror;
+  ror.setRadiusSearch (0.05);
+  ror.setMinNeighborsInRadius (5);
+  ror.setNumberOfThreads (4);
+  ror.setInputCloud (unorganized);
+  ror.filter (output);
+  // A new filter, which does not reuse the kd-tree of the first one
+  RadiusOutlierRemoval<PointXYZ> ror_organized;
+  ror_organized.setRadiusSearch (0.05);
+  ror_organized.setMinNeighborsInRadius (5);
+  ror_organized.setNumberOfThreads (4);
+  ror_organized.setInputCloud (organized);
+  ror_organized.filter (output_organized);
+
+  // The outliers and the invalid points are removed
+  EXPECT_LT (output.points.size (), organized->points.size () - 40);
+  ASSERT_EQ (output.points.size (), output_organized.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (output.points[i].getVector3fMap (), output_organized.points[i].getVector3fMap ());
+
+  StatisticalOutlierRemoval<PointXYZ> sor;
+  sor.setMeanK (8);
+  sor.setStddevMulThresh (1.0);
+  sor.setNumberOfThreads (4);
+  sor.setInputCloud (unorganized);
+  sor.filter (output);
+  StatisticalOutlierRemoval<PointXYZ> sor_organized;
+  sor_organized.setMeanK (8);
+  sor_organized.setStddevMulThresh (1.0);
+  sor_organized.setNumberOfThreads (4);
+  sor_organized.setInputCloud (organized);
+  sor_organized.filter (output_organized);
+
+  // Invalid points get a mean distance of 0 and are kept
+  ASSERT_EQ (output.points.size (), output_organized.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    if (!pcl_isfinite (output.points[i].x))
+      EXPECT_FALSE (pcl_isfinite (output_organized.points[i].x));
+    else
+      EXPECT_EQ (output.points[i].getVector3fMap (), output_organized.points[i].getVector3fMap ());
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ConditionalRemoval, Filters)
 {
@@ -1388,6 +1716,22 @@ TEST (ConditionalRemoval, Filters)
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief A comparison that counts the points it is evaluated on. */
+class CountingXComparison : public ComparisonBase<PointXYZ>
+{
+  public:
+    CountingXComparison () : count (0) { capable_ = true; }
+
+    virtual bool
+    evaluate (const PointXYZ &point) const
+    {
+      ++count;
+      return (point.x < 0.05f);
+    }
+
+    mutable int count;
+};
+
 TEST (ConditionalRemovalSetIndices, Filters)
 {
   // Test the PointCloud<PointT> method
@@ -1500,6 +1844,26 @@ TEST (ConditionalRemovalSetIndices, Filters)
   EXPECT_EQ (num_not_nan, 2);
 
   EXPECT_EQ (num_not_nan, int (indices->size ()) - int (condrem2_.getRemovedIndices ()->size ()));
+
+  // Only the indexed points are evaluated, also when keeping the cloud organized
+  boost::shared_ptr<vector<int> > sparse_indices (new vector<int>);
+  for (int i = static_cast<int> (cloud->points.size ()) - 1; i >= 0; i -= 10)
+    sparse_indices->push_back (i);
+  boost::shared_ptr<CountingXComparison> counting_comp (new CountingXComparison);
+  ConditionAnd<PointXYZ>::Ptr counting_cond (new ConditionAnd<PointXYZ> ());
+  counting_cond->addComparison (counting_comp);
+  ConditionalRemoval<PointXYZ> condrem3 (counting_cond);
+  condrem3.setInputCloud (cloud);
+  condrem3.setIndices (sparse_indices);
+  condrem3.setKeepOrganized (true);
+  condrem3.filter (output);
+  EXPECT_EQ (counting_comp->count, int (sparse_indices->size ()));
+  ASSERT_EQ (output.points.size (), cloud->points.size ());
+  std::vector<bool> indexed (cloud->points.size (), false);
+  for (size_t i = 0; i < sparse_indices->size (); ++i)
+    indexed[(*sparse_indices)[i]] = true;
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (indexed[i] && cloud->points[i].x < 0.05f, pcl_isfinite (output.points[i].x));
 }
 
 TEST (ConditionalRemovalTfQuadraticXYZComparison, Filters)
@@ -1585,6 +1949,281 @@ TEST (ConditionalRemovalTfQuadraticXYZComparison, Filters)
   EXPECT_EQ (input->points[5].z, output.points[5].z);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ConditionalRemovalCompiled, Filters)
+{
+  // A colored copy of the bunny, with a few invalid points
+  PointCloud<PointXYZRGB>::Ptr input (new PointCloud<PointXYZRGB> ());
+  copyPointCloud (*cloud, *input);
+  for (size_t i = 0; i < input->points.size (); ++i)
+  {
+    input->points[i].r = static_cast<uint8_t> (i * 7);
+    input->points[i].g = static_cast<uint8_t> (i * 13);
+    input->points[i].b = static_cast<uint8_t> (i * 29);
+    if (i % 50 == 0)
+      input->points[i].z = std::numeric_limits<float>::quiet_NaN ();
+  }
+
+  // (z in (0.02, 0.04) AND r >= 100) OR (y <= 0.1 AND (g == 26 OR h < 0 OR x > 0.05)) OR (empty AND)
+  ConditionAnd<PointXYZRGB>::Ptr range_cond (new ConditionAnd<PointXYZRGB> ());
+  range_cond->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (new FieldComparison<PointXYZRGB> ("z", ComparisonOps::GT, 0.02)));
+  range_cond->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (new FieldComparison<PointXYZRGB> ("z", ComparisonOps::LT, 0.04)));
+  range_cond->addComparison (PackedRGBComparison<PointXYZRGB>::ConstPtr (new PackedRGBComparison<PointXYZRGB> ("r", ComparisonOps::GE, 100)));
+
+  ConditionOr<PointXYZRGB>::Ptr color_cond (new ConditionOr<PointXYZRGB> ());
+  color_cond->addComparison (PackedRGBComparison<PointXYZRGB>::ConstPtr (new PackedRGBComparison<PointXYZRGB> ("g", ComparisonOps::EQ, 26)));
+  color_cond->addComparison (PackedHSIComparison<PointXYZRGB>::ConstPtr (new PackedHSIComparison<PointXYZRGB> ("h", ComparisonOps::LT, 0)));
+  color_cond->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (new FieldComparison<PointXYZRGB> ("x", ComparisonOps::GT, 0.05)));
+  ConditionAnd<PointXYZRGB>::Ptr side_cond (new ConditionAnd<PointXYZRGB> ());
+  side_cond->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (new FieldComparison<PointXYZRGB> ("y", ComparisonOps::LE, 0.1)));
+  side_cond->addCondition (color_cond);
+
+  ConditionOr<PointXYZRGB>::Ptr cond (new ConditionOr<PointXYZRGB> ());
+  cond->addCondition (range_cond);
+  cond->addCondition (side_cond);
+
+  // The compiled condition gives the same result as evaluating the condition tree
+  std::vector<int> expected;
+  for (int i = 0; i < static_cast<int> (input->points.size ()); ++i)
+    if (pcl_isfinite (input->points[i].z) && cond->evaluate (input->points[i]))
+      expected.push_back (i);
+  EXPECT_GT (expected.size (), 0u);
+  EXPECT_LT (expected.size (), input->points.size ());
+
+  ConditionalRemoval<PointXYZRGB> condrem (cond);
+  condrem.setInputCloud (input);
+  PointCloud<PointXYZRGB> output;
+  condrem.filter (output);
+  ASSERT_EQ (expected.size (), output.points.size ());
+  for (size_t i = 0; i < expected.size (); ++i)
+  {
+    EXPECT_EQ (input->points[expected[i]].x, output.points[i].x);
+    EXPECT_EQ (input->points[expected[i]].rgba, output.points[i].rgba);
+  }
+
+  // The output is the same for any number of threads
+  condrem.setNumberOfThreads (4);
+  PointCloud<PointXYZRGB> output_threads;
+  condrem.filter (output_threads);
+  ASSERT_EQ (output.points.size (), output_threads.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (output.points[i].getVector3fMap (), output_threads.points[i].getVector3fMap ());
+
+  condrem.setKeepOrganized (true);
+  condrem.filter (output_threads);
+  ASSERT_EQ (input->points.size (), output_threads.points.size ());
+  for (size_t i = 0; i < output_threads.points.size (); ++i)
+    EXPECT_EQ (cond->evaluate (input->points[i]), pcl_isfinite (output_threads.points[i].x));
+
+  // A condition without comparisons lets every point pass
+  ConditionalRemoval<PointXYZRGB> condrem_empty (ConditionAnd<PointXYZRGB>::Ptr (new ConditionAnd<PointXYZRGB> ()));
+  condrem_empty.setInputCloud (input);
+  condrem_empty.filter (output);
+  EXPECT_EQ (input->points.size () - (input->points.size () + 49) / 50, output.points.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+isBelowXLimit (const PointXYZ &point)
+{
+  return (point.x < 0.05f);
+}
+
+TEST (FilterChain, Filters)
+{
+  boost::shared_ptr<PassThrough<PointXYZ> > pass (new PassThrough<PointXYZ>);
+  pass->setFilterFieldName ("z");
+  pass->setFilterLimits (-0.04f, 0.05f);
+  boost::shared_ptr<CropBox<PointXYZ> > crop (new CropBox<PointXYZ>);
+  crop->setMin (Eigen::Vector4f (-0.09f, 0.04f, -1.0f, 1.0f));
+  crop->setMax (Eigen::Vector4f (1.0f, 1.0f, 1.0f, 1.0f));
+  boost::shared_ptr<VoxelGrid<PointXYZ> > grid (new VoxelGrid<PointXYZ>);
+  grid->setLeafSize (0.01f, 0.01f, 0.01f);
+  boost::shared_ptr<StatisticalOutlierRemoval<PointXYZ> > sor (new StatisticalOutlierRemoval<PointXYZ>);
+  sor->setMeanK (4);
+  sor->setStddevMulThresh (1.0);
+
+  // Apply the stages one after the other
+  PointCloud<PointXYZ>::Ptr passed (new PointCloud<PointXYZ>), below (new PointCloud<PointXYZ>),
+                            cropped (new PointCloud<PointXYZ>), grid_output (new PointCloud<PointXYZ>);
+  PointCloud<PointXYZ> expected, expected_cropped_sor;
+  pass->setInputCloud (cloud);
+  pass->filter (*passed);
+  for (size_t i = 0; i < passed->points.size (); ++i)
+    if (isBelowXLimit (passed->points[i]))
+      below->points.push_back (passed->points[i]);
+  below->width = static_cast<uint32_t> (below->points.size ());
+  below->height = 1;
+  crop->setInputCloud (below);
+  crop->filter (*cropped);
+  grid->setInputCloud (cropped);
+  grid->filter (*grid_output);
+  sor->setInputCloud (grid_output);
+  sor->filter (expected);
+  sor->setInputCloud (cropped);
+  sor->filter (expected_cropped_sor);
+  EXPECT_LT (cropped->points.size (), cloud->points.size ());
+  EXPECT_GT (expected.points.size (), 0u);
+
+  // The chain gives the same result, with any number of threads
+  FilterChain<PointXYZ> chain;
+  chain.addFilterIndices (pass);
+  chain.addPredicate (&isBelowXLimit);
+  chain.addFilterIndices (crop);
+  chain.setInputCloud (cloud);
+  for (unsigned int threads = 1; threads <= 4; threads += 3)
+  {
+    chain.setNumberOfThreads (threads);
+    PointCloud<PointXYZ> output;
+    chain.filter (output);
+    ASSERT_EQ (cropped->points.size (), output.points.size ());
+    for (size_t i = 0; i < output.points.size (); ++i)
+      EXPECT_EQ (cropped->points[i].getVector3fMap (), output.points[i].getVector3fMap ());
+  }
+
+  // The outlier removal is given a copy of the points that passed
+  PointCloud<PointXYZ> output;
+  chain.addFilter (sor);
+  chain.filter (output);
+  ASSERT_EQ (expected_cropped_sor.points.size (), output.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (expected_cropped_sor.points[i].getVector3fMap (), output.points[i].getVector3fMap ());
+
+  // The voxel grid is given the indices, the outlier removal a copy of the points that passed
+  chain.clear ();
+  chain.addFilterIndices (pass);
+  chain.addPredicate (&isBelowXLimit);
+  chain.addFilterIndices (crop);
+  chain.addFilter (grid, true);
+  chain.addFilter (sor);
+  EXPECT_EQ (5u, chain.size ());
+  chain.filter (output);
+  ASSERT_EQ (expected.points.size (), output.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+    EXPECT_EQ (expected.points[i].getVector3fMap (), output.points[i].getVector3fMap ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (BilateralFilter, Filters)
+{
+  // A step in intensity across the bunny, with some noise
+  PointCloud<PointXYZI>::Ptr input (new PointCloud<PointXYZI>);
+  Eigen::Vector4f min_pt, max_pt;
+  getMinMax3D (*cloud, min_pt, max_pt);
+  const float x_step = 0.5f * (min_pt[0] + max_pt[0]);
+  input->points.resize (cloud->points.size ());
+  for (size_t i = 0; i < cloud->points.size (); ++i)
+  {
+    input->points[i].getVector3fMap () = cloud->points[i].getVector3fMap ();
+    input->points[i].intensity = (cloud->points[i].x < x_step ? 0.0f : 100.0f) + static_cast<float> (i % 11) - 5.0f;
+  }
+  input->width = static_cast<uint32_t> (input->points.size ());
+  input->height = 1;
+
+  BilateralFilter<PointXYZI> bf;
+  bf.setInputCloud (input);
+  bf.setHalfSize (0.01);
+  bf.setStdDev (20.0);
+
+  PointCloud<PointXYZI> exact, approximate;
+  bf.filter (exact);
+  bf.setApproximate (true);
+  EXPECT_TRUE (bf.getApproximate ());
+  bf.filter (approximate);
+  ASSERT_EQ (input->points.size (), exact.points.size ());
+  ASSERT_EQ (input->points.size (), approximate.points.size ());
+
+  // Both filters remove the noise but keep the step, and agree with each other
+  double noise_exact = 0, noise_approximate = 0, difference = 0;
+  for (size_t i = 0; i < input->points.size (); ++i)
+  {
+    const float step = cloud->points[i].x < x_step ? 0.0f : 100.0f;
+    EXPECT_EQ (input->points[i].getVector3fMap (), approximate.points[i].getVector3fMap ());
+    EXPECT_NEAR (step, exact.points[i].intensity, 10.0f);
+    EXPECT_NEAR (step, approximate.points[i].intensity, 10.0f);
+    noise_exact += fabs (exact.points[i].intensity - step);
+    noise_approximate += fabs (approximate.points[i].intensity - step);
+    difference += fabs (exact.points[i].intensity - approximate.points[i].intensity);
+  }
+  const double nr_points = static_cast<double> (input->points.size ());
+  EXPECT_LT (noise_exact / nr_points, 2.0);
+  EXPECT_LT (noise_approximate / nr_points, 2.0);
+  EXPECT_LT (difference / nr_points, 2.0);
+
+  // The output is the same for any number of threads
+  for (int approximate_mode = 0; approximate_mode < 2; ++approximate_mode)
+  {
+    bf.setApproximate (approximate_mode == 1);
+    bf.setNumberOfThreads (4);
+    PointCloud<PointXYZI> output;
+    bf.filter (output);
+    const PointCloud<PointXYZI> &expected = approximate_mode == 1 ? approximate : exact;
+    for (size_t i = 0; i < output.points.size (); ++i)
+      EXPECT_EQ (expected.points[i].intensity, output.points[i].intensity);
+  }
+
+  // Smooth the depth of a noisy organized plane: the points stay on their viewing rays
+  PointCloud<PointXYZI>::Ptr organized (new PointCloud<PointXYZI> (40, 30));
+  for (int v = 0; v < 30; ++v)
+  {
+    for (int u = 0; u < 40; ++u)
+    {
+      PointXYZI &point = organized->at (u, v);
+      point.z = 1.0f + 0.002f * static_cast<float> ((u * 7 + v * 13) % 5 - 2);
+      point.x = (static_cast<float> (u) - 20.0f) * 0.005f * point.z;
+      point.y = (static_cast<float> (v) - 15.0f) * 0.005f * point.z;
+      point.intensity = 50.0f;
+    }
+  }
+  organized->at (5, 5).x = organized->at (5, 5).y = organized->at (5, 5).z = std::numeric_limits<float>::quiet_NaN ();
+  bf.setInputCloud (organized);
+  bf.setApproximate (true);
+  bf.setFilterDepth (true);
+  bf.setHalfSize (0.02);
+  bf.setNumberOfThreads (1);
+  PointCloud<PointXYZI> smoothed;
+  bf.filter (smoothed);
+  ASSERT_EQ (organized->width, smoothed.width);
+  ASSERT_EQ (organized->height, smoothed.height);
+  EXPECT_FALSE (pcl_isfinite (smoothed.at (5, 5).z));
+  double noise_before = 0, noise_after = 0;
+  for (int v = 5; v < 25; ++v)
+  {
+    for (int u = 5; u < 35; ++u)
+    {
+      if (u == 5 && v == 5)
+        continue;
+      const PointXYZI &before = organized->at (u, v), &after = smoothed.at (u, v);
+      EXPECT_NEAR (50.0f, after.intensity, 1e-3f);
+      EXPECT_NEAR (before.x / before.z, after.x / after.z, 1e-5f);
+      EXPECT_NEAR (before.y / before.z, after.y / after.z, 1e-5f);
+      noise_before += fabs (before.z - 1.0f);
+      noise_after += fabs (after.z - 1.0f);
+    }
+  }
+  EXPECT_LT (noise_after, 0.5 * noise_before);
+
+  // With the sensor away from the coordinate origin, the points move along the rays from the sensor origin. The
+  // offset is a multiple of the grid spacing, so that the points fall at the same place in the grid.
+  PointCloud<PointXYZI>::Ptr shifted (new PointCloud<PointXYZI> (*organized));
+  const Eigen::Vector3f offset (0.5f, -0.3f, 2.0f);
+  for (size_t i = 0; i < shifted->points.size (); ++i)
+    shifted->points[i].getVector3fMap () += offset;
+  shifted->sensor_origin_.head<3> () = offset;
+  bf.setInputCloud (shifted);
+  PointCloud<PointXYZI> smoothed_shifted;
+  bf.filter (smoothed_shifted);
+  ASSERT_EQ (smoothed.points.size (), smoothed_shifted.points.size ());
+  for (size_t i = 0; i < smoothed.points.size (); ++i)
+  {
+    if (!pcl_isfinite (smoothed.points[i].z))
+      continue;
+    EXPECT_NEAR (smoothed.points[i].x + offset[0], smoothed_shifted.points[i].x, 1e-4f);
+    EXPECT_NEAR (smoothed.points[i].y + offset[1], smoothed_shifted.points[i].y, 1e-4f);
+    EXPECT_NEAR (smoothed.points[i].z + offset[2], smoothed_shifted.points[i].z, 1e-4f);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
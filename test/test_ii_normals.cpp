@@ -342,6 +342,72 @@ TEST(PCL, IntegralImage3D)
   delete[] data;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IntegralImage3DMultiThreaded)
+{
+  // the rows are not split evenly between the threads on purpose
+  const unsigned width = 203;
+  const unsigned height = 97;
+  const unsigned element_stride = 4;
+  const unsigned row_stride = width * element_stride;
+  std::vector<float> data (row_stride * height);
+  srand (0);
+  for (size_t i = 0; i < data.size (); ++i)
+    data[i] = static_cast<float> (rand () % 100 - 50);
+  for (size_t i = 0; i < data.size (); i += 37 * element_stride)
+    data[i + 1] = std::numeric_limits<float>::quiet_NaN ();
+
+  IntegralImage2D<float, 3> integral_image (true);
+  integral_image.setNumberOfThreads (4);
+  EXPECT_EQ (integral_image.getNumberOfThreads (), 4);
+  integral_image.setInput (&data[0], width, height, element_stride, row_stride);
+
+  const unsigned window_size = 9;
+  for (unsigned yIdx = 0; yIdx + window_size <= height; yIdx += 3)
+  {
+    for (unsigned xIdx = 0; xIdx + window_size <= width; xIdx += 5)
+    {
+      IntegralImage2D<float, 3>::ElementType ground_truth = IntegralImage2D<float, 3>::ElementType::Zero ();
+      IntegralImage2D<float, 3>::SecondOrderType so_ground_truth = IntegralImage2D<float, 3>::SecondOrderType::Zero ();
+      unsigned count = 0;
+      for (unsigned wy = yIdx; wy < yIdx + window_size; ++wy)
+      {
+        for (unsigned wx = xIdx; wx < xIdx + window_size; ++wx)
+        {
+          const float* val = &data[wy * row_stride + wx * element_stride];
+          if (!pcl_isfinite (val[0] + val[1] + val[2]))
+            continue;
+          ++count;
+          for (unsigned myIdx = 0, elIdx = 0; myIdx < 3; ++myIdx)
+          {
+            ground_truth[myIdx] += val[myIdx];
+            for (unsigned mxIdx = myIdx; mxIdx < 3; ++mxIdx, ++elIdx)
+              so_ground_truth[elIdx] += val[myIdx] * val[mxIdx];
+          }
+        }
+      }
+      EXPECT_EQ (count, integral_image.getFiniteElementsCount (xIdx, yIdx, window_size, window_size));
+      EXPECT_TRUE (ground_truth == integral_image.getFirstOrderSum (xIdx, yIdx, window_size, window_size));
+      EXPECT_TRUE (so_ground_truth == integral_image.getSecondOrderSum (xIdx, yIdx, window_size, window_size));
+    }
+  }
+
+  // a smaller input reuses the buffers of the larger one
+  integral_image.setInput (&data[0], width / 2, height / 2, element_stride, row_stride);
+  IntegralImage2D<float, 3>::ElementType sum = integral_image.getFirstOrderSum (0, 0, width / 2, height / 2);
+  IntegralImage2D<float, 3>::ElementType ground_truth = IntegralImage2D<float, 3>::ElementType::Zero ();
+  for (unsigned wy = 0; wy < height / 2; ++wy)
+  {
+    for (unsigned wx = 0; wx < width / 2; ++wx)
+    {
+      const float* val = &data[wy * row_stride + wx * element_stride];
+      if (pcl_isfinite (val[0] + val[1] + val[2]))
+        ground_truth += Eigen::Vector3f (val[0], val[1], val[2]).cast<double> ();
+    }
+  }
+  EXPECT_TRUE (ground_truth == sum);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, NormalEstimation)
 {
@@ -490,6 +556,68 @@ TEST (PCL, IINormalEstimationSimple3DGradient)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IINormalEstimationMultiThreaded)
+{
+  PointCloud<Normal> output, output_mt;
+  ne.setNormalEstimationMethod (ne.COVARIANCE_MATRIX);
+  ne.setDepthDependentSmoothing (true);
+  ne.setNumberOfThreads (1);
+  ne.compute (output);
+  ne.setNumberOfThreads (4);
+  EXPECT_EQ (ne.getNumberOfThreads (), 4);
+  ne.compute (output_mt);
+  ne.setNumberOfThreads (1);
+  ne.setDepthDependentSmoothing (false);
+
+  ASSERT_EQ (output.points.size (), output_mt.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (pcl_isfinite (output.points[i].normal_x), pcl_isfinite (output_mt.points[i].normal_x));
+    if (!pcl_isfinite (output.points[i].normal_x))
+      continue;
+    EXPECT_EQ (output.points[i].normal_x, output_mt.points[i].normal_x);
+    EXPECT_EQ (output.points[i].normal_y, output_mt.points[i].normal_y);
+    EXPECT_EQ (output.points[i].normal_z, output_mt.points[i].normal_z);
+    EXPECT_EQ (output.points[i].curvature, output_mt.points[i].curvature);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IINormalEstimationMultiThreadedIntegralImages)
+{
+  const IntegralImageNormalEstimation<PointXYZ, Normal>::NormalEstimationMethod methods[] =
+    {ne.COVARIANCE_MATRIX, ne.AVERAGE_3D_GRADIENT, ne.AVERAGE_DEPTH_CHANGE, ne.SIMPLE_3D_GRADIENT};
+
+  for (int m = 0; m < 4; ++m)
+  {
+    PointCloud<Normal> output, output_mt;
+    ne.setRectSize (3, 3);
+    ne.setNormalEstimationMethod (methods[m]);
+    ne.setInputCloud (cloud.makeShared ());
+    ne.compute (output);
+
+    // the integral images are built with 4 threads as well
+    IntegralImageNormalEstimation<PointXYZ, Normal> ne_mt;
+    ne_mt.setNumberOfThreads (4);
+    ne_mt.setRectSize (3, 3);
+    ne_mt.setNormalEstimationMethod (methods[m]);
+    ne_mt.setInputCloud (cloud.makeShared ());
+    ne_mt.compute (output_mt);
+
+    ASSERT_EQ (output.points.size (), output_mt.points.size ());
+    for (size_t i = 0; i < output.points.size (); ++i)
+    {
+      EXPECT_EQ (pcl_isfinite (output.points[i].normal_x), pcl_isfinite (output_mt.points[i].normal_x));
+      if (!pcl_isfinite (output.points[i].normal_x))
+        continue;
+      EXPECT_NEAR (output.points[i].normal_x, output_mt.points[i].normal_x, 1e-4);
+      EXPECT_NEAR (output.points[i].normal_y, output_mt.points[i].normal_y, 1e-4);
+      EXPECT_NEAR (output.points[i].normal_z, output_mt.points[i].normal_z, 1e-4);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IINormalEstimationSimple3DGradientUnorganized)
 {
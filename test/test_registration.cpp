@@ -44,7 +44,9 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/fpfh.h>
 #include <pcl/registration/registration.h>
+#include <pcl/registration/correspondence_estimation.h>
 #include <pcl/registration/icp.h>
+#include <pcl/registration/correspondence_rejection_distance.h>
 #include <pcl/registration/icp_nl.h>
 #include <pcl/registration/transformation_estimation_point_to_plane.h>
 #include <pcl/registration/transformation_validation_euclidean.h>
@@ -150,6 +152,42 @@ TEST (PCL, findFeatureCorrespondences)
 */
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, CorrespondenceEstimationMultiThreaded)
+{
+  pcl::registration::CorrespondenceEstimation<PointXYZ, PointXYZ> est;
+  est.setInputCloud (cloud_source.makeShared ());
+  est.setInputTarget (cloud_target.makeShared ());
+
+  Correspondences serial, parallel;
+  est.determineCorrespondences (serial, 0.05f);
+  est.setNumberOfThreads (4);
+  EXPECT_EQ (est.getNumberOfThreads (), 4u);
+  est.determineCorrespondences (parallel, 0.05f);
+
+  ASSERT_EQ (serial.size (), parallel.size ());
+  for (size_t i = 0; i < serial.size (); ++i)
+  {
+    EXPECT_EQ (serial[i].index_query, parallel[i].index_query);
+    EXPECT_EQ (serial[i].index_match, parallel[i].index_match);
+    EXPECT_EQ (serial[i].distance, parallel[i].distance);
+  }
+
+  Correspondences serial_reciprocal, parallel_reciprocal;
+  est.setNumberOfThreads (1);
+  est.determineReciprocalCorrespondences (serial_reciprocal);
+  est.setNumberOfThreads (4);
+  est.determineReciprocalCorrespondences (parallel_reciprocal);
+
+  ASSERT_EQ (serial_reciprocal.size (), parallel_reciprocal.size ());
+  for (size_t i = 0; i < serial_reciprocal.size (); ++i)
+  {
+    EXPECT_EQ (serial_reciprocal[i].index_query, parallel_reciprocal[i].index_query);
+    EXPECT_EQ (serial_reciprocal[i].index_match, parallel_reciprocal[i].index_match);
+    EXPECT_EQ (serial_reciprocal[i].distance, parallel_reciprocal[i].distance);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IterativeClosestPoint)
 {
@@ -187,6 +225,60 @@ TEST (PCL, IterativeClosestPoint)
   EXPECT_EQ (transformation (3, 3), 1);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IterativeClosestPoint_RejectionChain)
+{
+  IterativeClosestPoint<PointXYZ, PointXYZ> reg;
+  reg.setInputCloud (cloud_source.makeShared ());
+  reg.setInputTarget (cloud_target.makeShared ());
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.setMaxCorrespondenceDistance (0.05);
+
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorDistance> rej_dist (new pcl::registration::CorrespondenceRejectorDistance);
+  rej_dist->setMaximumDistance (0.05f);
+  boost::shared_ptr<pcl::registration::CorrespondenceRejectorSampleConsensus<PointXYZ> > rej_sac (new pcl::registration::CorrespondenceRejectorSampleConsensus<PointXYZ>);
+  rej_sac->setInlierThreshold (0.05);
+  rej_sac->setMaxIterations (1000);
+  reg.addCorrespondenceRejector (rej_dist);
+  reg.addCorrespondenceRejector (rej_sac);
+  EXPECT_EQ (int (reg.getCorrespondenceRejectors ().size ()), 2);
+
+  // Register twice, the second run reuses the internal buffers of the first one
+  PointCloud<PointXYZ> output;
+  reg.align (output);
+  Eigen::Matrix4f first_transformation = reg.getFinalTransformation ();
+  reg.align (output);
+  EXPECT_EQ (int (output.points.size ()), int (cloud_source.points.size ()));
+  EXPECT_TRUE (reg.hasConverged ());
+
+  Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+  EXPECT_NEAR (transformation (0, 0), 0.8806,  1e-3);
+  EXPECT_NEAR (transformation (0, 2), -0.4724, 1e-3);
+  EXPECT_NEAR (transformation (1, 1),  0.9992,   1e-3);
+  EXPECT_NEAR (transformation (2, 0),  0.4732,  1e-3);
+  EXPECT_NEAR (transformation (2, 2),  0.8808,  1e-3);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR (transformation (i, j), first_transformation (i, j), 1e-3);
+
+  // One timing record per iteration
+  const std::vector<IterativeClosestPoint<PointXYZ, PointXYZ>::IterationTiming> &timings = reg.getIterationTimings ();
+  EXPECT_FALSE (timings.empty ());
+  for (size_t i = 0; i < timings.size (); ++i)
+  {
+    EXPECT_GE (timings[i].correspondence_search, 0);
+    EXPECT_GE (timings[i].rejection, 0);
+    EXPECT_GE (timings[i].total, timings[i].correspondence_search);
+  }
+
+  // Without RANSAC and without a chain, no correspondence is rejected
+  reg.clearCorrespondenceRejectors ();
+  reg.setRANSACIterations (0);
+  reg.align (output);
+  EXPECT_EQ (int (output.points.size ()), int (cloud_source.points.size ()));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IterativeClosestPointNonLinear)
 {
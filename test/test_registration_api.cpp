@@ -183,6 +183,14 @@ TEST (PCL, CorrespondenceRejectorSampleConsensus)
   for (int i = 0; i < 4; ++i)
     for (int j = 0; j < 4; ++j)
       EXPECT_NEAR (transform_res_from_SAC (i, j), transform_from_SAC[i][j], 1e-4);
+
+  // Without any inlier, all the correspondences are kept, unless only the inliers are asked for
+  corr_rej_sac.setInlierThreshold (0.0);
+  corr_rej_sac.getCorrespondences (*correspondences_result_rej_sac);
+  EXPECT_EQ (correspondences_result_rej_sac->size (), correspondences->size ());
+  corr_rej_sac.setKeepAllOnFewInliers (false);
+  corr_rej_sac.getCorrespondences (*correspondences_result_rej_sac);
+  EXPECT_EQ (int (correspondences_result_rej_sac->size ()), 0);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -215,6 +215,58 @@ TEST (MSAC, SampleConsensusModelPlane)
   verifyPlaneSac (model, sac);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename SacType>
+void verifyMultiThreadedSac ()
+{
+  // Both estimators draw the same models, so they have to find the same solution
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+  SacType sac (model, 0.03);
+  ASSERT_EQ (sac.computeModel (), true);
+
+  SampleConsensusModelPlanePtr model_mt (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+  SacType sac_mt (model_mt, 0.03);
+  sac_mt.setNumberOfThreads (4);
+  ASSERT_EQ (sac_mt.getNumberOfThreads (), 4u);
+  ASSERT_EQ (sac_mt.computeModel (), true);
+
+  std::vector<int> sample, sample_mt, inliers, inliers_mt;
+  sac.getModel (sample);
+  sac_mt.getModel (sample_mt);
+  EXPECT_EQ (sample, sample_mt);
+  sac.getInliers (inliers);
+  sac_mt.getInliers (inliers_mt);
+  EXPECT_EQ (inliers, inliers_mt);
+  Eigen::VectorXf coeff, coeff_mt;
+  sac.getModelCoefficients (coeff);
+  sac_mt.getModelCoefficients (coeff_mt);
+  EXPECT_EQ (coeff, coeff_mt);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SAC, MultiThreaded)
+{
+  verifyMultiThreadedSac<RandomSampleConsensus<PointXYZ> > ();
+  verifyMultiThreadedSac<MEstimatorSampleConsensus<PointXYZ> > ();
+  verifyMultiThreadedSac<MaximumLikelihoodSampleConsensus<PointXYZ> > ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RANSAC, PreTest)
+{
+  srand (0);
+  // Create a shared plane model pointer directly
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+
+  // Create the RANSAC object, dropping the models that fail the T(1,1) test
+  RandomSampleConsensus<PointXYZ> sac (model, 0.03);
+  sac.setPreTestSize (1);
+  ASSERT_EQ (sac.getPreTestSize (), 1u);
+  sac.setNumberOfThreads (2);
+
+  verifyPlaneSac (model, sac);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RRANSAC, SampleConsensusModelPlane)
 {
@@ -40,6 +40,7 @@
 #include <pcl/search/kdtree.h>
 #include <pcl/search/organized.h>
 #include <pcl/search/octree.h>
+#include <pcl/search/neighborhood_cache.h>
 #include <pcl/io/pcd_io.h>
 #include <boost/smart_ptr/shared_array.hpp>
 #include <boost/random/mersenne_twister.hpp>
@@ -65,10 +66,14 @@ using namespace std;
 #define TEST_unorganized_dense_cloud_VIEW_RADIUS      1
 #define TEST_unorganized_sparse_cloud_COMPLETE_RADIUS 1
 #define TEST_unorganized_sparse_cloud_VIEW_RADIUS     1
+#define TEST_unorganized_dense_cloud_BATCH            1
+#define TEST_unorganized_dense_cloud_CACHE            1
 #define TEST_ORGANIZED_SPARSE_COMPLETE_KNN            1
 #define TEST_ORGANIZED_SPARSE_VIEW_KNN                1
 #define TEST_ORGANIZED_SPARSE_COMPLETE_RADIUS         1
 #define TEST_ORGANIZED_SPARSE_VIEW_RADIUS             1
+#define TEST_ORGANIZED_SPARSE_BATCH                   1
+#define TEST_ORGANIZED_FRAME_BATCH_BENCHMARK          1
 
 #if EXCESSIVE_TESTING
 /** \brief number of points used for creating unordered point clouds */
@@ -415,6 +420,53 @@ testRadiusSearch (typename PointCloud<PointT>::ConstPtr point_cloud, vector<sear
   }
 }
 
+/** \brief does batched KNN and radius searches and tests whether they return the same results as the single query searches
+  * \param cloud the input point cloud
+  * \param search_methods vector of all search methods to be tested
+  * \param query_indices indices of query points in the point cloud
+  * \param nr_threads number of threads used by the batched searches
+  */
+template<typename PointT> void
+testBatchSearch (typename PointCloud<PointT>::ConstPtr point_cloud, vector<search::Search<PointT>*> search_methods,
+                 const vector<int>& query_indices, unsigned nr_threads)
+{
+  vector<int> indices, batch_indices, offsets;
+  vector<float> distances, batch_distances;
+
+  for (size_t sIdx = 0; sIdx < search_methods.size (); ++sIdx)
+  {
+    bool passed = true;
+    search_methods [sIdx]->setInputCloud (point_cloud);
+
+    const int knn = 8;
+    search_methods [sIdx]->batchNearestKSearch (*point_cloud, query_indices, knn, batch_indices, batch_distances, nr_threads);
+    passed = passed && (batch_indices.size () == query_indices.size () * knn);
+    for (size_t qIdx = 0; qIdx < query_indices.size () && passed; ++qIdx)
+    {
+      search_methods [sIdx]->nearestKSearch (*point_cloud, query_indices [qIdx], knn, indices, distances);
+      passed = compareResults (indices, distances, search_methods [sIdx]->getName (),
+                               vector<int> (batch_indices.begin () + qIdx * knn, batch_indices.begin () + (qIdx + 1) * knn),
+                               vector<float> (batch_distances.begin () + qIdx * knn, batch_distances.begin () + (qIdx + 1) * knn),
+                               search_methods [sIdx]->getName () + " (batch)", 1e-6f);
+    }
+
+    const double radius = 0.05;
+    search_methods [sIdx]->batchRadiusSearch (*point_cloud, query_indices, radius, batch_indices, batch_distances, offsets, 0, nr_threads);
+    passed = passed && (offsets.size () == query_indices.size () + 1);
+    for (size_t qIdx = 0; qIdx < query_indices.size () && passed; ++qIdx)
+    {
+      search_methods [sIdx]->radiusSearch (*point_cloud, query_indices [qIdx], radius, indices, distances);
+      passed = compareResults (indices, distances, search_methods [sIdx]->getName (),
+                               vector<int> (batch_indices.begin () + offsets [qIdx], batch_indices.begin () + offsets [qIdx + 1]),
+                               vector<float> (batch_distances.begin () + offsets [qIdx], batch_distances.begin () + offsets [qIdx + 1]),
+                               search_methods [sIdx]->getName () + " (batch)", 1e-6f);
+    }
+
+    cout << search_methods [sIdx]->getName () << " batch: " << (passed?"passed":"failed") << endl;
+    EXPECT_TRUE (passed);
+  }
+}
+
 #if TEST_unorganized_dense_cloud_COMPLETE_KNN
 // Test search on unorganized point clouds
 TEST (PCL, unorganized_dense_cloud_Complete_KNN)
@@ -493,6 +545,86 @@ TEST (PCL, unorganized_sparse_cloud_View_Radius)
 }
 #endif
 
+#if TEST_unorganized_dense_cloud_BATCH
+TEST (PCL, unorganized_dense_cloud_Batch)
+{
+  testBatchSearch (unorganized_dense_cloud, unorganized_search_methods, unorganized_dense_cloud_query_indices, 1);
+  testBatchSearch (unorganized_dense_cloud, unorganized_search_methods, unorganized_dense_cloud_query_indices, 4);
+}
+#endif
+
+#if TEST_unorganized_dense_cloud_CACHE
+TEST (PCL, unorganized_dense_cloud_Neighborhood_Cache)
+{
+  search::Search<PointXYZ>::Ptr kdtree (new search::KdTree<PointXYZ>);
+  search::NeighborhoodCache<PointXYZ> cache (kdtree);
+  cache.setInputCloud (unorganized_dense_cloud);
+  cache.setNumberOfThreads (4);
+
+  vector<int> indices, cached_indices;
+  vector<float> distances, cached_distances;
+  bool passed = true;
+
+  // Radius searches up to the stored radius come from the table, larger ones from the tree
+  const double radius = 0.1;
+  cache.computeRadiusNeighborhoods (unorganized_dense_cloud, radius);
+  const double radii[] = {radius, radius * 0.5, radius * 2.0};
+  for (size_t qIdx = 0; qIdx < unorganized_dense_cloud_query_indices.size (); ++qIdx)
+  {
+    for (int rIdx = 0; rIdx < 3; ++rIdx)
+    {
+      kdtree->radiusSearch (*unorganized_dense_cloud, unorganized_dense_cloud_query_indices [qIdx], radii [rIdx], indices, distances);
+      cache.radiusSearch (*unorganized_dense_cloud, unorganized_dense_cloud_query_indices [qIdx], radii [rIdx], cached_indices, cached_distances);
+      passed = passed && compareResults (indices, distances, "kdtree", cached_indices, cached_distances, "cache", 1e-6f);
+    }
+  }
+  EXPECT_TRUE (passed);
+  const int *nn_indices;
+  const float *nn_dists;
+  EXPECT_GT (cache.getNeighborhood (unorganized_dense_cloud_query_indices [0], nn_indices, nn_dists), 0);
+
+  // Once sorted, the smaller radius neighborhoods are prefixes of the stored ones
+  EXPECT_FALSE (cache.getSortedNeighborhoods ());
+  cache.sortNeighborhoods ();
+  EXPECT_TRUE (cache.getSortedNeighborhoods ());
+  for (size_t qIdx = 0; qIdx < unorganized_dense_cloud_query_indices.size (); ++qIdx)
+  {
+    for (int rIdx = 0; rIdx < 2; ++rIdx)
+    {
+      kdtree->radiusSearch (*unorganized_dense_cloud, unorganized_dense_cloud_query_indices [qIdx], radii [rIdx], indices, distances);
+      cache.radiusSearch (*unorganized_dense_cloud, unorganized_dense_cloud_query_indices [qIdx], radii [rIdx], cached_indices, cached_distances);
+      passed = passed && compareResults (indices, distances, "kdtree", cached_indices, cached_distances, "cache", 1e-6f);
+      for (size_t i = 1; i < cached_distances.size (); ++i)
+        passed = passed && (cached_distances [i - 1] <= cached_distances [i]);
+    }
+  }
+  EXPECT_TRUE (passed);
+
+  // Same for k-nearest neighbor searches up to the stored k
+  const int knn = 8;
+  cache.computeNearestKNeighborhoods (unorganized_dense_cloud, knn);
+  EXPECT_EQ (cache.getK (), knn);
+  const int ks[] = {knn, 3, 2 * knn};
+  for (size_t qIdx = 0; qIdx < unorganized_dense_cloud_query_indices.size (); ++qIdx)
+  {
+    for (int kIdx = 0; kIdx < 3; ++kIdx)
+    {
+      kdtree->nearestKSearch (*unorganized_dense_cloud, unorganized_dense_cloud_query_indices [qIdx], ks [kIdx], indices, distances);
+      cache.nearestKSearch (*unorganized_dense_cloud, unorganized_dense_cloud_query_indices [qIdx], ks [kIdx], cached_indices, cached_distances);
+      passed = passed && compareResults (indices, distances, "kdtree", cached_indices, cached_distances, "cache", 1e-6f);
+    }
+  }
+  EXPECT_TRUE (passed);
+
+  // The batch searches are answered from the table too
+  testBatchSearch (unorganized_dense_cloud, vector<search::Search<PointXYZ>*> (1, &cache), unorganized_dense_cloud_query_indices, 1);
+
+  // A new input cloud invalidates the stored neighborhoods
+  cache.setInputCloud (unorganized_sparse_cloud);
+  EXPECT_EQ (cache.getNeighborhood (unorganized_dense_cloud_query_indices [0], nn_indices, nn_dists), -1);
+}
+#endif
+
 #if TEST_ORGANIZED_SPARSE_COMPLETE_KNN
 TEST (PCL, Organized_Sparse_Complete_KNN)
 {
@@ -521,6 +653,78 @@ TEST (PCL, Organized_Sparse_View_Radius)
 }
 #endif
 
+#if TEST_ORGANIZED_SPARSE_BATCH
+TEST (PCL, Organized_Sparse_Batch)
+{
+  testBatchSearch (organized_sparse_cloud, organized_search_methods, organized_sparse_query_indices, 4);
+}
+#endif
+
+#if TEST_ORGANIZED_FRAME_BATCH_BENCHMARK
+// Compare the batched organized search against one query at a time, on a full 640x480 frame
+TEST (PCL, Organized_Frame_Batch_Benchmark)
+{
+  // slanted wall seen by a Kinect like camera
+  PointCloud<PointXYZ>::Ptr frame (new PointCloud<PointXYZ> (640, 480));
+  const float focal_length = 525.0f;
+  for (unsigned yIdx = 0; yIdx < frame->height; ++yIdx)
+  {
+    for (unsigned xIdx = 0; xIdx < frame->width; ++xIdx)
+    {
+      float z = 1.0f + 0.002f * static_cast<float> (xIdx) + 0.001f * rand_float ();
+      (*frame) (xIdx, yIdx) = PointXYZ ((static_cast<float> (xIdx) - 319.5f) * z / focal_length,
+                                        (static_cast<float> (yIdx) - 239.5f) * z / focal_length, z);
+    }
+  }
+
+  pcl::search::OrganizedNeighbor<PointXYZ> frame_search;
+  frame_search.setInputCloud (frame);
+
+  const double radius = 0.01;
+  const unsigned nr_threads = 4;
+  vector<int> indices, batch_indices, offsets;
+  vector<float> distances, batch_distances;
+  size_t nr_neighbors = 0;
+
+  double start = getTime ();
+  for (int pIdx = 0; pIdx < static_cast<int> (frame->size ()); ++pIdx)
+    nr_neighbors += frame_search.radiusSearch (frame->points [pIdx], radius, indices, distances);
+  double serial_time = getTime () - start;
+
+  start = getTime ();
+  frame_search.batchRadiusSearch (*frame, vector<int> (), radius, batch_indices, batch_distances, offsets, 0, nr_threads);
+  double batch_time = getTime () - start;
+
+  ASSERT_EQ (offsets.size (), frame->size () + 1);
+  EXPECT_EQ (batch_indices.size (), nr_neighbors);
+  for (int pIdx = 0; pIdx < static_cast<int> (frame->size ()); pIdx += 997)
+  {
+    frame_search.radiusSearch (frame->points [pIdx], radius, indices, distances);
+    EXPECT_TRUE (compareResults (indices, distances, "serial",
+                                 vector<int> (batch_indices.begin () + offsets [pIdx], batch_indices.begin () + offsets [pIdx + 1]),
+                                 vector<float> (batch_distances.begin () + offsets [pIdx], batch_distances.begin () + offsets [pIdx + 1]),
+                                 "batch", 1e-6f));
+  }
+
+  const int knn = 9;
+  start = getTime ();
+  for (int pIdx = 0; pIdx < static_cast<int> (frame->size ()); ++pIdx)
+    frame_search.nearestKSearch (frame->points [pIdx], knn, indices, distances);
+  double serial_knn_time = getTime () - start;
+
+  start = getTime ();
+  frame_search.batchNearestKSearch (*frame, vector<int> (), knn, batch_indices, batch_distances, nr_threads);
+  double batch_knn_time = getTime () - start;
+
+  EXPECT_EQ (batch_indices.size (), frame->size () * knn);
+
+  cout << "640x480 frame, radius search: " << serial_time * 1000.0 << " ms serial, " << batch_time * 1000.0
+       << " ms batched with " << nr_threads << " threads" << endl;
+  cout << "640x480 frame, " << knn << "-NN search: " << serial_knn_time * 1000.0 << " ms serial, " << batch_knn_time * 1000.0
+       << " ms batched with " << nr_threads << " threads" << endl;
+}
+#endif
+
 /** \brief create subset of point in cloud to use as query points
   * \param[out] query_indices resulting query indices - not guaranteed to have size of query_count but guaranteed not to exceed that value
   * \param cloud input cloud required to check for nans and to get number of points
@@ -45,6 +45,7 @@
 #include <pcl/search/search.h>
 #include <pcl/features/normal_3d.h>
 
+#include <pcl/segmentation/extract_clusters.h>
 #include <pcl/segmentation/extract_polygonal_prism_data.h>
 #include <pcl/segmentation/segment_differences.h>
 #include <pcl/segmentation/region_growing.h>
@@ -383,6 +384,58 @@ TEST (SegmentDifferences, Segmentation)
   //savePCDFile ("./test/t-0.pcd", output);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, MultiThreaded)
+{
+  EuclideanClusterExtraction<PointXYZ> ec;
+  ec.setInputCloud (another_cloud_);
+  ec.setClusterTolerance (0.08);
+  ec.setMinClusterSize (5);
+
+  std::vector<PointIndices> clusters;
+  ec.extract (clusters);
+  EXPECT_GT (static_cast<int> (clusters.size ()), 1);
+
+  // The union-find version has to find exactly the same clusters, in the same order
+  std::vector<PointIndices> clusters_mt;
+  ec.setNumberOfThreads (4);
+  EXPECT_EQ (ec.getNumberOfThreads (), 4u);
+  ec.extract (clusters_mt);
+  ASSERT_EQ (clusters_mt.size (), clusters.size ());
+  for (size_t i = 0; i < clusters.size (); ++i)
+    EXPECT_EQ (clusters_mt[i].indices, clusters[i].indices);
+
+  // With a subset of the points, both versions find the clusters of the subset alone
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = 0; i < static_cast<int> (another_cloud_->points.size ()); ++i)
+    if (i % 3 != 0)
+      indices->push_back (i);
+  PointCloud<PointXYZ>::Ptr subset (new PointCloud<PointXYZ>);
+  copyPointCloud (*another_cloud_, *indices, *subset);
+
+  std::vector<PointIndices> clusters_subset;
+  ec.setNumberOfThreads (1);
+  ec.setInputCloud (subset);
+  ec.extract (clusters_subset);
+  EXPECT_GT (static_cast<int> (clusters_subset.size ()), 1);
+
+  ec.setInputCloud (another_cloud_);
+  ec.setIndices (indices);
+  for (unsigned int nr_threads = 1; nr_threads <= 4; nr_threads += 3)
+  {
+    std::vector<PointIndices> clusters_indices;
+    ec.setNumberOfThreads (nr_threads);
+    ec.extract (clusters_indices);
+    ASSERT_EQ (clusters_indices.size (), clusters_subset.size ());
+    for (size_t i = 0; i < clusters_subset.size (); ++i)
+    {
+      ASSERT_EQ (clusters_indices[i].indices.size (), clusters_subset[i].indices.size ());
+      for (size_t j = 0; j < clusters_subset[i].indices.size (); ++j)
+        EXPECT_EQ (clusters_indices[i].indices[j], (*indices)[clusters_subset[i].indices[j]]);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ExtractPolygonalPrism, Segmentation)
 {